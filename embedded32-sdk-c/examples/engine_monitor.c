@@ -8,11 +8,17 @@
  * 3. Request specific PGNs
  * 4. Send control commands
  * 
- * Compile: gcc -I../include -o engine_monitor engine_monitor.c ../src/*.c
+ * Build: cmake -S .. -B ../build && cmake --build ../build
+ *        (target engine_monitor)
+ * 
+ * Run:   ./engine_monitor [interface]   (default can0; on Linux the
+ *        interface must exist, e.g. a vcan0 made with
+ *        "ip link add dev vcan0 type vcan && ip link set up vcan0")
  */
 
 #include "embedded32.h"
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 
 /* Engine state tracking */
@@ -62,7 +68,7 @@ void on_engine_temperature(const e32_j1939_message_t* msg, void* ctx)
     }
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
     printf("======================================\n");
     printf("  Embedded32 SDK - Engine Monitor\n");
@@ -79,7 +85,7 @@ int main(void)
     
     /* Create client configuration */
     e32_j1939_config_t config = {
-        .interface_name = "can0",
+        .interface_name = argc > 1 ? argv[1] : "can0",
         .source_address = E32_SA_DIAG_TOOL_2,
         .transport = E32_TRANSPORT_AUTO,
         .bitrate = 250000,
@@ -97,7 +103,7 @@ int main(void)
     /* Connect to network */
     err = e32_j1939_connect(client);
     if (err != E32_OK) {
-        printf("Failed to connect: %d\n", err);
+        printf("Failed to connect to %s: %d\n", config.interface_name, err);
         e32_j1939_destroy(client);
         return 1;
     }
@@ -105,8 +111,8 @@ int main(void)
     printf("Connected as SA=0x%02X\n\n", e32_j1939_get_source_address(client));
     
     /* Subscribe to PGNs */
-    e32_j1939_on_pgn(client, E32_PGN_EEC1, on_engine_controller, NULL);
-    e32_j1939_on_pgn(client, E32_PGN_ET1, on_engine_temperature, NULL);
+    e32_j1939_on_pgn(client, E32_PGN_EEC1, on_engine_controller, NULL, NULL);
+    e32_j1939_on_pgn(client, E32_PGN_ET1, on_engine_temperature, NULL, NULL);
     
     /* Request initial data */
     printf("Requesting engine data...\n\n");
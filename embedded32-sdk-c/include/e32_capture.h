@@ -0,0 +1,250 @@
+/**
+ * @file e32_capture.h
+ * @brief Embedded32 SDK - Binary CAN Capture Files
+ *
+ * Compact capture format for recording and replaying raw frame streams.
+ *
+ * File layout (all fields little-endian):
+ *
+ *   [header, 64 bytes][block index][records ...]
+ *
+ * Records are fixed-size (20 bytes, 76 in E32_CFG_CAN_FD builds, which
+ * therefore read only their own captures), so record i lives at
+ * records_offset + i * record_size. The block index holds the timestamp
+ * of the first record of every block of block_records records, which
+ * makes seeking by time a binary search over the index followed by a
+ * short scan inside one block.
+ *
+ * The writer appends to a ring of pre-sized files that are memory-mapped:
+ * recording a frame is a copy into the mapping, with no per-record
+ * syscalls, so it can run from a handler inside e32_j1939_poll(). When a
+ * file fills up the writer moves to the next one, overwriting the
+ * oldest. That file is created ahead of time by
+ * e32_capture_writer_flush(), so with a ring of N files N-1 hold
+ * records and one stands ready. The reader maps a file read-only and
+ * hands out records in place.
+ *
+ * Available on POSIX hosts; elsewhere the functions return
+ * E32_ERR_NOT_SUPPORTED.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_CAPTURE_H
+#define E32_CAPTURE_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==========================================================================
+ * FILE FORMAT
+ * ========================================================================== */
+
+/** File magic: "E32CAP" followed by two NUL bytes */
+#define E32_CAPTURE_MAGIC           "E32CAP\0\0"
+
+/** Current format version */
+#define E32_CAPTURE_VERSION         1
+
+/** Records per index block */
+#define E32_CAPTURE_BLOCK_RECORDS   256
+
+/** Record flag: 29-bit extended identifier */
+#define E32_CAPTURE_FLAG_EXTENDED   0x01
+
+/** Record flags: E32_CAN_FLAG_FD, _BRS and _ESI of the frame, shifted up by one */
+#define E32_CAPTURE_FLAG_FD         0x02
+#define E32_CAPTURE_FLAG_BRS        0x04
+#define E32_CAPTURE_FLAG_ESI        0x08
+
+/** Longest base path accepted by the writer */
+#define E32_CAPTURE_PATH_MAX        240
+
+/**
+ * @brief One captured frame (20 bytes, 76 with E32_CFG_CAN_FD)
+ */
+typedef struct {
+    uint32_t timestamp;         /**< Frame timestamp, ms */
+    uint32_t id;                /**< CAN identifier */
+    uint8_t  dlc;               /**< Data length in bytes */
+    uint8_t  flags;             /**< E32_CAPTURE_FLAG_* */
+    uint8_t  channel;           /**< Bus the frame was seen on */
+    uint8_t  reserved;
+    uint8_t  data[E32_CAN_MAX_DATA_LEN];
+} e32_capture_record_t;
+
+/**
+ * @brief File header (64 bytes)
+ */
+typedef struct {
+    char     magic[8];          /**< E32_CAPTURE_MAGIC */
+    uint16_t version;           /**< E32_CAPTURE_VERSION */
+    uint16_t record_size;       /**< sizeof(e32_capture_record_t) */
+    uint32_t block_records;     /**< Records per index block */
+    uint32_t index_offset;      /**< Byte offset of the block index */
+    uint32_t records_offset;    /**< Byte offset of record 0 */
+    uint32_t capacity;          /**< Records the file was sized for */
+    uint32_t count;             /**< Records written */
+    uint32_t sequence;          /**< Position in the writer's file sequence */
+    uint32_t first_timestamp;   /**< Timestamp of record 0 */
+    uint32_t last_timestamp;    /**< Timestamp of the last record */
+    uint8_t  reserved[20];
+} e32_capture_header_t;
+
+
+/* ==========================================================================
+ * WRITER
+ * ========================================================================== */
+
+/**
+ * @brief Capture writer state (treat as opaque)
+ */
+typedef struct {
+    char                   base_path[E32_CAPTURE_PATH_MAX];
+    uint32_t               file_count;
+    uint32_t               records_per_file;
+    uint32_t               file_index;      /**< Current file in the ring */
+    uint32_t               sequence;        /**< Files started so far */
+    int                    fd;
+    uint8_t*               map;
+    size_t                 map_len;
+    e32_capture_header_t*  header;
+    uint32_t*              index;
+    e32_capture_record_t*  records;
+    int                    spare_fd;        /**< Next file, created ahead of the switch */
+    uint8_t*               spare_map;
+    size_t                 spare_len;
+    int                    retired_fd;      /**< Full file awaiting unmap by flush */
+    uint8_t*               retired_map;
+    size_t                 retired_len;
+    uint32_t               dropped;         /**< Frames lost to rotation failures */
+} e32_capture_writer_t;
+
+/**
+ * @brief Open a ring of capture files
+ *
+ * Files are named "<base_path>.<n>.e32cap" for n = 0 .. file_count-1
+ * and are created or overwritten at full size, with their disk blocks
+ * allocated, when the writer gets to them. Files 0 and 1 are created here.
+ *
+ * @param writer Writer state
+ * @param base_path Path prefix
+ * @param file_count Files in the ring (>= 1)
+ * @param records_per_file Capacity of each file
+ * @return E32_OK, E32_ERR_IO if a file cannot be created, allocated
+ *         (e.g. the disk is full) or mapped
+ */
+e32_error_t e32_capture_writer_open(
+    e32_capture_writer_t* writer,
+    const char* base_path,
+    uint32_t file_count,
+    uint32_t records_per_file
+);
+
+/**
+ * @brief Append one frame
+ *
+ * A copy into the mapped file. Switching to the next file in the ring
+ * (once per records_per_file frames) is a swap to the file created by
+ * the last e32_capture_writer_flush(); if no flush ran since the last
+ * switch, or the ring has one file, the switch creates it inline.
+ *
+ * @return E32_OK, or E32_ERR_IO if moving to the next file failed
+ */
+e32_error_t e32_capture_write(e32_capture_writer_t* writer, const e32_can_frame_t* frame);
+
+/**
+ * @brief View handler that records every frame it receives
+ *
+ * Subscribe with the writer as user data to record the bus:
+ * @code
+ * e32_j1939_on_pgn_view(client, E32_PGN_ANY, e32_capture_view_handler, &writer, NULL);
+ * @endcode
+ * Reassembled transport messages are skipped; their TP.CM/TP.DT frames
+ * are recorded individually.
+ */
+void e32_capture_view_handler(const e32_j1939_view_t* view, void* writer);
+
+/**
+ * @brief Schedule written pages for write-back and prepare the next file
+ *
+ * Unmaps the file the writer last moved away from and creates the next
+ * file in the ring. Call it periodically from outside the receive path,
+ * e.g. once a second from a timer, so switching files stays a swap.
+ *
+ * @return E32_OK, or E32_ERR_IO if the next file cannot be created
+ */
+e32_error_t e32_capture_writer_flush(e32_capture_writer_t* writer);
+
+/**
+ * @brief Flush, unmap and close the current and prepared files
+ */
+void e32_capture_writer_close(e32_capture_writer_t* writer);
+
+
+/* ==========================================================================
+ * READER
+ * ========================================================================== */
+
+/**
+ * @brief Capture reader state (treat as opaque)
+ */
+typedef struct {
+    int                          fd;
+    const uint8_t*               map;
+    size_t                       map_len;
+    const e32_capture_header_t*  header;
+    const uint32_t*              index;
+    const e32_capture_record_t*  records;
+    uint32_t                     count;
+} e32_capture_reader_t;
+
+/**
+ * @brief Map a capture file read-only
+ *
+ * @return E32_OK, E32_ERR_IO if the file cannot be opened or mapped,
+ *         E32_ERR_INVALID_PARAM if it is not a valid capture file
+ */
+e32_error_t e32_capture_reader_open(e32_capture_reader_t* reader, const char* path);
+
+/**
+ * @brief Direct access to the mapped records
+ *
+ * @param count Receives the number of valid records
+ * @return First record (valid until the reader is closed)
+ */
+const e32_capture_record_t* e32_capture_records(const e32_capture_reader_t* reader, uint32_t* count);
+
+/**
+ * @brief Find the first record with timestamp >= the given time
+ *
+ * Assumes timestamps are non-decreasing within the file.
+ *
+ * @return Record index, or the record count if every record is older
+ */
+uint32_t e32_capture_seek(const e32_capture_reader_t* reader, uint32_t timestamp);
+
+/**
+ * @brief Copy a record out as a CAN frame
+ *
+ * @return E32_OK, or E32_ERR_NOT_FOUND if index is out of range
+ */
+e32_error_t e32_capture_get_frame(
+    const e32_capture_reader_t* reader,
+    uint32_t index,
+    e32_can_frame_t* frame
+);
+
+/**
+ * @brief Unmap and close
+ */
+void e32_capture_reader_close(e32_capture_reader_t* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_CAPTURE_H */
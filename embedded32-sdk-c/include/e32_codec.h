@@ -25,15 +25,31 @@ extern "C" {
  */
 typedef struct {
     uint8_t  priority;              /**< Priority (0-7) */
-    uint32_t pgn;                   /**< Parameter Group Number */
+    uint32_t pgn;                   /**< Parameter Group Number (18 bits, EDP/DP included) */
     uint8_t  source_address;        /**< Source Address */
     uint8_t  destination_address;   /**< Destination Address */
     bool     pdu1;                  /**< True if PDU1 format */
 } e32_j1939_id_t;
 
+/**
+ * @brief 0xFF if the identifier is PDU2 (PF >= 240), else 0
+ * 
+ * Branch-free, so it vectorises when applied over an array.
+ * 
+ * @param can_id 29-bit CAN ID
+ */
+static inline uint32_t e32_j1939_pdu2_mask(uint32_t can_id)
+{
+    return (0u - ((((can_id >> 16) & 0xFF) + 16) >> 8)) & 0xFF;
+}
+
 /**
  * @brief Parse a J1939 extended CAN ID
  * 
+ * The PGN keeps all 18 bits, EDP and DP included, so data page 1 PGNs
+ * do not alias those of page 0. No branches: every received frame goes
+ * through here.
+ * 
  * @param can_id 29-bit CAN ID
  * @param parsed Output structure
  */
@@ -42,7 +58,9 @@ void e32_parse_j1939_id(uint32_t can_id, e32_j1939_id_t* parsed);
 /**
  * @brief Build a J1939 extended CAN ID
  * 
- * @param pgn Parameter Group Number
+ * EDP and DP (PGN bits 17-16) go to identifier bits 25-24.
+ * 
+ * @param pgn Parameter Group Number (18 bits)
  * @param source_address Source Address
  * @param priority Priority (0-7)
  * @param destination Destination Address
@@ -63,11 +81,26 @@ uint32_t e32_build_j1939_id(
 /**
  * @brief Get PGN name from database
  * 
+ * Binary search over the sorted, generated PGN catalogue; cost grows
+ * logarithmically with the catalogue size.
+ * 
  * @param pgn Parameter Group Number
- * @return PGN name string (static, do not free)
+ * @return PGN name string (static, do not free), "Unknown" if not found
  */
 const char* e32_get_pgn_name(uint32_t pgn);
 
+/**
+ * @brief Get the PGN name of a decoded message, resolving it if deferred
+ * 
+ * Returns message->pgn_name when the decoder filled it, otherwise looks
+ * it up. Use this instead of reading pgn_name directly when the client
+ * runs in E32_DECODE_VALUES or E32_DECODE_HEADER mode.
+ * 
+ * @param message Decoded message
+ * @return PGN name string (static, do not free)
+ */
+const char* e32_msg_pgn_name(const e32_j1939_message_t* message);
+
 
 /* ==========================================================================
  * FRAME DECODING
@@ -85,6 +118,152 @@ e32_error_t e32_decode_frame(
     e32_j1939_message_t* message
 );
 
+/**
+ * @brief Decode a CAN frame with a selectable amount of work
+ * 
+ * E32_DECODE_FULL behaves like e32_decode_frame(), E32_DECODE_VALUES
+ * decodes SPNs but leaves pgn_name NULL, E32_DECODE_HEADER behaves like
+ * e32_decode_header().
+ * 
+ * @param frame Input CAN frame
+ * @param message Output decoded message
+ * @param mode Decode mode
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_decode_frame_ex(
+    const e32_can_frame_t* frame,
+    e32_j1939_message_t* message,
+    e32_decode_mode_t mode
+);
+
+/**
+ * @brief Decode a payload into a message whose header is already set
+ * 
+ * Used for messages that did not arrive as a single frame, e.g. those
+ * reassembled by the transport protocol. The caller fills pgn, the
+ * addresses, priority and timestamp; this fills raw[] (first 8 bytes),
+ * payload/payload_len (when len > 8), pgn_name and spns[] per mode.
+ * 
+ * @param message Message with header fields set
+ * @param data Payload bytes (referenced, not copied, when len > 8)
+ * @param len Payload length
+ * @param mode Decode mode
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_decode_message(
+    e32_j1939_message_t* message,
+    const uint8_t* data,
+    uint16_t len,
+    e32_decode_mode_t mode
+);
+
+/**
+ * @brief Get the payload of a message, single-frame or reassembled
+ * 
+ * @param message Decoded message
+ * @param len Receives the payload length (may be NULL)
+ * @return Pointer to the payload bytes
+ */
+const uint8_t* e32_msg_data(const e32_j1939_message_t* message, uint16_t* len);
+
+/**
+ * @brief Decode only the header of a CAN frame (hot path)
+ * 
+ * Fills PGN, addresses, priority, timestamp and raw bytes. Leaves
+ * pgn_name NULL and spn_count 0; the spns[] array is not touched.
+ * Extract values later with e32_msg_get_spn().
+ * 
+ * @param frame Input CAN frame
+ * @param message Output message
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_decode_header(
+    const e32_can_frame_t* frame,
+    e32_j1939_message_t* message
+);
+
+
+/* ==========================================================================
+ * ON-DEMAND SPN ACCESS
+ * ========================================================================== */
+
+/**
+ * @brief Extract one SPN from a message by SPN number
+ * 
+ * Decodes straight from message->raw, so it works for messages produced
+ * by either e32_decode_frame() or e32_decode_header().
+ * 
+ * @param message Decoded message
+ * @param spn SPN number (e.g. E32_SPN_ENGINE_SPEED)
+ * @param out Output SPN value
+ * @return E32_OK, or E32_ERR_NOT_FOUND if the PGN does not carry this
+ *         SPN or the frame is too short
+ * 
+ * @example
+ * @code
+ * e32_spn_t rpm;
+ * if (e32_msg_get_spn(msg, E32_SPN_ENGINE_SPEED, &rpm) == E32_OK) {
+ *     printf("%.1f RPM\n", rpm.value.f32);
+ * }
+ * @endcode
+ */
+e32_error_t e32_msg_get_spn(
+    const e32_j1939_message_t* message,
+    uint32_t spn,
+    e32_spn_t* out
+);
+
+/**
+ * @brief Extract one SPN from a message by name (e.g. "engineSpeed")
+ * 
+ * Slower than e32_msg_get_spn(); prefer SPN numbers on hot paths.
+ * 
+ * @param message Decoded message
+ * @param name SPN name as used in e32_spn_t.name
+ * @param out Output SPN value
+ * @return E32_OK, or E32_ERR_NOT_FOUND
+ */
+e32_error_t e32_msg_find_spn(
+    const e32_j1939_message_t* message,
+    const char* name,
+    e32_spn_t* out
+);
+
+
+/* ==========================================================================
+ * DIAGNOSTIC MESSAGES (DM1 / DM2)
+ * ========================================================================== */
+
+/**
+ * @brief Decode one 4-byte DTC field
+ * 
+ * @param bytes SPN (19 bits), FMI, CM and occurrence count as sent
+ * @param dtc Output DTC
+ * @return false for the "no DTC" filler (SPN 0 or all ones)
+ */
+bool e32_decode_dtc(const uint8_t* bytes, e32_dtc_t* dtc);
+
+/**
+ * @brief Decode every DTC of a DM1 or DM2 payload
+ * 
+ * Works on single frames and on reassembled multi-packet payloads alike:
+ * byte 1 holds the lamps, byte 2 the flash codes, then one 4-byte field
+ * per DTC. Fillers are skipped.
+ * 
+ * @param data Payload
+ * @param len Payload length
+ * @param dtcs Output array (may be NULL to count only)
+ * @param max Capacity of dtcs
+ * @return DTCs in the payload; only the first max are stored
+ * 
+ * @example
+ * @code
+ * e32_dtc_t dtcs[32];
+ * uint16_t n = e32_decode_dtcs(view->data, view->len, dtcs, 32);
+ * @endcode
+ */
+uint16_t e32_decode_dtcs(const uint8_t* data, uint16_t len, e32_dtc_t* dtcs, uint16_t max);
+
 
 /* ==========================================================================
  * FRAME ENCODING
@@ -118,6 +297,355 @@ void e32_encode_engine_control(
     e32_can_frame_t* frame
 );
 
+/**
+ * @brief Encode Address Claimed (or Cannot Claim) frame
+ * 
+ * Broadcast, priority 6, NAME little-endian in the 8 data bytes.
+ * 
+ * @param name Sender's NAME
+ * @param source_address Claimed SA, E32_SA_NULL for Cannot Claim Address
+ * @param frame Output CAN frame
+ */
+void e32_encode_address_claimed(
+    uint64_t name,
+    uint8_t source_address,
+    e32_can_frame_t* frame
+);
+
+/**
+ * @brief NAME carried by an Address Claimed payload
+ * 
+ * @param data 8 payload bytes
+ */
+uint64_t e32_decode_name(const uint8_t* data);
+
+
+#ifdef E32_CFG_CAN_FD
+/* ==========================================================================
+ * CAN FD AND MULTI-PG (J1939-22)
+ * ========================================================================== */
+
+/**
+ * @brief Data length of a 4-bit DLC code (9-15 map to 12..64 bytes)
+ */
+uint8_t e32_can_dlc_to_len(uint8_t dlc);
+
+/**
+ * @brief Smallest DLC code that holds len bytes
+ */
+uint8_t e32_can_len_to_dlc(uint8_t len);
+
+/**
+ * @brief len rounded up to the next length a CAN FD frame can have
+ */
+static inline uint8_t e32_can_fd_len(uint8_t len)
+{
+    return len <= 8 ? len : (uint8_t)(len <= 24 ? (len + 3) & ~3 : len <= 32 ? 32 : len <= 48 ? 48 : 64);
+}
+
+/**
+ * @brief Next contained PG of a Multi-PG payload
+ * 
+ * Each contained PG is a 4-byte header - PGN (18 bits), trailer format
+ * (3 bits) and type of service (3 bits), little-endian, then the payload
+ * length - followed by its payload. Padding or a header that does not
+ * fit ends the container.
+ * 
+ * @param data Container payload (e.g. view->data of E32_PGN_MULTI_PG)
+ * @param len Payload length
+ * @param offset Cursor, 0 for the first call
+ * @param cpg Output; cpg->data points into data
+ * @return false when there is no further PG
+ * 
+ * @example
+ * @code
+ * e32_cpg_t cpg;
+ * uint16_t at = 0;
+ * while (e32_mpg_next(view->data, view->len, &at, &cpg)) {
+ *     // cpg.pgn, cpg.data, cpg.len
+ * }
+ * @endcode
+ */
+bool e32_mpg_next(const uint8_t* data, uint16_t len, uint16_t* offset, e32_cpg_t* cpg);
+
+/**
+ * @brief Start an empty Multi-PG container frame
+ * 
+ * @param source_address Sender's SA
+ * @param priority Priority of every contained PG
+ * @param destination Target SA, E32_SA_GLOBAL to broadcast
+ * @param frame Output CAN FD frame
+ */
+void e32_mpg_begin(uint8_t source_address, uint8_t priority, uint8_t destination,
+                   e32_can_frame_t* frame);
+
+/**
+ * @brief Append one PG to a container frame
+ * 
+ * @return E32_OK, or E32_ERR_NO_MEMORY if the frame has no room left for
+ *         len more bytes (nothing is appended)
+ */
+e32_error_t e32_mpg_add(e32_can_frame_t* frame, uint32_t pgn, const uint8_t* data, uint8_t len);
+
+/**
+ * @brief Pad a container frame to the next CAN FD length
+ */
+void e32_mpg_finish(e32_can_frame_t* frame);
+#endif /* E32_CFG_CAN_FD */
+
+
+/* ==========================================================================
+ * ZERO-COPY VIEW ACCESS
+ * ========================================================================== */
+
+/**
+ * @brief Read a little-endian bit field straight from a view
+ * 
+ * Fields that extend past the payload read as all ones, the J1939
+ * "not available" value.
+ * 
+ * @param view Message view
+ * @param start_bit First bit (J1939-71 numbering from bit 0 of byte 1)
+ * @param bit_length Field width, 1-32
+ * @return Raw (unscaled) field value
+ */
+static inline uint32_t e32_view_bits(const e32_j1939_view_t* view, uint16_t start_bit, uint8_t bit_length)
+{
+    uint32_t mask = (bit_length >= 32) ? 0xFFFFFFFFu : ((1u << bit_length) - 1);
+    
+    if ((uint32_t)(start_bit + bit_length) > (uint32_t)view->len * 8) {
+        return mask;
+    }
+    
+    uint16_t first = start_bit / 8;
+    uint16_t last = (uint16_t)((start_bit + bit_length - 1) / 8);
+    uint64_t raw = 0;
+    for (uint16_t i = last + 1; i-- > first; ) {
+        raw = (raw << 8) | view->data[i];
+    }
+    
+    return (uint32_t)(raw >> (start_bit % 8)) & mask;
+}
+
+/**
+ * @brief Read one byte (0xFF when past the payload)
+ */
+static inline uint8_t e32_view_u8(const e32_j1939_view_t* view, uint16_t byte)
+{
+    return (byte < view->len) ? view->data[byte] : 0xFF;
+}
+
+/**
+ * @brief Read a little-endian 16-bit value (0xFFFF when past the payload)
+ */
+static inline uint16_t e32_view_u16(const e32_j1939_view_t* view, uint16_t byte)
+{
+    if ((uint32_t)byte + 2 > view->len) return 0xFFFF;
+    return (uint16_t)(view->data[byte] | (view->data[byte + 1] << 8));
+}
+
+/**
+ * @brief Read a little-endian 32-bit value (0xFFFFFFFF when past the payload)
+ */
+static inline uint32_t e32_view_u32(const e32_j1939_view_t* view, uint16_t byte)
+{
+    if ((uint32_t)byte + 4 > view->len) return 0xFFFFFFFFu;
+    return (uint32_t)view->data[byte] | ((uint32_t)view->data[byte + 1] << 8) |
+           ((uint32_t)view->data[byte + 2] << 16) | ((uint32_t)view->data[byte + 3] << 24);
+}
+
+/**
+ * @brief Decode one catalogued SPN from a view
+ * 
+ * Same scaling as e32_msg_get_spn(), without building a message.
+ * 
+ * @param view Message view
+ * @param spn SPN number (e.g. E32_SPN_ENGINE_SPEED)
+ * @param out Decoded value
+ * @return E32_OK, or E32_ERR_NOT_FOUND if the PGN has no such SPN or the
+ *         payload is too short
+ */
+e32_error_t e32_view_get_spn(const e32_j1939_view_t* view, uint32_t spn, e32_spn_t* out);
+
+/* ==========================================================================
+ * COMPACT DECODING (NO FLOATING POINT)
+ * ========================================================================== */
+
+/**
+ * @brief Decode a CAN frame into a compact message
+ * 
+ * Integer arithmetic only: suited to parts without an FPU. SPN values
+ * are fixed-point (see e32_spn_compact_t).
+ * 
+ * @param frame Input CAN frame
+ * @param message Output compact message
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_decode_compact(const e32_can_frame_t* frame, e32_j1939_compact_t* message);
+
+/**
+ * @brief Decode a view into a compact message
+ * 
+ * Pairs with view handlers: the client then never builds a full
+ * e32_j1939_message_t. Works for reassembled multi-packet views too.
+ * 
+ * @code
+ * void on_eec1(const e32_j1939_view_t* v, void* ctx) {
+ *     e32_j1939_compact_t m;
+ *     e32_view_decode_compact(v, &m);
+ *     const e32_spn_compact_t* rpm = e32_compact_find(&m, E32_SPN_ENGINE_SPEED);
+ *     if (rpm && rpm->status == E32_SPN_STATUS_OK) {
+ *         int32_t whole_rpm = e32_spn_to_scaled(rpm, 1);
+ *     }
+ * }
+ * @endcode
+ */
+e32_error_t e32_view_decode_compact(const e32_j1939_view_t* view, e32_j1939_compact_t* message);
+
+/**
+ * @brief Decode one catalogued SPN from a view in compact form
+ * 
+ * @return E32_OK, or E32_ERR_NOT_FOUND if the PGN has no such SPN or the
+ *         payload is too short
+ */
+e32_error_t e32_view_get_spn_compact(const e32_j1939_view_t* view, uint32_t spn,
+                                     e32_spn_compact_t* out);
+
+/**
+ * @brief Find an SPN of a compact message by SPN number
+ * 
+ * @return The entry, or NULL if the message does not carry it
+ */
+const e32_spn_compact_t* e32_compact_find(const e32_j1939_compact_t* message, uint32_t spn);
+
+/**
+ * @brief SPN number of a catalogue row (0 for an invalid index)
+ */
+uint32_t e32_spn_number(uint16_t index);
+
+/**
+ * @brief SDK name of a catalogue row, e.g. "engineSpeed" (NULL for an invalid index)
+ */
+const char* e32_spn_name(uint16_t index);
+
+/**
+ * @brief Fixed-point denominator of a catalogue row: value / den is the physical value
+ */
+uint32_t e32_spn_fixed_den(uint16_t index);
+
+/**
+ * @brief Physical value of a compact SPN as float
+ */
+float e32_spn_to_float(const e32_spn_compact_t* spn);
+
+/**
+ * @brief Physical value in caller-chosen integer units
+ * 
+ * Returns value * units / den, rounded toward zero and saturated to
+ * int32: units = 1 gives whole rpm, units = 10 tenths of a degree.
+ * 
+ * @param spn Compact SPN
+ * @param units Output steps per physical unit
+ */
+int32_t e32_spn_to_scaled(const e32_spn_compact_t* spn, int32_t units);
+
+/* ==========================================================================
+ * BATCH DECODING (LOG REPLAY / OFFLINE ANALYTICS)
+ * ========================================================================== */
+
+/**
+ * @brief One SPN time series (structure of arrays)
+ * 
+ * Storage is owned by the caller. e32_decode_frames() appends one sample
+ * per matching frame; samples past capacity are counted in dropped.
+ */
+typedef struct {
+    uint32_t         pgn;               /**< PGN carrying the SPN */
+    uint32_t         spn;               /**< SPN number */
+    const char*      name;              /**< SPN name (set by init) */
+    e32_spn_type_t   type;              /**< Value type (set by init) */
+    uint32_t*        timestamps;        /**< [capacity] sample times */
+    e32_spn_value_t* values;            /**< [capacity] decoded values */
+    uint8_t*         source_addresses;  /**< [capacity] senders, or NULL */
+    size_t           capacity;          /**< Length of the arrays */
+    size_t           count;             /**< Samples written */
+    size_t           dropped;           /**< Samples that did not fit */
+    const void*      def;               /**< Resolved definition (internal) */
+} e32_spn_column_t;
+
+/**
+ * @brief Per-frame header columns, each of length n (NULL to skip)
+ */
+typedef struct {
+    uint32_t* pgn;
+    uint8_t*  source_address;
+    uint8_t*  destination_address;
+    uint8_t*  priority;
+} e32_frame_columns_t;
+
+/**
+ * @brief Columns grouped by PGN, built once and reused for every batch
+ */
+typedef struct {
+    uint32_t          pgns[E32_CFG_BATCH_MAX_PGNS];     /**< Distinct PGNs (unused = E32_PGN_ANY) */
+    uint16_t          first[E32_CFG_BATCH_MAX_PGNS];    /**< Start of each group in order[] */
+    uint16_t          count[E32_CFG_BATCH_MAX_PGNS];    /**< Columns per group */
+    uint16_t          order[E32_CFG_BATCH_MAX_COLUMNS]; /**< Column indices grouped by PGN */
+    e32_spn_column_t* columns;
+    uint16_t          column_count;
+    uint8_t           pgn_count;
+} e32_batch_plan_t;
+
+/**
+ * @brief Bind a column to a catalogued SPN and its storage
+ * 
+ * @return E32_OK, E32_ERR_NOT_FOUND if the PGN/SPN pair is not in the
+ *         decoder tables, E32_ERR_INVALID_PARAM on bad arguments
+ */
+e32_error_t e32_spn_column_init(
+    e32_spn_column_t* column,
+    uint32_t pgn,
+    uint32_t spn,
+    uint32_t* timestamps,
+    e32_spn_value_t* values,
+    uint8_t* source_addresses,
+    size_t capacity
+);
+
+/**
+ * @brief Group initialized columns by PGN
+ * 
+ * @return E32_OK, or E32_ERR_NO_MEMORY if the columns exceed
+ *         E32_CFG_BATCH_MAX_COLUMNS or span more than
+ *         E32_CFG_BATCH_MAX_PGNS distinct PGNs
+ */
+e32_error_t e32_batch_plan_init(
+    e32_batch_plan_t* plan,
+    e32_spn_column_t* columns,
+    size_t column_count
+);
+
+/**
+ * @brief Decode an array of frames into columnar SPN time series
+ * 
+ * One pass over the input. Identifiers are parsed several at a time
+ * (SSE2 on x86, NEON on ARM, scalar elsewhere), each frame is routed to
+ * its PGN group with a vector compare, and every field is extracted from
+ * a single 64-bit load of the payload. Values match e32_decode_frame().
+ * Call repeatedly to stream a capture through the same columns.
+ * 
+ * @param in Input frames
+ * @param n Number of frames
+ * @param plan Column plan (may be NULL to only fill headers)
+ * @param headers Per-frame header output (may be NULL)
+ * @return Number of samples appended across all columns
+ */
+size_t e32_decode_frames(
+    const e32_can_frame_t* in,
+    size_t n,
+    e32_batch_plan_t* plan,
+    e32_frame_columns_t* headers
+);
 
 #ifdef __cplusplus
 }
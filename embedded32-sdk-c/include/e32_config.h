@@ -0,0 +1,528 @@
+/**
+ * @file e32_config.h
+ * @brief Embedded32 SDK - Compile-Time Configuration
+ *
+ * Sizing of all fixed-capacity tables used by the client. Every value
+ * can be overridden on the compiler command line (e.g.
+ * -DE32_CFG_MAX_SUBSCRIPTIONS=256) or by a project header included
+ * before the SDK headers.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_CONFIG_H
+#define E32_CONFIG_H
+
+/* ==========================================================================
+ * PGN DISPATCH
+ * ========================================================================== */
+
+/**
+ * Maximum number of PGN subscriptions per client (all PGNs and ranges
+ * combined). Any number of them may target the same PGN.
+ */
+#ifndef E32_CFG_MAX_SUBSCRIPTIONS
+#define E32_CFG_MAX_SUBSCRIPTIONS       64
+#endif
+
+/**
+ * Number of PGN hash buckets in the dispatch table. Must be a power of
+ * two and at least twice E32_CFG_MAX_SUBSCRIPTIONS so that lookups stay
+ * within a couple of probes.
+ */
+#ifndef E32_CFG_DISPATCH_BUCKETS
+#define E32_CFG_DISPATCH_BUCKETS        (2 * E32_CFG_MAX_SUBSCRIPTIONS)
+#endif
+
+#if (E32_CFG_DISPATCH_BUCKETS & (E32_CFG_DISPATCH_BUCKETS - 1)) != 0
+#error "E32_CFG_DISPATCH_BUCKETS must be a power of two"
+#endif
+
+#if E32_CFG_DISPATCH_BUCKETS < (2 * E32_CFG_MAX_SUBSCRIPTIONS)
+#error "E32_CFG_DISPATCH_BUCKETS must be at least 2 * E32_CFG_MAX_SUBSCRIPTIONS"
+#endif
+
+#if E32_CFG_MAX_SUBSCRIPTIONS >= 0xFFFF
+#error "E32_CFG_MAX_SUBSCRIPTIONS must be below 65535"
+#endif
+
+/**
+ * Subscriptions that may carry delivery options (on-change, minimum
+ * interval, decimation) at the same time. At most 32.
+ */
+#ifndef E32_CFG_GATED_SUBS_MAX
+#define E32_CFG_GATED_SUBS_MAX          8
+#endif
+
+/**
+ * (subscription, sender, PGN) histories kept for those options. Power
+ * of two. When it fills up, new senders are delivered unfiltered.
+ */
+#ifndef E32_CFG_GATE_STATES
+#define E32_CFG_GATE_STATES             64
+#endif
+
+#if E32_CFG_GATED_SUBS_MAX < 1 || E32_CFG_GATED_SUBS_MAX > 32
+#error "E32_CFG_GATED_SUBS_MAX must be between 1 and 32"
+#endif
+
+#if (E32_CFG_GATE_STATES & (E32_CFG_GATE_STATES - 1)) != 0 || E32_CFG_GATE_STATES < 2
+#error "E32_CFG_GATE_STATES must be a power of two (at least 2)"
+#endif
+
+/* ==========================================================================
+ * TRANSPORT
+ * ========================================================================== */
+
+/**
+ * CAN interfaces one client can serve (config.channel_count). Each
+ * channel has its own backend, transport protocol sessions and transmit
+ * queue; subscriptions and the receive ring are shared.
+ */
+#ifndef E32_CFG_MAX_CHANNELS
+#define E32_CFG_MAX_CHANNELS            4
+#endif
+
+#if E32_CFG_MAX_CHANNELS < 1 || E32_CFG_MAX_CHANNELS > 16
+#error "E32_CFG_MAX_CHANNELS must be between 1 and 16"
+#endif
+
+/**
+ * Frames moved per transport call (recvmmsg/sendmmsg vector length on
+ * SocketCAN).
+ */
+#ifndef E32_CFG_RX_BATCH
+#define E32_CFG_RX_BATCH                32
+#endif
+
+/**
+ * Upper bound on receive batches handled by a single e32_j1939_poll()
+ * call, so one poll cannot starve the caller on a saturated bus.
+ */
+#ifndef E32_CFG_POLL_MAX_BATCHES
+#define E32_CFG_POLL_MAX_BATCHES        8
+#endif
+
+/**
+ * Most acceptance filters the client plans from its subscriptions. The
+ * hardware limit (config.filter_banks, or the backend's own) may be
+ * lower; when there are more PGNs than filters, similar identifiers are
+ * merged into wider masks.
+ */
+#ifndef E32_CFG_FILTER_MAX
+#define E32_CFG_FILTER_MAX              64
+#endif
+
+#if E32_CFG_FILTER_MAX < 1 || E32_CFG_FILTER_MAX > 255
+#error "E32_CFG_FILTER_MAX must be between 1 and 255"
+#endif
+
+/**
+ * Define E32_CFG_CAN_FD for CAN FD and J1939-22: frames hold up to 64
+ * data bytes, config.can_fd may be set and Multi-PG containers are
+ * packed and unpacked. Without it every frame is a classic 8-byte one
+ * and the FD code is compiled out.
+ */
+
+/* ==========================================================================
+ * RX RING
+ * ========================================================================== */
+
+/**
+ * Capacity (in frames) of the single-producer/single-consumer ring
+ * between the CAN driver or ISR and e32_j1939_poll(). Power of two.
+ */
+#ifndef E32_CFG_RX_RING_SIZE
+#define E32_CFG_RX_RING_SIZE            64
+#endif
+
+#if (E32_CFG_RX_RING_SIZE & (E32_CFG_RX_RING_SIZE - 1)) != 0
+#error "E32_CFG_RX_RING_SIZE must be a power of two"
+#endif
+
+/** Cache line size used to keep producer and consumer indices apart */
+#ifndef E32_CFG_CACHE_LINE
+#define E32_CFG_CACHE_LINE              64
+#endif
+
+/* ==========================================================================
+ * TRANSPORT PROTOCOL (J1939-21 TP.CM / TP.DT)
+ * ========================================================================== */
+
+/**
+ * Concurrent multi-packet receive sessions (BAM and RTS/CTS combined).
+ * Each session owns a preallocated E32_CFG_TP_MAX_LEN byte buffer.
+ */
+#ifndef E32_CFG_TP_RX_SESSIONS
+#define E32_CFG_TP_RX_SESSIONS          4
+#endif
+
+/** Concurrent multi-packet send sessions */
+#ifndef E32_CFG_TP_TX_SESSIONS
+#define E32_CFG_TP_TX_SESSIONS          2
+#endif
+
+/**
+ * Largest multi-packet payload accepted or sent. Lower it to shrink the
+ * session buffers when only short messages (e.g. DM1) are expected.
+ */
+#ifndef E32_CFG_TP_MAX_LEN
+#define E32_CFG_TP_MAX_LEN              1785
+#endif
+
+/** Packets granted per CTS when receiving RTS/CTS transfers */
+#ifndef E32_CFG_TP_CTS_PACKETS
+#define E32_CFG_TP_CTS_PACKETS          16
+#endif
+
+/** Gap between BAM data packets on send (J1939-21: 50..200 ms) */
+#ifndef E32_CFG_TP_BAM_INTERVAL_MS
+#define E32_CFG_TP_BAM_INTERVAL_MS      50
+#endif
+
+#if E32_CFG_TP_RX_SESSIONS < 1 || E32_CFG_TP_TX_SESSIONS < 1
+#error "E32_CFG_TP_RX_SESSIONS and E32_CFG_TP_TX_SESSIONS must be at least 1"
+#endif
+
+#if E32_CFG_TP_MAX_LEN < 9 || E32_CFG_TP_MAX_LEN > 1785
+#error "E32_CFG_TP_MAX_LEN must be between 9 and 1785"
+#endif
+
+#if E32_CFG_TP_CTS_PACKETS < 1 || E32_CFG_TP_CTS_PACKETS > 255
+#error "E32_CFG_TP_CTS_PACKETS must be between 1 and 255"
+#endif
+
+/* ==========================================================================
+ * TRANSMIT QUEUE
+ * ========================================================================== */
+
+/**
+ * Frames the per-client transmit queue can hold across all eight
+ * priority levels. At most 255.
+ */
+#ifndef E32_CFG_TX_QUEUE_SIZE
+#define E32_CFG_TX_QUEUE_SIZE           32
+#endif
+
+/**
+ * Largest burst handed to the backend in one send call. Match it to the
+ * controller's TX mailbox count or the socket send buffer depth;
+ * config.tx_burst can lower it at run time.
+ */
+#ifndef E32_CFG_TX_BURST
+#define E32_CFG_TX_BURST                8
+#endif
+
+#if E32_CFG_TX_QUEUE_SIZE < 1 || E32_CFG_TX_QUEUE_SIZE > 255
+#error "E32_CFG_TX_QUEUE_SIZE must be between 1 and 255"
+#endif
+
+#if E32_CFG_TX_BURST < 1 || E32_CFG_TX_BURST > E32_CFG_TX_QUEUE_SIZE
+#error "E32_CFG_TX_BURST must be between 1 and E32_CFG_TX_QUEUE_SIZE"
+#endif
+
+/* ==========================================================================
+ * CYCLIC TRANSMISSION
+ * ========================================================================== */
+
+/** Cyclic PGNs one client can publish */
+#ifndef E32_CFG_CYCLIC_MAX
+#define E32_CFG_CYCLIC_MAX              32
+#endif
+
+/**
+ * Slots in the cyclic scheduler's timer wheel, one per millisecond.
+ * Power of two. Periods up to this length cost one visit per
+ * transmission; longer ones are passed over once per wheel turn.
+ */
+#ifndef E32_CFG_CYCLIC_WHEEL_SLOTS
+#define E32_CFG_CYCLIC_WHEEL_SLOTS      1024
+#endif
+
+#if (E32_CFG_CYCLIC_WHEEL_SLOTS & (E32_CFG_CYCLIC_WHEEL_SLOTS - 1)) != 0
+#error "E32_CFG_CYCLIC_WHEEL_SLOTS must be a power of two"
+#endif
+
+#if E32_CFG_CYCLIC_MAX < 1 || E32_CFG_CYCLIC_MAX >= 0xFFFF
+#error "E32_CFG_CYCLIC_MAX must be between 1 and 65534"
+#endif
+
+/* ==========================================================================
+ * REQUESTS
+ * ========================================================================== */
+
+/** Requests (e32_j1939_request_async()) waiting or in flight per client */
+#ifndef E32_CFG_REQUEST_MAX
+#define E32_CFG_REQUEST_MAX             32
+#endif
+
+/**
+ * Requests on the bus at once, across all destinations. Later ones wait
+ * their turn, so a sweep cannot flood the bus or the receivers.
+ */
+#ifndef E32_CFG_REQUEST_IN_FLIGHT
+#define E32_CFG_REQUEST_IN_FLIGHT       8
+#endif
+
+/**
+ * Requests on the bus at once to the same destination. Most ECUs answer
+ * one request at a time; a sweep still runs in parallel across them.
+ */
+#ifndef E32_CFG_REQUEST_PER_DEST
+#define E32_CFG_REQUEST_PER_DEST        1
+#endif
+
+#if E32_CFG_REQUEST_MAX < 1 || E32_CFG_REQUEST_MAX >= 0xFFFF
+#error "E32_CFG_REQUEST_MAX must be between 1 and 65534"
+#endif
+
+#if E32_CFG_REQUEST_IN_FLIGHT < 1 || E32_CFG_REQUEST_PER_DEST < 1
+#error "E32_CFG_REQUEST_IN_FLIGHT and E32_CFG_REQUEST_PER_DEST must be at least 1"
+#endif
+
+/* ==========================================================================
+ * DIAGNOSTIC TROUBLE CODES
+ * ========================================================================== */
+
+/** DTCs e32_j1939_on_dtc() tracks per client, all ECUs and both lists */
+#ifndef E32_CFG_DTC_MAX
+#define E32_CFG_DTC_MAX                 64
+#endif
+
+/** DM1/DM2 lists (one per ECU, list and channel) tracked per client */
+#ifndef E32_CFG_DTC_SOURCES
+#define E32_CFG_DTC_SOURCES             32
+#endif
+
+/**
+ * DTC bytes of the last DM1/DM2 kept per list to recognise the unchanged
+ * repeat (16 DTCs); longer lists are applied in full on every repeat
+ */
+#ifndef E32_CFG_DTC_REPEAT_BYTES
+#define E32_CFG_DTC_REPEAT_BYTES        64
+#endif
+
+#if E32_CFG_DTC_MAX < 1 || E32_CFG_DTC_MAX >= 0xFFFF
+#error "E32_CFG_DTC_MAX must be between 1 and 65534"
+#endif
+
+#if E32_CFG_DTC_SOURCES < 1 || E32_CFG_DTC_SOURCES > 255
+#error "E32_CFG_DTC_SOURCES must be between 1 and 255"
+#endif
+
+#if E32_CFG_DTC_REPEAT_BYTES < 4 || E32_CFG_DTC_REPEAT_BYTES > 1784 || E32_CFG_DTC_REPEAT_BYTES % 4
+#error "E32_CFG_DTC_REPEAT_BYTES must be a multiple of 4 between 4 and 1784"
+#endif
+
+/* ==========================================================================
+ * GATEWAY ROUTING
+ * ========================================================================== */
+
+/** Forwarding rules (e32_j1939_add_route()) per client, all channels */
+#ifndef E32_CFG_ROUTE_MAX
+#define E32_CFG_ROUTE_MAX               16
+#endif
+
+#if E32_CFG_ROUTE_MAX < 1 || E32_CFG_ROUTE_MAX > 255
+#error "E32_CFG_ROUTE_MAX must be between 1 and 255"
+#endif
+
+/* ==========================================================================
+ * VIRTUAL BUS
+ * ========================================================================== */
+
+/** Virtual buses (e32_vbus_create()) that can exist at once */
+#ifndef E32_CFG_VBUS_MAX
+#define E32_CFG_VBUS_MAX                4
+#endif
+
+/**
+ * Channels that can attach to one virtual bus, plus one for frames the
+ * application injects or replays. Each costs two E32_CFG_RX_RING_SIZE
+ * rings.
+ */
+#ifndef E32_CFG_VBUS_NODES
+#define E32_CFG_VBUS_NODES              8
+#endif
+
+#if E32_CFG_VBUS_NODES < 2 || E32_CFG_VBUS_NODES > 255
+#error "E32_CFG_VBUS_NODES must be between 2 and 255"
+#endif
+
+/* ==========================================================================
+ * THREADED DISPATCH
+ * ========================================================================== */
+
+/** Upper bound for config.workers */
+#ifndef E32_CFG_MAX_WORKERS
+#define E32_CFG_MAX_WORKERS             8
+#endif
+
+/**
+ * Messages each worker's queue can hold. Power of two. Every slot holds
+ * a transport payload of up to E32_CFG_TP_MAX_LEN bytes.
+ */
+#ifndef E32_CFG_WORKER_QUEUE_SIZE
+#define E32_CFG_WORKER_QUEUE_SIZE       256
+#endif
+
+/*
+ * Define E32_CFG_NO_THREADS to build without pthreads; config.workers
+ * is then ignored and handlers run inside poll.
+ */
+
+#if (E32_CFG_WORKER_QUEUE_SIZE & (E32_CFG_WORKER_QUEUE_SIZE - 1)) != 0
+#error "E32_CFG_WORKER_QUEUE_SIZE must be a power of two"
+#endif
+
+#if E32_CFG_MAX_WORKERS < 1 || E32_CFG_MAX_WORKERS > 64
+#error "E32_CFG_MAX_WORKERS must be between 1 and 64"
+#endif
+
+/* ==========================================================================
+ * SIGNAL CACHE
+ * ========================================================================== */
+
+/**
+ * Signals the last-value cache can track per client, each one
+ * (source address, PGN, SPN) triple.
+ */
+#ifndef E32_CFG_MAX_SIGNALS
+#define E32_CFG_MAX_SIGNALS             32
+#endif
+
+#if E32_CFG_MAX_SIGNALS < 1 || E32_CFG_MAX_SIGNALS >= 0xFFFF
+#error "E32_CFG_MAX_SIGNALS must be between 1 and 65534"
+#endif
+
+/* ==========================================================================
+ * STATISTICS
+ * ========================================================================== */
+
+/**
+ * PGNs with their own row of counters in e32_stats_t. Power of two, at
+ * most 128. Rows are handed out as PGNs are first handled and kept
+ * until e32_j1939_reset_stats(). A PGN has four candidate rows; if all
+ * are taken it counts in the totals only, so size this at about twice
+ * the number of PGNs the application handles.
+ */
+#ifndef E32_CFG_STATS_PGNS
+#define E32_CFG_STATS_PGNS              16
+#endif
+
+/**
+ * One in this many messages is timed for the latency and handler-time
+ * histograms (power of two, 1 = every message). Counters are always
+ * exact. Each timed message costs two clock_us reads. Frames taken from
+ * the receive ring are sampled by ring position, so the ISR reads the
+ * clock only for the frames that will be timed.
+ */
+#ifndef E32_CFG_STATS_SAMPLE
+#define E32_CFG_STATS_SAMPLE            8
+#endif
+
+/*
+ * Define E32_CFG_NO_STATS to compile out every counter and histogram;
+ * e32_j1939_get_stats() then returns E32_ERR_NOT_SUPPORTED. Define
+ * E32_CFG_NO_STATS_TIMING to keep the counters but drop the clock reads
+ * behind the latency and handler-time histograms.
+ */
+
+#if (E32_CFG_STATS_PGNS & (E32_CFG_STATS_PGNS - 1)) != 0 || E32_CFG_STATS_PGNS > 128
+#error "E32_CFG_STATS_PGNS must be a power of two, at most 128"
+#endif
+
+#if (E32_CFG_STATS_SAMPLE & (E32_CFG_STATS_SAMPLE - 1)) != 0 || E32_CFG_STATS_SAMPLE < 1 || \
+    E32_CFG_STATS_SAMPLE > E32_CFG_RX_RING_SIZE
+#error "E32_CFG_STATS_SAMPLE must be a power of two, at most E32_CFG_RX_RING_SIZE"
+#endif
+
+/* ==========================================================================
+ * BUS LOAD PROFILER
+ * ========================================================================== */
+
+/**
+ * Sliding window of the profiler: E32_CFG_BUSLOAD_SLOTS slots of
+ * E32_CFG_BUSLOAD_SLOT_MS each (1 s by default). Rates and load cover
+ * the last full window. The slot length is also the cycle over which
+ * the quiet-phase profile is kept (100 ms, the common J1939 base rate).
+ */
+#ifndef E32_CFG_BUSLOAD_SLOTS
+#define E32_CFG_BUSLOAD_SLOTS           10
+#endif
+
+#ifndef E32_CFG_BUSLOAD_SLOT_MS
+#define E32_CFG_BUSLOAD_SLOT_MS         100
+#endif
+
+/** Phases the slot cycle is divided into for quiet-window search */
+#ifndef E32_CFG_BUSLOAD_PHASES
+#define E32_CFG_BUSLOAD_PHASES          10
+#endif
+
+/**
+ * Source addresses and PGNs each channel keeps a rate for. Powers of
+ * two. An entry is released once its address or PGN has been silent
+ * for a whole window; traffic that finds no entry counts as "other".
+ */
+#ifndef E32_CFG_BUSLOAD_SOURCES
+#define E32_CFG_BUSLOAD_SOURCES         32
+#endif
+
+#ifndef E32_CFG_BUSLOAD_PGNS
+#define E32_CFG_BUSLOAD_PGNS            32
+#endif
+
+#if E32_CFG_BUSLOAD_SLOTS < 2 || E32_CFG_BUSLOAD_SLOTS > 255
+#error "E32_CFG_BUSLOAD_SLOTS must be between 2 and 255"
+#endif
+
+#if E32_CFG_BUSLOAD_PHASES < 1 || (E32_CFG_BUSLOAD_SLOT_MS % E32_CFG_BUSLOAD_PHASES) != 0
+#error "E32_CFG_BUSLOAD_SLOT_MS must be a multiple of E32_CFG_BUSLOAD_PHASES"
+#endif
+
+#if (E32_CFG_BUSLOAD_SOURCES & (E32_CFG_BUSLOAD_SOURCES - 1)) != 0 || \
+    (E32_CFG_BUSLOAD_PGNS & (E32_CFG_BUSLOAD_PGNS - 1)) != 0
+#error "E32_CFG_BUSLOAD_SOURCES and E32_CFG_BUSLOAD_PGNS must be powers of two"
+#endif
+
+/* ==========================================================================
+ * MEMORY
+ * ========================================================================== */
+
+/*
+ * The client is one fixed-size block sized by the macros above; its
+ * parts are listed by e32_j1939_footprint(). Define E32_CFG_NO_HEAP for
+ * builds that must not allocate: e32_j1939_create() is left out (use
+ * e32_j1939_create_static()) and threaded dispatch, which allocates its
+ * queues, is disabled.
+ */
+
+#if defined(E32_CFG_NO_HEAP) && !defined(E32_CFG_NO_THREADS)
+#define E32_CFG_NO_THREADS
+#endif
+
+/* ==========================================================================
+ * BATCH DECODING
+ * ========================================================================== */
+
+/** Distinct PGNs one e32_batch_plan_t can route (multiple of 4) */
+#ifndef E32_CFG_BATCH_MAX_PGNS
+#define E32_CFG_BATCH_MAX_PGNS          16
+#endif
+
+/** SPN columns one e32_batch_plan_t can fill */
+#ifndef E32_CFG_BATCH_MAX_COLUMNS
+#define E32_CFG_BATCH_MAX_COLUMNS       64
+#endif
+
+/*
+ * Define E32_CFG_NO_SIMD to build the batch decoder without SSE2/NEON
+ * intrinsics (portable scalar code only).
+ */
+
+#if (E32_CFG_BATCH_MAX_PGNS % 4) != 0
+#error "E32_CFG_BATCH_MAX_PGNS must be a multiple of 4"
+#endif
+
+#endif /* E32_CONFIG_H */
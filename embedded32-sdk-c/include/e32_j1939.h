@@ -51,12 +51,63 @@ typedef struct e32_j1939_client* e32_j1939_client_t;
  * e32_j1939_client_t client;
  * e32_error_t err = e32_j1939_create(&config, &client);
  * @endcode
+ * 
+ * To serve several buses from one client, list them in channels[]
+ * instead of interface_name. Subscriptions apply to every channel;
+ * messages carry the channel they arrived on.
+ * @code
+ * e32_j1939_config_t config = {
+ *     .source_address = E32_SA_DIAG_TOOL_2,
+ *     .channel_count = 3,
+ *     .channels = { "can0", "can1", "can2" }
+ * };
+ * @endcode
  */
+#ifndef E32_CFG_NO_HEAP
 e32_error_t e32_j1939_create(const e32_j1939_config_t* config, e32_j1939_client_t* client_out);
+#endif
+
+/**
+ * @brief Create a client in caller-provided memory
+ * 
+ * Works like e32_j1939_create() without touching the heap: the client
+ * lives in buffer until e32_j1939_destroy(), which does not free it.
+ * 
+ * @param config Client configuration
+ * @param buffer Memory for the client, aligned to E32_CFG_CACHE_LINE
+ *               ideally (otherwise E32_CFG_CACHE_LINE - 1 more bytes are needed)
+ * @param size Size of buffer in bytes
+ * @param client_out Pointer to receive client handle
+ * @return E32_OK, E32_ERR_NO_MEMORY if buffer is too small,
+ *         E32_ERR_INVALID_PARAM for a bad config
+ * 
+ * @code
+ * static uint8_t client_mem[E32_CLIENT_MEM_BYTES] __attribute__((aligned(64)));
+ * 
+ * e32_j1939_client_t client;
+ * e32_j1939_create_static(&config, client_mem, sizeof(client_mem), &client);
+ * @endcode
+ * 
+ * E32_CLIENT_MEM_BYTES is chosen by the project; check it against
+ * e32_j1939_footprint() once at start-up or in a test.
+ */
+e32_error_t e32_j1939_create_static(const e32_j1939_config_t* config, void* buffer,
+                                    size_t size, e32_j1939_client_t* client_out);
+
+/**
+ * @brief Bytes one client needs with the current compile-time sizing
+ * 
+ * @param breakdown Receives the size of each part (may be NULL)
+ * @return Buffer size e32_j1939_create_static() needs for an aligned buffer
+ */
+size_t e32_j1939_footprint(e32_footprint_t* breakdown);
 
 /**
  * @brief Destroy a J1939 client and free resources
  * 
+ * Clients from e32_j1939_create_static() are disconnected; their buffer
+ * stays with the caller.
+ * 
  * @param client Client handle
  */
 void e32_j1939_destroy(e32_j1939_client_t client);
@@ -95,6 +146,14 @@ bool e32_j1939_is_connected(e32_j1939_client_t client);
  */
 uint8_t e32_j1939_get_source_address(e32_j1939_client_t client);
 
+/**
+ * @brief Get the number of CAN channels the client serves
+ * 
+ * @param client Client handle
+ * @return config.channel_count, or 1 for a single-interface client
+ */
+uint8_t e32_j1939_get_channel_count(e32_j1939_client_t client);
+
 
 /* ==========================================================================
  * PGN SUBSCRIPTION
@@ -104,12 +163,30 @@ uint8_t e32_j1939_get_source_address(e32_j1939_client_t client);
  * @brief Subscribe to a specific PGN
  * 
  * Handler is called whenever a message with this PGN is received.
+ * Any number of handlers may be registered for the same PGN; they are
+ * called in registration order. Pass E32_PGN_ANY to receive every PGN.
+ * 
+ * Lookup is constant time regardless of the number of subscriptions.
+ * 
+ * With config.workers set, handlers run on worker threads. Messages
+ * sharing an affinity key (see e32_worker_affinity_t) reach their
+ * handlers in order on one thread; a handler that sees several keys
+ * must be thread-safe. Subscribing from the polling thread lets the
+ * workers finish what is queued and stops them; they start again with
+ * the next message. Handlers cannot subscribe while they run on a worker.
+ * 
+ * Every call adds a subscription of its own: pass sub_out to be able to
+ * remove exactly this one with e32_j1939_unsubscribe(), leaving other
+ * modules' handlers on the PGN in place.
  * 
  * @param client Client handle
- * @param pgn Parameter Group Number to subscribe to
+ * @param pgn Parameter Group Number to subscribe to (or E32_PGN_ANY)
  * @param handler Callback function
  * @param user_data User context passed to callback
- * @return E32_OK on success, error code otherwise
+ * @param sub_out Receives the subscription handle (may be NULL)
+ * @return E32_OK on success, E32_ERR_NO_MEMORY if all
+ *         E32_CFG_MAX_SUBSCRIPTIONS slots are in use, E32_ERR_BUSY
+ *         when called from a dispatch worker
  * 
  * @example
  * @code
@@ -121,25 +198,192 @@ uint8_t e32_j1939_get_source_address(e32_j1939_client_t client);
  *     }
  * }
  * 
- * e32_j1939_on_pgn(client, E32_PGN_EEC1, on_engine_data, NULL);
+ * e32_subscription_t sub;
+ * e32_j1939_on_pgn(client, E32_PGN_EEC1, on_engine_data, NULL, &sub);
+ * ...
+ * e32_j1939_unsubscribe(client, sub);
  * @endcode
  */
 e32_error_t e32_j1939_on_pgn(
     e32_j1939_client_t client,
     uint32_t pgn,
     e32_pgn_handler_t handler,
-    void* user_data
+    void* user_data,
+    e32_subscription_t* sub_out
 );
 
 /**
- * @brief Unsubscribe from a PGN
+ * @brief Subscribe to a contiguous range of PGNs
+ * 
+ * Useful for proprietary blocks (e.g. 0xFF00-0xFFFF). Range handlers
+ * run after the exact-PGN handlers of a message.
+ * 
+ * @param client Client handle
+ * @param pgn_first First PGN of the range
+ * @param pgn_last Last PGN of the range (inclusive, <= E32_PGN_MAX)
+ * @param handler Callback function
+ * @param user_data User context passed to callback
+ * @param sub_out Receives the subscription handle (may be NULL)
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_on_pgn_range(
+    e32_j1939_client_t client,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_pgn_handler_t handler,
+    void* user_data,
+    e32_subscription_t* sub_out
+);
+
+/**
+ * @brief Subscribe to a PGN with a zero-copy view handler
+ * 
+ * The handler receives a view borrowing the received frame instead of a
+ * decoded message: no copy, no SPN decoding. Read fields with
+ * e32_view_bits() / e32_view_get_spn(). Intended for high-rate
+ * consumers such as loggers and gateways. View and message handlers may
+ * be mixed on one PGN; the message is then decoded once for the message
+ * handlers only.
+ * 
+ * @code
+ * void on_eec1(const e32_j1939_view_t* v, void* ctx)
+ * {
+ *     float rpm = e32_view_u16(v, 3) * 0.125f;
+ * }
+ * e32_j1939_on_pgn_view(client, E32_PGN_EEC1, on_eec1, NULL, NULL);
+ * @endcode
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number (or E32_PGN_ANY)
+ * @param handler View callback
+ * @param user_data User context passed to callback
+ * @param sub_out Receives the subscription handle (may be NULL)
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_on_pgn_view(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_view_handler_t handler,
+    void* user_data,
+    e32_subscription_t* sub_out
+);
+
+/**
+ * @brief Subscribe a zero-copy view handler to a contiguous PGN range
  * 
  * @param client Client handle
- * @param pgn Parameter Group Number to unsubscribe from
+ * @param pgn_first First PGN of the range
+ * @param pgn_last Last PGN of the range (inclusive, <= E32_PGN_MAX)
+ * @param handler View callback
+ * @param user_data User context passed to callback
+ * @param sub_out Receives the subscription handle (may be NULL)
  * @return E32_OK on success, error code otherwise
  */
+e32_error_t e32_j1939_on_pgn_view_range(
+    e32_j1939_client_t client,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_view_handler_t handler,
+    void* user_data,
+    e32_subscription_t* sub_out
+);
+
+/**
+ * @brief Subscribe to a PGN with delivery options
+ * 
+ * Like e32_j1939_on_pgn(), but the handler only sees messages that pass
+ * options: changed payloads (E32_SUB_ON_CHANGE compares all payload
+ * bytes), at most one message per min_interval_ms, or every Nth message
+ * (decimate). Each sender of the PGN is tracked on its own, and the
+ * checks run before the message is decoded, so a message nobody lets
+ * through costs no decode. Other subscriptions on the PGN are not
+ * affected. The options are copied.
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number (or E32_PGN_ANY)
+ * @param handler Callback function
+ * @param user_data User context passed to callback
+ * @param options Delivery options (NULL delivers everything)
+ * @param sub_out Receives the subscription handle (may be NULL)
+ * @return E32_OK on success, E32_ERR_NO_MEMORY if E32_CFG_GATED_SUBS_MAX
+ *         subscriptions already have options, error code otherwise
+ * 
+ * @example
+ * @code
+ * // Engine temperatures: only when they change, and at most 1 Hz
+ * const e32_sub_options_t opts = { E32_SUB_ON_CHANGE, 0, 1000 };
+ * e32_j1939_on_pgn_ex(client, E32_PGN_ET1, on_temps, NULL, &opts, NULL);
+ * @endcode
+ */
+e32_error_t e32_j1939_on_pgn_ex(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_pgn_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    e32_subscription_t* sub_out
+);
+
+/**
+ * @brief Subscribe a zero-copy view handler with delivery options
+ * 
+ * See e32_j1939_on_pgn_ex().
+ */
+e32_error_t e32_j1939_on_pgn_view_ex(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_view_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    e32_subscription_t* sub_out
+);
+
+/**
+ * @brief Remove one subscription
+ * 
+ * Removes only the subscription the handle came from; other handlers on
+ * the same PGN keep running. A handler may remove its own subscription
+ * while it runs. Dispatch workers are stopped as for e32_j1939_on_pgn().
+ * 
+ * @param client Client handle
+ * @param sub Handle from one of the e32_j1939_on_pgn*() calls
+ * @return E32_OK, E32_ERR_NOT_FOUND if it was already removed,
+ *         E32_ERR_BUSY when called from a dispatch worker
+ */
+e32_error_t e32_j1939_unsubscribe(e32_j1939_client_t client, e32_subscription_t sub);
+
+/**
+ * @brief Unsubscribe from a PGN
+ * 
+ * Removes every handler registered for this PGN with e32_j1939_on_pgn(),
+ * e32_j1939_on_pgn_view() or their _ex variants, whoever registered
+ * them; use e32_j1939_unsubscribe() to remove a single one. Dispatch
+ * workers are stopped as for e32_j1939_on_pgn().
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number to unsubscribe from (or E32_PGN_ANY)
+ * @return E32_OK on success, E32_ERR_BUSY when called from a dispatch
+ *         worker, error code otherwise
+ */
 e32_error_t e32_j1939_off_pgn(e32_j1939_client_t client, uint32_t pgn);
 
+/**
+ * @brief Unsubscribe from a PGN range
+ * 
+ * Removes every handler registered with exactly this range.
+ * 
+ * @param client Client handle
+ * @param pgn_first First PGN of the range
+ * @param pgn_last Last PGN of the range (inclusive)
+ * @return E32_OK on success, E32_ERR_BUSY when called from a dispatch
+ *         worker, error code otherwise
+ */
+e32_error_t e32_j1939_off_pgn_range(
+    e32_j1939_client_t client,
+    uint32_t pgn_first,
+    uint32_t pgn_last
+);
+
 
 /* ==========================================================================
  * PGN REQUESTS
@@ -171,80 +415,1018 @@ e32_error_t e32_j1939_request_pgn(
     uint8_t destination
 );
 
+/**
+ * @brief Request a PGN and get the response through a callback
+ * 
+ * The request waits in submission order until it may be sent: at most
+ * E32_CFG_REQUEST_IN_FLIGHT requests are on the bus at once, and at most
+ * E32_CFG_REQUEST_PER_DEST to one destination. A sweep over many ECUs
+ * therefore runs in parallel while each ECU sees one request at a time.
+ * The response, a single frame or a multi-packet message, is matched by
+ * PGN and source address and handed to done even if nothing subscribes
+ * to the PGN; subscribers still get it as usual. The timeout starts
+ * when the request is sent.
+ * 
+ * done runs on the polling thread; it may submit the next request.
+ * See e32_response_fn_t for the outcomes.
+ * 
+ * @param client Client handle
+ * @param channel Bus to send on
+ * @param pgn Parameter Group Number to request
+ * @param destination Target address (E32_SA_GLOBAL collects every response)
+ * @param timeout_ms Wait for the response (0 = E32_REQUEST_TIMEOUT_MS)
+ * @param done Completion callback
+ * @param user_data Passed to done
+ * @return E32_OK if queued, E32_ERR_NO_MEMORY if E32_CFG_REQUEST_MAX
+ *         requests are pending
+ * 
+ * @example
+ * @code
+ * static void on_id(e32_error_t status, const e32_j1939_view_t* response, void* user_data)
+ * {
+ *     if (status == E32_OK) {
+ *         store_component_id(response->source_address, response->data, response->len);
+ *     }
+ * }
+ * 
+ * // Ask every known ECU at once; each answer arrives as soon as it is in
+ * for (int i = 0; i < ecu_count; i++) {
+ *     e32_j1939_request_async(client, 0, 0xFEEB, ecus[i], 0, on_id, NULL);
+ * }
+ * @endcode
+ */
+e32_error_t e32_j1939_request_async(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    uint8_t destination,
+    uint32_t timeout_ms,
+    e32_response_fn_t done,
+    void* user_data
+);
+
 
 /* ==========================================================================
- * INTERNAL/ADVANCED API (NOT PART OF PUBLIC CONTRACT)
+ * SIGNAL CACHE (LAST VALUES)
  * ========================================================================== */
 
 /**
- * @brief Send raw PGN data
+ * @brief Keep the latest value of one SPN from one sender
  * 
- * @warning INTERNAL API - Not part of the stable public API.
- *          This function may change or be removed without notice.
- *          Use e32_j1939_send_engine_control() for normal usage.
+ * Every received frame of pgn from source_address updates the signal in
+ * place, whether or not a handler subscribes to the PGN. Read it from
+ * any thread with e32_j1939_read_signal(). Values are compact
+ * fixed-point SPNs, so only SPNs in the decoder tables can be tracked.
+ * Tracking the same signal again changes its maximum age and returns
+ * the same id.
+ * 
+ * Call from the thread that polls the client; reads are the part that
+ * may happen elsewhere.
  * 
  * @param client Client handle
- * @param pgn Parameter Group Number
- * @param data Raw data bytes
- * @param len Data length (1-8)
- * @param destination Target address
- * @param priority Message priority (0-7, default 6)
- * @return E32_OK on success, error code otherwise
+ * @param source_address Sender to track
+ * @param pgn PGN carrying the SPN
+ * @param spn SPN number
+ * @param max_age_ms Age after which reads report E32_SIGNAL_STALE (0 = never)
+ * @param id_out Receives the signal handle
+ * @return E32_OK, E32_ERR_NOT_FOUND if the SPN is not in pgn's catalogue
+ *         entry, E32_ERR_NO_MEMORY if E32_CFG_MAX_SIGNALS are tracked
  * 
- * @internal
+ * @example
+ * @code
+ * e32_signal_id_t rpm_id;
+ * e32_j1939_track_signal(client, E32_SA_ENGINE_1, E32_PGN_EEC1,
+ *                        E32_SPN_ENGINE_SPEED, 100, &rpm_id);
+ * 
+ * // Any thread, any time:
+ * e32_signal_value_t rpm;
+ * if (e32_j1939_read_signal(client, rpm_id, &rpm) == E32_OK &&
+ *     rpm.state == E32_SIGNAL_FRESH && rpm.spn.status == E32_SPN_STATUS_OK) {
+ *     show_rpm(e32_spn_to_scaled(&rpm.spn, 1));
+ * }
+ * @endcode
  */
-e32_error_t e32_j1939_send_raw(
+e32_error_t e32_j1939_track_signal(
     e32_j1939_client_t client,
+    uint8_t source_address,
     uint32_t pgn,
-    const uint8_t* data,
-    uint8_t len,
-    uint8_t destination,
-    uint8_t priority
+    uint32_t spn,
+    uint32_t max_age_ms,
+    e32_signal_id_t* id_out
+);
+
+/**
+ * @brief Stop tracking a signal
+ * 
+ * Readers must be done with the id first; it may be handed out again.
+ * 
+ * @param client Client handle
+ * @param id Signal handle
+ * @return E32_OK, or E32_ERR_NOT_FOUND if it is not tracked
+ */
+e32_error_t e32_j1939_untrack_signal(e32_j1939_client_t client, e32_signal_id_t id);
+
+/**
+ * @brief Look up the handle of a tracked signal
+ * 
+ * @return E32_OK, or E32_ERR_NOT_FOUND if it is not tracked
+ */
+e32_error_t e32_j1939_find_signal(
+    e32_j1939_client_t client,
+    uint8_t source_address,
+    uint32_t pgn,
+    uint32_t spn,
+    e32_signal_id_t* id_out
+);
+
+/**
+ * @brief Copy the latest value of a tracked signal
+ * 
+ * Lock-free and safe from any thread: the reader never blocks the
+ * polling thread, and retries only if an update lands during the copy.
+ * age_ms and state are computed against the client clock at the call.
+ * 
+ * @param client Client handle
+ * @param id Signal handle from e32_j1939_track_signal()
+ * @param value Output value
+ * @return E32_OK, or E32_ERR_NOT_FOUND if id is not tracked
+ */
+e32_error_t e32_j1939_read_signal(
+    e32_j1939_client_t client,
+    e32_signal_id_t id,
+    e32_signal_value_t* value
 );
 
 
 /* ==========================================================================
- * ENGINE CONTROL COMMAND (CONVENIENCE)
+ * DIAGNOSTIC TROUBLE CODES (DM1 / DM2)
  * ========================================================================== */
 
 /**
- * @brief Send Engine Control Command (PGN 0xEF00)
+ * @brief Track the DTC lists of every ECU and hear only about changes
  * 
- * Convenience function for sending engine control commands.
+ * Every DM1 (active) and DM2 (previously active) message, single frame
+ * or multi-packet, updates the list of its ECU. handler is called for
+ * each DTC that appeared (E32_DTC_RAISED) or disappeared
+ * (E32_DTC_CLEARED) since the previous message of that list; repeats of
+ * an unchanged list cost one hash of the payload. Changed occurrence
+ * counts are stored without an event.
+ * 
+ * The handler runs on the polling thread, with the list already
+ * updated. Subscriptions to DM1/DM2 still see every message.
  * 
  * @param client Client handle
- * @param cmd Command data
- * @return E32_OK on success, error code otherwise
+ * @param handler Change callback, NULL to stop tracking and drop the lists
+ * @param user_data Passed to handler
+ * @return E32_OK on success
  * 
  * @example
  * @code
- * e32_engine_control_cmd_t cmd = {
- *     .target_rpm = 1200,
- *     .enable = true
- * };
- * e32_j1939_send_engine_control(client, &cmd);
+ * static void on_dtc(const e32_dtc_event_t* event, void* user_data)
+ * {
+ *     if (event->pgn == E32_PGN_DM1) {
+ *         log_fault(event->source_address, event->dtc.spn, event->dtc.fmi,
+ *                   event->change == E32_DTC_RAISED);
+ *     }
+ * }
+ * 
+ * e32_j1939_on_dtc(client, on_dtc, NULL);
  * @endcode
  */
-e32_error_t e32_j1939_send_engine_control(
+e32_error_t e32_j1939_on_dtc(
     e32_j1939_client_t client,
-    const e32_engine_control_cmd_t* cmd
+    e32_dtc_handler_t handler,
+    void* user_data
+);
+
+/**
+ * @brief Copy the current DTC list of one ECU
+ * 
+ * Call from the polling thread (or a handler running inline).
+ * 
+ * @param client Client handle
+ * @param channel Bus the ECU is on
+ * @param source_address ECU
+ * @param pgn E32_PGN_DM1 or E32_PGN_DM2
+ * @param dtcs Output array
+ * @param max Capacity of dtcs
+ * @param count Receives the number of DTCs listed (may exceed max)
+ * @return E32_OK, or E32_ERR_NOT_FOUND if no such list was received
+ */
+e32_error_t e32_j1939_get_dtcs(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint8_t source_address,
+    uint32_t pgn,
+    e32_dtc_t* dtcs,
+    uint16_t max,
+    uint16_t* count
 );
 
 
 /* ==========================================================================
- * POLLING (FOR NON-RTOS SYSTEMS)
+ * ADDRESS CLAIM (J1939-81)
  * ========================================================================== */
 
 /**
- * @brief Process pending messages
+ * @brief Current address claim state
  * 
- * Must be called periodically in main loop on non-RTOS systems.
- * On RTOS systems with dedicated receive task, this is optional.
+ * With config.name set, connect claims config.source_address and
+ * returns at once; the state is E32_ADDRESS_CLAIMING until the 250 ms
+ * contention window has passed in e32_j1939_poll(), then
+ * E32_ADDRESS_CLAIMED. A node with a higher-priority (lower) NAME takes
+ * the address over: with E32_NAME_ARBITRARY_ADDRESS the client claims a
+ * free one from 128-247, otherwise it goes to E32_ADDRESS_LOST and sends
+ * Cannot Claim. config.on_address hears about every change, and
+ * e32_j1939_get_source_address() reports the address in use.
+ * 
+ * While claiming an address from 128-247, and after losing, sends fail
+ * with E32_ERR_NO_ADDRESS.
+ * 
+ * @return E32_ADDRESS_NONE without config.name
+ */
+e32_address_state_t e32_j1939_get_address_state(e32_j1939_client_t client);
+
+/**
+ * @brief NAME of the node holding source_address on a channel
+ * 
+ * Every channel keeps a table of the Address Claimed frames it has seen,
+ * whether or not the client claims an address itself. Call from the
+ * thread that polls the client.
+ * 
+ * @return E32_OK, or E32_ERR_NOT_FOUND if nobody claimed it
+ */
+e32_error_t e32_j1939_name_of(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint8_t source_address,
+    uint64_t* name
+);
+
+/**
+ * @brief Source address currently claimed by a NAME on a channel
+ * 
+ * Constant time: one probe of a hashed index in the common case.
+ * 
+ * @return E32_OK, or E32_ERR_NOT_FOUND if name holds no address
+ */
+e32_error_t e32_j1939_address_of(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint64_t name,
+    uint8_t* source_address
+);
+
+/**
+ * @brief Send a destination-specific PGN to the node with this NAME
+ * 
+ * Keeps working when the node moves to another address.
+ * 
+ * @return As e32_j1939_send_raw_on(), or E32_ERR_NOT_FOUND if name holds
+ *         no address on the channel
+ */
+e32_error_t e32_j1939_send_to_name(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint16_t len,
+    uint64_t name,
+    uint8_t priority
+);
+
+
+/* ==========================================================================
+ * GATEWAY ROUTING
+ * ========================================================================== */
+
+/**
+ * @brief Forward matching frames from one channel to others
+ * 
+ * Every frame drained from the receive ring is first dispatched to this
+ * client's own handlers, then checked against the rules of the channel
+ * it arrived on, in the order they were added; the first rule that
+ * matches decides. A forwarding rule rewrites the identifier (source,
+ * PDU1 destination, priority) in the ring slot and sends the frame on
+ * each of its to_channels straight from there, without decoding or
+ * copying it. Only while a destination's transmit queue holds frames,
+ * or its backend is busy, are frames copied into that queue, behind
+ * higher-priority traffic. An E32_ROUTE_BLOCK rule keeps the frames it
+ * matches on their bus, so it can carve exceptions out of a wider rule
+ * added after it. Frames no rule matches are not forwarded.
+ * 
+ * Forwarded frames are other nodes' traffic: they are sent whatever the
+ * client's own address claim state. Transport protocol and Multi-PG
+ * frames are forwarded as frames, like any other. Call from the polling
+ * thread; the acceptance filters are widened to let routed traffic in.
  * 
  * @param client Client handle
- * @return Number of messages processed
+ * @param route Rule (copied)
+ * @return E32_OK, E32_ERR_INVALID_PARAM if the rule names a missing
+ *         channel or forwards back to its own, E32_ERR_NO_MEMORY when
+ *         E32_CFG_ROUTE_MAX rules exist
+ * 
+ * @example
+ * @code
+ * // Everything from the engine bus to the cab bus, except DM1
+ * e32_route_t dm1 = { .from_channel = 0, .flags = E32_ROUTE_BLOCK,
+ *                     .pgn = E32_PGN_DM1, .pgn_mask = 0x3FFFF };
+ * e32_route_t all = { .from_channel = 0, .to_channels = 1u << 1 };
+ * e32_j1939_add_route(client, &dm1);
+ * e32_j1939_add_route(client, &all);
+ * @endcode
  */
-int e32_j1939_poll(e32_j1939_client_t client);
+e32_error_t e32_j1939_add_route(e32_j1939_client_t client, const e32_route_t* route);
+
+/**
+ * @brief Remove every forwarding rule and reset the gateway statistics
+ * 
+ * @param client Client handle
+ * @return E32_OK on success
+ */
+e32_error_t e32_j1939_clear_routes(e32_j1939_client_t client);
+
+/**
+ * @brief Read gateway statistics
+ * 
+ * @param client Client handle
+ * @param stats Output statistics
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_get_route_stats(e32_j1939_client_t client, e32_route_stats_t* stats);
+
+
+/* ==========================================================================
+ * INTERNAL/ADVANCED API (NOT PART OF PUBLIC CONTRACT)
+ * ========================================================================== */
+
+/**
+ * @brief Send raw PGN data
+ * 
+ * @warning INTERNAL API - Not part of the stable public API.
+ *          This function may change or be removed without notice.
+ *          Use e32_j1939_send_engine_control() for normal usage.
+ * 
+ * Payloads longer than 8 bytes are sent with the J1939-21 transport
+ * protocol: BAM when destination is 0xFF, RTS/CTS otherwise. With
+ * config.can_fd, up to 64 bytes go out as one CAN FD frame (with BRS,
+ * padded to the next FD length) and only longer ones use TP. The data
+ * is copied and the call returns at once; packets go out from
+ * e32_j1939_poll(), so keep polling until the transfer completes
+ * (see e32_j1939_get_tp_stats()).
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number
+ * @param data Raw data bytes
+ * @param len Data length (1-E32_CFG_TP_MAX_LEN)
+ * @param destination Target address
+ * @param priority Message priority (0-7, default 6)
+ * @return E32_OK once sent or queued, E32_ERR_BUSY if the transmit queue
+ *         is full or a multi-packet transfer to the same destination is
+ *         still running or all send sessions are in use, error code otherwise
+ * 
+ * @internal
+ */
+e32_error_t e32_j1939_send_raw(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint16_t len,
+    uint8_t destination,
+    uint8_t priority
+);
+
+
+/**
+ * @brief Send raw PGN data on a specific channel
+ * 
+ * As e32_j1939_send_raw(), which always uses channel 0. Each channel
+ * has its own transport protocol sessions and transmit queue.
+ * 
+ * @warning INTERNAL API - Not part of the stable public API.
+ * 
+ * @param channel Channel index (< number of channels)
+ * 
+ * @internal
+ */
+e32_error_t e32_j1939_send_raw_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint16_t len,
+    uint8_t destination,
+    uint8_t priority
+);
+
+
+/* ==========================================================================
+ * QUEUED TRANSMISSION
+ * ========================================================================== */
+
+/**
+ * @brief Queue a single-frame PGN without waiting for the bus
+ * 
+ * All sends go through a per-client queue ordered by the J1939 priority
+ * in the identifier; frames of equal priority keep their order. The
+ * queue is flushed to the backend in bursts of config.tx_burst frames
+ * (default E32_CFG_TX_BURST) right away and again from every
+ * e32_j1939_poll(), so a priority 3 command overtakes priority 6/7
+ * diagnostic and transport traffic that is still waiting.
+ * 
+ * With E32_TX_COALESCE, a still-queued coalescing frame with the same
+ * identifier takes the new payload and callback, keeping its place in
+ * line; the replaced frame completes with E32_ERR_CANCELLED.
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number
+ * @param data Payload
+ * @param len Payload length (1-8, up to 64 with config.can_fd)
+ * @param destination Target address
+ * @param priority Message priority (0-7)
+ * @param flags E32_TX_* flags (0 for none)
+ * @param done Completion callback (may be NULL)
+ * @param user_data Passed to done
+ * @return E32_OK when queued, E32_ERR_BUSY if the queue is full, error
+ *         code otherwise (done is not called unless E32_OK is returned)
+ */
+e32_error_t e32_j1939_send_async(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t destination,
+    uint8_t priority,
+    uint8_t flags,
+    e32_tx_done_t done,
+    void* user_data
+);
+
+/**
+ * @brief Queue a single-frame PGN on one bus of a multi-channel client
+ * 
+ * As e32_j1939_send_async(), which sends on channel 0. Each channel has
+ * its own queue, so coalescing only replaces frames of the same bus.
+ * 
+ * @param channel Bus to send on
+ * @return As e32_j1939_send_async(), E32_ERR_INVALID_PARAM if channel
+ *         is out of range
+ */
+e32_error_t e32_j1939_send_async_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t destination,
+    uint8_t priority,
+    uint8_t flags,
+    e32_tx_done_t done,
+    void* user_data
+);
+
+/**
+ * @brief Send several PGs packed into J1939-22 Multi-PG containers
+ * 
+ * Needs E32_CFG_CAN_FD and config.can_fd. The PGs are packed in order,
+ * as many per 64-byte CAN FD frame as fit, so a burst of short PGs
+ * costs one arbitration per container instead of one per PG. Each
+ * container is queued like e32_j1939_send_async(). Receivers in FD
+ * builds unpack containers automatically: subscribers of a contained
+ * PGN see it as a message with view->frame NULL.
+ * 
+ * @param client Client handle
+ * @param channel Bus to send on
+ * @param pgs PGs to send (pgn, data, len; tos and trailer are ignored)
+ * @param count Number of PGs
+ * @param destination Container destination, E32_SA_GLOBAL to broadcast
+ * @param priority Priority of the containers (0-7)
+ * @return E32_OK once every container is queued, E32_ERR_NOT_SUPPORTED
+ *         without CAN FD, E32_ERR_INVALID_PARAM if a PG is longer than
+ *         E32_CPG_MAX_DATA_LEN, E32_ERR_BUSY if the transmit queue filled
+ *         up (earlier containers stay queued), error code otherwise
+ * 
+ * @example
+ * @code
+ * const e32_cpg_t pgs[] = {
+ *     { E32_PGN_EEC1, eec1, 8 },
+ *     { E32_PGN_ETC1, etc1, 8 },
+ *     { E32_PGN_ET1,  et1,  8 },
+ * };
+ * e32_j1939_send_multi_pg(client, 0, pgs, 3, E32_SA_GLOBAL, 3);
+ * @endcode
+ */
+e32_error_t e32_j1939_send_multi_pg(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    const e32_cpg_t* pgs,
+    uint8_t count,
+    uint8_t destination,
+    uint8_t priority
+);
+
+
+/* ==========================================================================
+ * CYCLIC TRANSMISSION
+ * ========================================================================== */
+
+/**
+ * @brief Publish a PGN periodically
+ * 
+ * The client's timer wheel calls provider whenever the PGN is due and
+ * queues the payload it returns. The schedule is driven by
+ * e32_j1939_poll() or e32_j1939_tick(); call either at least as often as
+ * the shortest period. Transmissions stay phase-locked to the first one,
+ * which goes out on the next tick. Registering a PGN again changes its
+ * period, priority, destination and provider and restarts its phase.
+ * Payloads over 8 bytes need CAN FD, as with e32_j1939_send_async();
+ * a classic client skips such cycles.
+ * PGNs registered here go out on channel 0; see e32_j1939_add_cyclic_on().
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number
+ * @param period_ms Transmission period (>= 1 ms)
+ * @param priority Message priority (0-7)
+ * @param destination Target address (E32_SA_GLOBAL for broadcast)
+ * @param provider Fills the payload for each cycle
+ * @param user_data Passed to provider
+ * @return E32_OK, E32_ERR_NO_MEMORY if E32_CFG_CYCLIC_MAX PGNs are registered,
+ *         error code otherwise
+ * 
+ * @example
+ * @code
+ * static bool fill_eec1(uint32_t pgn, uint8_t* data, uint8_t* len, void* ctx) {
+ *     encode_eec1(data, engine_state(ctx));
+ *     *len = 8;
+ *     return true;
+ * }
+ * e32_j1939_add_cyclic(client, E32_PGN_EEC1, 10, 3, E32_SA_GLOBAL, fill_eec1, &engine);
+ * @endcode
+ */
+e32_error_t e32_j1939_add_cyclic(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    uint32_t period_ms,
+    uint8_t priority,
+    uint8_t destination,
+    e32_cyclic_provider_t provider,
+    void* user_data
+);
+
+/**
+ * @brief Publish a PGN periodically on one bus of a multi-channel client
+ * 
+ * As e32_j1939_add_cyclic(). A PGN is published on one channel at a
+ * time: registering it again with another channel moves it there.
+ * 
+ * @param channel Bus to send on
+ * @return As e32_j1939_add_cyclic(), E32_ERR_INVALID_PARAM if channel
+ *         is out of range
+ */
+e32_error_t e32_j1939_add_cyclic_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    uint32_t period_ms,
+    uint8_t priority,
+    uint8_t destination,
+    e32_cyclic_provider_t provider,
+    void* user_data
+);
+
+/**
+ * @brief Stop publishing a PGN (safe from inside its provider)
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number
+ * @return E32_OK, or E32_ERR_NOT_FOUND if it was not registered
+ */
+e32_error_t e32_j1939_remove_cyclic(e32_j1939_client_t client, uint32_t pgn);
+
+/**
+ * @brief Read achieved period, jitter and deadline misses of a cyclic PGN
+ * 
+ * @param client Client handle
+ * @param pgn Parameter Group Number
+ * @param stats Output statistics
+ * @return E32_OK, or E32_ERR_NOT_FOUND if it is not registered
+ */
+e32_error_t e32_j1939_get_cyclic_stats(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_cyclic_stats_t* stats
+);
+
+
+/* ==========================================================================
+ * ENGINE CONTROL COMMAND (CONVENIENCE)
+ * ========================================================================== */
+
+/**
+ * @brief Send Engine Control Command (PGN 0xEF00)
+ * 
+ * Convenience function for sending engine control commands.
+ * 
+ * A command still queued for the bus is replaced by a newer one
+ * instead of both being sent (E32_TX_COALESCE).
+ * 
+ * @param client Client handle
+ * @param cmd Command data
+ * @return E32_OK on success, error code otherwise
+ * 
+ * @example
+ * @code
+ * e32_engine_control_cmd_t cmd = {
+ *     .target_rpm = 1200,
+ *     .enable = true
+ * };
+ * e32_j1939_send_engine_control(client, &cmd);
+ * @endcode
+ */
+e32_error_t e32_j1939_send_engine_control(
+    e32_j1939_client_t client,
+    const e32_engine_control_cmd_t* cmd
+);
+
+/**
+ * @brief Send Engine Control Command on one bus of a multi-channel client
+ * 
+ * As e32_j1939_send_engine_control(), which sends on channel 0.
+ * 
+ * @param client Client handle
+ * @param channel Bus to send on
+ * @param cmd Command data
+ * @return E32_OK on success, E32_ERR_INVALID_PARAM if channel is out of
+ *         range, error code otherwise
+ */
+e32_error_t e32_j1939_send_engine_control_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    const e32_engine_control_cmd_t* cmd
+);
+
+
+/* ==========================================================================
+ * POLLING (FOR NON-RTOS SYSTEMS)
+ * ========================================================================== */
+
+/**
+ * @brief Process pending messages
+ * 
+ * Must be called periodically in main loop on non-RTOS systems.
+ * On RTOS systems with dedicated receive task, this is optional.
+ * 
+ * Pulls frames from the transport backend (if any) into the receive
+ * ring, then drains the ring in batches of E32_CFG_RX_BATCH, decoding
+ * and calling handlers. At most E32_CFG_POLL_MAX_BATCHES batches are
+ * handled per call unless the ring is at or above its high-water mark,
+ * in which case it is drained completely.
+ * 
+ * Then runs cyclic transmissions, transport protocol timers and the
+ * transmit queue (see e32_j1939_tick()).
+ * 
+ * @param client Client handle
+ * @return Number of messages processed
+ */
+int e32_j1939_poll(e32_j1939_client_t client);
+
+/**
+ * @brief Run the time-driven work of poll without receiving
+ * 
+ * Sends due cyclic PGNs, advances transport protocol timers and flushes
+ * the transmit queue. Call it from a periodic timer task when reception
+ * is handled elsewhere, or more often than poll to tighten cycle times.
+ * 
+ * @param client Client handle
+ * @return E32_OK, or E32_ERR_NOT_CONNECTED
+ */
+e32_error_t e32_j1939_tick(e32_j1939_client_t client);
+
+/**
+ * @brief Block until there is work, then poll
+ * 
+ * Sleeps until a frame arrives on any channel, e32_j1939_wake() is
+ * called, the next cyclic PGN or transport protocol timer is due, or
+ * timeout_ms passes, whichever comes first; then runs e32_j1939_poll().
+ * Idle clients use no CPU.
+ * 
+ * @param client Client handle
+ * @param timeout_ms Longest wait, -1 for no limit
+ * @return Number of messages processed, E32_ERR_NOT_CONNECTED, or
+ *         E32_ERR_NOT_SUPPORTED without a waitable descriptor (non-Linux
+ *         builds: wait on config.rx_notify instead)
+ */
+int e32_j1939_wait(e32_j1939_client_t client, int timeout_ms);
+
+/**
+ * @brief Descriptor for an external event loop
+ * 
+ * Becomes readable when frames are pending or e32_j1939_wake() was
+ * called. Register it for reading with epoll, libuv (uv_poll_t) or
+ * select, call e32_j1939_poll() when it fires, and arm a timer with
+ * e32_j1939_next_timeout(). Owned by the client; do not read or close it.
+ * 
+ * @param client Client handle
+ * @return File descriptor, or -1 if unavailable
+ */
+int e32_j1939_get_fd(e32_j1939_client_t client);
+
+/**
+ * @brief Milliseconds until poll or tick has time-driven work
+ * 
+ * @param client Client handle
+ * @return 0 if due now, -1 if nothing is scheduled
+ */
+int e32_j1939_next_timeout(e32_j1939_client_t client);
+
+/**
+ * @brief Interrupt e32_j1939_wait() and make the descriptor readable
+ * 
+ * Safe from any thread and from signal handlers.
+ * 
+ * @param client Client handle
+ */
+void e32_j1939_wake(e32_j1939_client_t client);
+
+
+/* ==========================================================================
+ * BUS LOAD PROFILER
+ * ========================================================================== */
+
+/**
+ * @brief Start profiling bus load and per-source/per-PGN frame rates
+ * 
+ * Every channel gets its own profile over a sliding window of
+ * E32_CFG_BUSLOAD_SLOTS x E32_CFG_BUSLOAD_SLOT_MS (1 s by default),
+ * counting received frames and the client's own transmissions. Bus
+ * time per frame is derived from its DLC, the chosen stuff-bit method
+ * and config.bitrate. Memory is fixed and each frame costs O(1) work.
+ * 
+ * While profiling, the backend's acceptance filters are opened so that
+ * frames nobody subscribed to are counted too; they are still dropped
+ * before decode. Frames are timed by their timestamp (by the client
+ * clock if it is 0), so drivers feeding e32_j1939_rx_push_isr() should
+ * stamp them. Starting again clears the profiles.
+ * 
+ * @param client Client handle
+ * @param stuffing How stuff bits are counted (E32_STUFFING_EXACT is the default)
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_busload_start(e32_j1939_client_t client, e32_stuffing_t stuffing);
+
+/**
+ * @brief Stop profiling and restore the subscription filters
+ * 
+ * @param client Client handle
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_busload_stop(e32_j1939_client_t client);
+
+/**
+ * @brief Read the bus load of one channel
+ * 
+ * Besides utilization and frame rate over the window, reports the
+ * quietest phase of the E32_CFG_BUSLOAD_SLOT_MS cycle: most J1939
+ * traffic repeats at multiples of 100 ms, so starting a cyclic
+ * transmission (e32_j1939_add_cyclic()) quiet_in_ms from now lines it
+ * up with the least busy part of the cycle.
+ * 
+ * Call from the polling thread.
+ * 
+ * @param client Client handle
+ * @param channel Channel index
+ * @param stats Output statistics
+ * @return E32_OK, E32_ERR_NOT_FOUND if the profiler is not running,
+ *         E32_ERR_INVALID_PARAM for a bad channel
+ * 
+ * @example
+ * @code
+ * e32_busload_stats_t load;
+ * e32_j1939_get_busload(client, 0, &load);
+ * printf("%u.%u%% load, %u frames/s\n", load.load_permille / 10,
+ *        load.load_permille % 10, load.frames_per_sec);
+ * @endcode
+ */
+e32_error_t e32_j1939_get_busload(e32_j1939_client_t client, uint8_t channel,
+                                  e32_busload_stats_t* stats);
+
+/**
+ * @brief Busiest source addresses on a channel, highest frame rate first
+ * 
+ * @param client Client handle
+ * @param channel Channel index
+ * @param rates Output array
+ * @param max Capacity of rates
+ * @param count Receives the number of entries written
+ * @return E32_OK, E32_ERR_NOT_FOUND if the profiler is not running,
+ *         E32_ERR_INVALID_PARAM for a bad channel
+ */
+e32_error_t e32_j1939_busload_sources(e32_j1939_client_t client, uint8_t channel,
+                                      e32_busload_rate_t* rates, uint16_t max, uint16_t* count);
+
+/**
+ * @brief Busiest PGNs on a channel, highest frame rate first
+ * 
+ * The candidates for hardware filtering: PGNs near the top that no
+ * handler needs.
+ * 
+ * @param client Client handle
+ * @param channel Channel index
+ * @param rates Output array
+ * @param max Capacity of rates
+ * @param count Receives the number of entries written
+ * @return E32_OK, E32_ERR_NOT_FOUND if the profiler is not running,
+ *         E32_ERR_INVALID_PARAM for a bad channel
+ */
+e32_error_t e32_j1939_busload_pgns(e32_j1939_client_t client, uint8_t channel,
+                                   e32_busload_rate_t* rates, uint16_t max, uint16_t* count);
+
+
+/* ==========================================================================
+ * DRIVER / ISR INTERFACE
+ * ========================================================================== */
+
+/**
+ * @brief Queue a received frame from interrupt or driver context
+ * 
+ * Copies the frame into the client's lock-free receive ring and returns.
+ * No decoding or handler calls happen here; they run later from
+ * e32_j1939_poll(). Safe to call from an ISR concurrently with poll,
+ * provided there is a single producer per client: CAN ISRs, or the
+ * built-in transport backend - not both.
+ * 
+ * On multi-channel clients one ring serves every bus: set frame->channel
+ * to the controller the frame came from. The RX interrupts of all those
+ * controllers must then run at one priority (or share one handler), so
+ * that no push preempts another, and on one core. A push that does
+ * preempt another is refused with E32_ERR_BUSY and counted in
+ * e32_rx_stats_t.isr_nested; the frame is lost, but the ring stays
+ * intact.
+ * 
+ * When the ring was empty, config.rx_notify is called and a process
+ * blocked in e32_j1939_wait() is woken.
+ * 
+ * @param client Client handle
+ * @param frame Received frame
+ * @return E32_OK, E32_ERR_NO_MEMORY if the ring is full (frame dropped
+ *         and counted in e32_rx_stats_t.overflows), E32_ERR_BUSY if the
+ *         call preempted another push, E32_ERR_INVALID_PARAM if
+ *         frame->channel is out of range
+ * 
+ * @example
+ * @code
+ * void CAN1_RX0_IRQHandler(void) {
+ *     e32_can_frame_t frame;
+ *     read_mailbox(&frame);
+ *     e32_j1939_rx_push_isr(g_client, &frame);
+ * }
+ * @endcode
+ */
+e32_error_t e32_j1939_rx_push_isr(e32_j1939_client_t client, const e32_can_frame_t* frame);
+
+/**
+ * @brief Encode a filter for one STM32 bxCAN filter bank
+ * 
+ * 32-bit scale, identifier mask mode, extended data frames only. With
+ * config.on_filters the client hands over at most config.filter_banks
+ * filters (28 banks on dual-CAN parts, shared between CAN1 and CAN2).
+ * 
+ * @param filter Filter from config.on_filters
+ * @param fr1 Receives the CAN_FxR1 (identifier) value
+ * @param fr2 Receives the CAN_FxR2 (mask) value
+ * 
+ * @example
+ * @code
+ * static void program_filters(void* ctx, const e32_can_filter_t* filters, int count) {
+ *     CAN1->FMR |= CAN_FMR_FINIT;
+ *     CAN1->FA1R = 0;
+ *     if (!filters) {
+ *         CAN1->sFilterRegister[0].FR1 = 0;       // mask 0: everything
+ *         CAN1->sFilterRegister[0].FR2 = 0;
+ *         count = 1;
+ *     }
+ *     for (int i = 0; filters && i < count; i++) {
+ *         uint32_t fr1, fr2;
+ *         e32_filter_to_bxcan(&filters[i], &fr1, &fr2);
+ *         CAN1->sFilterRegister[i].FR1 = fr1;
+ *         CAN1->sFilterRegister[i].FR2 = fr2;
+ *     }
+ *     CAN1->FS1R = CAN1->FA1R = (1u << count) - 1;    // 32-bit, active
+ *     CAN1->FMR &= ~CAN_FMR_FINIT;
+ * }
+ * @endcode
+ */
+void e32_filter_to_bxcan(const e32_can_filter_t* filter, uint32_t* fr1, uint32_t* fr2);
+
+/**
+ * @brief Encode a filter for the ESP32 TWAI single acceptance filter
+ * 
+ * Fills twai_filter_config_t.acceptance_code / acceptance_mask for
+ * single_filter = true, extended data frames. TWAI has one filter, so
+ * set config.filter_banks to 1.
+ * 
+ * @param filter Filter from config.on_filters
+ * @param code Receives acceptance_code
+ * @param mask Receives acceptance_mask (set bits are don't-care)
+ */
+void e32_filter_to_twai(const e32_can_filter_t* filter, uint32_t* code, uint32_t* mask);
+
+/**
+ * @brief Read receive ring statistics
+ * 
+ * @param client Client handle
+ * @param stats Output statistics
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_get_rx_stats(e32_j1939_client_t client, e32_rx_stats_t* stats);
+
+/**
+ * @brief Read transport protocol statistics
+ * 
+ * @param client Client handle
+ * @param stats Output statistics
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_get_tp_stats(e32_j1939_client_t client, e32_tp_stats_t* stats);
+
+/**
+ * @brief Read transmit queue statistics
+ * 
+ * @param client Client handle
+ * @param stats Output statistics
+ * @return E32_OK on success, error code otherwise
+ */
+e32_error_t e32_j1939_get_tx_stats(e32_j1939_client_t client, e32_tx_stats_t* stats);
+
+/**
+ * @brief Read the counters of one dispatch worker
+ * 
+ * Counters start over when the workers restart after a subscription
+ * change.
+ * 
+ * @param client Client handle
+ * @param worker Worker index, below config.workers
+ * @param stats Output statistics
+ * @return E32_OK on success, E32_ERR_NOT_FOUND if no workers are running
+ */
+e32_error_t e32_j1939_get_worker_stats(e32_j1939_client_t client, uint8_t worker,
+                                       e32_worker_stats_t* stats);
+
+/**
+ * @brief Read all client statistics in one snapshot
+ * 
+ * Counts every dispatched frame, frames nobody wanted, messages held
+ * back by delivery options, decode failures and handler calls, per
+ * client and per PGN, together with the receive ring, transmit queue
+ * and worker queue state. The latency histogram shows how long frames
+ * waited between entering the SDK and reaching their handlers; the
+ * handler histogram how long the handlers took. A rising latency tail
+ * or rx.high_water_events is the sign of a bus the client cannot keep
+ * up with, well before rx.overflows starts counting.
+ * 
+ * Safe to call from any thread. Counters are exact; the histograms
+ * time one in E32_CFG_STATS_SAMPLE messages, at the cost of three
+ * clock_us reads each. Define E32_CFG_NO_STATS_TIMING to keep only the
+ * counters, or E32_CFG_NO_STATS to remove the instrumentation.
+ * 
+ * @param client Client handle
+ * @param stats Output statistics (about 1.9 KB with the default sizing)
+ * @return E32_OK, E32_ERR_NOT_SUPPORTED in E32_CFG_NO_STATS builds
+ * 
+ * @example
+ * @code
+ * e32_stats_t stats;
+ * e32_j1939_get_stats(client, &stats);
+ * printf("p99 latency %u us, slowest handler %u us\n",
+ *        e32_histogram_percentile(&stats.latency, 99.0), stats.handler.max);
+ * @endcode
+ */
+e32_error_t e32_j1939_get_stats(e32_j1939_client_t client, e32_stats_t* stats);
+
+/**
+ * @brief Zero the counters and histograms and free the per-PGN rows
+ * 
+ * Receive ring, transmit queue and worker counters are not affected.
+ * Call it from the polling thread; events counted by handler threads
+ * during the reset may survive it.
+ * 
+ * @param client Client handle
+ * @return E32_OK, E32_ERR_NOT_SUPPORTED in E32_CFG_NO_STATS builds
+ */
+e32_error_t e32_j1939_reset_stats(e32_j1939_client_t client);
+
+/**
+ * @brief Sample value at a percentile of a histogram
+ * 
+ * Returns the upper edge of the bin holding the percentile, so the
+ * result overstates the true value by at most 12.5% (never beyond the
+ * recorded max).
+ * 
+ * @param hist Histogram from e32_stats_t
+ * @param percent 0-100, e.g. 99.9
+ * @return Microseconds, 0 for an empty histogram
+ */
+uint32_t e32_histogram_percentile(const e32_histogram_t* hist, double percent);
 
 
 #ifdef __cplusplus
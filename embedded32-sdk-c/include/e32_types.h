@@ -15,6 +15,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "e32_config.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,6 +28,9 @@ extern "C" {
 /** Request PGN (59904) - used to request data from other ECUs */
 #define E32_PGN_REQUEST             0xEA00
 
+/** Acknowledgment (59392) - ACK/NACK of a request or command */
+#define E32_PGN_ACKNOWLEDGMENT      0xE800
+
 /** Address Claimed (60928) */
 #define E32_PGN_ADDRESS_CLAIMED     0xEE00
 
@@ -53,6 +58,50 @@ extern "C" {
 /** Engine Control Command - Proprietary B (61184) */
 #define E32_PGN_ENGINE_CONTROL_CMD  0xEF00
 
+/** Transport Protocol - Data Transfer (60160) */
+#define E32_PGN_TP_DT               0xEB00
+
+/** Transport Protocol - Connection Management (60416) */
+#define E32_PGN_TP_CM               0xEC00
+
+/** J1939-22 Multi-PG container (9472) */
+#define E32_PGN_MULTI_PG            0x2500
+
+/** Highest valid PGN (18-bit PGN space including EDP/DP) */
+#define E32_PGN_MAX                 0x3FFFF
+
+/** Wildcard for e32_j1939_on_pgn() - matches every PGN */
+#define E32_PGN_ANY                 0xFFFFFFFFu
+
+
+/* ==========================================================================
+ * WELL-KNOWN SPNs
+ * ========================================================================== */
+
+/** Engine Speed (EEC1), rpm */
+#define E32_SPN_ENGINE_SPEED        190
+
+/** Actual Engine - Percent Torque (EEC1), % */
+#define E32_SPN_ENGINE_TORQUE       513
+
+/** Engine Coolant Temperature (ET1), degC */
+#define E32_SPN_COOLANT_TEMP        110
+
+/** Transmission Output Shaft Speed (ETC1), rpm */
+#define E32_SPN_OUTPUT_SHAFT_SPEED  191
+
+/** Transmission Current Gear (ETC1) */
+#define E32_SPN_CURRENT_GEAR        523
+
+/** Parameter Group Number being requested (Request) */
+#define E32_SPN_REQUESTED_PGN       2540
+
+/** Target RPM (Engine Control Command) - proprietary SPN range */
+#define E32_SPN_TARGET_RPM          516096
+
+/** Enable flag (Engine Control Command) - proprietary SPN range */
+#define E32_SPN_CONTROL_ENABLE      516097
+
 
 /* ==========================================================================
  * WELL-KNOWN SOURCE ADDRESSES
@@ -82,6 +131,9 @@ extern "C" {
 /** Off-board Diagnostic Tool #2 */
 #define E32_SA_DIAG_TOOL_2          0xFA
 
+/** Null address: sender of Cannot Claim Address */
+#define E32_SA_NULL                 0xFE
+
 /** Global (broadcast) */
 #define E32_SA_GLOBAL               0xFF
 
@@ -90,20 +142,83 @@ extern "C" {
  * CAN FRAME TYPES
  * ========================================================================== */
 
-/** Maximum CAN data length */
-#define E32_CAN_MAX_DATA_LEN        8
+/** Classic CAN data length */
+#define E32_CAN_CLASSIC_DATA_LEN    8
+
+/** Maximum CAN data length: 64 with E32_CFG_CAN_FD, 8 otherwise */
+#ifdef E32_CFG_CAN_FD
+#define E32_CAN_MAX_DATA_LEN        64
+#else
+#define E32_CAN_MAX_DATA_LEN        E32_CAN_CLASSIC_DATA_LEN
+#endif
+
+/** Frame flag: CAN FD frame (FDF) */
+#define E32_CAN_FLAG_FD             0x01
+
+/** Frame flag: data phase at the fast bitrate (BRS, FD only) */
+#define E32_CAN_FLAG_BRS            0x02
+
+/** Frame flag: sender is error passive (ESI, FD only) */
+#define E32_CAN_FLAG_ESI            0x04
 
 /**
  * @brief Raw CAN frame structure
+ *
+ * dlc is the data length in bytes, also for CAN FD frames (0-8, 12, 16,
+ * 20, 24, 32, 48 or 64); drivers convert to and from the 4-bit DLC code
+ * with e32_can_dlc_to_len() / e32_can_len_to_dlc(). Classic builds keep
+ * the frame at 24 bytes.
+ *
+ * timestamp is on the SDK clock, e32_time_ms(): CLOCK_MONOTONIC on
+ * POSIX, never wall-clock time. SocketCAN moves the kernel's receive
+ * stamp onto it; virtual buses stamp bus time from an e32_time_ms()
+ * epoch. Drivers feeding e32_j1939_rx_push_isr() on targets without
+ * that clock stamp with the one given as config.clock_ms.
  */
 typedef struct {
     uint32_t id;                        /**< CAN ID (29-bit for J1939) */
     uint8_t  data[E32_CAN_MAX_DATA_LEN]; /**< Frame data */
-    uint8_t  dlc;                       /**< Data length code (0-8) */
-    uint32_t timestamp;                 /**< Timestamp in milliseconds */
+    uint8_t  dlc;                       /**< Data length in bytes */
+    uint32_t timestamp;                 /**< Receive time in ms on the e32_time_ms() clock, 0 = not stamped */
     bool     is_extended;               /**< True for 29-bit extended ID */
+    uint8_t  channel;                   /**< Bus received on / to send on (0 = first) */
+    uint8_t  flags;                     /**< E32_CAN_FLAG_*, 0 for classic frames */
 } e32_can_frame_t;
 
+/**
+ * @brief Acceptance filter: a frame passes when (id & mask) == (filter.id & mask)
+ */
+typedef struct {
+    uint32_t id;        /**< 29-bit identifier pattern */
+    uint32_t mask;      /**< Bits of id that must match */
+} e32_can_filter_t;
+
+/** Multi-PG: bytes of the header in front of each contained PG */
+#define E32_CPG_HEADER_LEN          4
+
+/** Multi-PG: longest payload of one contained PG (64-byte frame, one header) */
+#define E32_CPG_MAX_DATA_LEN        60
+
+/** Multi-PG: type of service of an ordinary contained PG (no trailer) */
+#define E32_CPG_TOS_PLAIN           2
+
+/** Multi-PG: filler after the last contained PG */
+#define E32_CPG_PADDING             0xAA
+
+/**
+ * @brief One PG inside a J1939-22 Multi-PG container
+ *
+ * It shares the container frame's priority, source and destination
+ * address; data points into the frame.
+ */
+typedef struct {
+    uint32_t       pgn;     /**< Contained PGN (18 bits) */
+    const uint8_t* data;    /**< Payload bytes */
+    uint8_t        len;     /**< Payload length */
+    uint8_t        tos;     /**< Type of service */
+    uint8_t        trailer; /**< Trailer format, 0 = none */
+} e32_cpg_t;
+
 
 /* ==========================================================================
  * J1939 MESSAGE TYPES
@@ -139,8 +254,47 @@ typedef struct {
     e32_spn_type_t  type;   /**< Value type */
 } e32_spn_t;
 
+/**
+ * @brief Validity of a compact SPN value (J1939-71 reserved ranges)
+ */
+typedef enum {
+    E32_SPN_STATUS_OK = 0,          /**< value holds a measurement */
+    E32_SPN_STATUS_ERROR,           /**< Sender reports an error (0xFE.. range) */
+    E32_SPN_STATUS_NOT_AVAILABLE    /**< Not available / not supported (0xFF.. range) */
+} e32_spn_status_t;
+
+/**
+ * @brief Compact SPN: 8 bytes, no pointers, no floating point
+ *
+ * value is fixed-point: the physical value times e32_spn_fixed_den(index),
+ * e.g. engine speed in 1/8 rpm. Bools are 0 or 1. e32_spn_to_float() and
+ * e32_spn_to_scaled() convert on request.
+ */
+typedef struct {
+    int32_t  value;     /**< Physical value in 1/e32_spn_fixed_den(index) units */
+    uint16_t index;     /**< Catalogue row; see e32_spn_number(), e32_spn_name() */
+    uint8_t  type;      /**< e32_spn_type_t */
+    uint8_t  status;    /**< e32_spn_status_t; value is 0 unless OK */
+} e32_spn_compact_t;
+
+/** Largest J1939-21 transport protocol payload (255 packets x 7 bytes) */
+#define E32_TP_MAX_DATA_LEN         1785
+
 /**
  * @brief Decoded J1939 message - what the user receives
+ * 
+ * Messages reassembled by the transport protocol, and CAN FD frames
+ * longer than 8 bytes, carry their full payload in payload/payload_len;
+ * raw[] then holds the first 8 bytes.
+ * The payload buffer belongs to the SDK and is only valid for the
+ * duration of the handler call. For single-frame messages payload is
+ * NULL, so e32_msg_data() is the uniform way to reach the bytes.
+ * 
+ * In E32_DECODE_HEADER mode only the header fields, raw bytes and
+ * timestamp are filled: spn_count is 0 and pgn_name is NULL. Use
+ * e32_msg_get_spn() / e32_msg_find_spn() to extract values on demand.
+ * In E32_DECODE_VALUES mode spns[] is filled but pgn_name is NULL;
+ * e32_msg_pgn_name() resolves it when needed.
  */
 typedef struct {
     uint32_t    pgn;                    /**< Parameter Group Number */
@@ -150,11 +304,60 @@ typedef struct {
     uint8_t     priority;               /**< Priority (0-7) */
     e32_spn_t   spns[E32_MAX_SPNS];     /**< Decoded SPNs */
     uint8_t     spn_count;              /**< Number of valid SPNs */
-    uint8_t     raw[E32_CAN_MAX_DATA_LEN]; /**< Raw data bytes */
+    uint8_t     raw[E32_CAN_CLASSIC_DATA_LEN]; /**< Raw data bytes (first 8) */
     uint8_t     raw_len;                /**< Raw data length */
     uint32_t    timestamp;              /**< Timestamp in milliseconds */
+    const uint8_t* payload;             /**< Reassembled multi-packet data, NULL for single frames */
+    uint16_t    payload_len;            /**< Length of payload in bytes */
+    uint8_t     channel;                /**< Bus the message arrived on */
 } e32_j1939_message_t;
 
+/**
+ * @brief Compact decoded message
+ *
+ * Same header as e32_j1939_message_t, with compact SPNs and without the
+ * name pointers: about half the size on 64-bit hosts. SPNs come from the
+ * generated catalogue only (DM1 and other hand-decoded PGNs have none);
+ * raw[] holds the first 8 payload bytes.
+ */
+typedef struct {
+    uint32_t    pgn;                    /**< Parameter Group Number */
+    uint32_t    timestamp;              /**< Timestamp in milliseconds */
+    uint8_t     source_address;         /**< Source Address of sender */
+    uint8_t     destination_address;    /**< Destination Address (255 for broadcast) */
+    uint8_t     priority;               /**< Priority (0-7) */
+    uint8_t     channel;                /**< Bus the message arrived on */
+    uint8_t     spn_count;              /**< Number of valid SPNs */
+    uint8_t     raw_len;                /**< Raw data length */
+    uint8_t     raw[E32_CAN_CLASSIC_DATA_LEN]; /**< Raw data bytes (first 8) */
+    e32_spn_compact_t spns[E32_MAX_SPNS];  /**< Decoded SPNs */
+} e32_j1939_compact_t;
+
+/** Handle of a signal in the last-value cache */
+typedef uint16_t e32_signal_id_t;
+
+/**
+ * @brief Freshness of a cached signal
+ */
+typedef enum {
+    E32_SIGNAL_NO_DATA = 0,         /**< Tracked, but no frame has carried it yet */
+    E32_SIGNAL_FRESH,               /**< Updated within its maximum age */
+    E32_SIGNAL_STALE                /**< Older than its maximum age */
+} e32_signal_state_t;
+
+/**
+ * @brief Latest value of one (source address, PGN, SPN) signal
+ */
+typedef struct {
+    e32_spn_compact_t spn;              /**< Value as last received (status says if it is valid) */
+    uint32_t    pgn;                    /**< PGN carrying the signal */
+    uint32_t    updated_ms;             /**< Client clock at the last update */
+    uint32_t    age_ms;                 /**< Time since the last update, 0 without data */
+    uint32_t    updates;                /**< Frames that carried the signal */
+    uint8_t     source_address;         /**< Sender the signal is tracked for */
+    uint8_t     state;                  /**< e32_signal_state_t */
+} e32_signal_value_t;
+
 
 /* ==========================================================================
  * CLIENT CONFIGURATION
@@ -164,13 +367,79 @@ typedef struct {
  * @brief Transport type enumeration
  */
 typedef enum {
-    E32_TRANSPORT_AUTO,         /**< Auto-detect transport */
+    E32_TRANSPORT_AUTO,         /**< SocketCAN on Linux when an interface is named, else application-fed */
     E32_TRANSPORT_SOCKETCAN,    /**< Linux SocketCAN */
     E32_TRANSPORT_STM32_BXCAN,  /**< STM32 bxCAN */
     E32_TRANSPORT_ESP32_TWAI,   /**< ESP32 TWAI */
     E32_TRANSPORT_VIRTUAL       /**< Virtual (testing) */
 } e32_transport_type_t;
 
+/**
+ * @brief Per-frame decode work done before handlers are called
+ */
+typedef enum {
+    E32_DECODE_FULL,    /**< Resolve PGN name and fill spns[] (default) */
+    E32_DECODE_HEADER,  /**< Header and raw bytes only; SPNs decoded on demand */
+    E32_DECODE_VALUES   /**< Fill spns[], defer the PGN name (see e32_msg_pgn_name()) */
+} e32_decode_mode_t;
+
+/**
+ * @brief How threaded dispatch assigns messages to workers
+ *
+ * Messages with the same key always go to the same worker, in arrival
+ * order.
+ */
+typedef enum {
+    E32_AFFINITY_SOURCE = 0,    /**< By source address: per-ECU ordering (default) */
+    E32_AFFINITY_PGN,           /**< By PGN: each handler sees one thread */
+    E32_AFFINITY_SOURCE_PGN     /**< By (source, PGN): widest spread, per-stream ordering */
+} e32_worker_affinity_t;
+
+/**
+ * @brief Monotonic clock (milliseconds, or microseconds for clock_us)
+ */
+typedef uint32_t (*e32_clock_fn_t)(void);
+
+/**
+ * @brief Receive-ready notification
+ *
+ * Called from e32_j1939_rx_push_isr() (that is, in ISR context) when the
+ * receive ring goes from empty to non-empty. Typical bodies set an RTOS
+ * event-group bit or give a semaphore the receive task waits on.
+ */
+typedef void (*e32_rx_notify_t)(void* ctx);
+
+/**
+ * @brief Where the client stands in J1939-81 address claiming
+ */
+typedef enum {
+    E32_ADDRESS_NONE = 0,       /**< No NAME configured: source_address is used unclaimed */
+    E32_ADDRESS_CLAIMING,       /**< Address Claimed sent, contention window running */
+    E32_ADDRESS_CLAIMED,        /**< Address held */
+    E32_ADDRESS_LOST            /**< No address could be claimed; only Cannot Claim is sent */
+} e32_address_state_t;
+
+/** NAME bit 63: arbitrary address capable (moves to a free address 128-247 when it loses) */
+#define E32_NAME_ARBITRARY_ADDRESS  (1ull << 63)
+
+/**
+ * @brief Address claim progress
+ *
+ * Called from e32_j1939_poll() (or connect) when the claim state or the
+ * source address changes. address is E32_SA_NULL once the claim is lost.
+ */
+typedef void (*e32_address_fn_t)(void* ctx, e32_address_state_t state, uint8_t address);
+
+/**
+ * @brief Acceptance filter update for an application-owned CAN driver
+ *
+ * Called from the API thread (connect, subscribe, unsubscribe) whenever
+ * the planned filter set changes; the set applies to every channel.
+ * filters == NULL means accept everything. Program the controller with
+ * e32_filter_to_bxcan() / e32_filter_to_twai().
+ */
+typedef void (*e32_filters_fn_t)(void* ctx, const e32_can_filter_t* filters, int count);
+
 /**
  * @brief J1939 Client configuration
  */
@@ -180,6 +449,25 @@ typedef struct {
     e32_transport_type_t transport;      /**< Transport type */
     uint32_t            bitrate;         /**< CAN bitrate (default: 250000) */
     bool                debug;           /**< Enable debug output */
+    uint16_t            rx_high_water;   /**< RX ring level that forces a full drain in poll (0 = 3/4 full) */
+    e32_decode_mode_t   decode_mode;     /**< Decode work per frame (default: E32_DECODE_FULL) */
+    e32_clock_fn_t      clock_ms;        /**< Clock for protocol timers (NULL = e32_time_ms()) */
+    e32_clock_fn_t      clock_us;        /**< Microsecond clock for statistics, ISR-safe (NULL = e32_time_us()) */
+    uint8_t             tx_burst;        /**< Frames per backend send call (0 = E32_CFG_TX_BURST) */
+    uint8_t             channel_count;   /**< Interfaces in channels[] (0 = just interface_name) */
+    const char*         channels[E32_CFG_MAX_CHANNELS]; /**< Interface per channel, e.g. "can0", "can1" */
+    uint8_t             workers;         /**< Handler threads (0 = run handlers inside poll) */
+    e32_worker_affinity_t affinity;      /**< Message to worker assignment when workers > 0 */
+    e32_rx_notify_t     rx_notify;       /**< Wake the receive task (may be NULL) */
+    void*               rx_notify_ctx;   /**< Passed to rx_notify */
+    uint8_t             filter_banks;    /**< Hardware filters on_filters may use (0 = E32_CFG_FILTER_MAX) */
+    e32_filters_fn_t    on_filters;      /**< Program the application's CAN driver (may be NULL) */
+    void*               on_filters_ctx;  /**< Passed to on_filters */
+    uint64_t            name;            /**< J1939-81 NAME; non-zero claims source_address at connect */
+    e32_address_fn_t    on_address;      /**< Claim state changes (may be NULL) */
+    void*               on_address_ctx;  /**< Passed to on_address */
+    bool                can_fd;          /**< Send up to 64 bytes per frame as CAN FD (needs E32_CFG_CAN_FD) */
+    uint32_t            data_bitrate;    /**< CAN FD data phase bitrate (default: 2000000) */
 } e32_j1939_config_t;
 
 
@@ -203,6 +491,80 @@ typedef struct {
 } e32_engine_control_cmd_t;
 
 
+/* ==========================================================================
+ * DIAGNOSTIC TROUBLE CODES (DM1 / DM2)
+ * ========================================================================== */
+
+/**
+ * @brief Diagnostic Trouble Code (J1939-73, SPN conversion method 4)
+ */
+typedef struct {
+    uint32_t spn;           /**< Suspect Parameter Number (19 bits) */
+    uint8_t  fmi;           /**< Failure Mode Identifier (0-31) */
+    uint8_t  occurrence;    /**< Occurrence count (0-126, 127 = not available) */
+} e32_dtc_t;
+
+/** Lamp states in DM1/DM2 byte 1: 0 off, 1 on, 3 not available */
+#define E32_DM_LAMP_MIL(status)         (((status) >> 6) & 0x03)   /**< Malfunction indicator */
+#define E32_DM_LAMP_RED_STOP(status)    (((status) >> 4) & 0x03)
+#define E32_DM_LAMP_AMBER(status)       (((status) >> 2) & 0x03)   /**< Amber warning */
+#define E32_DM_LAMP_PROTECT(status)     ((status) & 0x03)
+
+/**
+ * @brief What happened to a DTC
+ */
+typedef enum {
+    E32_DTC_RAISED = 0,     /**< Listed now, not in the previous message */
+    E32_DTC_CLEARED         /**< Listed before, gone from this message */
+} e32_dtc_change_t;
+
+/**
+ * @brief A change in the DTC list of one ECU
+ */
+typedef struct {
+    uint32_t  pgn;              /**< E32_PGN_DM1 (active) or E32_PGN_DM2 (previously active) */
+    uint8_t   source_address;
+    uint8_t   channel;
+    uint8_t   change;           /**< e32_dtc_change_t */
+    uint8_t   lamp_status;      /**< Byte 1 of the message, see E32_DM_LAMP_MIL() */
+    e32_dtc_t dtc;              /**< As listed (the last listing for CLEARED) */
+    uint32_t  timestamp;        /**< Of the message */
+} e32_dtc_event_t;
+
+
+/* ==========================================================================
+ * GATEWAY ROUTING
+ * ========================================================================== */
+
+/** e32_route_t flags */
+#define E32_ROUTE_BLOCK             0x01    /**< Matching frames are not forwarded anywhere */
+#define E32_ROUTE_SET_SOURCE        0x02    /**< Replace the source address with source_out */
+#define E32_ROUTE_SET_DESTINATION   0x04    /**< Replace the destination of PDU1 frames with destination_out */
+#define E32_ROUTE_SET_PRIORITY      0x08    /**< Replace the priority with priority_out */
+
+/**
+ * @brief One forwarding rule of the gateway (see e32_j1939_add_route())
+ *
+ * A frame received on from_channel matches when its PGN agrees with pgn
+ * in every bit set in pgn_mask and its source address agrees with
+ * source in every bit set in source_mask; zero masks match everything.
+ * The low byte of a PDU1 PGN is the destination address, so it is only
+ * compared when pgn and pgn_mask pin the PGN to PDU2 (PF >= 240).
+ */
+typedef struct {
+    uint8_t  from_channel;      /**< Bus the frames arrive on */
+    uint8_t  flags;             /**< E32_ROUTE_* */
+    uint16_t to_channels;       /**< Bit per bus to forward to (unused with E32_ROUTE_BLOCK) */
+    uint32_t pgn;               /**< PGN to match (18 bits) */
+    uint32_t pgn_mask;          /**< 0x3FFFF for one PGN, 0 for every PGN */
+    uint8_t  source;            /**< Source address to match */
+    uint8_t  source_mask;       /**< 0xFF for one sender, 0 for every sender */
+    uint8_t  source_out;        /**< With E32_ROUTE_SET_SOURCE */
+    uint8_t  destination_out;   /**< With E32_ROUTE_SET_DESTINATION */
+    uint8_t  priority_out;      /**< With E32_ROUTE_SET_PRIORITY (0-7) */
+} e32_route_t;
+
+
 /* ==========================================================================
  * CALLBACK TYPES
  * ========================================================================== */
@@ -215,6 +577,272 @@ typedef struct {
  */
 typedef void (*e32_pgn_handler_t)(const e32_j1939_message_t* message, void* user_data);
 
+/**
+ * @brief Zero-copy view of a received message
+ * 
+ * Borrows the received bytes instead of copying them: for single frames
+ * frame points at the slot in the client's receive ring and data at its
+ * payload; for reassembled multi-packet messages frame is NULL and data
+ * points into the transport session buffer. A view and everything it
+ * points to is only valid for the duration of the handler call. Read
+ * values with the e32_view_*() helpers in e32_codec.h.
+ */
+typedef struct {
+    const e32_can_frame_t* frame;       /**< Received frame, NULL for reassembled messages */
+    const uint8_t* data;                /**< Payload bytes */
+    uint16_t    len;                    /**< Payload length */
+    uint8_t     source_address;         /**< Source Address of sender */
+    uint8_t     destination_address;    /**< Destination Address (255 for broadcast) */
+    uint32_t    pgn;                    /**< Parameter Group Number */
+    uint32_t    timestamp;              /**< Timestamp in milliseconds */
+    uint8_t     priority;               /**< Priority (0-7) */
+    uint8_t     channel;                /**< Bus the message arrived on */
+} e32_j1939_view_t;
+
+/**
+ * @brief Callback for receiving zero-copy message views
+ * 
+ * @param view Borrowed view (valid during the call only)
+ * @param user_data User-provided context pointer
+ */
+typedef void (*e32_view_handler_t)(const e32_j1939_view_t* view, void* user_data);
+
+/**
+ * @brief Handle of one PGN subscription (see e32_j1939_unsubscribe())
+ *
+ * Never E32_SUBSCRIPTION_NONE for a live subscription. A handle stays
+ * unique after its subscription is removed, so removing twice is harmless.
+ */
+typedef uint32_t e32_subscription_t;
+
+/** No subscription */
+#define E32_SUBSCRIPTION_NONE   0u
+
+/**
+ * @brief Callback for DTC changes (see e32_j1939_on_dtc())
+ *
+ * @param event The change (valid during the call only)
+ * @param user_data User-provided context pointer
+ */
+typedef void (*e32_dtc_handler_t)(const e32_dtc_event_t* event, void* user_data);
+
+/** e32_sub_options_t flags */
+#define E32_SUB_ON_CHANGE           0x01    /**< Skip payloads equal to the last one delivered */
+
+/**
+ * @brief Delivery options of a subscription
+ * 
+ * Conditions are tracked per sender and PGN and checked before the
+ * message is decoded. A message is delivered only if it passes every
+ * condition that is set; a zeroed struct delivers everything.
+ */
+typedef struct {
+    uint8_t  flags;             /**< E32_SUB_* */
+    uint16_t decimate;          /**< Offer every Nth message to the other checks, 0 or 1 = all */
+    uint32_t min_interval_ms;   /**< Minimum time between deliveries, 0 = no limit */
+} e32_sub_options_t;
+
+
+/* ==========================================================================
+ * CLIENT STATISTICS
+ * ========================================================================== */
+
+/**
+ * @brief Receive ring statistics
+ */
+typedef struct {
+    uint32_t depth;             /**< Frames currently queued */
+    uint32_t peak_depth;        /**< Highest fill level seen */
+    uint32_t high_water;        /**< Configured high-water mark */
+    uint32_t high_water_events; /**< Times the high-water mark was reached */
+    uint32_t overflows;         /**< Frames dropped because the ring was full */
+    uint32_t isr_nested;        /**< Frames refused because e32_j1939_rx_push_isr() was nested */
+} e32_rx_stats_t;
+
+/**
+ * @brief Transmit queue statistics
+ */
+typedef struct {
+    uint32_t depth;             /**< Frames currently queued */
+    uint32_t peak_depth;        /**< Highest fill level seen */
+    uint32_t sent;              /**< Frames accepted by the backend */
+    uint32_t coalesced;         /**< Queued frames replaced by a newer one */
+    uint32_t rejected;          /**< Enqueues refused because the queue was full */
+    uint32_t errors;            /**< Frames the backend rejected with an error */
+} e32_tx_stats_t;
+
+/**
+ * @brief Gateway statistics (frames counted once per destination bus)
+ */
+typedef struct {
+    uint32_t forwarded;         /**< Sent straight from the receive ring */
+    uint32_t queued;            /**< Copied to the destination's transmit queue first */
+    uint32_t dropped;           /**< Lost because that queue was full as well */
+    uint32_t blocked;           /**< Stopped by an E32_ROUTE_BLOCK rule */
+} e32_route_stats_t;
+
+/**
+ * @brief Statistics of one dispatch worker
+ */
+typedef struct {
+    uint32_t depth;             /**< Messages waiting */
+    uint32_t peak_depth;        /**< Highest backlog seen */
+    uint32_t dispatched;        /**< Messages handed to handlers */
+    uint32_t overflows;         /**< Messages dropped because the queue was full */
+} e32_worker_stats_t;
+
+/**
+ * @brief RAM used by one client, in bytes
+ *
+ * Parts are sized at compile time (see e32_config.h); total includes
+ * padding and the remaining client state.
+ */
+typedef struct {
+    size_t total;               /**< Buffer size for e32_j1939_create_static() (aligned buffer) */
+    size_t rx_ring;             /**< E32_CFG_RX_RING_SIZE frames */
+    size_t dispatch;            /**< E32_CFG_MAX_SUBSCRIPTIONS handlers and the hash table */
+    size_t tp;                  /**< E32_CFG_TP_*_SESSIONS sessions, all channels */
+    size_t tx_queue;            /**< E32_CFG_TX_QUEUE_SIZE frames, all channels */
+    size_t cyclic;              /**< E32_CFG_CYCLIC_MAX entries and the timer wheel */
+    size_t signals;             /**< E32_CFG_MAX_SIGNALS last-value cache entries */
+    size_t stats;               /**< Counters and histograms (see E32_CFG_NO_STATS) */
+    size_t busload;             /**< Bus load profiler, all channels */
+    size_t filters;             /**< E32_CFG_FILTER_MAX planned acceptance filters */
+    size_t names;               /**< NAME table of every address, all channels */
+    size_t requests;            /**< E32_CFG_REQUEST_MAX pending requests */
+    size_t faults;              /**< E32_CFG_DTC_MAX tracked DTCs, the last bytes of each list */
+    size_t routes;              /**< E32_CFG_ROUTE_MAX forwarding rules */
+} e32_footprint_t;
+
+/**
+ * @brief Timing statistics of one cyclic PGN
+ *
+ * Intervals are measured between consecutive transmissions; jitter is
+ * the absolute difference between an interval and the period.
+ */
+typedef struct {
+    uint32_t period_ms;         /**< Configured period */
+    uint32_t sent;              /**< Frames queued for transmission */
+    uint32_t skipped;           /**< Cycles the provider declined or the queue refused */
+    uint32_t missed;            /**< Whole periods that passed without a transmission slot */
+    uint32_t last_interval_ms;  /**< Latest achieved interval */
+    uint32_t min_interval_ms;   /**< Shortest achieved interval */
+    uint32_t max_interval_ms;   /**< Longest achieved interval */
+    uint32_t max_jitter_ms;     /**< Largest jitter seen */
+    uint32_t mean_jitter_us;    /**< Mean jitter, microseconds */
+} e32_cyclic_stats_t;
+
+/**
+ * @brief Transport protocol (TP.CM/TP.DT) statistics
+ */
+typedef struct {
+    uint32_t rx_completed;      /**< Multi-packet messages reassembled */
+    uint32_t rx_aborted;        /**< Receive sessions aborted by the sender or by sequence errors */
+    uint32_t rx_timeouts;       /**< Receive sessions dropped on T1/T2 expiry */
+    uint32_t rx_no_session;     /**< Announcements refused because every session was busy */
+    uint32_t tx_completed;      /**< Multi-packet messages fully sent */
+    uint32_t tx_aborted;        /**< Send sessions aborted by the receiver */
+    uint32_t tx_timeouts;       /**< Send sessions dropped on T3/T4 expiry */
+    uint8_t  rx_active;         /**< Receive sessions currently open */
+    uint8_t  tx_active;         /**< Send sessions currently open */
+} e32_tp_stats_t;
+
+/**
+ * @brief How the bus load profiler counts stuff bits
+ */
+typedef enum {
+    E32_STUFFING_EXACT = 0,     /**< Replay the frame's bits and CRC: the real bus time (default) */
+    E32_STUFFING_WORST,         /**< Worst-case bound: cheaper, overstates by up to ~10% */
+    E32_STUFFING_NONE           /**< Nominal frame length only */
+} e32_stuffing_t;
+
+/**
+ * @brief Bus load of one channel over the profiler window
+ *
+ * Load is bus time used (frames received and sent, with stuffing and
+ * interframe space) relative to config.bitrate, in tenths of a percent.
+ */
+typedef struct {
+    uint32_t window_ms;         /**< Time covered (less than the window just after start) */
+    uint32_t frames;            /**< Frames in the window */
+    uint32_t frames_per_sec;
+    uint32_t bits;              /**< Bus bits in the window */
+    uint16_t load_permille;     /**< Utilization over the window, 1000 = 100% */
+    uint16_t peak_permille;     /**< Busiest single slot since start */
+    uint32_t other_sources;     /**< Frames from addresses without an entry */
+    uint32_t other_pgns;        /**< Frames of PGNs without an entry */
+    uint16_t quiet_permille;    /**< Typical load of the quietest phase of the slot cycle */
+    uint16_t quiet_in_ms;       /**< Time until that phase next begins */
+} e32_busload_stats_t;
+
+/**
+ * @brief Frame rate of one source address or PGN
+ */
+typedef struct {
+    uint32_t key;               /**< Source address or PGN */
+    uint32_t frames;            /**< Frames in the window */
+    uint32_t frames_per_sec;
+} e32_busload_rate_t;
+
+/** Histogram sub-buckets per power of two (3 bits: at most 12.5% wide) */
+#define E32_HIST_SUB_BITS   3
+
+/** Histogram bins: exact below 8 us, then 8 per octave up to 2^24 us */
+#define E32_HIST_BINS       176
+
+/**
+ * @brief Log-linear (HDR-style) histogram of microsecond samples
+ *
+ * Samples below 8 land in bins[sample]. Above that, a sample with its
+ * highest set bit at position m (m >= 3) lands in bin
+ * (m - 2) * 8 + the next three bits, so each bin spans 1/8 of its
+ * octave. Samples of 2^24 us (about 16.8 s) or more go to the last bin.
+ * Use e32_histogram_percentile() to read it.
+ */
+typedef struct {
+    uint32_t count;             /**< Samples recorded */
+    uint32_t max;               /**< Largest sample, us */
+    uint32_t bins[E32_HIST_BINS];
+} e32_histogram_t;
+
+/**
+ * @brief Counters of one PGN
+ */
+typedef struct {
+    uint32_t pgn;
+    uint32_t messages;          /**< Messages with a subscriber or tracked signal */
+    uint32_t gated;             /**< Held back by delivery options */
+    uint32_t handler_calls;     /**< Handler invocations */
+    uint32_t decode_errors;     /**< Messages that failed to decode */
+    uint32_t handler_max_us;    /**< Longest handler run for one message */
+} e32_pgn_stats_t;
+
+/**
+ * @brief Client statistics (see e32_j1939_get_stats())
+ *
+ * Counters start at e32_j1939_create() or e32_j1939_reset_stats() and
+ * wrap at 2^32. Latency runs from the moment a frame entered the SDK
+ * (e32_j1939_rx_push_isr() or the backend read in poll) to the start of
+ * its handlers, so it covers receive ring and worker queue waits; it is
+ * not recorded for frames passed to e32_j1939_dispatch_frame() directly.
+ */
+typedef struct {
+    uint32_t frames;            /**< Frames dispatched, all channels */
+    uint32_t unwanted;          /**< Frames without a subscriber or tracked signal */
+    uint32_t gated;             /**< Messages held back by delivery options */
+    uint32_t delivered;         /**< Messages passed to handlers */
+    uint32_t handler_calls;     /**< Handler invocations */
+    uint32_t decode_errors;     /**< Messages that failed to decode (message handlers skipped) */
+    uint32_t worker_overflows;  /**< Messages dropped by full worker queues */
+    e32_rx_stats_t rx;          /**< Receive ring, as e32_j1939_get_rx_stats() */
+    e32_tx_stats_t tx;          /**< Transmit queues, as e32_j1939_get_tx_stats() */
+    e32_histogram_t latency;    /**< Receive to handler start, us */
+    e32_histogram_t handler;    /**< Handler run time per message, us */
+    uint32_t pgn_overflow;      /**< Messages of PGNs that found no free row */
+    uint16_t pgn_count;         /**< Rows used in pgns[] */
+    e32_pgn_stats_t pgns[E32_CFG_STATS_PGNS];
+} e32_stats_t;
+
 
 /* ==========================================================================
  * ERROR CODES
@@ -228,10 +856,81 @@ typedef enum {
     E32_ERR_TRANSPORT = -4,         /**< Transport error */
     E32_ERR_NO_MEMORY = -5,         /**< Out of memory */
     E32_ERR_TIMEOUT = -6,           /**< Operation timed out */
-    E32_ERR_NOT_SUPPORTED = -7      /**< Not supported on this platform */
+    E32_ERR_NOT_SUPPORTED = -7,     /**< Not supported on this platform */
+    E32_ERR_NOT_FOUND = -8,         /**< Requested item does not exist */
+    E32_ERR_BUSY = -9,              /**< Resource in use, retry later */
+    E32_ERR_IO = -10,               /**< File or device I/O error */
+    E32_ERR_CANCELLED = -11,        /**< Superseded or cancelled before completion */
+    E32_ERR_NO_ADDRESS = -12        /**< Source address lost, or still being claimed */
 } e32_error_t;
 
 
+/* ==========================================================================
+ * TRANSMIT COMPLETION
+ * ========================================================================== */
+
+/**
+ * @brief Transmit completion callback
+ *
+ * Called from e32_j1939_poll() or the sending call once a queued frame
+ * has been handed to the backend (E32_OK), replaced by a newer frame
+ * (E32_ERR_CANCELLED), dropped on disconnect (E32_ERR_NOT_CONNECTED) or
+ * rejected by the backend (its error code).
+ *
+ * @param frame The frame (valid during the call only)
+ * @param status Outcome
+ * @param user_data User-provided context pointer
+ */
+typedef void (*e32_tx_done_t)(const e32_can_frame_t* frame, e32_error_t status, void* user_data);
+
+/** Send flag: replace a still-queued frame with the same CAN identifier */
+#define E32_TX_COALESCE     0x01
+
+/**
+ * @brief Payload provider for a cyclic PGN
+ *
+ * Called when the PGN is due. Fill data (up to 8 bytes, or up to 64 in
+ * E32_CFG_CAN_FD builds for a client with config.can_fd) and set *len,
+ * which starts out at the length of the previous transmission (8 for
+ * the first). Payloads over 8 bytes go out as one CAN FD frame with
+ * BRS, padded to the next FD length.
+ *
+ * @param pgn The PGN being sent
+ * @param data Payload buffer, keeps the previous contents
+ * @param len Payload length in/out (1-8, 1-64 with CAN FD); a length
+ *            the client cannot send skips the cycle
+ * @param user_data User-provided context pointer
+ * @return false to skip this cycle
+ */
+typedef bool (*e32_cyclic_provider_t)(uint32_t pgn, uint8_t* data, uint8_t* len, void* user_data);
+
+/** Default wait for a response (J1939-21 T3), ms */
+#define E32_REQUEST_TIMEOUT_MS  1250
+
+/**
+ * @brief Request completion callback
+ *
+ * Called from e32_j1939_poll() once per request to one destination:
+ * - E32_OK with the response, a single frame or a reassembled
+ *   multi-packet message (borrowed: valid during the call only)
+ * - E32_OK with the Acknowledgment frame if the destination sent a
+ *   positive ACK instead of data
+ * - E32_ERR_NOT_SUPPORTED (NACK or Access Denied) or E32_ERR_BUSY
+ *   (Cannot Respond) with the Acknowledgment frame
+ * - E32_ERR_TIMEOUT with response NULL when nothing came back in time
+ * - E32_ERR_NOT_CONNECTED on disconnect, or the send error, with NULL
+ *
+ * Requests to E32_SA_GLOBAL collect: every response is delivered with
+ * E32_OK, and the end of the timeout is reported with E32_ERR_TIMEOUT.
+ *
+ * @param status Outcome
+ * @param response The response, or NULL
+ * @param user_data User-provided context pointer
+ */
+typedef void (*e32_response_fn_t)(e32_error_t status, const e32_j1939_view_t* response,
+                                  void* user_data);
+
+
 #ifdef __cplusplus
 }
 #endif
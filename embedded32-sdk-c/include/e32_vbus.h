@@ -0,0 +1,174 @@
+/**
+ * @file e32_vbus.h
+ * @brief Embedded32 SDK - In-Process Virtual CAN Bus
+ *
+ * Connects several clients in one process without CAN hardware, for
+ * load tests and deterministic replay. A bus is created under a name;
+ * clients connect to it with transport E32_TRANSPORT_VIRTUAL and that
+ * name as interface (or as one of their channels). Each attached
+ * channel owns a pair of lock-free rings: frames it sends wait in one
+ * until the bus arbitrates them, frames it receives are delivered into
+ * the other.
+ *
+ * The bus emulates a real one: among the frames waiting on every node
+ * the lowest identifier wins arbitration, each frame occupies the bus
+ * for its bit time at config.bitrate (stuff bits and interframe space
+ * included), and a sender never receives its own frames. Faults are
+ * drawn from a seeded generator, so a run with the same seed, clock
+ * mode and traffic repeats exactly:
+ * - drops: a receiver misses a frame the others got
+ * - error frames: a transmission is destroyed and retried
+ * - bursts: several transmissions in a row are destroyed
+ *
+ * The bus only moves when it is called: on every send and receive of an
+ * attached channel, on e32_vbus_inject() and on e32_vbus_advance(). In
+ * E32_VBUS_CLOCK_WALL mode a client sleeping in e32_j1939_wait() is
+ * therefore only woken once some other node or the application moves
+ * the bus.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_VBUS_H
+#define E32_VBUS_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief How bus time passes
+ */
+typedef enum {
+    /**
+     * Virtual time that jumps ahead as far as there is traffic: frames
+     * are delivered as fast as the receivers drain them, and a full
+     * receive ring holds the bus instead of losing frames. Timestamps
+     * still carry the emulated bus time. For throughput tests.
+     */
+    E32_VBUS_CLOCK_FREE = 0,
+
+    /** Bus time follows e32_time_us(), as on a real bus */
+    E32_VBUS_CLOCK_WALL,
+
+    /** Bus time only moves with e32_vbus_advance(): fully deterministic */
+    E32_VBUS_CLOCK_MANUAL
+} e32_vbus_clock_t;
+
+/**
+ * @brief Virtual bus configuration
+ */
+typedef struct {
+    const char*      name;          /**< Interface name clients connect to, e.g. "vcan0" */
+    e32_vbus_clock_t clock;         /**< Bus time mode */
+    uint32_t         bitrate;       /**< Bit rate to emulate (0 = frames take no bus time) */
+    uint32_t         data_bitrate;  /**< CAN FD data phase bit rate (0 = 2000000) */
+    e32_stuffing_t   stuffing;      /**< Stuff bits counted in a frame's bus time (WORST is much cheaper than EXACT) */
+    uint32_t         epoch_ms;      /**< Timestamp of bus time 0 (E32_VBUS_CLOCK_WALL: e32_time_ms() at create) */
+    uint32_t         seed;          /**< Fault generator seed (0 = 1) */
+    uint32_t         drop_ppm;      /**< Chance per frame and receiver that the receiver misses it */
+    uint32_t         error_ppm;     /**< Chance per transmission of an error frame */
+    uint32_t         burst_ppm;     /**< Chance per transmission that an error burst starts */
+    uint16_t         burst_length;  /**< Transmissions a burst destroys */
+} e32_vbus_config_t;
+
+/**
+ * @brief Virtual bus statistics
+ */
+typedef struct {
+    uint32_t frames;            /**< Frames completed on the bus */
+    uint32_t arbitration_lost;  /**< Waiting frames that lost an arbitration */
+    uint32_t error_frames;      /**< Transmissions destroyed (error_ppm and bursts) */
+    uint32_t dropped;           /**< Deliveries suppressed by drop_ppm */
+    uint32_t overflows;         /**< Deliveries lost to a full receive ring */
+    uint32_t injected;          /**< Frames taken by e32_vbus_inject() */
+    uint32_t replayed;          /**< Capture records put on the bus */
+    uint32_t replay_pending;    /**< Capture records still to replay */
+    uint8_t  nodes;             /**< Channels attached */
+    uint64_t time_us;           /**< Bus time */
+    uint64_t busy_us;           /**< Bus time spent carrying frames and error frames */
+} e32_vbus_stats_t;
+
+/**
+ * @brief Virtual bus handle (opaque)
+ */
+typedef struct e32_vbus e32_vbus_t;
+
+/**
+ * @brief Create a virtual bus and make it reachable by name
+ *
+ * @param config Bus configuration (copied; name must stay valid)
+ * @param bus Receives the handle
+ * @return E32_OK, E32_ERR_INVALID_PARAM without a name or with a
+ *         certain error frame (error_ppm or burst_ppm of 1000000),
+ *         E32_ERR_BUSY if a bus of that name exists, E32_ERR_NO_MEMORY
+ *         when E32_CFG_VBUS_MAX buses exist or allocation fails
+ *
+ * @example
+ * @code
+ * e32_vbus_config_t vcfg = { .name = "vcan0", .bitrate = 500000 };
+ * e32_vbus_t* bus;
+ * e32_vbus_create(&vcfg, &bus);
+ *
+ * e32_j1939_config_t config = { .interface_name = "vcan0", .source_address = 0x80,
+ *                               .transport = E32_TRANSPORT_VIRTUAL };
+ * @endcode
+ */
+e32_error_t e32_vbus_create(const e32_vbus_config_t* config, e32_vbus_t** bus);
+
+/**
+ * @brief Remove the bus
+ *
+ * Disconnect every client attached to it first.
+ */
+void e32_vbus_destroy(e32_vbus_t* bus);
+
+/**
+ * @brief Put frames on the bus as if another node sent them
+ *
+ * The frames wait for arbitration like any node's. Receivers see them
+ * as sent; timestamps are replaced with bus time.
+ *
+ * @return Frames accepted (fewer than count while the injection ring
+ *         is full), or E32_ERR_INVALID_PARAM
+ */
+int e32_vbus_inject(e32_vbus_t* bus, const e32_can_frame_t* frames, int count);
+
+/**
+ * @brief Move the bus
+ *
+ * With E32_VBUS_CLOCK_MANUAL bus time moves on by us and every frame
+ * that completes by then is delivered. The other modes ignore us and
+ * catch up to the present.
+ */
+e32_error_t e32_vbus_advance(e32_vbus_t* bus, uint32_t us);
+
+/**
+ * @brief Replay a capture file onto the bus
+ *
+ * Records go through the injection ring, so they arbitrate against the
+ * clients' traffic. speed_pct 100 keeps the recorded spacing on the
+ * bus clock, 200 halves it, 0 sends them back to back as fast as the
+ * bus takes them. A replay still running is replaced.
+ *
+ * @return E32_OK, or the error of e32_capture_reader_open()
+ */
+e32_error_t e32_vbus_replay(e32_vbus_t* bus, const char* path, uint32_t speed_pct);
+
+/**
+ * @brief Current bus time in microseconds
+ */
+uint64_t e32_vbus_time_us(e32_vbus_t* bus);
+
+/**
+ * @brief Read the bus statistics
+ */
+e32_error_t e32_vbus_get_stats(e32_vbus_t* bus, e32_vbus_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_VBUS_H */
@@ -19,6 +19,12 @@
 /* Codec utilities */
 #include "e32_codec.h"
 
+/* Capture file recording and replay */
+#include "e32_capture.h"
+
+/* In-process virtual CAN bus */
+#include "e32_vbus.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,6 +46,28 @@ e32_error_t e32_init(void);
  */
 void e32_deinit(void);
 
+/**
+ * @brief Default monotonic millisecond clock
+ * 
+ * Used for protocol timers when e32_j1939_config_t.clock_ms is NULL.
+ * Available on POSIX and Windows hosts; on bare-metal targets it returns
+ * 0, so set clock_ms (e.g. to a HAL tick function) there.
+ * 
+ * @return Milliseconds since an arbitrary start point (wraps)
+ */
+uint32_t e32_time_ms(void);
+
+/**
+ * @brief Default monotonic microsecond clock
+ * 
+ * Timestamps statistics samples when e32_j1939_config_t.clock_us is
+ * NULL. Returns 0 on bare-metal targets, where clock_us should point at
+ * a free-running timer readable from interrupt context.
+ * 
+ * @return Microseconds since an arbitrary start point (wraps)
+ */
+uint32_t e32_time_us(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,241 @@
+/**
+ * @file e32_address.c
+ * @brief Embedded32 SDK - Address Claim and NAME Table Implementation
+ *
+ * The NAME index is linear-probed with backward-shift deletion, so it
+ * never fills with tombstones however often nodes come and go.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_address.h"
+#include <string.h>
+
+#define SLOT_MASK       (E32_NAMES_SLOTS - 1)
+
+/* Range arbitrary-address capable nodes pick from (J1939 self-configurable addresses) */
+#define DYNAMIC_FIRST   128
+#define DYNAMIC_LAST    247
+
+/* Cannot Claim goes out after a pseudo-random 0-153 ms, so lost nodes do not collide */
+#define CANNOT_CLAIM_SPREAD 154
+
+static uint32_t home_slot(uint64_t name)
+{
+    return (uint32_t)((name * 0x9E3779B97F4A7C15ull) >> 55) & SLOT_MASK;
+}
+
+static bool is_present(const e32_names_t* names, uint8_t sa)
+{
+    return (names->present[sa >> 5] >> (sa & 31)) & 1u;
+}
+
+/* Index slot of name, or SLOT_MASK + 1 if it holds no address */
+static uint32_t find_slot(const e32_names_t* names, uint64_t name)
+{
+    for (uint32_t i = home_slot(name); ; i = (i + 1) & SLOT_MASK) {
+        uint8_t sa = names->slots[i];
+        if (sa == E32_NAMES_EMPTY) {
+            return SLOT_MASK + 1;
+        }
+        if (names->name[sa] == name) {
+            return i;
+        }
+    }
+}
+
+static void remove_address(e32_names_t* names, uint8_t sa)
+{
+    uint32_t i = find_slot(names, names->name[sa]);
+
+    /* Pull later entries of the probe run back over the hole */
+    for (uint32_t j = (i + 1) & SLOT_MASK; names->slots[j] != E32_NAMES_EMPTY; j = (j + 1) & SLOT_MASK) {
+        uint32_t home = home_slot(names->name[names->slots[j]]);
+        if (((j - home) & SLOT_MASK) >= ((j - i) & SLOT_MASK)) {
+            names->slots[i] = names->slots[j];
+            i = j;
+        }
+    }
+    names->slots[i] = E32_NAMES_EMPTY;
+
+    names->present[sa >> 5] &= ~(1u << (sa & 31));
+    names->name[sa] = 0;
+    names->count--;
+}
+
+void e32_names_init(e32_names_t* names)
+{
+    memset(names, 0, sizeof(*names));
+    memset(names->slots, E32_NAMES_EMPTY, sizeof(names->slots));
+}
+
+void e32_names_claimed(e32_names_t* names, uint8_t sa, uint64_t name)
+{
+    uint32_t slot = find_slot(names, name);
+    if (slot <= SLOT_MASK) {
+        if (names->slots[slot] == sa) {
+            return;                         /* Repeated claim: nothing moves */
+        }
+        remove_address(names, names->slots[slot]);
+    }
+
+    if (sa >= E32_NAMES_ADDRESSES) {
+        return;                             /* Cannot Claim, or a bogus global claim */
+    }
+    if (is_present(names, sa)) {
+        remove_address(names, sa);          /* Someone else lost sa to this NAME */
+    }
+
+    uint32_t i = home_slot(name);
+    while (names->slots[i] != E32_NAMES_EMPTY) {
+        i = (i + 1) & SLOT_MASK;
+    }
+    names->slots[i] = sa;
+    names->name[sa] = name;
+    names->present[sa >> 5] |= 1u << (sa & 31);
+    names->count++;
+}
+
+bool e32_names_name_of(const e32_names_t* names, uint8_t sa, uint64_t* name)
+{
+    if (sa >= E32_NAMES_ADDRESSES || !is_present(names, sa)) {
+        return false;
+    }
+    *name = names->name[sa];
+    return true;
+}
+
+uint8_t e32_names_address_of(const e32_names_t* names, uint64_t name)
+{
+    uint32_t slot = find_slot(names, name);
+    return (slot <= SLOT_MASK) ? names->slots[slot] : E32_SA_NULL;
+}
+
+/* ==========================================================================
+ * ADDRESS CLAIM
+ * ========================================================================== */
+
+static uint32_t cannot_claim_delay(const e32_claim_t* claim, uint32_t now)
+{
+    return (uint32_t)((claim->name ^ (claim->name >> 32) ^ now) % CANNOT_CLAIM_SPREAD);
+}
+
+/* A new claim frame is due at the given time, on every bus again */
+static void schedule(e32_claim_t* claim, uint32_t at)
+{
+    claim->pending = true;
+    claim->send_at = at;
+    claim->sent_on = 0;
+}
+
+static void give_up(e32_claim_t* claim, uint32_t now)
+{
+    claim->state = E32_ADDRESS_LOST;
+    claim->address = E32_SA_NULL;
+    schedule(claim, now + cannot_claim_delay(claim, now));
+}
+
+static void claim_address(e32_claim_t* claim, uint8_t address, uint32_t now)
+{
+    claim->state = E32_ADDRESS_CLAIMING;
+    claim->address = address;
+    schedule(claim, now);
+    claim->deadline = now + E32_CLAIM_WINDOW_MS;
+}
+
+void e32_claim_init(e32_claim_t* claim)
+{
+    memset(claim, 0, sizeof(*claim));
+    claim->state = E32_ADDRESS_NONE;
+    claim->next_try = DYNAMIC_FIRST;
+}
+
+void e32_claim_start(e32_claim_t* claim, uint64_t name, uint8_t address, uint32_t now)
+{
+    e32_claim_init(claim);
+    claim->name = name;
+    claim_address(claim, address, now);
+}
+
+bool e32_claim_contend(e32_claim_t* claim, uint8_t sa, uint64_t name,
+                       bool (*in_use)(void* ctx, uint8_t sa), void* ctx, uint32_t now)
+{
+    if (claim->state == E32_ADDRESS_NONE || claim->state == E32_ADDRESS_LOST ||
+        sa != claim->address || name == claim->name) {
+        return false;
+    }
+
+    if (claim->name < name) {
+        /* Lower NAME wins: repeat our claim so the other node moves */
+        schedule(claim, now);
+        return false;
+    }
+
+    if (claim->name & E32_NAME_ARBITRARY_ADDRESS) {
+        uint32_t span = DYNAMIC_LAST - DYNAMIC_FIRST + 1;
+        for (uint32_t k = 0; k < span; k++) {
+            uint8_t a = (uint8_t)(DYNAMIC_FIRST + (claim->next_try - DYNAMIC_FIRST + k) % span);
+            if (a != sa && !in_use(ctx, a)) {
+                claim->next_try = (uint8_t)(DYNAMIC_FIRST + (a - DYNAMIC_FIRST + 1) % span);
+                claim_address(claim, a, now);
+                return true;
+            }
+        }
+    }
+
+    give_up(claim, now);
+    return true;
+}
+
+void e32_claim_requested(e32_claim_t* claim, uint32_t now)
+{
+    if (claim->state == E32_ADDRESS_NONE || claim->pending) {
+        return;
+    }
+    schedule(claim, (claim->state == E32_ADDRESS_LOST) ? now + cannot_claim_delay(claim, now) : now);
+}
+
+void e32_claim_sent(e32_claim_t* claim, uint32_t now)
+{
+    claim->pending = false;
+    claim->sent_on = 0;
+    if (claim->state == E32_ADDRESS_CLAIMING) {
+        claim->deadline = now + E32_CLAIM_WINDOW_MS;
+    }
+}
+
+bool e32_claim_poll(e32_claim_t* claim, uint32_t now)
+{
+    if (claim->state != E32_ADDRESS_CLAIMING || claim->pending ||
+        (int32_t)(now - claim->deadline) < 0) {
+        return false;
+    }
+    claim->state = E32_ADDRESS_CLAIMED;
+    return true;
+}
+
+uint32_t e32_claim_next_timeout(const e32_claim_t* claim, uint32_t now)
+{
+    uint32_t at;
+    if (claim->pending) {
+        at = claim->send_at;
+    } else if (claim->state == E32_ADDRESS_CLAIMING) {
+        at = claim->deadline;
+    } else {
+        return UINT32_MAX;
+    }
+    return ((int32_t)(at - now) > 0) ? at - now : 0;
+}
+
+bool e32_claim_may_send(const e32_claim_t* claim)
+{
+    switch (claim->state) {
+        case E32_ADDRESS_NONE:
+        case E32_ADDRESS_CLAIMED:
+            return true;
+        case E32_ADDRESS_CLAIMING:
+            return claim->address < DYNAMIC_FIRST || claim->address > DYNAMIC_LAST;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ * @file e32_address.h
+ * @brief Embedded32 SDK - Address Claim and NAME Table (internal)
+ *
+ * J1939-81 network management. The claim state machine decides what
+ * this client transmits (Address Claimed, or Cannot Claim from the null
+ * address) and when its address may be used; the client does the I/O.
+ * It never blocks: the 250 ms contention window runs out in poll.
+ *
+ * The NAME table maps both ways between the source addresses of one
+ * bus and the NAMEs that claimed them. It is updated from every
+ * Address Claimed frame seen, so SA -> NAME is an array read and
+ * NAME -> SA one probe of a small open-addressed index in the common
+ * case.
+ *
+ * All functions run on the polling thread.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_ADDRESS_H
+#define E32_ADDRESS_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Claimable source addresses, 0x00-0xFD */
+#define E32_NAMES_ADDRESSES     254
+
+/** NAME index slots: power of two, at most half full */
+#define E32_NAMES_SLOTS         512
+
+/** Empty NAME index slot */
+#define E32_NAMES_EMPTY         0xFF
+
+/** Contention window after an Address Claimed, ms */
+#define E32_CLAIM_WINDOW_MS     250
+
+/**
+ * @brief Source address <-> NAME of every node on one bus
+ */
+typedef struct {
+    uint64_t name[E32_NAMES_ADDRESSES];
+    uint32_t present[(E32_NAMES_ADDRESSES + 31) / 32];  /**< Bit per address with a NAME */
+    uint8_t  slots[E32_NAMES_SLOTS];                    /**< Addresses by NAME hash */
+    uint16_t count;
+} e32_names_t;
+
+/**
+ * @brief Forget every node
+ */
+void e32_names_init(e32_names_t* names);
+
+/**
+ * @brief Account an Address Claimed frame from sa
+ *
+ * The NAME moves to sa and whatever NAME held sa before is dropped.
+ * sa == E32_SA_NULL (Cannot Claim) removes the NAME.
+ */
+void e32_names_claimed(e32_names_t* names, uint8_t sa, uint64_t name);
+
+/**
+ * @brief NAME that claimed sa
+ *
+ * @return true if sa is claimed
+ */
+bool e32_names_name_of(const e32_names_t* names, uint8_t sa, uint64_t* name);
+
+/**
+ * @brief Address claimed by name
+ *
+ * @return The address, or E32_SA_NULL if name holds none
+ */
+uint8_t e32_names_address_of(const e32_names_t* names, uint64_t name);
+
+/**
+ * @brief Address claim state of this client
+ */
+typedef struct {
+    uint64_t name;
+    uint8_t  state;         /**< e32_address_state_t */
+    uint8_t  address;       /**< Address held or being claimed, E32_SA_NULL once lost */
+    uint8_t  next_try;      /**< Next address an arbitrary-address node tries, 128-247 */
+    bool     pending;       /**< Address Claimed / Cannot Claim still to send */
+    uint16_t sent_on;       /**< Bit per channel the pending frame already went out on */
+    uint32_t send_at;       /**< Earliest time for it (Cannot Claim is delayed), ms */
+    uint32_t deadline;      /**< End of the contention window while claiming, ms */
+} e32_claim_t;
+
+/**
+ * @brief Nothing claimed: the configured address is used as is
+ */
+void e32_claim_init(e32_claim_t* claim);
+
+/**
+ * @brief Start claiming address for name
+ */
+void e32_claim_start(e32_claim_t* claim, uint64_t name, uint8_t address, uint32_t now);
+
+/**
+ * @brief Another node claimed sa
+ *
+ * Defends our address against a lower-priority NAME (our claim is sent
+ * again), gives it up to a higher-priority one: arbitrary-address
+ * capable NAMEs move to the next address in_use() reports free, others
+ * go to E32_ADDRESS_LOST and announce Cannot Claim.
+ *
+ * @param in_use Whether any bus has a node at an address
+ * @return true if our address changed
+ */
+bool e32_claim_contend(e32_claim_t* claim, uint8_t sa, uint64_t name,
+                       bool (*in_use)(void* ctx, uint8_t sa), void* ctx, uint32_t now);
+
+/**
+ * @brief A Request for Address Claimed reached us: answer it
+ */
+void e32_claim_requested(e32_claim_t* claim, uint32_t now);
+
+/**
+ * @brief The pending claim frame is due
+ */
+static inline bool e32_claim_due(const e32_claim_t* claim, uint32_t now)
+{
+    return claim->pending && (int32_t)(now - claim->send_at) >= 0;
+}
+
+/**
+ * @brief The pending claim frame went out on every bus
+ *
+ * Until then the client records each bus it reached in sent_on, so a
+ * full transmit queue on one bus does not repeat the frame on others.
+ */
+void e32_claim_sent(e32_claim_t* claim, uint32_t now);
+
+/**
+ * @brief End the contention window when it has run out
+ *
+ * @return true if the state changed (to E32_ADDRESS_CLAIMED)
+ */
+bool e32_claim_poll(e32_claim_t* claim, uint32_t now);
+
+/**
+ * @brief Milliseconds until e32_claim_poll() or a pending frame needs attention
+ *
+ * @return UINT32_MAX when nothing is scheduled
+ */
+uint32_t e32_claim_next_timeout(const e32_claim_t* claim, uint32_t now);
+
+/**
+ * @brief Whether ordinary traffic may be sent from claim->address
+ *
+ * J1939-81: addresses 0-127 and 248-253 may be used as soon as they are
+ * claimed, the others after the contention window.
+ */
+bool e32_claim_may_send(const e32_claim_t* claim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_ADDRESS_H */
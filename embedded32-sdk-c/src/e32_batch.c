@@ -0,0 +1,339 @@
+/**
+ * @file e32_batch.c
+ * @brief Embedded32 SDK - Batch Frame Decoder
+ *
+ * Columnar decoding of large frame arrays. Frames are processed in
+ * chunks: identifiers of a chunk are parsed with SIMD into local header
+ * columns, then each frame is routed to the columns of its PGN group.
+ * Because the payload is exactly 8 bytes, every SPN is one shift and
+ * mask of a single 64-bit load, regardless of its byte alignment.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_codec.h"
+#include "e32_pgn_defs.h"
+#include <string.h>
+
+#if defined(E32_CFG_NO_SIMD)
+/* Scalar paths only */
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define E32_BATCH_SSE2  1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define E32_BATCH_NEON  1
+#endif
+
+/** Frames whose headers are parsed per vector pass */
+#define BATCH_CHUNK     64
+
+/** Marks an unused PGN slot; never equal to a parsed 18-bit PGN */
+#define PGN_SLOT_FREE   E32_PGN_ANY
+
+/* ==========================================================================
+ * IDENTIFIER PARSING
+ * ========================================================================== */
+
+typedef struct {
+    uint32_t pgn[BATCH_CHUNK];
+    uint8_t  sa[BATCH_CHUNK];
+    uint8_t  da[BATCH_CHUNK];
+    uint8_t  priority[BATCH_CHUNK];
+} chunk_headers_t;
+
+/* Same field rules as e32_parse_j1939_id(), four identifiers at a time */
+static void parse_ids(const e32_can_frame_t* in, size_t n, chunk_headers_t* out)
+{
+    size_t i = 0;
+
+#if defined(E32_BATCH_SSE2)
+    const __m128i ff = _mm_set1_epi32(0xFF);
+    const __m128i page_pf = _mm_set1_epi32(0x3FF);
+    const __m128i seven = _mm_set1_epi32(7);
+    const __m128i pdu2_pf = _mm_set1_epi32(240);
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i id = _mm_set_epi32((int)in[i + 3].id, (int)in[i + 2].id,
+                                   (int)in[i + 1].id, (int)in[i].id);
+        __m128i sa = _mm_and_si128(id, ff);
+        __m128i ps = _mm_and_si128(_mm_srli_epi32(id, 8), ff);
+        __m128i dp_pf = _mm_and_si128(_mm_srli_epi32(id, 16), page_pf);
+        __m128i pf = _mm_and_si128(dp_pf, ff);
+        __m128i pr = _mm_and_si128(_mm_srli_epi32(id, 26), seven);
+        __m128i pdu1 = _mm_cmplt_epi32(pf, pdu2_pf);
+
+        /* PDU1: PS is the destination; PDU2: PS is part of the PGN */
+        __m128i pgn = _mm_or_si128(_mm_slli_epi32(dp_pf, 8), _mm_andnot_si128(pdu1, ps));
+        __m128i da = _mm_or_si128(_mm_and_si128(pdu1, ps), _mm_andnot_si128(pdu1, ff));
+
+        _mm_storeu_si128((__m128i*)&out->pgn[i], pgn);
+
+        /* Narrow 32-bit lanes to bytes: all values are 0..255 */
+        int32_t sa8 = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(sa, sa), sa));
+        int32_t da8 = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(da, da), da));
+        int32_t pr8 = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(pr, pr), pr));
+        memcpy(&out->sa[i], &sa8, 4);
+        memcpy(&out->da[i], &da8, 4);
+        memcpy(&out->priority[i], &pr8, 4);
+    }
+#elif defined(E32_BATCH_NEON)
+    const uint32x4_t ff = vdupq_n_u32(0xFF);
+    const uint32x4_t page_pf = vdupq_n_u32(0x3FF);
+    const uint32x4_t seven = vdupq_n_u32(7);
+    const uint32x4_t pdu2_pf = vdupq_n_u32(240);
+
+    for (; i + 4 <= n; i += 4) {
+        const uint32_t ids[4] = { in[i].id, in[i + 1].id, in[i + 2].id, in[i + 3].id };
+        uint32x4_t id = vld1q_u32(ids);
+        uint32x4_t sa = vandq_u32(id, ff);
+        uint32x4_t ps = vandq_u32(vshrq_n_u32(id, 8), ff);
+        uint32x4_t dp_pf = vandq_u32(vshrq_n_u32(id, 16), page_pf);
+        uint32x4_t pf = vandq_u32(dp_pf, ff);
+        uint32x4_t pr = vandq_u32(vshrq_n_u32(id, 26), seven);
+        uint32x4_t pdu1 = vcltq_u32(pf, pdu2_pf);
+
+        uint32x4_t pgn = vorrq_u32(vshlq_n_u32(dp_pf, 8), vbicq_u32(ps, pdu1));
+        uint32x4_t da = vbslq_u32(pdu1, ps, ff);
+
+        vst1q_u32(&out->pgn[i], pgn);
+
+        uint8x8_t sa8 = vmovn_u16(vcombine_u16(vmovn_u32(sa), vmovn_u32(sa)));
+        uint8x8_t da8 = vmovn_u16(vcombine_u16(vmovn_u32(da), vmovn_u32(da)));
+        uint8x8_t pr8 = vmovn_u16(vcombine_u16(vmovn_u32(pr), vmovn_u32(pr)));
+        uint8_t tmp[8];
+        vst1_u8(tmp, sa8); memcpy(&out->sa[i], tmp, 4);
+        vst1_u8(tmp, da8); memcpy(&out->da[i], tmp, 4);
+        vst1_u8(tmp, pr8); memcpy(&out->priority[i], tmp, 4);
+    }
+#endif
+
+    /* Branch-free like e32_parse_j1939_id(), so compilers can vectorise it too */
+    for (; i < n; i++) {
+        uint32_t id = in[i].id;
+        uint32_t pdu2_mask = e32_j1939_pdu2_mask(id);
+        out->pgn[i] = (id >> 8) & (0x3FF00u | pdu2_mask);
+        out->sa[i] = (uint8_t)id;
+        out->da[i] = (uint8_t)(((id >> 8) & 0xFF) | pdu2_mask);
+        out->priority[i] = (uint8_t)((id >> 26) & 0x07);
+    }
+}
+
+/* ==========================================================================
+ * PGN ROUTING
+ * ========================================================================== */
+
+static int find_group(const e32_batch_plan_t* plan, uint32_t pgn)
+{
+#if defined(E32_BATCH_SSE2)
+    const __m128i key = _mm_set1_epi32((int)pgn);
+    for (int g = 0; g < plan->pgn_count; g += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&plan->pgns[g]);
+        int hits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, key)));
+        if (hits) {
+            for (int k = 0; k < 4; k++) {
+                if (hits & (1 << k)) return g + k;
+            }
+        }
+    }
+    return -1;
+#elif defined(E32_BATCH_NEON)
+    const uint32x4_t key = vdupq_n_u32(pgn);
+    for (int g = 0; g < plan->pgn_count; g += 4) {
+        uint32x4_t eq = vceqq_u32(vld1q_u32(&plan->pgns[g]), key);
+        uint32_t lanes[4];
+        vst1q_u32(lanes, eq);
+        for (int k = 0; k < 4; k++) {
+            if (lanes[k]) return g + k;
+        }
+    }
+    return -1;
+#else
+    for (int g = 0; g < plan->pgn_count; g++) {
+        if (plan->pgns[g] == pgn) return g;
+    }
+    return -1;
+#endif
+}
+
+/* ==========================================================================
+ * FIELD EXTRACTION
+ * ========================================================================== */
+
+static inline uint64_t load_le64(const uint8_t* p)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+#else
+    uint64_t w = 0;
+    for (int i = 7; i >= 0; i--) {
+        w = (w << 8) | p[i];
+    }
+    return w;
+#endif
+}
+
+static size_t append_group(const e32_batch_plan_t* plan, int g, const e32_can_frame_t* frame, uint8_t sa)
+{
+    size_t appended = 0;
+    uint64_t word = load_le64(frame->data);
+    uint32_t bits = (uint32_t)(frame->dlc > E32_CAN_CLASSIC_DATA_LEN ? E32_CAN_CLASSIC_DATA_LEN : frame->dlc) * 8;
+
+    for (uint16_t k = 0; k < plan->count[g]; k++) {
+        e32_spn_column_t* col = &plan->columns[plan->order[plan->first[g] + k]];
+        const e32_spn_def_t* def = (const e32_spn_def_t*)col->def;
+
+        if ((uint32_t)(def->start_bit + def->bit_length) > bits) {
+            continue;   /* Field not present in this frame */
+        }
+        if (col->count >= col->capacity) {
+            col->dropped++;
+            continue;
+        }
+
+        uint32_t raw = (uint32_t)((word >> def->start_bit) & ((1ull << def->bit_length) - 1));
+        e32_spn_t spn;
+        e32_spn_from_raw(def, raw, &spn);
+
+        col->timestamps[col->count] = frame->timestamp;
+        col->values[col->count] = spn.value;
+        if (col->source_addresses) {
+            col->source_addresses[col->count] = sa;
+        }
+        col->count++;
+        appended++;
+    }
+
+    return appended;
+}
+
+/* ==========================================================================
+ * PUBLIC API
+ * ========================================================================== */
+
+e32_error_t e32_spn_column_init(
+    e32_spn_column_t* column,
+    uint32_t pgn,
+    uint32_t spn,
+    uint32_t* timestamps,
+    e32_spn_value_t* values,
+    uint8_t* source_addresses,
+    size_t capacity
+)
+{
+    if (!column || !timestamps || !values) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    const e32_spn_def_t* def = e32_find_spn_def(e32_find_pgn_def(pgn), spn);
+    if (!def) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    memset(column, 0, sizeof(*column));
+    column->pgn = pgn;
+    column->spn = spn;
+    column->name = def->name;
+    column->type = (e32_spn_type_t)def->type;
+    column->timestamps = timestamps;
+    column->values = values;
+    column->source_addresses = source_addresses;
+    column->capacity = capacity;
+    column->def = def;
+    return E32_OK;
+}
+
+e32_error_t e32_batch_plan_init(
+    e32_batch_plan_t* plan,
+    e32_spn_column_t* columns,
+    size_t column_count
+)
+{
+    if (!plan || (!columns && column_count > 0)) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    if (column_count > E32_CFG_BATCH_MAX_COLUMNS) {
+        return E32_ERR_NO_MEMORY;
+    }
+
+    memset(plan, 0, sizeof(*plan));
+    for (int g = 0; g < E32_CFG_BATCH_MAX_PGNS; g++) {
+        plan->pgns[g] = PGN_SLOT_FREE;
+    }
+    plan->columns = columns;
+    plan->column_count = (uint16_t)column_count;
+
+    /* Collect distinct PGNs */
+    for (size_t c = 0; c < column_count; c++) {
+        if (!columns[c].def) {
+            return E32_ERR_INVALID_PARAM;   /* Not set up by e32_spn_column_init() */
+        }
+        int g = find_group(plan, columns[c].pgn);
+        if (g < 0) {
+            if (plan->pgn_count >= E32_CFG_BATCH_MAX_PGNS) {
+                return E32_ERR_NO_MEMORY;
+            }
+            g = plan->pgn_count++;
+            plan->pgns[g] = columns[c].pgn;
+        }
+        plan->count[g]++;
+    }
+
+    /* Lay the column indices out group by group */
+    uint16_t next = 0;
+    for (int g = 0; g < plan->pgn_count; g++) {
+        plan->first[g] = next;
+        next += plan->count[g];
+        plan->count[g] = 0;
+    }
+    for (size_t c = 0; c < column_count; c++) {
+        int g = find_group(plan, columns[c].pgn);
+        plan->order[plan->first[g] + plan->count[g]++] = (uint16_t)c;
+    }
+
+    return E32_OK;
+}
+
+size_t e32_decode_frames(
+    const e32_can_frame_t* in,
+    size_t n,
+    e32_batch_plan_t* plan,
+    e32_frame_columns_t* headers
+)
+{
+    if (!in) {
+        return 0;
+    }
+
+    size_t appended = 0;
+    chunk_headers_t hdr;
+
+    for (size_t base = 0; base < n; base += BATCH_CHUNK) {
+        size_t m = (n - base < BATCH_CHUNK) ? n - base : BATCH_CHUNK;
+        const e32_can_frame_t* chunk = &in[base];
+
+        parse_ids(chunk, m, &hdr);
+
+        if (headers) {
+            if (headers->pgn) memcpy(&headers->pgn[base], hdr.pgn, m * sizeof(uint32_t));
+            if (headers->source_address) memcpy(&headers->source_address[base], hdr.sa, m);
+            if (headers->destination_address) memcpy(&headers->destination_address[base], hdr.da, m);
+            if (headers->priority) memcpy(&headers->priority[base], hdr.priority, m);
+        }
+
+        if (!plan || plan->pgn_count == 0) {
+            continue;
+        }
+
+        for (size_t j = 0; j < m; j++) {
+            int g = find_group(plan, hdr.pgn[j]);
+            if (g >= 0) {
+                appended += append_group(plan, g, &chunk[j], hdr.sa[j]);
+            }
+        }
+    }
+
+    return appended;
+}
@@ -0,0 +1,465 @@
+/**
+ * @file e32_busload.c
+ * @brief Embedded32 SDK - Bus Load Profiler Implementation
+ *
+ * Frame length follows ISO 11898-1: SOF, arbitration, control, data
+ * and CRC are subject to bit stuffing (a complement bit after five
+ * equal bits); CRC delimiter, ACK, EOF and the 3-bit interframe space
+ * are not. E32_STUFFING_EXACT serialises those fields and the CRC-15
+ * to count the stuff bits the controller really sends, at most 118
+ * bit steps per frame.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_busload.h"
+#include <string.h>
+
+#define DEFAULT_BITRATE 250000u
+#define DEFAULT_DATA_BITRATE 2000000u
+#define TAIL_BITS       13u     /* CRC delimiter, ACK slot and delimiter, EOF, IFS */
+#define PHASE_MS        (E32_CFG_BUSLOAD_SLOT_MS / E32_CFG_BUSLOAD_PHASES)
+#define CRC15_POLY      0x4599u
+
+/* ==========================================================================
+ * FRAME LENGTH
+ * ========================================================================== */
+
+typedef struct {
+    uint32_t crc;
+    uint32_t last;      /* Previous bit on the wire, 2 before SOF */
+    uint32_t run;       /* Equal bits ending with last */
+    uint32_t stuffed;
+} wire_t;
+
+static void put_wire(wire_t* w, uint32_t bit)
+{
+    if (bit == w->last) {
+        w->run++;
+    } else {
+        w->last = bit;
+        w->run = 1;
+    }
+    if (w->run == 5) {
+        /* The stuff bit starts the next run */
+        w->stuffed++;
+        w->last ^= 1;
+        w->run = 1;
+    }
+}
+
+/* Bits covered by the CRC, most significant first */
+static void put_field(wire_t* w, uint32_t value, uint32_t bits)
+{
+    while (bits--) {
+        uint32_t bit = (value >> bits) & 1;
+        uint32_t feedback = bit ^ ((w->crc >> 14) & 1);
+        w->crc = (w->crc << 1) & 0x7FFF;
+        if (feedback) {
+            w->crc ^= CRC15_POLY;
+        }
+        put_wire(w, bit);
+    }
+}
+
+static uint32_t exact_stuff_bits(const e32_can_frame_t* frame, uint32_t len)
+{
+    wire_t w = { 0, 2, 0, 0 };
+
+    put_field(&w, 0, 1);                                /* SOF */
+    if (frame->is_extended) {
+        put_field(&w, (frame->id >> 18) & 0x7FF, 11);   /* Base ID */
+        put_field(&w, 3, 2);                            /* SRR, IDE */
+        put_field(&w, frame->id & 0x3FFFF, 18);         /* ID extension */
+        put_field(&w, 0, 3);                            /* RTR, r1, r0 */
+    } else {
+        put_field(&w, frame->id & 0x7FF, 11);
+        put_field(&w, 0, 3);                            /* RTR, IDE, r0 */
+    }
+    put_field(&w, frame->dlc & 0x0F, 4);
+    for (uint32_t i = 0; i < len; i++) {
+        put_field(&w, frame->data[i], 8);
+    }
+
+    uint32_t crc = w.crc;
+    for (uint32_t i = 15; i-- > 0; ) {
+        put_wire(&w, (crc >> i) & 1);
+    }
+    return w.stuffed;
+}
+
+uint32_t e32_busload_frame_bits(const e32_can_frame_t* frame, e32_stuffing_t stuffing)
+{
+    uint32_t len = frame->dlc > E32_CAN_CLASSIC_DATA_LEN ? E32_CAN_CLASSIC_DATA_LEN : frame->dlc;
+    /* SOF through CRC: 39 or 19 header bits, data, CRC-15 */
+    uint32_t stuffable = (frame->is_extended ? 39u : 19u) + 8u * len + 15u;
+    uint32_t stuffed;
+
+    switch (stuffing) {
+    case E32_STUFFING_NONE:
+        stuffed = 0;
+        break;
+    case E32_STUFFING_WORST:
+        stuffed = (stuffable - 1) / 4;
+        break;
+    case E32_STUFFING_EXACT:
+    default:
+        stuffed = exact_stuff_bits(frame, len);
+        break;
+    }
+    return stuffable + stuffed + TAIL_BITS;
+}
+
+#ifdef E32_CFG_CAN_FD
+#define FD_TAIL_BITS    12u     /* ACK slot and delimiter, EOF, IFS */
+
+uint32_t e32_busload_fd_frame_bits(const e32_can_frame_t* frame, e32_stuffing_t stuffing,
+                                   uint32_t bitrate, uint32_t data_bitrate)
+{
+    uint32_t len = frame->dlc > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : frame->dlc;
+    uint32_t brs = (frame->flags & E32_CAN_FLAG_BRS) ? 1u : 0u;
+
+    /* SOF through BRS, then ESI, DLC and data: dynamically stuffed */
+    uint32_t arbitration = frame->is_extended ? 36u : 17u;
+    uint32_t data = 5u + 8u * len;
+    uint32_t crc = len > 16 ? 21u : 17u;
+    /* Stuff count and CRC with a fixed stuff bit every 4 bits, then the CRC delimiter */
+    uint32_t fixed = 4u + crc + 1u + (4u + crc) / 4u + 1u;
+    uint32_t arbitration_stuffed;
+    uint32_t data_stuffed;
+
+    switch (stuffing) {
+    case E32_STUFFING_NONE:
+        arbitration_stuffed = 0;
+        data_stuffed = 0;
+        break;
+    case E32_STUFFING_WORST:
+        arbitration_stuffed = (arbitration - 1) / 4;
+        data_stuffed = (arbitration + data - 1) / 4 - arbitration_stuffed;
+        break;
+    case E32_STUFFING_EXACT:
+    default: {
+        wire_t w = { 0, 2, 0, 0 };
+        put_field(&w, 0, 1);                                /* SOF */
+        if (frame->is_extended) {
+            put_field(&w, (frame->id >> 18) & 0x7FF, 11);   /* Base ID */
+            put_field(&w, 3, 2);                            /* SRR, IDE */
+            put_field(&w, frame->id & 0x3FFFF, 18);         /* ID extension */
+            put_field(&w, 0, 1);                            /* RRS */
+        } else {
+            put_field(&w, frame->id & 0x7FF, 11);
+            put_field(&w, 0, 2);                            /* RRS, IDE */
+        }
+        put_field(&w, 2 | brs, 3);                          /* FDF, res, BRS */
+        arbitration_stuffed = w.stuffed;
+        put_field(&w, (frame->flags & E32_CAN_FLAG_ESI) ? 1 : 0, 1);
+        put_field(&w, e32_can_len_to_dlc((uint8_t)len), 4);
+        for (uint32_t i = 0; i < len; i++) {
+            put_field(&w, frame->data[i], 8);
+        }
+        data_stuffed = w.stuffed - arbitration_stuffed;
+        break;
+    }
+    }
+
+    uint32_t nominal = arbitration + arbitration_stuffed + FD_TAIL_BITS;
+    uint32_t fast = data + data_stuffed + fixed;
+    if (brs && data_bitrate > bitrate) {
+        /* Round up: a partial nominal bit time is still bus time */
+        fast = (uint32_t)(((uint64_t)fast * bitrate + data_bitrate - 1) / data_bitrate);
+    }
+    return nominal + fast;
+}
+#endif
+
+/* ==========================================================================
+ * RATE ROWS
+ * ========================================================================== */
+
+static void clear_rows(e32_busload_row_t* rows, uint32_t count)
+{
+    memset(rows, 0, sizeof(*rows) * count);
+    for (uint32_t i = 0; i < count; i++) {
+        rows[i].key = E32_BUSLOAD_FREE;
+    }
+}
+
+/* Row of key among its four candidates, a free candidate, or other */
+static e32_busload_row_t* find_row(e32_busload_row_t* rows, uint32_t count,
+                                   e32_busload_row_t* other, uint32_t key)
+{
+    uint32_t mask = count - 1;
+    uint32_t home = (key ^ (key >> 8) ^ (key >> 16)) & mask;
+    uint32_t probes = count < 4 ? count : 4;
+    e32_busload_row_t* free_row = NULL;
+
+    /* Rows are released out of probe order, so look at every candidate */
+    for (uint32_t p = 0; p < probes; p++) {
+        e32_busload_row_t* row = &rows[(home + p) & mask];
+        if (row->key == key) {
+            return row;
+        }
+        if (!free_row && row->key == E32_BUSLOAD_FREE) {
+            free_row = row;
+        }
+    }
+    if (free_row) {
+        free_row->key = key;    /* Released rows are all zero */
+        return free_row;
+    }
+    return other;
+}
+
+static void count_row(e32_busload_row_t* row, uint8_t slot)
+{
+    if (row->slots[slot] != 0xFFFF) {
+        row->slots[slot]++;
+        row->total++;
+    }
+}
+
+static void expire_row(e32_busload_row_t* row, uint8_t slot, bool release)
+{
+    row->total -= row->slots[slot];
+    row->slots[slot] = 0;
+    if (release && row->total == 0) {
+        row->key = E32_BUSLOAD_FREE;
+    }
+}
+
+static void expire_rows(e32_busload_row_t* rows, uint32_t count, uint8_t slot)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        if (rows[i].key != E32_BUSLOAD_FREE) {
+            expire_row(&rows[i], slot, true);
+        }
+    }
+}
+
+/* ==========================================================================
+ * WINDOW
+ * ========================================================================== */
+
+static uint16_t permille(uint32_t bits, uint32_t bitrate, uint32_t ms)
+{
+    if (ms == 0) {
+        return 0;
+    }
+    uint64_t v = (uint64_t)bits * 1000000u / ((uint64_t)bitrate * ms);
+    return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+static void decay_phases(e32_busload_t* load)
+{
+    for (uint32_t p = 0; p < E32_CFG_BUSLOAD_PHASES; p++) {
+        load->phase_bits[p] -= load->phase_bits[p] >> 3;
+    }
+}
+
+static void next_slot(e32_busload_t* load)
+{
+    uint16_t done = permille(load->bits[load->current], load->bitrate, E32_CFG_BUSLOAD_SLOT_MS);
+    if (done > load->peak_permille) {
+        load->peak_permille = done;
+    }
+    decay_phases(load);
+
+    uint8_t slot = (uint8_t)((load->current + 1) % E32_CFG_BUSLOAD_SLOTS);
+    load->window_bits -= load->bits[slot];
+    load->window_frames -= load->frames[slot];
+    load->bits[slot] = 0;
+    load->frames[slot] = 0;
+    expire_rows(load->sources, E32_CFG_BUSLOAD_SOURCES, slot);
+    expire_rows(load->pgns, E32_CFG_BUSLOAD_PGNS, slot);
+    expire_row(&load->other_sources, slot, false);
+    expire_row(&load->other_pgns, slot, false);
+
+    load->current = slot;
+    load->slot_start += E32_CFG_BUSLOAD_SLOT_MS;
+}
+
+void e32_busload_init(e32_busload_t* load, uint32_t bitrate, uint32_t data_bitrate,
+                      e32_stuffing_t stuffing)
+{
+    memset(load, 0, sizeof(*load));
+    load->bitrate = bitrate ? bitrate : DEFAULT_BITRATE;
+#ifdef E32_CFG_CAN_FD
+    load->data_bitrate = data_bitrate ? data_bitrate : DEFAULT_DATA_BITRATE;
+#else
+    (void)data_bitrate;
+#endif
+    load->stuffing = (uint8_t)stuffing;
+    clear_rows(load->sources, E32_CFG_BUSLOAD_SOURCES);
+    clear_rows(load->pgns, E32_CFG_BUSLOAD_PGNS);
+}
+
+void e32_busload_advance(e32_busload_t* load, uint32_t now)
+{
+    if (!load->started) {
+        return;
+    }
+
+    /* A clock step backwards keeps filling the current slot */
+    int32_t ahead = (int32_t)(now - load->slot_start);
+    if (ahead < E32_CFG_BUSLOAD_SLOT_MS) {
+        return;
+    }
+
+    uint32_t slots = (uint32_t)ahead / E32_CFG_BUSLOAD_SLOT_MS;
+    if (slots <= E32_CFG_BUSLOAD_SLOTS) {
+        while (slots--) {
+            next_slot(load);
+        }
+        return;
+    }
+
+    /* Silent for longer than the window: start over, keeping the peak */
+    next_slot(load);
+    for (uint32_t i = 1; i < slots && i < 64; i++) {
+        decay_phases(load);
+    }
+    for (uint8_t s = 0; s < E32_CFG_BUSLOAD_SLOTS; s++) {
+        load->frames[s] = 0;
+        load->bits[s] = 0;
+    }
+    load->window_bits = 0;
+    load->window_frames = 0;
+    clear_rows(load->sources, E32_CFG_BUSLOAD_SOURCES);
+    clear_rows(load->pgns, E32_CFG_BUSLOAD_PGNS);
+    memset(&load->other_sources, 0, sizeof(load->other_sources));
+    memset(&load->other_pgns, 0, sizeof(load->other_pgns));
+    load->slot_start = now - now % E32_CFG_BUSLOAD_SLOT_MS;
+}
+
+bool e32_busload_add(e32_busload_t* load, const e32_can_frame_t* frame,
+                     const e32_j1939_id_t* id, uint32_t now)
+{
+    bool turned = false;
+
+    if (!load->started) {
+        load->started = true;
+        load->since = now;
+        load->slot_start = now - now % E32_CFG_BUSLOAD_SLOT_MS;
+        turned = true;
+    } else {
+        uint32_t start = load->slot_start;
+        e32_busload_advance(load, now);
+        turned = (load->slot_start != start);
+    }
+
+#ifdef E32_CFG_CAN_FD
+    uint32_t bits = (frame->flags & E32_CAN_FLAG_FD)
+                    ? e32_busload_fd_frame_bits(frame, (e32_stuffing_t)load->stuffing,
+                                                load->bitrate, load->data_bitrate)
+                    : e32_busload_frame_bits(frame, (e32_stuffing_t)load->stuffing);
+#else
+    uint32_t bits = e32_busload_frame_bits(frame, (e32_stuffing_t)load->stuffing);
+#endif
+    uint8_t slot = load->current;
+
+    load->bits[slot] += bits;
+    load->frames[slot]++;
+    load->window_bits += bits;
+    load->window_frames++;
+    load->phase_bits[(now % E32_CFG_BUSLOAD_SLOT_MS) / PHASE_MS] += bits;
+
+    /* 11-bit frames carry no J1939 address or PGN */
+    if (frame->is_extended) {
+        count_row(find_row(load->sources, E32_CFG_BUSLOAD_SOURCES, &load->other_sources,
+                           id->source_address), slot);
+        count_row(find_row(load->pgns, E32_CFG_BUSLOAD_PGNS, &load->other_pgns, id->pgn), slot);
+    } else {
+        count_row(&load->other_sources, slot);
+        count_row(&load->other_pgns, slot);
+    }
+    return turned;
+}
+
+/* ==========================================================================
+ * QUERIES
+ * ========================================================================== */
+
+/* Length of the window ending at now: the full past slots plus the current one */
+static uint32_t covered_ms(const e32_busload_t* load, uint32_t now)
+{
+    if (!load->started) {
+        return 0;
+    }
+    uint32_t in_slot = now - load->slot_start;
+    if (in_slot >= E32_CFG_BUSLOAD_SLOT_MS) {
+        in_slot = E32_CFG_BUSLOAD_SLOT_MS - 1;   /* Clock went backwards */
+    }
+    uint32_t ms = (E32_CFG_BUSLOAD_SLOTS - 1) * E32_CFG_BUSLOAD_SLOT_MS + in_slot + 1;
+    uint32_t running = now - load->since + 1;
+    return running < ms ? running : ms;
+}
+
+static uint32_t per_sec(uint32_t frames, uint32_t ms)
+{
+    return ms ? (uint32_t)((uint64_t)frames * 1000u / ms) : 0;
+}
+
+void e32_busload_get(const e32_busload_t* load, uint32_t now, e32_busload_stats_t* out)
+{
+    uint32_t ms = covered_ms(load, now);
+
+    memset(out, 0, sizeof(*out));
+    out->window_ms = ms;
+    out->frames = load->window_frames;
+    out->frames_per_sec = per_sec(load->window_frames, ms);
+    out->bits = load->window_bits;
+    out->load_permille = permille(load->window_bits, load->bitrate, ms);
+    out->peak_permille = load->peak_permille;
+    out->other_sources = load->other_sources.total;
+    out->other_pgns = load->other_pgns.total;
+
+    uint32_t quiet = 0;
+    for (uint32_t p = 1; p < E32_CFG_BUSLOAD_PHASES; p++) {
+        if (load->phase_bits[p] < load->phase_bits[quiet]) {
+            quiet = p;
+        }
+    }
+    out->quiet_permille = permille(load->phase_bits[quiet] / 8, load->bitrate, PHASE_MS);
+
+    uint32_t pos = now % E32_CFG_BUSLOAD_SLOT_MS;
+    uint32_t begin = quiet * PHASE_MS;
+    if (pos >= begin && pos < begin + PHASE_MS) {
+        out->quiet_in_ms = 0;
+    } else {
+        out->quiet_in_ms = (uint16_t)((begin + E32_CFG_BUSLOAD_SLOT_MS - pos) % E32_CFG_BUSLOAD_SLOT_MS);
+    }
+}
+
+uint16_t e32_busload_top(const e32_busload_t* load, bool pgns, uint32_t now,
+                         e32_busload_rate_t* out, uint16_t max)
+{
+    const e32_busload_row_t* rows = pgns ? load->pgns : load->sources;
+    uint32_t count = pgns ? E32_CFG_BUSLOAD_PGNS : E32_CFG_BUSLOAD_SOURCES;
+    uint32_t ms = covered_ms(load, now);
+    uint16_t n = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const e32_busload_row_t* row = &rows[i];
+        if (row->key == E32_BUSLOAD_FREE || row->total == 0) {
+            continue;
+        }
+
+        /* Insertion into the sorted output, dropping the smallest when full */
+        uint16_t at = n;
+        while (at > 0 && out[at - 1].frames < row->total) {
+            at--;
+        }
+        if (at >= max) {
+            continue;
+        }
+        uint16_t last = (n < max) ? n : (uint16_t)(max - 1);
+        memmove(&out[at + 1], &out[at], sizeof(*out) * (last - at));
+        out[at].key = row->key;
+        out[at].frames = row->total;
+        out[at].frames_per_sec = per_sec(row->total, ms);
+        if (n < max) {
+            n++;
+        }
+    }
+    return n;
+}
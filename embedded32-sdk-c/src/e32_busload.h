@@ -0,0 +1,139 @@
+/**
+ * @file e32_busload.h
+ * @brief Embedded32 SDK - Bus Load Profiler (internal)
+ *
+ * Streaming bus utilization and frame rates for one CAN channel. Time
+ * is split into E32_CFG_BUSLOAD_SLOTS slots; every counter keeps one
+ * value per slot plus a running window total, so adding a frame is a
+ * few increments and moving to the next slot subtracts the slot that
+ * falls out of the window. Memory is fixed at compile time.
+ *
+ * Per-source and per-PGN rates live in small open-addressed tables of
+ * rows with at most four candidate positions per key. Rows whose
+ * window total drops to zero are released when the slot turns.
+ *
+ * A second, exponentially decayed profile records bus bits by phase
+ * within the slot cycle, so traffic that repeats every slot (100 ms
+ * by default) shows up as busy phases and the quietest phase can be
+ * offered to the application for its own transmissions.
+ *
+ * All functions run on the polling thread.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_BUSLOAD_H
+#define E32_BUSLOAD_H
+
+#include "e32_types.h"
+#include "e32_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Row key of an unused row */
+#define E32_BUSLOAD_FREE    0xFFFFFFFFu
+
+/**
+ * @brief Frames per slot of one source address or PGN
+ */
+typedef struct {
+    uint32_t key;
+    uint32_t total;                             /**< Sum of slots[] */
+    uint16_t slots[E32_CFG_BUSLOAD_SLOTS];
+} e32_busload_row_t;
+
+/**
+ * @brief Profiler state of one channel
+ */
+typedef struct {
+    bool            enabled;
+    bool            started;    /**< First frame seen */
+    uint8_t         stuffing;   /**< e32_stuffing_t */
+    uint8_t         current;    /**< Slot being filled */
+    uint32_t        bitrate;
+#ifdef E32_CFG_CAN_FD
+    uint32_t        data_bitrate;   /**< Bitrate after BRS */
+#endif
+    uint32_t        slot_start; /**< Frame clock at the start of the current slot, ms */
+    uint32_t        since;      /**< Frame clock of the first frame */
+    uint16_t        peak_permille;
+
+    uint32_t        bits[E32_CFG_BUSLOAD_SLOTS];
+    uint32_t        frames[E32_CFG_BUSLOAD_SLOTS];
+    uint32_t        window_bits;
+    uint32_t        window_frames;
+
+    /* Bits by phase of the slot cycle, decayed by 1/8 per cycle: 8x the typical cycle */
+    uint32_t        phase_bits[E32_CFG_BUSLOAD_PHASES];
+
+    e32_busload_row_t sources[E32_CFG_BUSLOAD_SOURCES];
+    e32_busload_row_t pgns[E32_CFG_BUSLOAD_PGNS];
+    e32_busload_row_t other_sources;
+    e32_busload_row_t other_pgns;
+} e32_busload_t;
+
+/**
+ * @brief Clear all counters and set the counting method
+ *
+ * @param bitrate Bus bitrate in bit/s (0 selects 250000)
+ * @param data_bitrate CAN FD data phase bitrate (0 selects 2000000, unused in classic builds)
+ */
+void e32_busload_init(e32_busload_t* load, uint32_t bitrate, uint32_t data_bitrate,
+                      e32_stuffing_t stuffing);
+
+/**
+ * @brief Bits one frame occupies on the bus, interframe space included
+ */
+uint32_t e32_busload_frame_bits(const e32_can_frame_t* frame, e32_stuffing_t stuffing);
+
+#ifdef E32_CFG_CAN_FD
+/**
+ * @brief Bus time of a CAN FD frame, in bits at the nominal bitrate
+ *
+ * With BRS the data phase, from ESI to the CRC delimiter, counts at
+ * data_bitrate. The stuff count and CRC carry fixed stuff bits.
+ */
+uint32_t e32_busload_fd_frame_bits(const e32_can_frame_t* frame, e32_stuffing_t stuffing,
+                                   uint32_t bitrate, uint32_t data_bitrate);
+#endif
+
+/**
+ * @brief Account one frame seen on the bus at time now (frame clock, ms)
+ *
+ * @param id The frame's parsed identifier
+ * @return true if a new slot was started (the first frame starts one)
+ */
+bool e32_busload_add(e32_busload_t* load, const e32_can_frame_t* frame,
+                     const e32_j1939_id_t* id, uint32_t now);
+
+/**
+ * @brief Move the window to time now without adding traffic
+ */
+void e32_busload_advance(e32_busload_t* load, uint32_t now);
+
+/**
+ * @brief Summary over the window ending at now
+ *
+ * Call e32_busload_advance() with the same time first.
+ */
+void e32_busload_get(const e32_busload_t* load, uint32_t now, e32_busload_stats_t* out);
+
+/**
+ * @brief Busiest source addresses (pgns = false) or PGNs, highest rate first
+ *
+ * Call e32_busload_advance() with the same time first.
+ *
+ * @return Entries written (at most max)
+ */
+uint16_t e32_busload_top(const e32_busload_t* load, bool pgns, uint32_t now,
+                         e32_busload_rate_t* out, uint16_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_BUSLOAD_H */
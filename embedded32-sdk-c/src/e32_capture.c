@@ -0,0 +1,505 @@
+/**
+ * @file e32_capture.c
+ * @brief Embedded32 SDK - Binary CAN Capture Files Implementation
+ *
+ * Files are allocated with posix_fallocate() and mapped MAP_SHARED, so
+ * the kernel writes dirty pages back on its own schedule. The next file
+ * in the ring is created one flush ahead of the switch to it, keeping
+ * open/fallocate/munmap off the write path. The header's count is
+ * updated on every append; after a crash a reader sees every record
+ * that reached the page cache.
+ *
+ * @version 1.0.0
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "e32_capture.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define E32_HAVE_MMAP 1
+#endif
+
+/* Layout checks: the format is defined by these sizes */
+typedef char e32_capture_record_size_check[(sizeof(e32_capture_record_t) == 12 + E32_CAN_MAX_DATA_LEN) ? 1 : -1];
+typedef char e32_capture_header_size_check[(sizeof(e32_capture_header_t) == 64) ? 1 : -1];
+
+#define CAPTURE_ALIGN   64
+
+#if defined(E32_HAVE_MMAP)
+
+/* ==========================================================================
+ * LAYOUT
+ * ========================================================================== */
+
+static uint32_t index_entries(uint32_t capacity)
+{
+    return (capacity + E32_CAPTURE_BLOCK_RECORDS - 1) / E32_CAPTURE_BLOCK_RECORDS;
+}
+
+static uint32_t records_offset(uint32_t capacity)
+{
+    uint32_t end = (uint32_t)sizeof(e32_capture_header_t) + index_entries(capacity) * 4;
+    return (end + CAPTURE_ALIGN - 1) & ~(uint32_t)(CAPTURE_ALIGN - 1);
+}
+
+/* ==========================================================================
+ * WRITER
+ * ========================================================================== */
+
+static void release(int* fd, uint8_t** map, size_t len)
+{
+    if (*map) {
+        msync(*map, len, MS_ASYNC);
+        munmap(*map, len);
+        *map = NULL;
+    }
+    if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+    }
+}
+
+static void unmap_current(e32_capture_writer_t* writer)
+{
+    release(&writer->fd, &writer->map, writer->map_len);
+    writer->header = NULL;
+    writer->index = NULL;
+    writer->records = NULL;
+}
+
+/**
+ * Create, allocate and map file number file_index with an empty header.
+ * Blocks are reserved up front: a sparse file would turn a full disk
+ * into SIGBUS on a later store into the mapping.
+ */
+static e32_error_t create_file(const e32_capture_writer_t* writer, uint32_t file_index,
+                               int* fd_out, uint8_t** map_out, size_t* len_out)
+{
+    char path[E32_CAPTURE_PATH_MAX + 24];
+    snprintf(path, sizeof(path), "%s.%u.e32cap", writer->base_path, (unsigned)file_index);
+
+    uint32_t capacity = writer->records_per_file;
+    uint32_t offset = records_offset(capacity);
+    size_t len = (size_t)offset + (size_t)capacity * sizeof(e32_capture_record_t);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return E32_ERR_IO;
+    }
+#if defined(__APPLE__)
+    int sized = ftruncate(fd, (off_t)len);
+#else
+    int sized = posix_fallocate(fd, 0, (off_t)len);
+#endif
+    if (sized != 0) {
+        close(fd);
+        return E32_ERR_IO;
+    }
+
+    void* map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return E32_ERR_IO;
+    }
+
+    e32_capture_header_t* h = (e32_capture_header_t*)map;
+    memcpy(h->magic, E32_CAPTURE_MAGIC, sizeof(h->magic));
+    h->version = E32_CAPTURE_VERSION;
+    h->record_size = (uint16_t)sizeof(e32_capture_record_t);
+    h->block_records = E32_CAPTURE_BLOCK_RECORDS;
+    h->index_offset = (uint32_t)sizeof(e32_capture_header_t);
+    h->records_offset = offset;
+    h->capacity = capacity;
+    h->count = 0;
+
+    *fd_out = fd;
+    *map_out = (uint8_t*)map;
+    *len_out = len;
+    return E32_OK;
+}
+
+/**
+ * Make a created file the one being written.
+ */
+static void use_file(e32_capture_writer_t* writer, int fd, uint8_t* map, size_t len)
+{
+    writer->fd = fd;
+    writer->map = map;
+    writer->map_len = len;
+    writer->header = (e32_capture_header_t*)map;
+    writer->index = (uint32_t*)(map + sizeof(e32_capture_header_t));
+    writer->records = (e32_capture_record_t*)(map + writer->header->records_offset);
+    writer->header->sequence = writer->sequence++;
+}
+
+/**
+ * Create the file after the current one, so the switch to it is a swap.
+ * A ring of one file has nothing to create ahead of time.
+ */
+static e32_error_t prepare_spare(e32_capture_writer_t* writer)
+{
+    if (writer->file_count < 2 || writer->spare_map) {
+        return E32_OK;
+    }
+    return create_file(writer, (writer->file_index + 1) % writer->file_count,
+                       &writer->spare_fd, &writer->spare_map, &writer->spare_len);
+}
+
+/**
+ * Move to the next file in the ring. With a spare this makes no
+ * syscalls: the full file is unmapped by the next flush. Without one
+ * (flush was not called in time, or a ring of one file) the next file
+ * is created here.
+ */
+static e32_error_t rotate(e32_capture_writer_t* writer)
+{
+    writer->file_index = (writer->file_index + 1) % writer->file_count;
+
+    if (writer->spare_map && writer->map && !writer->retired_map) {
+        writer->retired_fd = writer->fd;
+        writer->retired_map = writer->map;
+        writer->retired_len = writer->map_len;
+        use_file(writer, writer->spare_fd, writer->spare_map, writer->spare_len);
+        writer->spare_fd = -1;
+        writer->spare_map = NULL;
+        return E32_OK;
+    }
+
+    unmap_current(writer);
+    release(&writer->retired_fd, &writer->retired_map, writer->retired_len);
+    if (writer->spare_map) {
+        use_file(writer, writer->spare_fd, writer->spare_map, writer->spare_len);
+        writer->spare_fd = -1;
+        writer->spare_map = NULL;
+        return E32_OK;
+    }
+
+    int fd;
+    uint8_t* map;
+    size_t len;
+    e32_error_t err = create_file(writer, writer->file_index, &fd, &map, &len);
+    if (err == E32_OK) {
+        use_file(writer, fd, map, len);
+    }
+    return err;
+}
+
+e32_error_t e32_capture_writer_open(
+    e32_capture_writer_t* writer,
+    const char* base_path,
+    uint32_t file_count,
+    uint32_t records_per_file
+)
+{
+    if (!writer || !base_path || file_count == 0 || records_per_file == 0 ||
+        strlen(base_path) >= E32_CAPTURE_PATH_MAX) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    /* Keep every offset within the 32-bit header fields */
+    if ((uint64_t)records_per_file * sizeof(e32_capture_record_t) > 0xF0000000u) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    strcpy(writer->base_path, base_path);
+    writer->file_count = file_count;
+    writer->records_per_file = records_per_file;
+    writer->fd = -1;
+    writer->spare_fd = -1;
+    writer->retired_fd = -1;
+
+    int fd;
+    uint8_t* map;
+    size_t len;
+    e32_error_t err = create_file(writer, 0, &fd, &map, &len);
+    if (err != E32_OK) {
+        return err;
+    }
+    use_file(writer, fd, map, len);
+
+    err = prepare_spare(writer);
+    if (err != E32_OK) {
+        e32_capture_writer_close(writer);
+    }
+    return err;
+}
+
+e32_error_t e32_capture_write(e32_capture_writer_t* writer, const e32_can_frame_t* frame)
+{
+    if (!writer || !frame) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    if (!writer->map || writer->header->count >= writer->header->capacity) {
+        /* Current file full (or a previous rotation failed): next in the ring */
+        if (rotate(writer) != E32_OK) {
+            writer->dropped++;
+            return E32_ERR_IO;
+        }
+    }
+
+    e32_capture_header_t* h = writer->header;
+    uint32_t n = h->count;
+    e32_capture_record_t* rec = &writer->records[n];
+
+    rec->timestamp = frame->timestamp;
+    rec->id = frame->id;
+    rec->dlc = frame->dlc > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : frame->dlc;
+    rec->flags = (uint8_t)((frame->is_extended ? E32_CAPTURE_FLAG_EXTENDED : 0) | ((frame->flags & 0x07) << 1));
+    rec->channel = frame->channel;
+    rec->reserved = 0;
+    memcpy(rec->data, frame->data, E32_CAN_MAX_DATA_LEN);
+
+    if (n % E32_CAPTURE_BLOCK_RECORDS == 0) {
+        writer->index[n / E32_CAPTURE_BLOCK_RECORDS] = frame->timestamp;
+    }
+    if (n == 0) {
+        h->first_timestamp = frame->timestamp;
+    }
+    h->last_timestamp = frame->timestamp;
+    h->count = n + 1;       /* Publish last, after the record is complete */
+
+    return E32_OK;
+}
+
+void e32_capture_view_handler(const e32_j1939_view_t* view, void* writer)
+{
+    if (view->frame) {
+        e32_capture_write((e32_capture_writer_t*)writer, view->frame);
+    }
+}
+
+e32_error_t e32_capture_writer_flush(e32_capture_writer_t* writer)
+{
+    if (!writer) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    release(&writer->retired_fd, &writer->retired_map, writer->retired_len);
+    if (writer->map && msync(writer->map, writer->map_len, MS_ASYNC) != 0) {
+        return E32_ERR_IO;
+    }
+    return prepare_spare(writer);
+}
+
+void e32_capture_writer_close(e32_capture_writer_t* writer)
+{
+    if (!writer) return;
+    unmap_current(writer);
+    release(&writer->retired_fd, &writer->retired_map, writer->retired_len);
+    release(&writer->spare_fd, &writer->spare_map, writer->spare_len);
+}
+
+/* ==========================================================================
+ * READER
+ * ========================================================================== */
+
+e32_error_t e32_capture_reader_open(e32_capture_reader_t* reader, const char* path)
+{
+    if (!reader || !path) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return E32_ERR_IO;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return E32_ERR_IO;
+    }
+    if ((size_t)st.st_size < sizeof(e32_capture_header_t)) {
+        close(fd);
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    size_t len = (size_t)st.st_size;
+    void* map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return E32_ERR_IO;
+    }
+
+    reader->fd = fd;
+    reader->map = (const uint8_t*)map;
+    reader->map_len = len;
+
+    const e32_capture_header_t* h = (const e32_capture_header_t*)map;
+    uint64_t records_end = (uint64_t)h->records_offset + (uint64_t)h->capacity * sizeof(e32_capture_record_t);
+    uint64_t index_end = (uint64_t)h->index_offset + (uint64_t)index_entries(h->capacity) * 4;
+
+    if (memcmp(h->magic, E32_CAPTURE_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != E32_CAPTURE_VERSION ||
+        h->record_size != sizeof(e32_capture_record_t) ||
+        h->block_records != E32_CAPTURE_BLOCK_RECORDS ||
+        records_end > len || index_end > h->records_offset ||
+        h->count > h->capacity) {
+        e32_capture_reader_close(reader);
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    reader->header = h;
+    reader->index = (const uint32_t*)(reader->map + h->index_offset);
+    reader->records = (const e32_capture_record_t*)(reader->map + h->records_offset);
+    reader->count = h->count;
+    return E32_OK;
+}
+
+const e32_capture_record_t* e32_capture_records(const e32_capture_reader_t* reader, uint32_t* count)
+{
+    if (!reader || !reader->records) {
+        if (count) *count = 0;
+        return NULL;
+    }
+    if (count) *count = reader->count;
+    return reader->records;
+}
+
+uint32_t e32_capture_seek(const e32_capture_reader_t* reader, uint32_t timestamp)
+{
+    if (!reader || reader->count == 0) {
+        return 0;
+    }
+
+    /* Last block starting at or before the target */
+    uint32_t blocks = index_entries(reader->count);
+    uint32_t lo = 0;
+    uint32_t hi = blocks;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (reader->index[mid] <= timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    uint32_t block = (lo > 0) ? lo - 1 : 0;
+
+    /* The target may still lie in that block or at the next block's start */
+    uint32_t i = block * E32_CAPTURE_BLOCK_RECORDS;
+    while (i < reader->count && reader->records[i].timestamp < timestamp) {
+        i++;
+    }
+    return i;
+}
+
+e32_error_t e32_capture_get_frame(
+    const e32_capture_reader_t* reader,
+    uint32_t index,
+    e32_can_frame_t* frame
+)
+{
+    if (!reader || !frame) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    if (index >= reader->count) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    const e32_capture_record_t* rec = &reader->records[index];
+    memset(frame, 0, sizeof(*frame));
+    frame->id = rec->id;
+    frame->dlc = rec->dlc;
+    frame->timestamp = rec->timestamp;
+    frame->is_extended = (rec->flags & E32_CAPTURE_FLAG_EXTENDED) != 0;
+    frame->channel = rec->channel;
+    frame->flags = (rec->flags >> 1) & 0x07;
+    memcpy(frame->data, rec->data, E32_CAN_MAX_DATA_LEN);
+    return E32_OK;
+}
+
+void e32_capture_reader_close(e32_capture_reader_t* reader)
+{
+    if (!reader) return;
+
+    if (reader->map) {
+        munmap((void*)reader->map, reader->map_len);
+        reader->map = NULL;
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+    reader->header = NULL;
+    reader->index = NULL;
+    reader->records = NULL;
+    reader->count = 0;
+}
+
+#else /* !E32_HAVE_MMAP */
+
+e32_error_t e32_capture_writer_open(e32_capture_writer_t* writer, const char* base_path,
+                                    uint32_t file_count, uint32_t records_per_file)
+{
+    (void)writer; (void)base_path; (void)file_count; (void)records_per_file;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+e32_error_t e32_capture_write(e32_capture_writer_t* writer, const e32_can_frame_t* frame)
+{
+    (void)writer; (void)frame;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+void e32_capture_view_handler(const e32_j1939_view_t* view, void* writer)
+{
+    (void)view; (void)writer;
+}
+
+e32_error_t e32_capture_writer_flush(e32_capture_writer_t* writer)
+{
+    (void)writer;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+void e32_capture_writer_close(e32_capture_writer_t* writer)
+{
+    (void)writer;
+}
+
+e32_error_t e32_capture_reader_open(e32_capture_reader_t* reader, const char* path)
+{
+    (void)reader; (void)path;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+const e32_capture_record_t* e32_capture_records(const e32_capture_reader_t* reader, uint32_t* count)
+{
+    (void)reader;
+    if (count) *count = 0;
+    return NULL;
+}
+
+uint32_t e32_capture_seek(const e32_capture_reader_t* reader, uint32_t timestamp)
+{
+    (void)reader; (void)timestamp;
+    return 0;
+}
+
+e32_error_t e32_capture_get_frame(const e32_capture_reader_t* reader, uint32_t index,
+                                  e32_can_frame_t* frame)
+{
+    (void)reader; (void)index; (void)frame;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+void e32_capture_reader_close(e32_capture_reader_t* reader)
+{
+    (void)reader;
+}
+
+#endif /* E32_HAVE_MMAP */
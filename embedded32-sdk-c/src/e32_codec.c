@@ -8,36 +8,34 @@
  */
 
 #include "e32_codec.h"
+#include "e32_pgn_defs.h"
 #include <string.h>
 
 /* ==========================================================================
- * PGN DATABASE
+ * J1939 ID PARSING
  * ========================================================================== */
 
-typedef struct {
-    uint32_t    pgn;
-    const char* name;
-    uint8_t     length;
-} pgn_entry_t;
-
-static const pgn_entry_t PGN_DATABASE[] = {
-    { 0x00EA00, "Request", 3 },
-    { 0x00EE00, "Address Claimed", 8 },
-    { 0x00F004, "Electronic Engine Controller 1 (EEC1)", 8 },
-    { 0x00F003, "Electronic Transmission Controller 1 (ETC1)", 8 },
-    { 0x00F000, "Proprietary Transmission Status", 8 },
-    { 0x00FEEE, "Engine Temperature 1 (ET1)", 8 },
-    { 0x00FEF2, "Fuel Economy (FE)", 8 },
-    { 0x00FECA, "DM1 - Active Diagnostic Trouble Codes", 8 },
-    { 0x00FECB, "DM2 - Previously Active DTCs", 8 },
-    { 0x00EF00, "Engine Control Command (Proprietary B)", 8 },
-    { 0, NULL, 0 }  /* Sentinel */
+/* PF -> PDU2 mask (0xFF for PF >= 240); one load beats the arithmetic
+ * form of e32_j1939_pdu2_mask() on the per-frame path */
+static const uint8_t PF_PDU2_MASK[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
 };
 
-/* ==========================================================================
- * J1939 ID PARSING
- * ========================================================================== */
-
 void e32_parse_j1939_id(uint32_t can_id, e32_j1939_id_t* parsed)
 {
     if (!parsed) return;
@@ -45,28 +43,23 @@ void e32_parse_j1939_id(uint32_t can_id, e32_j1939_id_t* parsed)
     /*
      * J1939 29-bit ID format:
      * Bits 28-26: Priority (3 bits)
-     * Bits 25-24: Reserved/EDP/DP (2 bits)
+     * Bits 25-24: EDP/DP (2 bits, part of the PGN)
      * Bits 23-16: PF (PDU Format, 8 bits)
      * Bits 15-8:  PS (PDU Specific, 8 bits)
      * Bits 7-0:   SA (Source Address, 8 bits)
+     *
+     * PF < 240 (PDU1) makes PS the destination, otherwise PS is the low
+     * byte of the PGN; the masks below select either without a branch.
      */
     
+    uint32_t pdu2_mask = PF_PDU2_MASK[(can_id >> 16) & 0xFF];
+    uint32_t ps = (can_id >> 8) & 0xFF;
+    
     parsed->priority = (can_id >> 26) & 0x07;
-    uint8_t pf = (can_id >> 16) & 0xFF;
-    uint8_t ps = (can_id >> 8) & 0xFF;
+    parsed->pgn = (can_id >> 8) & (0x3FF00u | pdu2_mask);
     parsed->source_address = can_id & 0xFF;
-    
-    if (pf < 240) {
-        /* PDU1 format - destination specific */
-        parsed->pgn = (uint32_t)pf << 8;
-        parsed->destination_address = ps;
-        parsed->pdu1 = true;
-    } else {
-        /* PDU2 format - broadcast */
-        parsed->pgn = ((uint32_t)pf << 8) | ps;
-        parsed->destination_address = 0xFF;
-        parsed->pdu1 = false;
-    }
+    parsed->destination_address = (uint8_t)(ps | pdu2_mask);
+    parsed->pdu1 = pdu2_mask == 0;
 }
 
 uint32_t e32_build_j1939_id(
@@ -76,23 +69,14 @@ uint32_t e32_build_j1939_id(
     uint8_t destination
 )
 {
-    uint8_t pf = (pgn >> 8) & 0xFF;
-    uint8_t ps = pgn & 0xFF;
-    
-    uint32_t can_id = ((uint32_t)(priority & 0x07)) << 26;
-    can_id |= ((uint32_t)pf << 16);
-    
-    if (pf < 240) {
-        /* PDU1 - use destination address as PS */
-        can_id |= ((uint32_t)destination << 8);
-    } else {
-        /* PDU2 - use PS from PGN */
-        can_id |= ((uint32_t)ps << 8);
-    }
+    /* PDU1 - destination address as PS; PDU2 - PS from the PGN */
+    uint32_t pdu2_mask = e32_j1939_pdu2_mask(pgn << 8);
+    uint32_t ps = (destination & ~pdu2_mask) | (pgn & pdu2_mask);
     
-    can_id |= source_address;
-    
-    return can_id;
+    return ((uint32_t)(priority & 0x07) << 26) |
+           ((pgn & 0x3FF00u) << 8) |
+           (ps << 8) |
+           source_address;
 }
 
 /* ==========================================================================
@@ -101,26 +85,160 @@ uint32_t e32_build_j1939_id(
 
 const char* e32_get_pgn_name(uint32_t pgn)
 {
-    for (const pgn_entry_t* entry = PGN_DATABASE; entry->name != NULL; entry++) {
-        if (entry->pgn == pgn) {
-            return entry->name;
+    const e32_pgn_def_t* def = e32_find_pgn_def(pgn);
+    return def ? def->name : "Unknown";
+}
+
+const char* e32_msg_pgn_name(const e32_j1939_message_t* message)
+{
+    if (!message) return "Unknown";
+    return message->pgn_name ? message->pgn_name : e32_get_pgn_name(message->pgn);
+}
+
+/* ==========================================================================
+ * SPN DEFINITIONS
+ * ========================================================================== */
+
+/*
+ * The decoder tables (E32_PGN_DEFS / E32_SPN_DEFS) are generated into
+ * e32_pgn_defs.c from defs/j1939_pgns.json by tools/gen_pgn_tables.py.
+ */
+
+const e32_pgn_def_t* e32_find_pgn_def(uint32_t pgn)
+{
+    size_t lo = 0;
+    size_t hi = E32_PGN_DEFS_COUNT;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (E32_PGN_DEFS[mid].pgn < pgn) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
-    return "Unknown";
+
+    return (lo < E32_PGN_DEFS_COUNT && E32_PGN_DEFS[lo].pgn == pgn) ? &E32_PGN_DEFS[lo] : NULL;
+}
+
+const e32_spn_def_t* e32_find_spn_def(const e32_pgn_def_t* pgn_def, uint32_t spn)
+{
+    if (!pgn_def) return NULL;
+
+    for (uint8_t i = 0; i < pgn_def->spn_count; i++) {
+        const e32_spn_def_t* def = &E32_SPN_DEFS[pgn_def->first_spn + i];
+        if (def->spn == spn) {
+            return def;
+        }
+    }
+    return NULL;
 }
 
 /* ==========================================================================
  * SPN DECODING HELPERS
  * ========================================================================== */
 
-static void add_spn_float(e32_j1939_message_t* msg, const char* name, float value)
+static uint32_t extract_bits(const uint8_t* data, uint16_t start_bit, uint8_t bit_length)
 {
-    if (msg->spn_count < E32_MAX_SPNS) {
-        msg->spns[msg->spn_count].name = name;
-        msg->spns[msg->spn_count].value.f32 = value;
-        msg->spns[msg->spn_count].type = E32_SPN_TYPE_FLOAT;
-        msg->spn_count++;
+    uint32_t first = start_bit / 8;
+    uint32_t last = (uint32_t)(start_bit + bit_length - 1) / 8;
+    uint64_t raw = 0;
+
+    for (uint32_t i = last + 1; i-- > first; ) {
+        raw = (raw << 8) | data[i];
     }
+
+    raw >>= (start_bit % 8);
+    return (uint32_t)(raw & ((1ull << bit_length) - 1));
+}
+
+void e32_spn_from_raw(const e32_spn_def_t* def, uint32_t raw, e32_spn_t* out)
+{
+    int32_t value = (int32_t)raw;
+
+    if ((def->flags & E32_SPN_FLAG_SIGNED) && def->bit_length < 32) {
+        uint32_t sign = 1u << (def->bit_length - 1);
+        value = (int32_t)((raw ^ sign) - sign);
+    }
+
+    out->name = def->name;
+    out->type = (e32_spn_type_t)def->type;
+
+    switch (def->type) {
+        case E32_SPN_TYPE_FLOAT:
+            out->value.f32 = (float)value * def->scale + def->offset;
+            break;
+        case E32_SPN_TYPE_BOOL:
+            out->value.boolean = (raw == 1);
+            break;
+        case E32_SPN_TYPE_INT:
+        default:
+            out->value.i32 = value * (int32_t)def->scale + (int32_t)def->offset;
+            break;
+    }
+}
+
+/* J1939-71 reserved ranges: top byte 0xFE/0xFF, or the two highest codes of short fields */
+static e32_spn_status_t raw_status(const e32_spn_def_t* def, uint32_t raw)
+{
+    if ((def->flags & E32_SPN_FLAG_SIGNED) || def->bit_length < 2) {
+        return E32_SPN_STATUS_OK;
+    }
+
+    uint32_t high = (def->bit_length >= 8) ? raw >> (def->bit_length - 8) : raw;
+    uint32_t ones = (def->bit_length >= 8) ? 0xFFu : (1u << def->bit_length) - 1;
+
+    if (high == ones) return E32_SPN_STATUS_NOT_AVAILABLE;
+    if (high == ones - 1) return E32_SPN_STATUS_ERROR;
+    return E32_SPN_STATUS_OK;
+}
+
+void e32_spn_compact_from_raw(const e32_spn_def_t* def, uint32_t raw, e32_spn_compact_t* out)
+{
+    out->index = (uint16_t)(def - E32_SPN_DEFS);
+    out->type = def->type;
+    out->status = (uint8_t)raw_status(def, raw);
+    out->value = 0;
+
+    if (out->status != E32_SPN_STATUS_OK) {
+        return;
+    }
+
+    if (def->type == E32_SPN_TYPE_BOOL) {
+        out->value = (raw == 1);
+        return;
+    }
+
+    int64_t value = (int64_t)raw;
+    if ((def->flags & E32_SPN_FLAG_SIGNED) && def->bit_length < 32) {
+        uint32_t sign = 1u << (def->bit_length - 1);
+        value = (int32_t)((raw ^ sign) - sign);
+    } else if (def->flags & E32_SPN_FLAG_SIGNED) {
+        value = (int32_t)raw;
+    }
+
+    /* Up to 16-bit fields with small factors cannot overflow 32-bit arithmetic */
+    if (def->bit_length <= 16 &&
+        def->fixed_num >= -0x7FFF && def->fixed_num <= 0x7FFF &&
+        def->fixed_offset >= -0xFFFF && def->fixed_offset <= 0xFFFF) {
+        out->value = (int32_t)value * def->fixed_num + def->fixed_offset;
+        return;
+    }
+
+    value = value * def->fixed_num + def->fixed_offset;
+    if (value > INT32_MAX) value = INT32_MAX;
+    if (value < INT32_MIN) value = INT32_MIN;
+    out->value = (int32_t)value;
+}
+
+static bool decode_spn(const e32_spn_def_t* def, const uint8_t* data, uint16_t len, e32_spn_t* out)
+{
+    if ((uint32_t)(def->start_bit + def->bit_length) > (uint32_t)len * 8) {
+        return false;   /* Field not present in this frame */
+    }
+
+    e32_spn_from_raw(def, extract_bits(data, def->start_bit, def->bit_length), out);
+    return true;
 }
 
 static void add_spn_int(e32_j1939_message_t* msg, const char* name, int32_t value)
@@ -133,25 +251,143 @@ static void add_spn_int(e32_j1939_message_t* msg, const char* name, int32_t valu
     }
 }
 
-static void add_spn_bool(e32_j1939_message_t* msg, const char* name, bool value)
+/**
+ * Fill message->spns from the payload: table-driven for catalogued PGNs,
+ * hand-written for the rest.
+ */
+static void decode_spns(
+    e32_j1939_message_t* message,
+    const e32_pgn_def_t* def,
+    const uint8_t* data,
+    uint16_t len
+)
 {
-    if (msg->spn_count < E32_MAX_SPNS) {
-        msg->spns[msg->spn_count].name = name;
-        msg->spns[msg->spn_count].value.boolean = value;
-        msg->spns[msg->spn_count].type = E32_SPN_TYPE_BOOL;
-        msg->spn_count++;
+    if (def && def->spn_count > 0) {
+        for (uint8_t i = 0; i < def->spn_count && message->spn_count < E32_MAX_SPNS; i++) {
+            if (decode_spn(&E32_SPN_DEFS[def->first_spn + i], data, len, &message->spns[message->spn_count])) {
+                message->spn_count++;
+            }
+        }
+        return;
+    }
+    
+    switch (message->pgn) {
+        case E32_PGN_DM1:  /* 0xFECA */
+        case E32_PGN_DM2:  /* 0xFECB */
+            if (len >= 2) {
+                add_spn_int(message, "lampStatus", data[0]);
+            }
+            /* As many DTCs as fit; e32_decode_dtcs() returns all of them */
+            for (uint16_t i = 2; i + 4 <= len && message->spn_count + 3 <= E32_MAX_SPNS; i += 4) {
+                e32_dtc_t dtc;
+                if (e32_decode_dtc(&data[i], &dtc)) {
+                    add_spn_int(message, "spn", (int32_t)dtc.spn);
+                    add_spn_int(message, "fmi", dtc.fmi);
+                    add_spn_int(message, "occurrenceCount", dtc.occurrence);
+                }
+            }
+            break;
+            
+        default:
+            /* Unknown PGN - no SPN decoding */
+            break;
+    }
+}
+
+/* ==========================================================================
+ * DIAGNOSTIC MESSAGES (DM1 / DM2)
+ * ========================================================================== */
+
+bool e32_decode_dtc(const uint8_t* bytes, e32_dtc_t* dtc)
+{
+    uint32_t spn = bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)(bytes[2] & 0xE0) << 11);
+    
+    dtc->spn = spn;
+    dtc->fmi = bytes[2] & 0x1F;
+    dtc->occurrence = bytes[3] & 0x7F;
+    
+    /* Lists without faults carry one all-zero (or all-ones) field */
+    return spn != 0 && spn != 0x7FFFF;
+}
+
+uint16_t e32_decode_dtcs(const uint8_t* data, uint16_t len, e32_dtc_t* dtcs, uint16_t max)
+{
+    uint16_t count = 0;
+    
+    if (!data) return 0;
+    
+    for (uint16_t i = 2; i + 4 <= len; i += 4) {
+        e32_dtc_t dtc;
+        if (!e32_decode_dtc(&data[i], &dtc)) {
+            continue;
+        }
+        if (dtcs && count < max) {
+            dtcs[count] = dtc;
+        }
+        count++;
     }
+    return count;
 }
 
 /* ==========================================================================
  * FRAME DECODING
  * ========================================================================== */
 
+e32_error_t e32_decode_header(
+    const e32_can_frame_t* frame,
+    e32_j1939_message_t* message
+)
+{
+    if (!frame || !message) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_j1939_id_t parsed;
+    e32_parse_j1939_id(frame->id, &parsed);
+    
+    message->pgn = parsed.pgn;
+    message->pgn_name = NULL;
+    message->source_address = parsed.source_address;
+    message->destination_address = parsed.destination_address;
+    message->priority = parsed.priority;
+    message->timestamp = frame->timestamp;
+    message->channel = frame->channel;
+    message->spn_count = 0;
+    message->payload = NULL;
+    message->payload_len = 0;
+    
+    /* Fixed-size copy: cheaper than a length-dependent one */
+    message->raw_len = frame->dlc > E32_CAN_CLASSIC_DATA_LEN ? E32_CAN_CLASSIC_DATA_LEN : frame->dlc;
+    memcpy(message->raw, frame->data, E32_CAN_CLASSIC_DATA_LEN);
+    
+#ifdef E32_CFG_CAN_FD
+    if (frame->dlc > E32_CAN_CLASSIC_DATA_LEN) {
+        message->payload = frame->data;
+        message->payload_len = frame->dlc > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : frame->dlc;
+    }
+#endif
+    
+    return E32_OK;
+}
+
 e32_error_t e32_decode_frame(
     const e32_can_frame_t* frame,
     e32_j1939_message_t* message
 )
 {
+    return e32_decode_frame_ex(frame, message, E32_DECODE_FULL);
+}
+
+e32_error_t e32_decode_frame_ex(
+    const e32_can_frame_t* frame,
+    e32_j1939_message_t* message,
+    e32_decode_mode_t mode
+)
+{
+    if (mode == E32_DECODE_HEADER) {
+        return e32_decode_header(frame, message);
+    }
+    
     if (!frame || !message) {
         return E32_ERR_INVALID_PARAM;
     }
@@ -163,80 +399,290 @@ e32_error_t e32_decode_frame(
     e32_j1939_id_t parsed;
     e32_parse_j1939_id(frame->id, &parsed);
     
+    /* One catalogue search serves both the name and the SPN layout */
+    const e32_pgn_def_t* def = e32_find_pgn_def(parsed.pgn);
+    
     message->pgn = parsed.pgn;
-    message->pgn_name = e32_get_pgn_name(parsed.pgn);
+    if (mode == E32_DECODE_FULL) {
+        message->pgn_name = def ? def->name : "Unknown";
+    }
     message->source_address = parsed.source_address;
     message->destination_address = parsed.destination_address;
     message->priority = parsed.priority;
     message->timestamp = frame->timestamp;
+    message->channel = frame->channel;
+    
+#ifdef E32_CFG_CAN_FD
+    if (frame->dlc > E32_CAN_CLASSIC_DATA_LEN) {
+        /* FD payloads are referenced like reassembled ones */
+        return e32_decode_message(message, frame->data,
+                                  frame->dlc > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : frame->dlc, mode);
+    }
+#endif
     
     /* Copy raw data */
     message->raw_len = frame->dlc;
     memcpy(message->raw, frame->data, frame->dlc);
     
-    /* Decode SPNs based on PGN */
-    const uint8_t* data = frame->data;
-    uint8_t len = frame->dlc;
+    decode_spns(message, def, frame->data, frame->dlc);
+    return E32_OK;
+}
+
+e32_error_t e32_decode_message(
+    e32_j1939_message_t* message,
+    const uint8_t* data,
+    uint16_t len,
+    e32_decode_mode_t mode
+)
+{
+    if (!message || !data) {
+        return E32_ERR_INVALID_PARAM;
+    }
     
-    switch (parsed.pgn) {
-        case E32_PGN_EEC1:  /* 0xF004 - Electronic Engine Controller 1 */
-            if (len >= 5) {
-                uint16_t raw_speed = data[3] | ((uint16_t)data[4] << 8);
-                add_spn_float(message, "engineSpeed", raw_speed * 0.125f);
-            }
-            if (len >= 3) {
-                add_spn_int(message, "torque", (int32_t)data[2] - 125);
-            }
-            break;
-            
-        case E32_PGN_ET1:  /* 0xFEEE - Engine Temperature 1 */
-            if (len >= 1) {
-                add_spn_int(message, "coolantTemp", (int32_t)data[0] - 40);
-            }
-            break;
-            
-        case E32_PGN_ETC1:  /* 0xF003 */
-        case E32_PGN_PROP_TRANS_STATUS:  /* 0xF000 */
-            if (len >= 2) {
-                uint16_t raw_speed = data[0] | ((uint16_t)data[1] << 8);
-                add_spn_float(message, "outputShaftSpeed", raw_speed * 0.125f);
-            }
-            if (len >= 5) {
-                add_spn_int(message, "gear", data[4]);
-            }
-            break;
-            
-        case E32_PGN_REQUEST:  /* 0xEA00 */
-            if (len >= 3) {
-                uint32_t req_pgn = data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16);
-                add_spn_int(message, "requestedPGN", (int32_t)req_pgn);
-            }
-            break;
-            
-        case E32_PGN_ENGINE_CONTROL_CMD:  /* 0xEF00 */
-            if (len >= 3) {
-                add_spn_int(message, "targetRpm", data[0] | ((uint16_t)data[1] << 8));
-                add_spn_bool(message, "enable", data[2] == 1);
-            }
-            break;
-            
-        case E32_PGN_DM1:  /* 0xFECA */
-            if (len >= 5) {
-                add_spn_int(message, "lampStatus", data[0]);
-                uint32_t spn = data[2] | ((uint32_t)data[3] << 8) | (((uint32_t)(data[4] & 0xE0)) << 11);
-                add_spn_int(message, "spn", (int32_t)spn);
-                add_spn_int(message, "fmi", data[4] & 0x1F);
+    message->raw_len = len > E32_CAN_CLASSIC_DATA_LEN ? E32_CAN_CLASSIC_DATA_LEN : (uint8_t)len;
+    memcpy(message->raw, data, message->raw_len);
+    message->payload = (len > E32_CAN_CLASSIC_DATA_LEN) ? data : NULL;
+    message->payload_len = (len > E32_CAN_CLASSIC_DATA_LEN) ? len : 0;
+    message->pgn_name = NULL;
+    message->spn_count = 0;
+    
+    if (mode == E32_DECODE_HEADER) {
+        return E32_OK;
+    }
+    
+    const e32_pgn_def_t* def = e32_find_pgn_def(message->pgn);
+    if (mode == E32_DECODE_FULL) {
+        message->pgn_name = def ? def->name : "Unknown";
+    }
+    
+    decode_spns(message, def, data, len);
+    return E32_OK;
+}
+
+const uint8_t* e32_msg_data(const e32_j1939_message_t* message, uint16_t* len)
+{
+    if (!message) {
+        if (len) *len = 0;
+        return NULL;
+    }
+    
+    if (message->payload) {
+        if (len) *len = message->payload_len;
+        return message->payload;
+    }
+    
+    if (len) *len = message->raw_len;
+    return message->raw;
+}
+
+/* ==========================================================================
+ * ON-DEMAND SPN ACCESS
+ * ========================================================================== */
+
+e32_error_t e32_msg_get_spn(
+    const e32_j1939_message_t* message,
+    uint32_t spn,
+    e32_spn_t* out
+)
+{
+    if (!message || !out) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    const e32_pgn_def_t* pgn_def = e32_find_pgn_def(message->pgn);
+    if (!pgn_def) {
+        return E32_ERR_NOT_FOUND;
+    }
+    
+    uint16_t len;
+    const uint8_t* data = e32_msg_data(message, &len);
+    
+    const e32_spn_def_t* def = e32_find_spn_def(pgn_def, spn);
+    return (def && decode_spn(def, data, len, out)) ? E32_OK : E32_ERR_NOT_FOUND;
+}
+
+e32_error_t e32_msg_find_spn(
+    const e32_j1939_message_t* message,
+    const char* name,
+    e32_spn_t* out
+)
+{
+    if (!message || !name || !out) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    uint16_t len;
+    const uint8_t* data = e32_msg_data(message, &len);
+    
+    const e32_pgn_def_t* pgn_def = e32_find_pgn_def(message->pgn);
+    if (pgn_def && pgn_def->spn_count > 0) {
+        for (uint8_t i = 0; i < pgn_def->spn_count; i++) {
+            const e32_spn_def_t* def = &E32_SPN_DEFS[pgn_def->first_spn + i];
+            if (strcmp(def->name, name) == 0) {
+                return decode_spn(def, data, len, out) ? E32_OK : E32_ERR_NOT_FOUND;
             }
-            break;
-            
-        default:
-            /* Unknown PGN - no SPN decoding */
-            break;
+        }
+        return E32_ERR_NOT_FOUND;
+    }
+    
+    /* PGNs with hand-written decoders: run the full decode from the payload */
+    e32_j1939_message_t full;
+    memset(&full, 0, sizeof(full));
+    full.pgn = message->pgn;
+    e32_decode_message(&full, data, len, E32_DECODE_VALUES);
+    
+    for (uint8_t i = 0; i < full.spn_count; i++) {
+        if (strcmp(full.spns[i].name, name) == 0) {
+            *out = full.spns[i];
+            return E32_OK;
+        }
+    }
+    
+    return E32_ERR_NOT_FOUND;
+}
+
+e32_error_t e32_view_get_spn(const e32_j1939_view_t* view, uint32_t spn, e32_spn_t* out)
+{
+    if (!view || !out) {
+        return E32_ERR_INVALID_PARAM;
     }
     
+    const e32_spn_def_t* def = e32_find_spn_def(e32_find_pgn_def(view->pgn), spn);
+    return (def && decode_spn(def, view->data, view->len, out)) ? E32_OK : E32_ERR_NOT_FOUND;
+}
+
+/* ==========================================================================
+ * COMPACT DECODING
+ * ========================================================================== */
+
+bool e32_spn_decode_compact(const e32_spn_def_t* def, const uint8_t* data, uint16_t len,
+                            e32_spn_compact_t* out)
+{
+    if ((uint32_t)(def->start_bit + def->bit_length) > (uint32_t)len * 8) {
+        return false;
+    }
+
+    e32_spn_compact_from_raw(def, extract_bits(data, def->start_bit, def->bit_length), out);
+    return true;
+}
+
+/* Header fields are already set */
+static void decode_compact_body(e32_j1939_compact_t* message, const uint8_t* data, uint16_t len)
+{
+    message->raw_len = len > E32_CAN_CLASSIC_DATA_LEN ? E32_CAN_CLASSIC_DATA_LEN : (uint8_t)len;
+    memcpy(message->raw, data, message->raw_len);
+    message->spn_count = 0;
+
+    const e32_pgn_def_t* def = e32_find_pgn_def(message->pgn);
+    if (!def) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < def->spn_count && message->spn_count < E32_MAX_SPNS; i++) {
+        if (e32_spn_decode_compact(&E32_SPN_DEFS[def->first_spn + i], data, len,
+                               &message->spns[message->spn_count])) {
+            message->spn_count++;
+        }
+    }
+}
+
+e32_error_t e32_decode_compact(const e32_can_frame_t* frame, e32_j1939_compact_t* message)
+{
+    if (!frame || !message) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    e32_j1939_id_t parsed;
+    e32_parse_j1939_id(frame->id, &parsed);
+
+    message->pgn = parsed.pgn;
+    message->timestamp = frame->timestamp;
+    message->source_address = parsed.source_address;
+    message->destination_address = parsed.destination_address;
+    message->priority = parsed.priority;
+    message->channel = frame->channel;
+
+    decode_compact_body(message, frame->data,
+                        frame->dlc > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : frame->dlc);
     return E32_OK;
 }
 
+e32_error_t e32_view_decode_compact(const e32_j1939_view_t* view, e32_j1939_compact_t* message)
+{
+    if (!view || !message) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    message->pgn = view->pgn;
+    message->timestamp = view->timestamp;
+    message->source_address = view->source_address;
+    message->destination_address = view->destination_address;
+    message->priority = view->priority;
+    message->channel = view->channel;
+
+    decode_compact_body(message, view->data, view->len);
+    return E32_OK;
+}
+
+e32_error_t e32_view_get_spn_compact(const e32_j1939_view_t* view, uint32_t spn,
+                                     e32_spn_compact_t* out)
+{
+    if (!view || !out) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    const e32_spn_def_t* def = e32_find_spn_def(e32_find_pgn_def(view->pgn), spn);
+    return (def && e32_spn_decode_compact(def, view->data, view->len, out)) ? E32_OK : E32_ERR_NOT_FOUND;
+}
+
+const e32_spn_compact_t* e32_compact_find(const e32_j1939_compact_t* message, uint32_t spn)
+{
+    if (!message) return NULL;
+
+    for (uint8_t i = 0; i < message->spn_count; i++) {
+        if (E32_SPN_DEFS[message->spns[i].index].spn == spn) {
+            return &message->spns[i];
+        }
+    }
+    return NULL;
+}
+
+uint32_t e32_spn_number(uint16_t index)
+{
+    return (index < E32_SPN_DEFS_COUNT) ? E32_SPN_DEFS[index].spn : 0;
+}
+
+const char* e32_spn_name(uint16_t index)
+{
+    return (index < E32_SPN_DEFS_COUNT) ? E32_SPN_DEFS[index].name : NULL;
+}
+
+uint32_t e32_spn_fixed_den(uint16_t index)
+{
+    return (index < E32_SPN_DEFS_COUNT) ? E32_SPN_DEFS[index].fixed_den : 1;
+}
+
+float e32_spn_to_float(const e32_spn_compact_t* spn)
+{
+    if (!spn) return 0.0f;
+    return (float)spn->value / (float)e32_spn_fixed_den(spn->index);
+}
+
+int32_t e32_spn_to_scaled(const e32_spn_compact_t* spn, int32_t units)
+{
+    if (!spn) return 0;
+
+    uint32_t den = e32_spn_fixed_den(spn->index);
+    int64_t value = (int64_t)spn->value * units;
+
+    if (den != 1) {
+        value /= (int64_t)den;
+    }
+    if (value > INT32_MAX) return INT32_MAX;
+    if (value < INT32_MIN) return INT32_MIN;
+    return (int32_t)value;
+}
+
 /* ==========================================================================
  * FRAME ENCODING
  * ========================================================================== */
@@ -284,3 +730,122 @@ void e32_encode_engine_control(
     frame->data[6] = 0xFF;
     frame->data[7] = 0xFF;
 }
+
+void e32_encode_address_claimed(
+    uint64_t name,
+    uint8_t source_address,
+    e32_can_frame_t* frame
+)
+{
+    if (!frame) return;
+    
+    memset(frame, 0, sizeof(*frame));
+    
+    frame->id = e32_build_j1939_id(E32_PGN_ADDRESS_CLAIMED, source_address, 6, E32_SA_GLOBAL);
+    frame->dlc = 8;
+    frame->is_extended = true;
+    
+    for (int i = 0; i < 8; i++) {
+        frame->data[i] = (uint8_t)(name >> (8 * i));
+    }
+}
+
+uint64_t e32_decode_name(const uint8_t* data)
+{
+    uint64_t name = 0;
+    for (int i = 7; i >= 0; i--) {
+        name = (name << 8) | data[i];
+    }
+    return name;
+}
+
+
+#ifdef E32_CFG_CAN_FD
+/* ==========================================================================
+ * CAN FD AND MULTI-PG (J1939-22)
+ * ========================================================================== */
+
+static const uint8_t FD_LENGTHS[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+uint8_t e32_can_dlc_to_len(uint8_t dlc)
+{
+    return FD_LENGTHS[dlc & 0x0F];
+}
+
+uint8_t e32_can_len_to_dlc(uint8_t len)
+{
+    uint8_t dlc = len <= 8 ? len : 9;
+    while (dlc < 15 && FD_LENGTHS[dlc] < len) {
+        dlc++;
+    }
+    return dlc;
+}
+
+bool e32_mpg_next(const uint8_t* data, uint16_t len, uint16_t* offset, e32_cpg_t* cpg)
+{
+    uint32_t at = *offset;
+    if (!data || at + E32_CPG_HEADER_LEN > len) {
+        return false;
+    }
+    
+    /* Padding reads as a 170-byte PG, longer than any frame holds */
+    const uint8_t* header = data + at;
+    if (header[3] > len - at - E32_CPG_HEADER_LEN) {
+        return false;
+    }
+    
+    uint32_t word = (uint32_t)header[0] | ((uint32_t)header[1] << 8) | ((uint32_t)header[2] << 16);
+    cpg->pgn = word & E32_PGN_MAX;
+    cpg->trailer = (word >> 18) & 0x07;
+    cpg->tos = (word >> 21) & 0x07;
+    cpg->data = header + E32_CPG_HEADER_LEN;
+    cpg->len = header[3];
+    
+    *offset = (uint16_t)(at + E32_CPG_HEADER_LEN + header[3]);
+    return true;
+}
+
+void e32_mpg_begin(uint8_t source_address, uint8_t priority, uint8_t destination,
+                   e32_can_frame_t* frame)
+{
+    if (!frame) return;
+    
+    memset(frame, 0, sizeof(*frame));
+    
+    frame->id = e32_build_j1939_id(E32_PGN_MULTI_PG, source_address, priority, destination);
+    frame->is_extended = true;
+    frame->flags = E32_CAN_FLAG_FD | E32_CAN_FLAG_BRS;
+}
+
+e32_error_t e32_mpg_add(e32_can_frame_t* frame, uint32_t pgn, const uint8_t* data, uint8_t len)
+{
+    if (!frame || (len && !data) || frame->dlc > E32_CAN_MAX_DATA_LEN) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    if (len > E32_CAN_MAX_DATA_LEN - E32_CPG_HEADER_LEN - frame->dlc) {
+        return E32_ERR_NO_MEMORY;
+    }
+    
+    uint32_t word = (pgn & E32_PGN_MAX) | ((uint32_t)E32_CPG_TOS_PLAIN << 21);
+    uint8_t* header = &frame->data[frame->dlc];
+    header[0] = word & 0xFF;
+    header[1] = (word >> 8) & 0xFF;
+    header[2] = (word >> 16) & 0xFF;
+    header[3] = len;
+    if (len) {
+        memcpy(header + E32_CPG_HEADER_LEN, data, len);
+    }
+    
+    frame->dlc = (uint8_t)(frame->dlc + E32_CPG_HEADER_LEN + len);
+    return E32_OK;
+}
+
+void e32_mpg_finish(e32_can_frame_t* frame)
+{
+    if (!frame || frame->dlc > E32_CAN_MAX_DATA_LEN) return;
+    
+    uint8_t len = e32_can_fd_len(frame->dlc);
+    memset(&frame->data[frame->dlc], E32_CPG_PADDING, (size_t)(len - frame->dlc));
+    frame->dlc = len;
+}
+#endif /* E32_CFG_CAN_FD */
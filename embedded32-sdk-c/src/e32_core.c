@@ -2,13 +2,24 @@
  * @file e32_core.c
  * @brief Embedded32 SDK - Core Functions
  * 
- * SDK initialization and version info.
+ * SDK initialization, version info and the default clocks.
  * 
  * @version 1.0.0
  */
 
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include "embedded32.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define E32_HAVE_POSIX_CLOCK 1
+#endif
+
 #define E32_VERSION "1.0.0"
 
 const char* e32_get_version(void)
@@ -35,3 +46,38 @@ void e32_deinit(void)
      * Platform-specific cleanup would go here.
      */
 }
+
+uint32_t e32_time_ms(void)
+{
+#if defined(_WIN32)
+    return (uint32_t)GetTickCount();
+#elif defined(E32_HAVE_POSIX_CLOCK)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000u + (uint32_t)(ts.tv_nsec / 1000000);
+#else
+    /* No portable clock on bare metal: set e32_j1939_config_t.clock_ms */
+    return 0;
+#endif
+}
+
+uint32_t e32_time_us(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&now);
+    return (uint32_t)((now.QuadPart / freq.QuadPart) * 1000000 +
+                      (now.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
+#elif defined(E32_HAVE_POSIX_CLOCK)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000u + (uint32_t)(ts.tv_nsec / 1000);
+#else
+    /* Set e32_j1939_config_t.clock_us (e.g. to a free-running timer) */
+    return 0;
+#endif
+}
@@ -0,0 +1,273 @@
+/**
+ * @file e32_cyclic.c
+ * @brief Embedded32 SDK - Cyclic PGN Scheduler Implementation
+ *
+ * Slot lists are singly linked through 16-bit entry indices. A tick
+ * detaches a whole slot before calling any provider, so providers may
+ * add or remove PGNs (including their own) while the wheel is turning.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_cyclic.h"
+#include <string.h>
+
+/* Wrap-safe "a is at or before b" on the millisecond clock */
+#define TIME_REACHED(a, b)  ((int32_t)((b) - (a)) >= 0)
+
+static int find_entry(const e32_cyclic_t* sched, uint32_t pgn)
+{
+    for (int i = 0; i < E32_CFG_CYCLIC_MAX; i++) {
+        const e32_cyclic_entry_t* e = &sched->entries[i];
+        if (e->state != E32_CYCLIC_FREE && !e->removed && e->pgn == pgn) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void link_entry(e32_cyclic_t* sched, uint16_t index)
+{
+    e32_cyclic_entry_t* e = &sched->entries[index];
+    uint16_t* slot = &sched->wheel[e->due & E32_CYCLIC_MASK];
+
+    e->next = *slot;
+    *slot = index;
+    e->state = E32_CYCLIC_LINKED;
+}
+
+static void unlink_entry(e32_cyclic_t* sched, uint16_t index)
+{
+    uint16_t* link = &sched->wheel[sched->entries[index].due & E32_CYCLIC_MASK];
+
+    while (*link != E32_CYCLIC_NONE) {
+        if (*link == index) {
+            *link = sched->entries[index].next;
+            break;
+        }
+        link = &sched->entries[*link].next;
+    }
+    sched->entries[index].next = E32_CYCLIC_NONE;
+}
+
+/**
+ * First millisecond a newly (re)scheduled entry can still be picked up.
+ * Starts the wheel if this is the first entry.
+ */
+static uint32_t first_due(e32_cyclic_t* sched, uint32_t now)
+{
+    if (!sched->started) {
+        sched->started = true;
+        sched->last_tick = now - 1;
+    }
+    if (!TIME_REACHED(sched->last_tick + 1, now)) {
+        return sched->last_tick + 1;
+    }
+    return now;
+}
+
+void e32_cyclic_init(e32_cyclic_t* sched)
+{
+    memset(sched, 0, sizeof(*sched));
+
+    for (int i = 0; i < E32_CFG_CYCLIC_WHEEL_SLOTS; i++) {
+        sched->wheel[i] = E32_CYCLIC_NONE;
+    }
+}
+
+e32_error_t e32_cyclic_add(e32_cyclic_t* sched, uint8_t channel, uint32_t pgn, uint32_t period_ms,
+                           uint8_t priority, uint8_t destination,
+                           e32_cyclic_provider_t provider, void* user_data,
+                           uint32_t now)
+{
+    int index = find_entry(sched, pgn);
+
+    if (index < 0) {
+        for (int i = 0; i < E32_CFG_CYCLIC_MAX; i++) {
+            if (sched->entries[i].state == E32_CYCLIC_FREE) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            return E32_ERR_NO_MEMORY;
+        }
+
+        e32_cyclic_entry_t* e = &sched->entries[index];
+        memset(e, 0, sizeof(*e));
+        e->pgn = pgn;
+        e->len = E32_CAN_CLASSIC_DATA_LEN;
+        e->stats.min_interval_ms = UINT32_MAX;
+    } else if (sched->entries[index].state == E32_CYCLIC_LINKED) {
+        unlink_entry(sched, (uint16_t)index);
+    }
+
+    e32_cyclic_entry_t* e = &sched->entries[index];
+    e->period = period_ms;
+    e->priority = priority;
+    e->destination = destination;
+    e->channel = channel;
+    e->provider = provider;
+    e->user_data = user_data;
+    e->stats.period_ms = period_ms;
+
+    /* A RUNNING entry is rescheduled with the new period when its tick finishes */
+    if (e->state != E32_CYCLIC_RUNNING) {
+        e->due = first_due(sched, now);
+        link_entry(sched, (uint16_t)index);
+    }
+    return E32_OK;
+}
+
+e32_error_t e32_cyclic_remove(e32_cyclic_t* sched, uint32_t pgn)
+{
+    int index = find_entry(sched, pgn);
+    if (index < 0) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    e32_cyclic_entry_t* e = &sched->entries[index];
+    if (e->state == E32_CYCLIC_RUNNING) {
+        e->removed = true;      /* Freed by the tick that holds it */
+    } else {
+        unlink_entry(sched, (uint16_t)index);
+        e->state = E32_CYCLIC_FREE;
+    }
+    return E32_OK;
+}
+
+/**
+ * Called after stats.sent has been incremented; the first transmission
+ * has no interval.
+ */
+static void record_interval(e32_cyclic_entry_t* e, uint32_t now)
+{
+    e32_cyclic_stats_t* st = &e->stats;
+
+    if (e->has_sent) {
+        uint32_t interval = now - e->last_sent;
+        uint32_t jitter = (interval > e->period) ? interval - e->period : e->period - interval;
+
+        st->last_interval_ms = interval;
+        if (interval < st->min_interval_ms) st->min_interval_ms = interval;
+        if (interval > st->max_interval_ms) st->max_interval_ms = interval;
+        if (jitter > st->max_jitter_ms) st->max_jitter_ms = jitter;
+
+        e->jitter_sum += jitter;
+        st->mean_jitter_us = (uint32_t)((e->jitter_sum * 1000u) / (st->sent - 1));
+    }
+
+    e->has_sent = true;
+    e->last_sent = now;
+}
+
+static void fire(e32_cyclic_entry_t* e, uint32_t now, e32_cyclic_send_fn_t send, void* ctx)
+{
+    uint8_t len = e->len;
+
+    if (!e->provider(e->pgn, e->data, &len, e->user_data) ||
+        len == 0 || len > E32_CAN_MAX_DATA_LEN) {
+        e->stats.skipped++;
+        return;
+    }
+
+    e->len = len;
+    if (send(ctx, e) != E32_OK) {
+        e->stats.skipped++;
+        return;
+    }
+
+    e->stats.sent++;
+    record_interval(e, now);
+}
+
+static void run_slot(e32_cyclic_t* sched, uint32_t slot, uint32_t now,
+                     e32_cyclic_send_fn_t send, void* ctx)
+{
+    uint16_t list = sched->wheel[slot];
+    sched->wheel[slot] = E32_CYCLIC_NONE;
+
+    for (uint16_t i = list; i != E32_CYCLIC_NONE; i = sched->entries[i].next) {
+        sched->entries[i].state = E32_CYCLIC_RUNNING;
+    }
+
+    uint16_t i = list;
+    while (i != E32_CYCLIC_NONE) {
+        e32_cyclic_entry_t* e = &sched->entries[i];
+        uint16_t next = e->next;
+
+        if (!e->removed && TIME_REACHED(e->due, now)) {
+            fire(e, now, send, ctx);
+
+            /* Stay phase-locked; count whole periods lost to a late tick */
+            uint32_t lost = (now - e->due) / e->period;
+            e->stats.missed += lost;
+            e->due += e->period * (lost + 1);
+        }
+
+        if (e->removed) {
+            e->removed = false;
+            e->state = E32_CYCLIC_FREE;
+        } else {
+            link_entry(sched, i);   /* Due in a later turn of the wheel, or rescheduled */
+        }
+        i = next;
+    }
+}
+
+void e32_cyclic_run(e32_cyclic_t* sched, uint32_t now,
+                    e32_cyclic_send_fn_t send, void* ctx)
+{
+    if (!sched->started) {
+        sched->started = true;
+        sched->last_tick = now - 1;
+    }
+
+    if (TIME_REACHED(now, sched->last_tick)) {
+        return;     /* Already processed this millisecond */
+    }
+
+    /* After a long stall every slot is visited once, ending at now */
+    uint32_t ticks = now - sched->last_tick;
+    if (ticks > E32_CFG_CYCLIC_WHEEL_SLOTS) {
+        ticks = E32_CFG_CYCLIC_WHEEL_SLOTS;
+    }
+
+    for (uint32_t t = now - ticks + 1; ; t++) {
+        sched->last_tick = t;
+        run_slot(sched, t & E32_CYCLIC_MASK, now, send, ctx);
+        if (t == now) {
+            break;
+        }
+    }
+}
+
+uint32_t e32_cyclic_next_timeout(const e32_cyclic_t* sched, uint32_t now)
+{
+    uint32_t next = UINT32_MAX;
+
+    for (int i = 0; i < E32_CFG_CYCLIC_MAX; i++) {
+        const e32_cyclic_entry_t* e = &sched->entries[i];
+        if (e->state != E32_CYCLIC_LINKED) continue;
+
+        int32_t left = (int32_t)(e->due - now);
+        uint32_t t = (left > 0) ? (uint32_t)left : 0;
+        if (t < next) next = t;
+    }
+    return next;
+}
+
+e32_error_t e32_cyclic_get_stats(const e32_cyclic_t* sched, uint32_t pgn,
+                                 e32_cyclic_stats_t* stats)
+{
+    int index = find_entry(sched, pgn);
+    if (index < 0) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    *stats = sched->entries[index].stats;
+    if (stats->min_interval_ms == UINT32_MAX) {
+        stats->min_interval_ms = 0;
+    }
+    return E32_OK;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file e32_cyclic.h
+ * @brief Embedded32 SDK - Cyclic PGN Scheduler (internal)
+ *
+ * Hashed timer wheel with one slot per millisecond. Each registered PGN
+ * sits in the slot of its next due time; a tick visits only the slots
+ * whose millisecond has passed since the previous tick, so the work per
+ * tick depends on how many PGNs are due, not on how many exist.
+ *
+ * Transmissions stay phase-locked to the first one: the next due time is
+ * the previous due time plus the period, not the time the frame was
+ * actually sent, so a late poll does not shift every later cycle. If
+ * whole periods are lost in a stall they are counted as missed and the
+ * schedule skips ahead instead of sending a burst of catch-up frames.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_CYCLIC_H
+#define E32_CYCLIC_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define E32_CYCLIC_NONE     0xFFFF
+#define E32_CYCLIC_MASK     (E32_CFG_CYCLIC_WHEEL_SLOTS - 1)
+
+/**
+ * @brief Entry state
+ */
+typedef enum {
+    E32_CYCLIC_FREE = 0,
+    E32_CYCLIC_LINKED,      /**< Waiting in its wheel slot */
+    E32_CYCLIC_RUNNING      /**< Taken out of the wheel by the current tick */
+} e32_cyclic_state_t;
+
+/**
+ * @brief One cyclic PGN
+ */
+typedef struct {
+    uint8_t               state;        /**< e32_cyclic_state_t */
+    bool                  removed;      /**< Removed while RUNNING */
+    uint8_t               priority;
+    uint8_t               destination;
+    uint8_t               channel;      /**< Bus it is published on */
+    uint8_t               len;          /**< Length of the last payload */
+    uint8_t               data[E32_CAN_MAX_DATA_LEN];
+    uint16_t              next;         /**< Next entry in the same slot */
+    uint32_t              pgn;
+    uint32_t              period;       /**< ms */
+    uint32_t              due;          /**< Next due time, ms */
+    uint32_t              last_sent;    /**< Time of the last transmission */
+    bool                  has_sent;
+    e32_cyclic_provider_t provider;
+    void*                 user_data;
+    e32_cyclic_stats_t    stats;
+    uint64_t              jitter_sum;   /**< Sum of jitter, ms */
+} e32_cyclic_entry_t;
+
+/**
+ * @brief Puts one due frame on the transmit path
+ */
+typedef e32_error_t (*e32_cyclic_send_fn_t)(void* ctx, const e32_cyclic_entry_t* entry);
+
+/**
+ * @brief Scheduler state
+ */
+typedef struct {
+    e32_cyclic_entry_t entries[E32_CFG_CYCLIC_MAX];
+    uint16_t           wheel[E32_CFG_CYCLIC_WHEEL_SLOTS];
+    uint32_t           last_tick;   /**< Last millisecond processed */
+    bool               started;
+} e32_cyclic_t;
+
+/**
+ * @brief Reset the scheduler, dropping every entry
+ */
+void e32_cyclic_init(e32_cyclic_t* sched);
+
+/**
+ * @brief Register a PGN, or change the settings of a registered one
+ *
+ * The first transmission is due at the next tick. A PGN is published on
+ * one channel; registering it again may move it to another.
+ *
+ * @return E32_OK, E32_ERR_NO_MEMORY if all entries are in use
+ */
+e32_error_t e32_cyclic_add(e32_cyclic_t* sched, uint8_t channel, uint32_t pgn, uint32_t period_ms,
+                           uint8_t priority, uint8_t destination,
+                           e32_cyclic_provider_t provider, void* user_data,
+                           uint32_t now);
+
+/**
+ * @brief Stop publishing a PGN
+ *
+ * @return E32_OK, E32_ERR_NOT_FOUND if it was not registered
+ */
+e32_error_t e32_cyclic_remove(e32_cyclic_t* sched, uint32_t pgn);
+
+/**
+ * @brief Send everything due at or before now
+ */
+void e32_cyclic_run(e32_cyclic_t* sched, uint32_t now,
+                    e32_cyclic_send_fn_t send, void* ctx);
+
+/**
+ * @brief Milliseconds until the next entry is due
+ *
+ * @return 0 if one is due now, UINT32_MAX when nothing is scheduled
+ */
+uint32_t e32_cyclic_next_timeout(const e32_cyclic_t* sched, uint32_t now);
+
+/**
+ * @brief Copy the statistics of a registered PGN
+ *
+ * @return E32_OK, E32_ERR_NOT_FOUND if it is not registered
+ */
+e32_error_t e32_cyclic_get_stats(const e32_cyclic_t* sched, uint32_t pgn,
+                                 e32_cyclic_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_CYCLIC_H */
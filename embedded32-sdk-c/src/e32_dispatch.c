@@ -0,0 +1,580 @@
+/**
+ * @file e32_dispatch.c
+ * @brief Embedded32 SDK - PGN Dispatch Table Implementation
+ *
+ * Linear-probing hash of PGN -> handler chain. The table never holds
+ * more distinct PGNs than nodes, and has at least twice as many buckets
+ * as nodes, so probe sequences stay short. Deletion uses backward-shift
+ * so no tombstones accumulate.
+ *
+ * Delivery histories of gated subscriptions live in a second linear-
+ * probing table keyed by (gate, sender, PGN), with the same deletion
+ * scheme.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_dispatch.h"
+#include <string.h>
+
+#define BUCKET_MASK     (E32_CFG_DISPATCH_BUCKETS - 1)
+#define STATE_MASK      (E32_CFG_GATE_STATES - 1)
+
+/* ==========================================================================
+ * HASHING
+ * ========================================================================== */
+
+static inline uint32_t pgn_hash(uint32_t pgn)
+{
+    /* Fibonacci hashing spreads the clustered PGN values evenly */
+    return (pgn * 2654435761u) >> 13;
+}
+
+static int find_bucket(const e32_dispatch_table_t* table, uint32_t pgn)
+{
+    uint32_t i = pgn_hash(pgn) & BUCKET_MASK;
+
+    while (table->buckets[i].head != E32_DISPATCH_NIL) {
+        if (table->buckets[i].pgn == pgn) {
+            return (int)i;
+        }
+        i = (i + 1) & BUCKET_MASK;
+    }
+    return -1;
+}
+
+static void release_bucket(e32_dispatch_table_t* table, uint32_t hole)
+{
+    /* Backward-shift deletion: pull later entries of the probe run into the hole */
+    uint32_t i = hole;
+
+    for (;;) {
+        i = (i + 1) & BUCKET_MASK;
+        if (table->buckets[i].head == E32_DISPATCH_NIL) {
+            break;
+        }
+
+        uint32_t home = pgn_hash(table->buckets[i].pgn) & BUCKET_MASK;
+        uint32_t dist_i = (i - home) & BUCKET_MASK;
+        uint32_t dist_hole = (hole - home) & BUCKET_MASK;
+
+        if (dist_hole < dist_i) {
+            table->buckets[hole] = table->buckets[i];
+            hole = i;
+        }
+    }
+
+    table->buckets[hole].head = E32_DISPATCH_NIL;
+    table->buckets[hole].tail = E32_DISPATCH_NIL;
+    table->buckets[hole].kinds = 0;
+}
+
+/* ==========================================================================
+ * GATE HISTORIES
+ * ========================================================================== */
+
+static inline uint32_t state_hash(uint32_t key)
+{
+    return (key * 2654435761u) >> 16;
+}
+
+static uint32_t gate_key(uint8_t gate, const e32_j1939_view_t* view)
+{
+    return ((uint32_t)gate << 26) | ((uint32_t)view->source_address << 18) | (view->pgn & 0x3FFFF);
+}
+
+/* Find the history for key, adding it if there is room; NULL when full */
+static e32_dispatch_gate_state_t* find_state(e32_dispatch_table_t* table, uint32_t key)
+{
+    uint32_t i = state_hash(key) & STATE_MASK;
+
+    while (table->states[i].key != E32_DISPATCH_GATE_FREE) {
+        if (table->states[i].key == key) {
+            return &table->states[i];
+        }
+        i = (i + 1) & STATE_MASK;
+    }
+
+    /* Keep one slot free so every probe run ends */
+    if (table->state_count >= E32_CFG_GATE_STATES - 1) {
+        return NULL;
+    }
+
+    e32_dispatch_gate_state_t* state = &table->states[i];
+    memset(state, 0, sizeof(*state));
+    state->key = key;
+    table->state_count++;
+    return state;
+}
+
+static void release_state(e32_dispatch_table_t* table, uint32_t hole)
+{
+    uint32_t i = hole;
+
+    for (;;) {
+        i = (i + 1) & STATE_MASK;
+        if (table->states[i].key == E32_DISPATCH_GATE_FREE) {
+            break;
+        }
+
+        uint32_t home = state_hash(table->states[i].key) & STATE_MASK;
+        if (((hole - home) & STATE_MASK) < ((i - home) & STATE_MASK)) {
+            table->states[hole] = table->states[i];
+            hole = i;
+        }
+    }
+
+    table->states[hole].key = E32_DISPATCH_GATE_FREE;
+    table->state_count--;
+}
+
+/* Drop a gate and every history it owns */
+static void release_gate(e32_dispatch_table_t* table, uint8_t gate)
+{
+    for (uint32_t i = 0; i < E32_CFG_GATE_STATES; ) {
+        uint32_t key = table->states[i].key;
+        if (key != E32_DISPATCH_GATE_FREE && (key >> 26) == gate) {
+            release_state(table, i);    /* Re-check i: a later entry may have moved in */
+        } else {
+            i++;
+        }
+    }
+    table->gates_used &= ~((uint32_t)1 << gate);
+}
+
+/* Last-delivered signature: the bytes themselves, or FNV-1a of a long payload */
+static void payload_signature(const e32_j1939_view_t* view, uint8_t out[8])
+{
+    if (view->len <= 8) {
+        memset(out, 0, 8);
+        memcpy(out, view->data, view->len);
+        return;
+    }
+
+    uint32_t h = 2166136261u;
+    for (uint16_t i = 0; i < view->len; i++) {
+        h = (h ^ view->data[i]) * 16777619u;
+    }
+    memset(out, 0, 8);
+    memcpy(out, &h, sizeof(h));
+}
+
+static bool gate_passes(e32_dispatch_table_t* table, uint8_t gate,
+                        const e32_j1939_view_t* view, uint32_t now)
+{
+    const e32_sub_options_t* options = &table->gates[gate];
+    e32_dispatch_gate_state_t* state = find_state(table, gate_key(gate, view));
+
+    if (!state) {
+        return true;    /* No room to remember this sender: deliver unfiltered */
+    }
+
+    if (options->decimate > 1) {
+        bool sample = (state->count == 0);
+        state->count = (uint16_t)((state->count + 1) % options->decimate);
+        if (!sample) {
+            return false;
+        }
+    }
+
+    if (options->min_interval_ms && state->delivered &&
+        (uint32_t)(now - state->last_time) < options->min_interval_ms) {
+        return false;
+    }
+
+    uint8_t signature[8];
+    payload_signature(view, signature);
+    if ((options->flags & E32_SUB_ON_CHANGE) && state->delivered &&
+        state->len == view->len && memcmp(state->data, signature, 8) == 0) {
+        return false;
+    }
+
+    state->delivered = true;
+    state->last_time = now;
+    state->len = view->len;
+    memcpy(state->data, signature, 8);
+    return true;
+}
+
+/* ==========================================================================
+ * NODE POOL
+ * ========================================================================== */
+
+static uint16_t alloc_node(e32_dispatch_table_t* table)
+{
+    uint16_t idx = table->free_head;
+    if (idx != E32_DISPATCH_NIL) {
+        table->free_head = table->nodes[idx].next;
+        table->nodes[idx].next = E32_DISPATCH_NIL;
+    }
+    return idx;
+}
+
+static void free_node(e32_dispatch_table_t* table, uint16_t idx)
+{
+    if (table->nodes[idx].gate != E32_DISPATCH_NO_GATE) {
+        release_gate(table, table->nodes[idx].gate);
+        table->nodes[idx].gate = E32_DISPATCH_NO_GATE;
+    }
+    table->nodes[idx].handler = NULL;
+    table->nodes[idx].view_handler = NULL;
+    table->nodes[idx].user_data = NULL;
+    table->nodes[idx].next = table->free_head;
+    if (++table->nodes[idx].generation == 0) {
+        table->nodes[idx].generation = 1;   /* Handles are never 0 */
+    }
+    table->free_head = idx;
+}
+
+/**
+ * Unlink every node of a chain matching [first, last], or only node
+ * only when it is not E32_DISPATCH_NIL. Returns the number of nodes
+ * removed and updates head/tail in place.
+ */
+static int remove_from_chain(
+    e32_dispatch_table_t* table,
+    uint16_t* head,
+    uint16_t* tail,
+    uint32_t first,
+    uint32_t last,
+    uint16_t only
+)
+{
+    int removed = 0;
+    uint16_t prev = E32_DISPATCH_NIL;
+    uint16_t idx = *head;
+
+    while (idx != E32_DISPATCH_NIL) {
+        e32_dispatch_node_t* node = &table->nodes[idx];
+        uint16_t next = node->next;
+
+        if (node->pgn_first == first && node->pgn_last == last &&
+            (only == E32_DISPATCH_NIL || only == idx)) {
+            if (prev == E32_DISPATCH_NIL) {
+                *head = next;
+            } else {
+                table->nodes[prev].next = next;
+            }
+            if (*tail == idx) {
+                *tail = prev;
+            }
+            free_node(table, idx);
+            removed++;
+        } else {
+            prev = idx;
+        }
+        idx = next;
+    }
+
+    return removed;
+}
+
+/* ==========================================================================
+ * PUBLIC (INTERNAL) API
+ * ========================================================================== */
+
+void e32_dispatch_init(e32_dispatch_table_t* table)
+{
+    memset(table, 0, sizeof(*table));
+
+    for (uint32_t i = 0; i < E32_CFG_DISPATCH_BUCKETS; i++) {
+        table->buckets[i].head = E32_DISPATCH_NIL;
+        table->buckets[i].tail = E32_DISPATCH_NIL;
+    }
+
+    for (uint16_t i = 0; i < E32_CFG_MAX_SUBSCRIPTIONS; i++) {
+        table->nodes[i].next = (i + 1 < E32_CFG_MAX_SUBSCRIPTIONS) ? (uint16_t)(i + 1) : E32_DISPATCH_NIL;
+        table->nodes[i].generation = 1;
+        table->nodes[i].gate = E32_DISPATCH_NO_GATE;
+    }
+
+    for (uint32_t i = 0; i < E32_CFG_GATE_STATES; i++) {
+        table->states[i].key = E32_DISPATCH_GATE_FREE;
+    }
+
+    table->free_head = 0;
+    table->range_head = E32_DISPATCH_NIL;
+    table->range_tail = E32_DISPATCH_NIL;
+    table->count = 0;
+}
+
+static e32_error_t add_node(
+    e32_dispatch_table_t* table,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_pgn_handler_t handler,
+    e32_view_handler_t view_handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    uint32_t* handle
+)
+{
+    if (pgn_first > pgn_last) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    /* Options that filter nothing need no gate */
+    uint8_t gate = E32_DISPATCH_NO_GATE;
+    if (options && (options->flags || options->decimate > 1 || options->min_interval_ms)) {
+        for (uint8_t g = 0; g < E32_CFG_GATED_SUBS_MAX; g++) {
+            if (!(table->gates_used & ((uint32_t)1 << g))) {
+                gate = g;
+                break;
+            }
+        }
+        if (gate == E32_DISPATCH_NO_GATE) {
+            return E32_ERR_NO_MEMORY;
+        }
+    }
+
+    uint16_t idx = alloc_node(table);
+    if (idx == E32_DISPATCH_NIL) {
+        return E32_ERR_NO_MEMORY;
+    }
+
+    if (gate != E32_DISPATCH_NO_GATE) {
+        table->gates[gate] = *options;
+        table->gates_used |= (uint32_t)1 << gate;
+    }
+
+    e32_dispatch_node_t* node = &table->nodes[idx];
+    node->pgn_first = pgn_first;
+    node->pgn_last = pgn_last;
+    node->handler = handler;
+    node->view_handler = view_handler;
+    node->user_data = user_data;
+    node->next = E32_DISPATCH_NIL;
+    node->gate = gate;
+
+    uint16_t* head;
+    uint16_t* tail;
+
+    if (pgn_first != pgn_last) {
+        head = &table->range_head;
+        tail = &table->range_tail;
+    } else {
+        int b = find_bucket(table, pgn_first);
+        if (b < 0) {
+            /* Claim the first empty bucket on the probe sequence */
+            uint32_t i = pgn_hash(pgn_first) & BUCKET_MASK;
+            while (table->buckets[i].head != E32_DISPATCH_NIL) {
+                i = (i + 1) & BUCKET_MASK;
+            }
+            table->buckets[i].pgn = pgn_first;
+            b = (int)i;
+        }
+        table->buckets[b].kinds |= handler ? E32_DISPATCH_WANT_MESSAGE : E32_DISPATCH_WANT_VIEW;
+        head = &table->buckets[b].head;
+        tail = &table->buckets[b].tail;
+    }
+
+    if (*head == E32_DISPATCH_NIL) {
+        *head = idx;
+    } else {
+        table->nodes[*tail].next = idx;
+    }
+    *tail = idx;
+
+    table->count++;
+    *handle = E32_DISPATCH_HANDLE(idx, node->generation);
+    return E32_OK;
+}
+
+e32_error_t e32_dispatch_add(
+    e32_dispatch_table_t* table,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_pgn_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    uint32_t* handle
+)
+{
+    if (!handler) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    return add_node(table, pgn_first, pgn_last, handler, NULL, user_data, options, handle);
+}
+
+e32_error_t e32_dispatch_add_view(
+    e32_dispatch_table_t* table,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_view_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    uint32_t* handle
+)
+{
+    if (!handler) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    return add_node(table, pgn_first, pgn_last, NULL, handler, user_data, options, handle);
+}
+
+static uint8_t node_kind(const e32_dispatch_node_t* node)
+{
+    if (node->handler) return E32_DISPATCH_WANT_MESSAGE;
+    if (node->view_handler) return E32_DISPATCH_WANT_VIEW;
+    return 0;
+}
+
+/* Remove the nodes of [first, last] (or only that one) from their chain */
+static int remove_nodes(e32_dispatch_table_t* table, uint32_t first, uint32_t last, uint16_t only)
+{
+    int removed;
+
+    if (first != last) {
+        removed = remove_from_chain(table, &table->range_head, &table->range_tail,
+                                    first, last, only);
+    } else {
+        int b = find_bucket(table, first);
+        if (b < 0) {
+            return 0;
+        }
+
+        e32_dispatch_bucket_t* bucket = &table->buckets[b];
+        removed = remove_from_chain(table, &bucket->head, &bucket->tail, first, last, only);
+        if (bucket->head == E32_DISPATCH_NIL) {
+            release_bucket(table, (uint32_t)b);
+        } else {
+            /* Some handlers stay: the kinds are those of the survivors */
+            bucket->kinds = 0;
+            for (uint16_t i = bucket->head; i != E32_DISPATCH_NIL; i = table->nodes[i].next) {
+                bucket->kinds |= node_kind(&table->nodes[i]);
+            }
+        }
+    }
+
+    table->count -= (uint16_t)removed;
+    return removed;
+}
+
+int e32_dispatch_remove(e32_dispatch_table_t* table, uint32_t pgn_first, uint32_t pgn_last)
+{
+    return remove_nodes(table, pgn_first, pgn_last, E32_DISPATCH_NIL);
+}
+
+bool e32_dispatch_remove_handle(e32_dispatch_table_t* table, uint32_t handle)
+{
+    uint16_t idx = (uint16_t)(handle & 0xFFFF);
+    if (idx >= E32_CFG_MAX_SUBSCRIPTIONS) {
+        return false;
+    }
+
+    const e32_dispatch_node_t* node = &table->nodes[idx];
+    if (node->generation != (uint16_t)(handle >> 16) || node_kind(node) == 0) {
+        return false;
+    }
+    return remove_nodes(table, node->pgn_first, node->pgn_last, idx) > 0;
+}
+
+uint16_t e32_dispatch_lookup(const e32_dispatch_table_t* table, uint32_t pgn)
+{
+    int b = find_bucket(table, pgn);
+    return (b < 0) ? E32_DISPATCH_NIL : table->buckets[b].head;
+}
+
+uint8_t e32_dispatch_wants(const e32_dispatch_table_t* table, uint32_t pgn)
+{
+    int b = find_bucket(table, pgn);
+    uint8_t wants = (b < 0) ? 0 : table->buckets[b].kinds;
+
+    for (uint16_t i = table->range_head; i != E32_DISPATCH_NIL; i = table->nodes[i].next) {
+        if (pgn >= table->nodes[i].pgn_first && pgn <= table->nodes[i].pgn_last) {
+            wants |= node_kind(&table->nodes[i]);
+        }
+    }
+    return wants;
+}
+
+/* Kind of node, after its gate (if any) has been consulted */
+static uint8_t gated_kind(e32_dispatch_table_t* table, const e32_dispatch_node_t* node,
+                          const e32_j1939_view_t* view, uint32_t now, uint32_t* pass)
+{
+    if (node->gate != E32_DISPATCH_NO_GATE) {
+        if (!gate_passes(table, node->gate, view, now)) {
+            return 0;
+        }
+        *pass |= (uint32_t)1 << node->gate;
+    }
+    return node_kind(node);
+}
+
+uint8_t e32_dispatch_gate(
+    e32_dispatch_table_t* table,
+    const e32_j1939_view_t* view,
+    uint32_t now,
+    uint32_t* pass
+)
+{
+    uint8_t wants = 0;
+    uint32_t pgn = view->pgn;
+
+    *pass = 0;
+
+    for (uint16_t i = e32_dispatch_lookup(table, pgn); i != E32_DISPATCH_NIL; i = table->nodes[i].next) {
+        wants |= gated_kind(table, &table->nodes[i], view, now, pass);
+    }
+
+    for (uint16_t i = table->range_head; i != E32_DISPATCH_NIL; i = table->nodes[i].next) {
+        const e32_dispatch_node_t* node = &table->nodes[i];
+        if (pgn >= node->pgn_first && pgn <= node->pgn_last) {
+            wants |= gated_kind(table, node, view, now, pass);
+        }
+    }
+    return wants;
+}
+
+static int call_node(
+    const e32_dispatch_node_t* node,
+    const e32_j1939_view_t* view,
+    const e32_j1939_message_t* message,
+    uint32_t pass
+)
+{
+    if (node->gate != E32_DISPATCH_NO_GATE && !(pass & ((uint32_t)1 << node->gate))) {
+        return 0;
+    }
+    if (node->view_handler) {
+        node->view_handler(view, node->user_data);
+        return 1;
+    }
+    if (node->handler && message) {
+        node->handler(message, node->user_data);
+        return 1;
+    }
+    return 0;
+}
+
+int e32_dispatch_invoke(
+    const e32_dispatch_table_t* table,
+    const e32_j1939_view_t* view,
+    const e32_j1939_message_t* message,
+    uint32_t pass
+)
+{
+    int invoked = 0;
+    uint32_t pgn = view->pgn;
+
+    /* Capture next before calling so a handler may unsubscribe itself */
+    uint16_t i = e32_dispatch_lookup(table, pgn);
+    while (i != E32_DISPATCH_NIL) {
+        const e32_dispatch_node_t* node = &table->nodes[i];
+        uint16_t next = node->next;
+        invoked += call_node(node, view, message, pass);
+        i = next;
+    }
+
+    i = table->range_head;
+    while (i != E32_DISPATCH_NIL) {
+        const e32_dispatch_node_t* node = &table->nodes[i];
+        uint16_t next = node->next;
+        if (pgn >= node->pgn_first && pgn <= node->pgn_last) {
+            invoked += call_node(node, view, message, pass);
+        }
+        i = next;
+    }
+
+    return invoked;
+}
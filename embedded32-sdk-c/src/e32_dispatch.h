@@ -0,0 +1,203 @@
+/**
+ * @file e32_dispatch.h
+ * @brief Embedded32 SDK - PGN Dispatch Table (internal)
+ *
+ * PGN-indexed subscription table used by the client to route received
+ * messages to handlers. Exact-PGN subscriptions are found through an
+ * open-addressed hash of PGN -> handler chain, so a lookup costs the
+ * same regardless of how many handlers are registered. Range and
+ * wildcard subscriptions live on their own chain, which only links
+ * active entries.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_DISPATCH_H
+#define E32_DISPATCH_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Chain terminator / empty bucket marker */
+#define E32_DISPATCH_NIL    0xFFFF
+
+/** Node without delivery options */
+#define E32_DISPATCH_NO_GATE    0xFF
+
+/** Free e32_dispatch_gate_state_t */
+#define E32_DISPATCH_GATE_FREE  0xFFFFFFFFu
+
+/** Handle of node idx in its current generation; never 0 */
+#define E32_DISPATCH_HANDLE(idx, generation)   (((uint32_t)(generation) << 16) | (idx))
+
+/** e32_dispatch_wants() result bits */
+#define E32_DISPATCH_WANT_MESSAGE   0x01    /**< A decoded-message handler matches */
+#define E32_DISPATCH_WANT_VIEW      0x02    /**< A zero-copy view handler matches */
+
+/**
+ * @brief One subscription (exact PGN when pgn_first == pgn_last)
+ *
+ * Exactly one of handler / view_handler is set on an active node.
+ */
+typedef struct {
+    uint32_t            pgn_first;  /**< First PGN matched */
+    uint32_t            pgn_last;   /**< Last PGN matched (inclusive) */
+    e32_pgn_handler_t   handler;    /**< Decoded-message callback */
+    e32_view_handler_t  view_handler; /**< Zero-copy callback */
+    void*               user_data;  /**< User context */
+    uint16_t            next;       /**< Next node in chain or free list */
+    uint16_t            generation; /**< Bumped when the node is freed, so old handles miss */
+    uint8_t             gate;       /**< Index in gates[], E32_DISPATCH_NO_GATE if unconditional */
+} e32_dispatch_node_t;
+
+/**
+ * @brief Delivery history of one gated subscription for one sender and PGN
+ */
+typedef struct {
+    uint32_t key;                   /**< gate << 26 | SA << 18 | PGN, E32_DISPATCH_GATE_FREE */
+    uint32_t last_time;             /**< Time of the last delivery, ms */
+    uint16_t count;                 /**< Messages since the last decimated sample */
+    uint16_t len;                   /**< Length of the last delivered payload */
+    uint8_t  data[8];               /**< Its bytes, or a hash when longer than 8 */
+    bool     delivered;             /**< Anything delivered yet */
+} e32_dispatch_gate_state_t;
+
+/**
+ * @brief Hash bucket: one PGN and its handler chain
+ */
+typedef struct {
+    uint32_t pgn;                   /**< PGN owning this bucket */
+    uint16_t head;                  /**< First node, E32_DISPATCH_NIL if empty */
+    uint16_t tail;                  /**< Last node (for in-order append) */
+    uint8_t  kinds;                 /**< E32_DISPATCH_WANT_* bits of the chain */
+} e32_dispatch_bucket_t;
+
+/**
+ * @brief Dispatch table
+ */
+typedef struct {
+    e32_dispatch_node_t   nodes[E32_CFG_MAX_SUBSCRIPTIONS];
+    e32_dispatch_bucket_t buckets[E32_CFG_DISPATCH_BUCKETS];
+    uint16_t              free_head;    /**< Free node list */
+    uint16_t              range_head;   /**< Range/wildcard chain */
+    uint16_t              range_tail;
+    uint16_t              count;        /**< Active subscriptions */
+    e32_sub_options_t     gates[E32_CFG_GATED_SUBS_MAX];
+    uint32_t              gates_used;   /**< Bit per gates[] entry */
+    e32_dispatch_gate_state_t states[E32_CFG_GATE_STATES];
+    uint16_t              state_count;
+} e32_dispatch_table_t;
+
+/**
+ * @brief Reset the table to empty
+ */
+void e32_dispatch_init(e32_dispatch_table_t* table);
+
+/**
+ * @brief Add a subscription for [pgn_first, pgn_last]
+ *
+ * Handlers on the same PGN are invoked in registration order. options
+ * may be NULL; otherwise the node only sees messages that pass them.
+ *
+ * @param handle Receives the handle for e32_dispatch_remove_handle()
+ * @return E32_OK, or E32_ERR_NO_MEMORY when the node pool (or, with
+ *         options, the gate table) is exhausted
+ */
+e32_error_t e32_dispatch_add(
+    e32_dispatch_table_t* table,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_pgn_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    uint32_t* handle
+);
+
+/**
+ * @brief Add a zero-copy view subscription for [pgn_first, pgn_last]
+ *
+ * Shares the node pool and ordering rules of e32_dispatch_add().
+ */
+e32_error_t e32_dispatch_add_view(
+    e32_dispatch_table_t* table,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_view_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    uint32_t* handle
+);
+
+/**
+ * @brief Remove every subscription registered for exactly [pgn_first, pgn_last]
+ *
+ * @return Number of subscriptions removed
+ */
+int e32_dispatch_remove(e32_dispatch_table_t* table, uint32_t pgn_first, uint32_t pgn_last);
+
+/**
+ * @brief Remove the one subscription a handle from e32_dispatch_add() names
+ *
+ * @return false if it was already removed (or never existed)
+ */
+bool e32_dispatch_remove_handle(e32_dispatch_table_t* table, uint32_t handle);
+
+/**
+ * @brief Find the exact-PGN handler chain
+ *
+ * @return Index of the first node, or E32_DISPATCH_NIL
+ */
+uint16_t e32_dispatch_lookup(const e32_dispatch_table_t* table, uint32_t pgn);
+
+/**
+ * @brief Check which kinds of handler (exact or range) want this PGN
+ *
+ * @return E32_DISPATCH_WANT_* bits, 0 when nobody is subscribed
+ */
+uint8_t e32_dispatch_wants(const e32_dispatch_table_t* table, uint32_t pgn);
+
+/**
+ * @brief Run the delivery options of every gated node matching view
+ *
+ * Updates the per-sender histories, so call it once per message. Only
+ * needed while gates_used is non-zero.
+ *
+ * @param pass Receives one bit per gate that lets the message through
+ * @return E32_DISPATCH_WANT_* bits of the nodes that will see the message
+ */
+uint8_t e32_dispatch_gate(
+    e32_dispatch_table_t* table,
+    const e32_j1939_view_t* view,
+    uint32_t now,
+    uint32_t* pass
+);
+
+/**
+ * @brief Invoke every handler subscribed to view->pgn
+ *
+ * Exact subscriptions run first, then matching range subscriptions.
+ * View handlers get the view, message handlers the decoded message,
+ * which may be NULL when e32_dispatch_wants() reported no message
+ * handler. Gated nodes run only if their bit is set in pass (from
+ * e32_dispatch_gate()). A handler may remove its own subscription, or
+ * every subscription of its PGN, while it runs.
+ *
+ * @return Number of handlers invoked
+ */
+int e32_dispatch_invoke(
+    const e32_dispatch_table_t* table,
+    const e32_j1939_view_t* view,
+    const e32_j1939_message_t* message,
+    uint32_t pass
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_DISPATCH_H */
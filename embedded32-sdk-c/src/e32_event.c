@@ -0,0 +1,134 @@
+/**
+ * @file e32_event.c
+ * @brief Embedded32 SDK - Backend Readiness Multiplexing Implementation
+ *
+ * Level-triggered epoll: a channel that still has frames after one
+ * receive batch is reported again on the next wait.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_event.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+e32_error_t e32_event_open(e32_event_t* event)
+{
+    event->wake_fd = -1;
+    event->fd = epoll_create1(EPOLL_CLOEXEC);
+    return (event->fd >= 0) ? E32_OK : E32_ERR_TRANSPORT;
+}
+
+e32_error_t e32_event_add(e32_event_t* event, int fd, uint8_t tag)
+{
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = tag;
+
+    return (epoll_ctl(event->fd, EPOLL_CTL_ADD, fd, &ev) == 0) ? E32_OK : E32_ERR_TRANSPORT;
+}
+
+e32_error_t e32_event_add_wake(e32_event_t* event)
+{
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        return E32_ERR_TRANSPORT;
+    }
+
+    if (e32_event_add(event, fd, E32_EVENT_WAKE) != E32_OK) {
+        close(fd);
+        return E32_ERR_TRANSPORT;
+    }
+    event->wake_fd = fd;
+    return E32_OK;
+}
+
+void e32_event_wake(e32_event_t* event)
+{
+    if (event->wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(event->wake_fd, &one, sizeof(one));
+        (void)n;    /* Counter saturated: a wake-up is already pending */
+    }
+}
+
+int e32_event_wait(e32_event_t* event, int timeout_ms, uint8_t* tags, int max)
+{
+    struct epoll_event ev[E32_CFG_MAX_CHANNELS + 1];
+
+    if (max > E32_CFG_MAX_CHANNELS + 1) {
+        max = E32_CFG_MAX_CHANNELS + 1;
+    }
+
+    int n = epoll_wait(event->fd, ev, max, timeout_ms);
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : E32_ERR_TRANSPORT;
+    }
+
+    for (int i = 0; i < n; i++) {
+        tags[i] = (uint8_t)ev[i].data.u64;
+        if (tags[i] == E32_EVENT_WAKE) {
+            uint64_t count;
+            ssize_t r = read(event->wake_fd, &count, sizeof(count));
+            (void)r;
+        }
+    }
+    return n;
+}
+
+void e32_event_close(e32_event_t* event)
+{
+    if (event->wake_fd >= 0) {
+        close(event->wake_fd);
+        event->wake_fd = -1;
+    }
+    if (event->fd >= 0) {
+        close(event->fd);
+        event->fd = -1;
+    }
+}
+
+#else
+
+e32_error_t e32_event_open(e32_event_t* event)
+{
+    event->fd = -1;
+    event->wake_fd = -1;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+e32_error_t e32_event_add(e32_event_t* event, int fd, uint8_t tag)
+{
+    (void)event; (void)fd; (void)tag;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+e32_error_t e32_event_add_wake(e32_event_t* event)
+{
+    (void)event;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+void e32_event_wake(e32_event_t* event)
+{
+    (void)event;
+}
+
+int e32_event_wait(e32_event_t* event, int timeout_ms, uint8_t* tags, int max)
+{
+    (void)event; (void)timeout_ms; (void)tags; (void)max;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+void e32_event_close(e32_event_t* event)
+{
+    event->fd = -1;
+    event->wake_fd = -1;
+}
+
+#endif /* __linux__ */
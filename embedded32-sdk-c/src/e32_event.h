@@ -0,0 +1,88 @@
+/**
+ * @file e32_event.h
+ * @brief Embedded32 SDK - Backend Readiness Multiplexing (internal)
+ *
+ * Lets one poll loop find out which of several channel backends have
+ * frames pending with a single system call (epoll on Linux), instead of
+ * trying a receive on every channel. Where no such facility exists
+ * e32_event_open() fails and the client falls back to visiting every
+ * channel in turn.
+ *
+ * The set can also hold a wake-up descriptor (eventfd), so another
+ * thread can interrupt a blocking wait and the whole set can be nested
+ * in an application's own epoll or libuv loop.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_EVENT_H
+#define E32_EVENT_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Readiness set
+ */
+typedef struct {
+    int fd;         /**< epoll descriptor, -1 when closed or unsupported */
+    int wake_fd;    /**< eventfd for e32_event_wake(), -1 if not added */
+} e32_event_t;
+
+/** Tag reported for the wake-up descriptor */
+#define E32_EVENT_WAKE  0xFF
+
+/**
+ * @brief Create an empty set
+ *
+ * @return E32_OK, E32_ERR_NOT_SUPPORTED on platforms without epoll,
+ *         E32_ERR_TRANSPORT if the kernel refused
+ */
+e32_error_t e32_event_open(e32_event_t* event);
+
+/**
+ * @brief Watch fd for readability, reporting it as tag
+ */
+e32_error_t e32_event_add(e32_event_t* event, int fd, uint8_t tag);
+
+/**
+ * @brief Add the wake-up descriptor, reported as E32_EVENT_WAKE
+ */
+e32_error_t e32_event_add_wake(e32_event_t* event);
+
+/**
+ * @brief Make the set readable from any thread (no-op without a wake-up descriptor)
+ *
+ * Async-signal-safe, so it may be called from a driver thread or signal
+ * handler.
+ */
+void e32_event_wake(e32_event_t* event);
+
+/**
+ * @brief Wait for readiness
+ *
+ * A reported wake-up is consumed here, so it fires once per
+ * e32_event_wake() burst.
+ *
+ * @param timeout_ms 0 to return at once, -1 to wait indefinitely
+ * @param tags Receives the tags of ready descriptors
+ * @param max Capacity of tags
+ * @return Number of ready descriptors, or negative e32_error_t
+ */
+int e32_event_wait(e32_event_t* event, int timeout_ms, uint8_t* tags, int max);
+
+/**
+ * @brief Release the set (safe on a closed set)
+ */
+void e32_event_close(e32_event_t* event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_EVENT_H */
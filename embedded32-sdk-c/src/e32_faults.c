@@ -0,0 +1,198 @@
+/**
+ * @file e32_faults.c
+ * @brief Embedded32 SDK - Active Fault Sets Implementation
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_faults.h"
+#include "e32_codec.h"
+#include <string.h>
+
+static int find_source(const e32_faults_t* faults, uint8_t channel, uint8_t sa, bool dm2)
+{
+    for (int i = 0; i < E32_CFG_DTC_SOURCES; i++) {
+        const e32_fault_source_t* source = &faults->sources[i];
+        if (source->used && source->channel == channel && source->sa == sa && source->dm2 == dm2) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static e32_fault_source_t* add_source(e32_faults_t* faults, uint8_t channel, uint8_t sa, bool dm2)
+{
+    e32_fault_source_t* source = NULL;
+
+    for (int i = 0; i < E32_CFG_DTC_SOURCES && !source; i++) {
+        if (!faults->sources[i].used) {
+            source = &faults->sources[i];
+        }
+    }
+    /* Full: a list without faults has nothing to forget */
+    for (int i = 0; i < E32_CFG_DTC_SOURCES && !source; i++) {
+        if (faults->sources[i].count == 0) {
+            source = &faults->sources[i];
+        }
+    }
+    if (!source) {
+        return NULL;
+    }
+
+    source->used = true;
+    source->dm2 = dm2;
+    source->channel = channel;
+    source->sa = sa;
+    source->len = 0xFFFF;       /* Matches no message: the first one is applied */
+    source->head = E32_FAULTS_NIL;
+    source->count = 0;
+    return source;
+}
+
+static e32_fault_t* find_fault(e32_faults_t* faults, const e32_fault_source_t* source,
+                               const e32_dtc_t* dtc)
+{
+    for (uint16_t i = source->head; i != E32_FAULTS_NIL; i = faults->faults[i].next) {
+        e32_fault_t* fault = &faults->faults[i];
+        if (fault->dtc.spn == dtc->spn && fault->dtc.fmi == dtc->fmi) {
+            return fault;
+        }
+    }
+    return NULL;
+}
+
+void e32_faults_init(e32_faults_t* faults)
+{
+    memset(faults, 0, sizeof(*faults));
+    for (uint16_t i = 0; i < E32_CFG_DTC_MAX; i++) {
+        faults->faults[i].next = (uint16_t)(i + 1 < E32_CFG_DTC_MAX ? i + 1 : E32_FAULTS_NIL);
+    }
+    faults->free_head = 0;
+}
+
+void e32_faults_update(e32_faults_t* faults, const e32_j1939_view_t* view)
+{
+    if (view->len < 2) {
+        return;
+    }
+
+    bool dm2 = (view->pgn == E32_PGN_DM2);
+    int index = find_source(faults, view->channel, view->source_address, dm2);
+    e32_fault_source_t* source = (index >= 0) ? &faults->sources[index]
+                                              : add_source(faults, view->channel, view->source_address, dm2);
+    if (!source) {
+        return;
+    }
+
+    const uint8_t* dtcs = view->data + 2;
+    uint16_t len = (uint16_t)((view->len - 2) & ~3u);
+    if (len == source->len && memcmp(dtcs, source->dtcs, len) == 0) {
+        return;                             /* The once-a-second repeat */
+    }
+    if (len <= E32_CFG_DTC_REPEAT_BYTES) {
+        source->len = len;
+        memcpy(source->dtcs, dtcs, len);
+    } else {
+        source->len = 0xFFFF;               /* Too long to keep: applied every time */
+    }
+
+    /* Mark what is still listed, add what is new */
+    for (uint16_t i = 0; i + 4 <= len; i += 4) {
+        e32_dtc_t dtc;
+        if (!e32_decode_dtc(&dtcs[i], &dtc)) {
+            continue;
+        }
+
+        e32_fault_t* fault = find_fault(faults, source, &dtc);
+        if (fault) {
+            fault->seen = true;
+            fault->dtc.occurrence = dtc.occurrence;
+            continue;
+        }
+        if (faults->free_head == E32_FAULTS_NIL) {
+            source->len = 0xFFFF;           /* Pool full: retry on the next repeat */
+            continue;
+        }
+
+        uint16_t slot = faults->free_head;
+        fault = &faults->faults[slot];
+        faults->free_head = fault->next;
+        fault->dtc = dtc;
+        fault->seen = true;
+        fault->fresh = true;
+        fault->next = source->head;
+        source->head = slot;
+        source->count++;
+    }
+
+    /* Unlink what is gone; it is reported before it is freed */
+    uint16_t cleared = E32_FAULTS_NIL;
+    for (uint16_t* link = &source->head; *link != E32_FAULTS_NIL; ) {
+        e32_fault_t* fault = &faults->faults[*link];
+        if (fault->seen) {
+            fault->seen = false;
+            link = &fault->next;
+            continue;
+        }
+        uint16_t slot = *link;
+        *link = fault->next;
+        fault->next = cleared;
+        cleared = slot;
+        source->count--;
+    }
+
+    e32_dtc_event_t event;
+    event.pgn = view->pgn;
+    event.source_address = view->source_address;
+    event.channel = view->channel;
+    event.lamp_status = view->data[0];
+    event.timestamp = view->timestamp;
+
+    /* The handler may turn tracking off, which drops every list */
+    event.change = E32_DTC_CLEARED;
+    while (cleared != E32_FAULTS_NIL) {
+        e32_fault_t* fault = &faults->faults[cleared];
+        uint16_t next = fault->next;
+        event.dtc = fault->dtc;
+        fault->next = faults->free_head;
+        faults->free_head = cleared;
+        cleared = next;
+
+        faults->handler(&event, faults->user_data);
+        if (!faults->handler) {
+            return;
+        }
+    }
+
+    event.change = E32_DTC_RAISED;
+    for (uint16_t i = source->head; i != E32_FAULTS_NIL; i = faults->faults[i].next) {
+        e32_fault_t* fault = &faults->faults[i];
+        if (!fault->fresh) {
+            continue;
+        }
+        fault->fresh = false;
+        event.dtc = fault->dtc;
+
+        faults->handler(&event, faults->user_data);
+        if (!faults->handler) {
+            return;
+        }
+    }
+}
+
+e32_error_t e32_faults_get(const e32_faults_t* faults, uint8_t channel, uint8_t sa,
+                           uint32_t pgn, e32_dtc_t* dtcs, uint16_t max, uint16_t* count)
+{
+    int index = find_source(faults, channel, sa, pgn == E32_PGN_DM2);
+    if (index < 0) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    const e32_fault_source_t* source = &faults->sources[index];
+    uint16_t n = 0;
+    for (uint16_t i = source->head; i != E32_FAULTS_NIL && n < max; i = faults->faults[i].next) {
+        dtcs[n++] = faults->faults[i].dtc;
+    }
+    *count = source->count;
+    return E32_OK;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file e32_faults.h
+ * @brief Embedded32 SDK - Active Fault Sets (internal)
+ *
+ * Keeps the DTC lists ECUs broadcast in DM1 (and DM2) and reports only
+ * what changed between two messages of the same list. ECUs repeat DM1
+ * every second, mostly unchanged: a repeat whose DTC bytes equal those
+ * of the previous message is dismissed without looking at the DTCs.
+ *
+ * DTCs live in one pool shared by all lists, each list chaining its own.
+ * All functions run on the polling thread.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_FAULTS_H
+#define E32_FAULTS_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define E32_FAULTS_NIL      0xFFFF
+
+/**
+ * @brief One tracked DTC
+ */
+typedef struct {
+    e32_dtc_t dtc;
+    uint16_t  next;         /**< Next DTC of the list, or next free entry */
+    bool      seen;         /**< Listed in the message being applied */
+    bool      fresh;        /**< Raised by the message being applied */
+} e32_fault_t;
+
+/**
+ * @brief DTC list of one ECU
+ */
+typedef struct {
+    bool     used;
+    bool     dm2;           /**< Previously active list */
+    uint8_t  channel;
+    uint8_t  sa;
+    uint16_t len;           /**< DTC bytes in the last message, 0xFFFF if not kept */
+    uint16_t head;          /**< First DTC */
+    uint16_t count;
+    uint8_t  dtcs[E32_CFG_DTC_REPEAT_BYTES]; /**< Those bytes */
+} e32_fault_source_t;
+
+/**
+ * @brief Fault sets of a client
+ */
+typedef struct {
+    e32_fault_t        faults[E32_CFG_DTC_MAX];
+    e32_fault_source_t sources[E32_CFG_DTC_SOURCES];
+    uint16_t           free_head;
+    e32_dtc_handler_t  handler;     /**< NULL: tracking off */
+    void*              user_data;
+} e32_faults_t;
+
+/**
+ * @brief Forget every list; tracking off
+ */
+void e32_faults_init(e32_faults_t* faults);
+
+/**
+ * @brief Whether a message of pgn goes to e32_faults_update()
+ */
+static inline bool e32_faults_wants(const e32_faults_t* faults, uint32_t pgn)
+{
+    return faults->handler && (pgn == E32_PGN_DM1 || pgn == E32_PGN_DM2);
+}
+
+/**
+ * @brief Apply a DM1/DM2 message and report the changes to the handler
+ *
+ * The handler runs once the list is up to date. DTCs beyond
+ * E32_CFG_DTC_MAX (and lists beyond E32_CFG_DTC_SOURCES) are not
+ * tracked until room frees up.
+ */
+void e32_faults_update(e32_faults_t* faults, const e32_j1939_view_t* view);
+
+/**
+ * @brief Copy a list
+ *
+ * @param count Receives the number of DTCs listed, which may exceed max
+ * @return E32_OK, E32_ERR_NOT_FOUND if the ECU sent no such list yet
+ */
+e32_error_t e32_faults_get(const e32_faults_t* faults, uint8_t channel, uint8_t sa,
+                           uint32_t pgn, e32_dtc_t* dtcs, uint16_t max, uint16_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_FAULTS_H */
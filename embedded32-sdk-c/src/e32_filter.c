@@ -0,0 +1,197 @@
+/**
+ * @file e32_filter.c
+ * @brief Embedded32 SDK - Acceptance Filter Planner Implementation
+ *
+ * A filter's cost is the number of 29-bit identifiers it lets through,
+ * 2^(29 - mask bits). Merging two filters keeps the mask bits where both
+ * care and agree; the pair merged when over budget is the one whose
+ * union grows the accepted space least.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_filter.h"
+#include "e32_j1939.h"
+#include <string.h>
+
+#define ID_BITS     0x1FFFFFFFu
+
+/* Identifier bits a PGN occupies: DP/EDP, PF and (PDU2 only) PS */
+#define PDU1_MASK   0x03FF0000u
+#define PDU2_MASK   0x03FFFF00u
+
+static uint32_t bit_count(uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcount(v);
+#else
+    uint32_t n = 0;
+    for (; v; v &= v - 1) n++;
+    return n;
+#endif
+}
+
+static int64_t accepted(uint32_t mask)
+{
+    return (int64_t)1 << (29 - bit_count(mask));
+}
+
+/* a lets every frame through that b does */
+static bool covers(const e32_can_filter_t* a, const e32_can_filter_t* b)
+{
+    return (a->mask & ~b->mask) == 0 && ((a->id ^ b->id) & a->mask) == 0;
+}
+
+static e32_can_filter_t merged(const e32_can_filter_t* a, const e32_can_filter_t* b)
+{
+    e32_can_filter_t m;
+    m.mask = a->mask & b->mask & ~(a->id ^ b->id);
+    m.id = a->id & m.mask;
+    return m;
+}
+
+static void remove_at(e32_filter_plan_t* plan, uint16_t i)
+{
+    plan->filters[i] = plan->filters[--plan->count];
+}
+
+/* Add f within budget + 1, joining it with what it covers or neighbours exactly */
+static void insert(e32_filter_plan_t* plan, e32_can_filter_t f)
+{
+    for (;;) {
+        bool joined = false;
+        for (uint16_t i = 0; i < plan->count; ) {
+            e32_can_filter_t* g = &plan->filters[i];
+            if (covers(g, &f)) {
+                return;
+            }
+            if (covers(&f, g)) {
+                remove_at(plan, i);
+                continue;
+            }
+            uint32_t diff = (g->id ^ f.id) & f.mask;
+            if (g->mask == f.mask && (diff & (diff - 1)) == 0) {
+                /* One bit apart: the union is exact */
+                f = merged(&f, g);
+                remove_at(plan, i);
+                joined = true;
+                break;
+            }
+            i++;
+        }
+        if (!joined) {
+            break;
+        }
+    }
+    plan->filters[plan->count++] = f;
+}
+
+void e32_filter_plan_init(e32_filter_plan_t* plan, int banks)
+{
+    memset(plan, 0, sizeof(*plan));
+    plan->banks = (banks <= 0 || banks > E32_CFG_FILTER_MAX) ? E32_CFG_FILTER_MAX : (uint16_t)banks;
+}
+
+bool e32_filter_plan_add(e32_filter_plan_t* plan, uint32_t id, uint32_t mask)
+{
+    e32_can_filter_t f;
+    f.mask = mask & ID_BITS;
+    f.id = id & f.mask;
+
+    for (uint16_t i = 0; i < plan->count; i++) {
+        if (covers(&plan->filters[i], &f)) {
+            return false;
+        }
+    }
+
+    insert(plan, f);
+
+    while (plan->count > plan->banks) {
+        uint16_t best_i = 0, best_j = 1;
+        int64_t best = INT64_MAX;
+        for (uint16_t i = 0; i < plan->count; i++) {
+            for (uint16_t j = i + 1; j < plan->count; j++) {
+                const e32_can_filter_t* a = &plan->filters[i];
+                const e32_can_filter_t* b = &plan->filters[j];
+                int64_t cost = accepted(merged(a, b).mask) - accepted(a->mask) - accepted(b->mask);
+                if (cost < best) {
+                    best = cost;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        e32_can_filter_t m = merged(&plan->filters[best_i], &plan->filters[best_j]);
+        remove_at(plan, best_j);    /* Higher index first: remove_at moves the last entry */
+        remove_at(plan, best_i);
+        insert(plan, m);
+    }
+    return true;
+}
+
+bool e32_filter_plan_add_pgns(e32_filter_plan_t* plan, uint32_t first, uint32_t last)
+{
+    bool changed = false;
+
+    if (last > E32_PGN_MAX) {
+        last = E32_PGN_MAX;
+    }
+
+    /* Cover the range with aligned power-of-two blocks of PGNs */
+    while (first <= last) {
+        uint32_t size = 1;
+        while ((first & (size * 2 - 1)) == 0 && first + size * 2 - 1 <= last &&
+               size * 2 <= E32_PGN_MAX + 1) {
+            size *= 2;
+        }
+
+        uint32_t id = first << 8;
+        uint32_t mask = ((~(size - 1)) & E32_PGN_MAX) << 8;
+        if (size < 256 && ((first >> 8) & 0xFF) < 240) {
+            /* PDU1: the only PGN of this PF is PF << 8, at any destination */
+            if ((first & 0xFF) == 0) {
+                changed |= e32_filter_plan_add(plan, id, PDU1_MASK);
+            }
+        } else {
+            changed |= e32_filter_plan_add(plan, id, mask);
+        }
+
+        first += size;
+    }
+    return changed;
+}
+
+bool e32_filter_plan_add_source(e32_filter_plan_t* plan, uint32_t pgn, uint8_t sa)
+{
+    uint32_t mask = (((pgn >> 8) & 0xFF) < 240) ? PDU1_MASK : PDU2_MASK;
+    return e32_filter_plan_add(plan, ((pgn & E32_PGN_MAX) << 8) | sa, mask | 0xFF);
+}
+
+bool e32_filter_plan_accepts(const e32_filter_plan_t* plan, uint32_t can_id)
+{
+    for (uint16_t i = 0; i < plan->count; i++) {
+        const e32_can_filter_t* f = &plan->filters[i];
+        if (((can_id ^ f->id) & f->mask) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ==========================================================================
+ * CONTROLLER REGISTER FORMATS
+ * ========================================================================== */
+
+void e32_filter_to_bxcan(const e32_can_filter_t* filter, uint32_t* fr1, uint32_t* fr2)
+{
+    /* 32-bit scale, mask mode: EXID[28:0] IDE RTR 0; IDE and RTR must match (IDE=1, RTR=0) */
+    *fr1 = ((filter->id & ID_BITS) << 3) | 0x4u;
+    *fr2 = ((filter->mask & ID_BITS) << 3) | 0x6u;
+}
+
+void e32_filter_to_twai(const e32_can_filter_t* filter, uint32_t* code, uint32_t* mask)
+{
+    /* Single filter mode, extended frames: ID[28:0] RTR x x; mask bits set = don't care */
+    *code = (filter->id & ID_BITS) << 3;
+    *mask = ~(((filter->mask & ID_BITS) << 3) | 0x4u);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file e32_filter.h
+ * @brief Embedded32 SDK - Acceptance Filter Planner (internal)
+ *
+ * Turns the identifiers a client wants (subscribed PGNs and ranges,
+ * tracked (SA, PGN) signals, the transport protocol) into at most
+ * `banks` ID/mask pairs for the CAN controller. Every wanted frame
+ * passes the planned set; frames nobody wants pass only when the
+ * budget forced two filters to be merged into a wider one.
+ *
+ * Filters are added one at a time. An added filter that an existing one
+ * already covers changes nothing; otherwise it absorbs the filters it
+ * covers and is joined with any filter it differs from in a single
+ * identifier bit (no extra frames pass). Only when the set is then over
+ * budget are the two filters whose union lets the fewest extra
+ * identifiers through merged. Removing a filter needs a fresh plan.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_FILTER_H
+#define E32_FILTER_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Planned filter set
+ */
+typedef struct {
+    e32_can_filter_t filters[E32_CFG_FILTER_MAX + 1];   /**< One spare: the entry over budget */
+    uint16_t         count;
+    uint16_t         banks;     /**< Filters allowed, 1..E32_CFG_FILTER_MAX */
+} e32_filter_plan_t;
+
+/**
+ * @brief Empty plan (accepts nothing) for a controller with banks filters
+ *
+ * @param banks 0 or more than E32_CFG_FILTER_MAX selects E32_CFG_FILTER_MAX
+ */
+void e32_filter_plan_init(e32_filter_plan_t* plan, int banks);
+
+/**
+ * @brief Let frames with (frame id & mask) == (id & mask) through
+ *
+ * @return true if the planned set changed
+ */
+bool e32_filter_plan_add(e32_filter_plan_t* plan, uint32_t id, uint32_t mask);
+
+/**
+ * @brief Let every frame whose parsed PGN is in [first, last] through
+ *
+ * PDU1 PGNs match any destination address.
+ *
+ * @return true if the planned set changed
+ */
+bool e32_filter_plan_add_pgns(e32_filter_plan_t* plan, uint32_t first, uint32_t last);
+
+/**
+ * @brief Let frames of pgn from one source address through
+ *
+ * @return true if the planned set changed
+ */
+bool e32_filter_plan_add_source(e32_filter_plan_t* plan, uint32_t pgn, uint8_t sa);
+
+/**
+ * @brief Check whether the plan lets a frame with this identifier through
+ */
+bool e32_filter_plan_accepts(const e32_filter_plan_t* plan, uint32_t can_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_FILTER_H */
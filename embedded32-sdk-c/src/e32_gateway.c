@@ -0,0 +1,113 @@
+/**
+ * @file e32_gateway.c
+ * @brief Embedded32 SDK - Gateway Rule Table Implementation
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_gateway.h"
+#include "e32_codec.h"
+#include <string.h>
+
+void e32_gateway_init(e32_gateway_t* gateway)
+{
+    memset(gateway, 0, sizeof(*gateway));
+}
+
+/* The identifier bits a rule compares, and their values */
+static void compile_match(const e32_route_t* route, e32_gateway_rule_t* rule)
+{
+    uint32_t pgn_mask = route->pgn_mask & 0x3FFFF;
+    uint32_t pgn = route->pgn & pgn_mask;
+
+    /* PS is the destination unless the rule only matches PDU2 PGNs */
+    bool pdu2 = (pgn_mask & 0xF000) == 0xF000 && (pgn & 0xF000) == 0xF000;
+    if (!pdu2) {
+        pgn_mask &= 0x3FF00;
+        pgn &= 0x3FF00;
+    }
+
+    rule->mask = (pgn_mask << 8) | route->source_mask;
+    rule->value = (pgn << 8) | (route->source & route->source_mask);
+}
+
+static void compile_rewrite(const e32_route_t* route, e32_gateway_rule_t* rule)
+{
+    rule->keep = 0x1FFFFFFF;
+    rule->set = 0;
+    if (route->flags & E32_ROUTE_SET_SOURCE) {
+        rule->keep &= ~0xFFu;
+        rule->set |= route->source_out;
+    }
+    if (route->flags & E32_ROUTE_SET_PRIORITY) {
+        rule->keep &= ~(0x07u << 26);
+        rule->set |= (uint32_t)route->priority_out << 26;
+    }
+    rule->destination = route->destination_out;
+}
+
+e32_error_t e32_gateway_add(e32_gateway_t* gateway, const e32_route_t* route, uint8_t channels)
+{
+    uint16_t all = (uint16_t)((1u << channels) - 1);
+    bool block = (route->flags & E32_ROUTE_BLOCK) != 0;
+
+    if (route->from_channel >= channels || route->priority_out > 7) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    if (!block && (!route->to_channels || (route->to_channels & ~all) ||
+                   (route->to_channels & (1u << route->from_channel)))) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    if (gateway->count >= E32_CFG_ROUTE_MAX) {
+        return E32_ERR_NO_MEMORY;
+    }
+
+    /* Last of its channel's rules: first match wins in the order added */
+    uint8_t at = gateway->first[route->from_channel + 1];
+    memmove(&gateway->rules[at + 1], &gateway->rules[at],
+            sizeof(gateway->rules[0]) * (gateway->count - at));
+    for (uint32_t c = 0; c <= E32_CFG_MAX_CHANNELS; c++) {
+        if (c > route->from_channel) {
+            gateway->first[c]++;
+        }
+    }
+    gateway->count++;
+
+    e32_gateway_rule_t* rule = &gateway->rules[at];
+    compile_match(route, rule);
+    compile_rewrite(route, rule);
+    rule->flags = route->flags;
+    rule->to = block ? 0 : route->to_channels;
+    return E32_OK;
+}
+
+uint16_t e32_gateway_route(e32_gateway_t* gateway, e32_can_frame_t* frame)
+{
+    if (!frame->is_extended || frame->channel >= E32_CFG_MAX_CHANNELS) {
+        return 0;
+    }
+
+    uint32_t id = frame->id;
+    uint32_t end = gateway->first[frame->channel + 1];
+
+    for (uint32_t i = gateway->first[frame->channel]; i < end; i++) {
+        const e32_gateway_rule_t* rule = &gateway->rules[i];
+        if ((id & rule->mask) != rule->value) {
+            continue;
+        }
+        if (!rule->to) {
+            gateway->stats.blocked++;
+            return 0;
+        }
+
+        id = (id & rule->keep) | rule->set;
+        if (rule->flags & E32_ROUTE_SET_DESTINATION) {
+            /* PS bits that hold a destination: none for PDU2 */
+            uint32_t ps = (~e32_j1939_pdu2_mask(id) & 0xFF) << 8;
+            id = (id & ~ps) | (((uint32_t)rule->destination << 8) & ps);
+        }
+        frame->id = id;
+        return rule->to;
+    }
+    return 0;
+}
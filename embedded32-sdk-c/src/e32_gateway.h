@@ -0,0 +1,76 @@
+/**
+ * @file e32_gateway.h
+ * @brief Embedded32 SDK - Gateway Rule Table (internal)
+ *
+ * Forwarding rules compiled into identifier mask/value pairs, so routing
+ * a frame never parses or decodes it: a rule matches when
+ * (id & mask) == value, and its rewrite is (id & keep) | set. Rules are
+ * kept grouped by the channel they apply to, in the order they were
+ * added, and the first matching rule of the frame's channel decides.
+ *
+ * Runs on the polling thread only.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_GATEWAY_H
+#define E32_GATEWAY_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One compiled rule
+ */
+typedef struct {
+    uint32_t mask;          /**< Identifier bits compared */
+    uint32_t value;         /**< Their values in a matching frame */
+    uint32_t keep;          /**< Identifier bits the rewrite leaves alone */
+    uint32_t set;           /**< Bits it puts in their place (source, priority) */
+    uint16_t to;            /**< Destination channel bits, 0 for a blocking rule */
+    uint8_t  flags;         /**< E32_ROUTE_* */
+    uint8_t  destination;   /**< New PDU1 destination (E32_ROUTE_SET_DESTINATION) */
+} e32_gateway_rule_t;
+
+/**
+ * @brief Rule table of a client
+ */
+typedef struct {
+    e32_gateway_rule_t rules[E32_CFG_ROUTE_MAX];
+    uint8_t            first[E32_CFG_MAX_CHANNELS + 1];  /**< Rules of channel c: [first[c], first[c + 1]) */
+    uint8_t            count;
+    e32_route_stats_t  stats;
+} e32_gateway_t;
+
+/**
+ * @brief Drop every rule and reset the statistics
+ */
+void e32_gateway_init(e32_gateway_t* gateway);
+
+/**
+ * @brief Compile a rule and append it to those of its channel
+ *
+ * @param channels Channels of the client; routes must stay within them
+ * @return E32_OK, E32_ERR_INVALID_PARAM for a rule that names a missing
+ *         channel, forwards back to its own or nowhere, or
+ *         E32_ERR_NO_MEMORY when E32_CFG_ROUTE_MAX rules exist
+ */
+e32_error_t e32_gateway_add(e32_gateway_t* gateway, const e32_route_t* route, uint8_t channels);
+
+/**
+ * @brief Find the rule for a received frame and apply its rewrite in place
+ *
+ * @return Channels to forward the frame to, 0 if it stays on its bus
+ */
+uint16_t e32_gateway_route(e32_gateway_t* gateway, e32_can_frame_t* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_GATEWAY_H */
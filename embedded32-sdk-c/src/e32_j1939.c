@@ -7,8 +7,23 @@
  * @version 1.0.0
  */
 
-#include "e32_j1939.h"
-#include "e32_codec.h"
+#include "embedded32.h"
+#include "e32_dispatch.h"
+#include "e32_transport.h"
+#include "e32_rx_ring.h"
+#include "e32_tp.h"
+#include "e32_tx_queue.h"
+#include "e32_cyclic.h"
+#include "e32_event.h"
+#include "e32_workers.h"
+#include "e32_signals.h"
+#include "e32_stats.h"
+#include "e32_busload.h"
+#include "e32_filter.h"
+#include "e32_address.h"
+#include "e32_request.h"
+#include "e32_faults.h"
+#include "e32_gateway.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,310 +31,2507 @@
  * INTERNAL TYPES
  * ========================================================================== */
 
-#define MAX_PGN_HANDLERS 16
+/* One CAN interface: everything that is per bus */
+typedef struct {
+    e32_transport_t     transport;
+    e32_tp_t            tp;             /* Multi-packet sessions on this bus */
+    e32_tx_queue_t      tx_queue;       /* Outgoing frames by priority */
+    e32_busload_t       busload;        /* Utilization and rates (when enabled) */
+    int32_t             busload_offset; /* Frame timestamp clock minus client clock, ms */
+    e32_names_t         names;          /* Who holds which address on this bus */
+    struct e32_j1939_client* client;
+    uint8_t             index;
+} e32_channel_t;
+
+struct e32_j1939_client {
+    e32_rx_ring_t       rx_ring;        /* First: needs cache-line alignment; shared by all channels */
+    uint32_t            isr_active;     /* Set while e32_j1939_rx_push_isr() owns the ring head */
+    uint32_t            isr_nested;     /* Pushes refused because another was in progress */
+    e32_j1939_config_t  config;
+    bool                connected;
+    uint8_t             address;        /* Source address in use: claimed, or config.source_address */
+    e32_claim_t         claim;          /* J1939-81 address claim, shared by all channels */
+    e32_dispatch_table_t dispatch;      /* Shared by all channels */
+    e32_channel_t       channels[E32_CFG_MAX_CHANNELS];
+    uint8_t             channel_count;
+    e32_event_t         event;          /* Channel readiness and wake-up (epoll), fd -1 if unused */
+    bool                multiplexed;    /* Poll asks event which channels are ready */
+    e32_cyclic_t        cyclic;         /* Periodic broadcasts */
+    e32_requests_t      requests;       /* Requests awaiting their response */
+    e32_signals_t       signals;        /* Last-value cache, written by the polling thread */
+    e32_faults_t        faults;         /* DM1/DM2 lists per ECU, written by the polling thread */
+    e32_gateway_t       gateway;        /* Forwarding rules between channels */
+    e32_stats_block_t   stats;          /* Counters and histograms */
+    e32_filter_plan_t   filters;        /* Acceptance filters planned from the subscriptions */
+    bool                filters_pushed; /* filters (or accept-all) reached the backends since connect */
+    bool                filters_open;   /* What was pushed was accept-all */
+    e32_workers_t*      workers;        /* Handler threads, NULL for inline dispatch */
+    bool                workers_tried;  /* Start attempted since connect */
+    void*               alloc_base;     /* Pointer returned by malloc, NULL for static clients */
+};
+
+void e32_j1939_dispatch_frame(e32_j1939_client_t client, const e32_can_frame_t* frame);
+
+static uint32_t client_now(e32_j1939_client_t client)
+{
+    return client->config.clock_ms ? client->config.clock_ms() : e32_time_ms();
+}
+
+/* ==========================================================================
+ * STATISTICS
+ * ========================================================================== */
+
+/*
+ * Instrumentation points. Each one is empty in E32_CFG_NO_STATS builds,
+ * and the clock reads go away with E32_CFG_NO_STATS_TIMING. Counters
+ * written while handlers run need atomics only once workers exist.
+ */
+
+#define STATS_SAMPLE_MASK   (E32_CFG_STATS_SAMPLE - 1)
+
+#if !defined(E32_CFG_NO_STATS) && !defined(E32_CFG_NO_STATS_TIMING)
+#define STATS_TIMING 1
+
+static uint32_t stats_clock(e32_j1939_client_t client)
+{
+    return client->config.clock_us ? client->config.clock_us() : e32_time_us();
+}
+#endif
+
+/* Producer side: stamp the sampled slots among count ring slots from index first */
+static void stats_stamp(e32_j1939_client_t client, uint32_t first, uint32_t count)
+{
+#ifdef STATS_TIMING
+    uint32_t i = (E32_CFG_STATS_SAMPLE - (first & STATS_SAMPLE_MASK)) & STATS_SAMPLE_MASK;
+    if (i >= count) {
+        return;
+    }
+    uint32_t now = stats_clock(client);
+    for (; i < count; i += E32_CFG_STATS_SAMPLE) {
+        client->stats.rx_us[(first + i) & E32_RX_RING_MASK] = now;
+    }
+#else
+    (void)client; (void)first; (void)count;
+#endif
+}
+
+/* The frame in ring slot index is being dispatched, or none (UINT32_MAX) */
+static void stats_current(e32_j1939_client_t client, uint32_t index)
+{
+#ifdef STATS_TIMING
+    client->stats.from_ring = (index != UINT32_MAX);
+    client->stats.current_stamped = client->stats.from_ring && (index & STATS_SAMPLE_MASK) == 0;
+    if (client->stats.current_stamped) {
+        client->stats.current_us = client->stats.rx_us[index & E32_RX_RING_MASK];
+    }
+#else
+    (void)client; (void)index;
+#endif
+}
+
+static void stats_frame(e32_j1939_client_t client, bool wanted)
+{
+#ifndef E32_CFG_NO_STATS
+    e32_stats_bump(&client->stats.frames);
+    if (!wanted) {
+        e32_stats_bump(&client->stats.unwanted);
+    }
+#else
+    (void)client; (void)wanted;
+#endif
+}
+
+/* Polling thread: count the message under its PGN and tag it for its handlers */
+static void stats_message(e32_j1939_client_t client, uint32_t pgn, e32_stats_tag_t* tag)
+{
+    tag->rx_us = 0;
+    tag->row = E32_STATS_NO_ROW;
+    tag->stamped = false;
+    tag->timed = false;
+#ifndef E32_CFG_NO_STATS
+    tag->row = e32_stats_row(&client->stats, pgn);
+    if (tag->row != E32_STATS_NO_ROW) {
+        e32_stats_bump(&client->stats.pgns[tag->row].messages);
+    }
+#ifdef STATS_TIMING
+    if (client->stats.from_ring) {
+        tag->stamped = client->stats.current_stamped;
+        tag->rx_us = client->stats.current_us;
+        tag->timed = tag->stamped;
+    } else {
+        e32_stats_bump(&client->stats.direct);
+        tag->timed = (client->stats.direct & STATS_SAMPLE_MASK) == 0;
+    }
+#endif
+#else
+    (void)client; (void)pgn;
+#endif
+}
+
+static void stats_gated(e32_j1939_client_t client, const e32_stats_tag_t* tag)
+{
+#ifndef E32_CFG_NO_STATS
+    e32_stats_bump(&client->stats.gated);
+    if (tag->row != E32_STATS_NO_ROW) {
+        e32_stats_bump(&client->stats.pgns[tag->row].gated);
+    }
+#else
+    (void)client; (void)tag;
+#endif
+}
+
+static void stats_decode_error(e32_j1939_client_t client, const e32_stats_tag_t* tag)
+{
+#ifndef E32_CFG_NO_STATS
+    bool shared = client->workers != NULL;
+    e32_stats_add(&client->stats.decode_errors, 1, shared);
+    if (tag->row != E32_STATS_NO_ROW) {
+        e32_stats_add(&client->stats.pgns[tag->row].decode_errors, 1, shared);
+    }
+#else
+    (void)client; (void)tag;
+#endif
+}
+
+/* Handler side: record the wait and return the start time of timed messages */
+static uint32_t stats_begin(e32_j1939_client_t client, const e32_stats_tag_t* tag)
+{
+#ifdef STATS_TIMING
+    if (!tag->timed) {
+        return 0;
+    }
+    uint32_t now = stats_clock(client);
+    if (tag->stamped) {
+        e32_stats_record(&client->stats.latency, now - tag->rx_us, client->workers != NULL);
+    }
+    return now;
+#else
+    (void)client; (void)tag;
+    return 0;
+#endif
+}
+
+static void stats_end(e32_j1939_client_t client, const e32_stats_tag_t* tag, uint32_t start,
+                      int invoked)
+{
+#ifndef E32_CFG_NO_STATS
+    if (invoked <= 0) {
+        return;
+    }
+    bool shared = client->workers != NULL;
+    e32_pgn_stats_t* row = (tag->row != E32_STATS_NO_ROW) ? &client->stats.pgns[tag->row] : NULL;
+    
+    e32_stats_add(&client->stats.delivered, 1, shared);
+    e32_stats_add(&client->stats.handler_calls, (uint32_t)invoked, shared);
+    if (row) {
+        e32_stats_add(&row->handler_calls, (uint32_t)invoked, shared);
+    }
+#ifdef STATS_TIMING
+    if (tag->timed) {
+        uint32_t took = stats_clock(client) - start;
+        e32_stats_record(&client->stats.handler, took, shared);
+        if (row) {
+            e32_stats_max(&row->handler_max_us, took, shared);
+        }
+    }
+#else
+    (void)start;
+#endif
+#else
+    (void)client; (void)tag; (void)start; (void)invoked;
+#endif
+}
+
+/* ==========================================================================
+ * DISPATCH
+ * ========================================================================== */
+
+/* Client-side wants bit next to E32_DISPATCH_WANT_*: the signal cache tracks the PGN */
+#define WANT_SIGNALS    0x80
+#define WANT_FAULTS     0x40
+
+static uint8_t client_wants(e32_j1939_client_t client, uint32_t pgn)
+{
+    uint8_t wants = e32_dispatch_wants(&client->dispatch, pgn);
+    if (e32_signals_wants(&client->signals, pgn)) {
+        wants |= WANT_SIGNALS;
+    }
+    if (e32_faults_wants(&client->faults, pgn)) {
+        wants |= WANT_FAULTS;
+    }
+    return wants;
+}
+
+/* Decode only when a message handler wants it, then call the handlers */
+static void deliver(e32_j1939_client_t client, const e32_j1939_view_t* view, uint8_t wants,
+                    uint32_t gate_pass, const e32_stats_tag_t* tag)
+{
+    e32_j1939_message_t message;
+    const e32_j1939_message_t* decoded = NULL;
+    uint32_t start = stats_begin(client, tag);
+    
+    if (wants & E32_DISPATCH_WANT_MESSAGE) {
+        e32_error_t err;
+        
+        if (view->frame) {
+            err = e32_decode_frame_ex(view->frame, &message, client->config.decode_mode);
+        } else {
+            message.pgn = view->pgn;
+            message.source_address = view->source_address;
+            message.destination_address = view->destination_address;
+            message.priority = view->priority;
+            message.timestamp = view->timestamp;
+            message.channel = view->channel;
+            err = e32_decode_message(&message, view->data, view->len, client->config.decode_mode);
+        }
+        if (err == E32_OK) {
+            decoded = &message;
+        } else {
+            stats_decode_error(client, tag);
+        }
+    }
+    
+    int invoked = e32_dispatch_invoke(&client->dispatch, view, decoded, gate_pass);
+    stats_end(client, tag, start, invoked);
+}
+
+#ifndef E32_CFG_NO_THREADS
+/* Runs on a worker thread; the dispatch table is frozen while workers exist */
+static void worker_run(void* ctx, const e32_work_item_t* item)
+{
+    e32_j1939_client_t client = (e32_j1939_client_t)ctx;
+    e32_j1939_view_t view;
+    
+    if (item->payload) {
+        view.frame = NULL;
+        view.data = item->payload;
+        view.len = item->payload_len;
+    } else {
+        view.frame = &item->frame;
+        view.data = item->frame.data;
+        view.len = item->payload_len;
+    }
+    view.pgn = item->pgn;
+    view.source_address = item->source_address;
+    view.destination_address = item->destination_address;
+    view.priority = item->priority;
+    view.timestamp = item->timestamp;
+    view.channel = item->channel;
+    
+    deliver(client, &view, item->wants, item->gate_pass, &item->tag);
+}
+
+static uint32_t worker_key(e32_j1939_client_t client, const e32_j1939_view_t* view)
+{
+    switch (client->config.affinity) {
+    case E32_AFFINITY_PGN:
+        return view->pgn;
+    case E32_AFFINITY_SOURCE_PGN:
+        return ((uint32_t)view->source_address << 18) ^ view->pgn;
+    case E32_AFFINITY_SOURCE:
+    default:
+        return view->source_address;
+    }
+}
+
+static void hand_off(e32_j1939_client_t client, const e32_j1939_view_t* view, uint8_t wants,
+                     uint32_t gate_pass, const e32_stats_tag_t* tag)
+{
+    e32_work_item_t item;
+    item.payload = NULL;
+    item.payload_len = view->len;
+    if (view->frame) {
+        item.frame = *view->frame;
+    } else {
+        item.payload = view->data;      /* Copied into the queue slot */
+    }
+    item.source_address = view->source_address;
+    item.destination_address = view->destination_address;
+    item.priority = view->priority;
+    item.channel = view->channel;
+    item.pgn = view->pgn;
+    item.timestamp = view->timestamp;
+    item.gate_pass = gate_pass;
+    item.wants = wants;
+    item.tag = *tag;
+    
+    (void)e32_workers_push(client->workers, worker_key(client, view), &item);
+}
+#endif
+
+/**
+ * Hand a message to its worker, or deliver it here without workers.
+ * The pool starts with the first message, and again with the first one
+ * after a subscription change stopped it, so handler threads only ever
+ * read a table nobody writes. If
+ * threads cannot be started, handlers keep running inline. The signal
+ * cache and the delivery options of gated subscriptions are always
+ * handled here, keeping the polling thread the only writer of both.
+ */
+static void route(e32_j1939_client_t client, const e32_j1939_view_t* view, uint8_t wants)
+{
+    uint32_t gate_pass = 0;
+    e32_stats_tag_t tag;
+    
+    stats_message(client, view->pgn, &tag);
+    
+    if (wants & WANT_SIGNALS) {
+        e32_signals_update(&client->signals, view, client_now(client));
+        wants &= (uint8_t)~WANT_SIGNALS;
+    }
+    
+    if (wants & WANT_FAULTS) {
+        e32_faults_update(&client->faults, view);
+        wants &= (uint8_t)~WANT_FAULTS;
+    }
+    
+    /* Messages the options filter out are dropped before any decode */
+    if (wants && client->dispatch.gates_used) {
+        wants = e32_dispatch_gate(&client->dispatch, view, client_now(client), &gate_pass);
+        if (!wants) {
+            stats_gated(client, &tag);
+        }
+    }
+    
+    if (!wants) {
+        return;
+    }
+    
+#ifndef E32_CFG_NO_THREADS
+    if (client->config.workers && !client->workers_tried) {
+        client->workers_tried = true;
+        if (e32_workers_start(&client->workers, client->config.workers, worker_run, client) != E32_OK) {
+            client->workers = NULL;
+        }
+    }
+    
+    if (client->workers) {
+        hand_off(client, view, wants, gate_pass, &tag);
+        return;
+    }
+#endif
+    
+    deliver(client, view, wants, gate_pass, &tag);
+}
+
+static void stop_workers(e32_j1939_client_t client)
+{
+    e32_workers_stop(client->workers);
+    client->workers = NULL;
+    client->workers_tried = false;
+}
+
+/*
+ * Before the handler table changes: queued messages are handled with
+ * the old table, then the pool is gone and route() starts a new one with
+ * the next message. A handler cannot stop the pool it runs on.
+ */
+static e32_error_t quiesce_workers(e32_j1939_client_t client)
+{
+    if (!client->workers) {
+        return E32_OK;
+    }
+    if (e32_workers_on_worker(client->workers)) {
+        return E32_ERR_BUSY;
+    }
+    stop_workers(client);
+    return E32_OK;
+}
+
+/* ==========================================================================
+ * TRANSPORT HELPERS
+ * ========================================================================== */
+
+static const e32_transport_ops_t* select_transport(const e32_j1939_config_t* config)
+{
+    switch (config->transport) {
+#if defined(__linux__)
+        case E32_TRANSPORT_AUTO:
+            /* Only a named interface means a bus to open */
+            if (!config->interface_name && !config->channel_count) {
+                return NULL;
+            }
+            return &e32_socketcan_transport;
+        case E32_TRANSPORT_SOCKETCAN:
+            return &e32_socketcan_transport;
+#endif
+        case E32_TRANSPORT_VIRTUAL:
+            return &e32_vbus_transport;
+        default:
+            return NULL;
+    }
+}
+
+/* ==========================================================================
+ * BUS LOAD
+ * ========================================================================== */
+
+/* The profiler runs on frame timestamps; this is now on that clock */
+static uint32_t busload_now(e32_channel_t* channel)
+{
+    return client_now(channel->client) + (uint32_t)channel->busload_offset;
+}
+
+static void busload_frame(e32_channel_t* channel, const e32_can_frame_t* frame,
+                          const e32_j1939_id_t* id, uint32_t timestamp)
+{
+    /* Unstamped frames (application-fed) are timed by the client clock */
+    uint32_t now = timestamp ? timestamp : busload_now(channel);
+    
+    if (e32_busload_add(&channel->busload, frame, id, now) && timestamp) {
+        channel->busload_offset = (int32_t)(timestamp - client_now(channel->client));
+    }
+}
+
+static bool busload_enabled(e32_j1939_client_t client)
+{
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        if (client->channels[i].busload.enabled) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int backend_send(void* ctx, const e32_can_frame_t* frames, int count)
+{
+    e32_channel_t* channel = (e32_channel_t*)ctx;
+    int sent = channel->transport.ops->send(&channel->transport, frames, count);
+    
+    /* Our own frames are on the bus too; the backend does not echo them */
+    if (channel->busload.enabled) {
+        for (int i = 0; i < sent; i++) {
+            e32_j1939_id_t id;
+            e32_parse_j1939_id(frames[i].id, &id);
+            busload_frame(channel, &frames[i], &id, 0);
+        }
+    }
+    return sent;
+}
+
+static void flush_channel(e32_channel_t* channel)
+{
+    /* No backend attached (application-fed frames): queued frames are discarded */
+    e32_tx_queue_flush(&channel->tx_queue, channel->transport.ops ? backend_send : NULL,
+                       channel, channel->client->config.tx_burst);
+}
+
+static void flush_tx(e32_j1939_client_t client)
+{
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        flush_channel(&client->channels[i]);
+    }
+}
+
+/**
+ * Queue a frame behind any higher-priority traffic and push out as much
+ * as the backend takes right now. Whatever it cannot take yet goes out
+ * from the next send or poll.
+ */
+static e32_error_t enqueue(e32_j1939_client_t client, const e32_can_frame_t* frame,
+                           uint8_t flags, e32_tx_done_t done, void* user_data)
+{
+    e32_channel_t* channel = &client->channels[frame->channel];
+    
+    e32_error_t err = e32_tx_queue_push(&channel->tx_queue, frame, flags, done, user_data);
+    if (err == E32_ERR_BUSY) {
+        flush_channel(channel);
+        err = e32_tx_queue_push(&channel->tx_queue, frame, flags, done, user_data);
+    }
+    if (err != E32_OK) {
+        return err;
+    }
+    
+    flush_channel(channel);
+    return E32_OK;
+}
+
+/* Ordinary traffic: only from an address the claim lets us use */
+static e32_error_t queue_frame(e32_j1939_client_t client, const e32_can_frame_t* frame,
+                               uint8_t flags, e32_tx_done_t done, void* user_data)
+{
+    if (!e32_claim_may_send(&client->claim)) {
+        return E32_ERR_NO_ADDRESS;
+    }
+    return enqueue(client, frame, flags, done, user_data);
+}
+
+static e32_error_t send_frame(e32_j1939_client_t client, const e32_can_frame_t* frame)
+{
+    return queue_frame(client, frame, 0, NULL, NULL);
+}
+
+/* Fewest filters any backend (or the application's driver) can hold */
+static int filter_banks(e32_j1939_client_t client)
+{
+    int banks = client->config.filter_banks;
+    
+    for (uint8_t c = 0; c < client->channel_count; c++) {
+        const e32_transport_ops_t* ops = client->channels[c].transport.ops;
+        if (ops && ops->set_filters && ops->max_filters > 0 &&
+            (banks == 0 || ops->max_filters < banks)) {
+            banks = ops->max_filters;
+        }
+    }
+    return banks;
+}
+
+/* Hand the planned set, or accept-all, to every channel and the application */
+static void push_filters(e32_j1939_client_t client, bool accept_all)
+{
+    const e32_can_filter_t* filters = accept_all ? NULL : client->filters.filters;
+    int count = accept_all ? 0 : client->filters.count;
+    
+    /* Subscriptions are shared, so every channel gets the same set */
+    for (uint8_t c = 0; c < client->channel_count; c++) {
+        e32_transport_t* transport = &client->channels[c].transport;
+        if (!transport->ops || !transport->ops->set_filters) {
+            continue;
+        }
+        if (transport->ops->set_filters(transport, filters, count) != E32_OK && filters) {
+            transport->ops->set_filters(transport, NULL, 0);
+        }
+    }
+    if (client->config.on_filters) {
+        client->config.on_filters(client->config.on_filters_ctx, filters, count);
+    }
+    client->filters_pushed = true;
+    client->filters_open = accept_all;
+}
+
+/* Let the response to a request through, and the destination's NACK */
+static bool filter_request(e32_filter_plan_t* plan, uint32_t pgn, uint8_t destination)
+{
+    if (destination == E32_SA_GLOBAL) {
+        return e32_filter_plan_add_pgns(plan, pgn, pgn);
+    }
+    bool changed = e32_filter_plan_add_source(plan, pgn, destination);
+    changed |= e32_filter_plan_add_source(plan, E32_PGN_ACKNOWLEDGMENT, destination);
+    return changed;
+}
+
+/**
+ * Plan the acceptance filters from scratch: every subscribed PGN and
+ * range, every tracked (SA, PGN) signal, DM1/DM2 while DTCs are
+ * tracked, the responses to pending requests, the traffic forwarding
+ * rules pass on, plus TP.CM/TP.DT for the transport protocol, the
+ * address claim frames and, in CAN FD builds, Multi-PG containers,
+ * within the fewest filter banks any channel has.
+ * The backends are only reprogrammed when the result differs from what
+ * they hold. The bus load profiler has to see every frame, so while it
+ * runs the backends accept everything.
+ */
+static void update_filters(e32_j1939_client_t client)
+{
+    if (!client->connected) {
+        return;
+    }
+    
+    const e32_dispatch_table_t* table = &client->dispatch;
+    e32_filter_plan_t plan;
+    e32_filter_plan_init(&plan, filter_banks(client));
+    
+    e32_filter_plan_add_pgns(&plan, E32_PGN_TP_CM, E32_PGN_TP_CM);
+    e32_filter_plan_add_pgns(&plan, E32_PGN_TP_DT, E32_PGN_TP_DT);
+    e32_filter_plan_add_pgns(&plan, E32_PGN_ADDRESS_CLAIMED, E32_PGN_ADDRESS_CLAIMED);
+    if (client->config.name) {
+        e32_filter_plan_add_pgns(&plan, E32_PGN_REQUEST, E32_PGN_REQUEST);
+    }
+#ifdef E32_CFG_CAN_FD
+    e32_filter_plan_add_pgns(&plan, E32_PGN_MULTI_PG, E32_PGN_MULTI_PG);
+#endif
+    
+    for (uint32_t i = 0; i < E32_CFG_DISPATCH_BUCKETS; i++) {
+        if (table->buckets[i].head != E32_DISPATCH_NIL) {
+            e32_filter_plan_add_pgns(&plan, table->buckets[i].pgn, table->buckets[i].pgn);
+        }
+    }
+    
+    for (uint16_t n = table->range_head; n != E32_DISPATCH_NIL; n = table->nodes[n].next) {
+        e32_filter_plan_add_pgns(&plan, table->nodes[n].pgn_first, table->nodes[n].pgn_last);
+    }
+    
+    for (uint32_t i = 0; i < E32_CFG_MAX_SIGNALS; i++) {
+        const e32_signal_t* signal = &client->signals.signals[i];
+        if (signal->used) {
+            e32_filter_plan_add_source(&plan, signal->pgn, signal->sa);
+        }
+    }
+    
+    if (client->faults.handler) {
+        e32_filter_plan_add_pgns(&plan, E32_PGN_DM1, E32_PGN_DM2);
+    }
+    
+    for (uint32_t i = 0; i < E32_CFG_REQUEST_MAX; i++) {
+        const e32_request_t* request = &client->requests.entries[i];
+        if (request->state != E32_REQUEST_FREE) {
+            filter_request(&plan, request->pgn, request->destination);
+        }
+    }
+    
+    for (uint32_t i = 0; i < client->gateway.count; i++) {
+        const e32_gateway_rule_t* rule = &client->gateway.rules[i];
+        if (rule->to) {
+            e32_filter_plan_add(&plan, rule->value, rule->mask);
+        }
+    }
+    
+    bool accept_all = busload_enabled(client);
+    bool same = plan.count == client->filters.count && plan.banks == client->filters.banks &&
+                memcmp(plan.filters, client->filters.filters, sizeof(plan.filters[0]) * plan.count) == 0;
+    
+    client->filters = plan;
+    if (!same || !client->filters_pushed || client->filters_open != accept_all) {
+        push_filters(client, accept_all);
+    }
+}
+
+/* Something was added to the plan: push it if it changed (additions never need a replan) */
+static void extend_filters(e32_j1939_client_t client, bool changed)
+{
+    if (changed && !client->filters_open) {
+        push_filters(client, false);
+    }
+}
+
+/* ==========================================================================
+ * TRANSPORT PROTOCOL HOOKS
+ * ========================================================================== */
+
+static e32_error_t tp_send(void* ctx, const e32_can_frame_t* frame)
+{
+    e32_channel_t* channel = (e32_channel_t*)ctx;
+    e32_can_frame_t out = *frame;
+    
+    out.channel = channel->index;
+    return send_frame(channel->client, &out);
+}
+
+static bool tp_accept(void* ctx, uint32_t pgn)
+{
+    e32_j1939_client_t client = ((e32_channel_t*)ctx)->client;
+    return client_wants(client, pgn) != 0 ||
+           (client->requests.in_flight && e32_requests_expects(&client->requests, pgn));
+}
+
+static void tp_deliver(void* ctx, const e32_tp_session_t* session)
+{
+    e32_channel_t* channel = (e32_channel_t*)ctx;
+    e32_j1939_client_t client = channel->client;
+    
+    e32_j1939_view_t view;
+    view.frame = NULL;
+    view.data = session->data;
+    view.len = session->size;
+    view.pgn = session->pgn;
+    view.source_address = session->sa;
+    view.destination_address = session->da;
+    view.priority = session->priority;
+    view.timestamp = session->timestamp;
+    view.channel = channel->index;
+    
+    if (client->requests.in_flight) {
+        e32_requests_match(&client->requests, &view, client->address);
+    }
+    
+    uint8_t wants = client_wants(client, session->pgn);
+    if (!wants) {
+        return;
+    }
+    
+    route(client, &view, wants);
+}
+
+static void tp_reset(e32_j1939_client_t client)
+{
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_channel_t* channel = &client->channels[i];
+        const e32_tp_hooks_t hooks = { tp_send, tp_accept, tp_deliver, channel };
+        e32_tp_init(&channel->tp, &hooks, client->address);
+    }
+}
+
+/* ==========================================================================
+ * ADDRESS CLAIM
+ * ========================================================================== */
+
+static void claim_notify(e32_j1939_client_t client)
+{
+    if (client->config.on_address) {
+        client->config.on_address(client->config.on_address_ctx,
+                                  (e32_address_state_t)client->claim.state, client->claim.address);
+    }
+}
+
+/* Our address changed: sessions bound to the old one cannot continue */
+static void claim_moved(e32_j1939_client_t client)
+{
+    client->address = client->claim.address;
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_tp_set_address(&client->channels[i].tp, client->address);
+    }
+    claim_notify(client);
+}
+
+/* Put a due Address Claimed (or Cannot Claim) on every bus not yet reached */
+static void claim_flush(e32_j1939_client_t client, uint32_t now)
+{
+    e32_claim_t* claim = &client->claim;
+    if (!e32_claim_due(claim, now)) {
+        return;
+    }
+    
+    e32_can_frame_t frame;
+    e32_encode_address_claimed(claim->name, claim->address, &frame);
+    bool complete = true;
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        if (claim->sent_on & (1u << i)) {
+            continue;
+        }
+        frame.channel = i;
+        if (enqueue(client, &frame, 0, NULL, NULL) == E32_OK) {
+            claim->sent_on |= (uint16_t)(1u << i);
+        } else {
+            complete = false;                   /* Queue full: retried from the next poll */
+        }
+    }
+    if (!complete) {
+        return;
+    }
+    
+    /* We are a node on every bus too */
+    if (claim->address != E32_SA_NULL) {
+        for (uint8_t i = 0; i < client->channel_count; i++) {
+            e32_names_claimed(&client->channels[i].names, claim->address, claim->name);
+        }
+    }
+    e32_claim_sent(claim, now);
+}
+
+static bool address_in_use(void* ctx, uint8_t sa)
+{
+    e32_j1939_client_t client = (e32_j1939_client_t)ctx;
+    uint64_t name;
+    
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        if (e32_names_name_of(&client->channels[i].names, sa, &name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Address Claimed and Request frames, before anything else sees them */
+static void claim_frame(e32_j1939_client_t client, const e32_j1939_id_t* id,
+                        const e32_can_frame_t* frame)
+{
+    if (id->pgn == E32_PGN_ADDRESS_CLAIMED) {
+        if (frame->dlc < 8) {
+            return;
+        }
+        uint64_t name = e32_decode_name(frame->data);
+        e32_names_claimed(&client->channels[frame->channel].names, id->source_address, name);
+        if (e32_claim_contend(&client->claim, id->source_address, name,
+                              address_in_use, client, client_now(client))) {
+            claim_moved(client);
+        }
+        return;
+    }
+    
+    /* Request for Address Claimed, to everyone or to us */
+    if (frame->dlc >= 3 &&
+        frame->data[0] == (uint8_t)E32_PGN_ADDRESS_CLAIMED &&
+        frame->data[1] == (uint8_t)(E32_PGN_ADDRESS_CLAIMED >> 8) &&
+        frame->data[2] == (uint8_t)(E32_PGN_ADDRESS_CLAIMED >> 16) &&
+        (id->destination_address == E32_SA_GLOBAL || id->destination_address == client->address)) {
+        e32_claim_requested(&client->claim, client_now(client));
+    }
+}
+
+/* Ask who is on each bus, then claim our preferred address */
+static void claim_start(e32_j1939_client_t client)
+{
+    uint32_t now = client_now(client);
+    
+    e32_claim_start(&client->claim, client->config.name, client->config.source_address, now);
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_can_frame_t frame;
+        e32_encode_request(E32_PGN_ADDRESS_CLAIMED, E32_SA_NULL, E32_SA_GLOBAL, &frame);
+        frame.channel = i;
+        enqueue(client, &frame, 0, NULL, NULL);
+    }
+    claim_flush(client, now);
+    claim_notify(client);
+}
+
+/* ==========================================================================
+ * CLIENT LIFECYCLE
+ * ========================================================================== */
+
+static bool config_valid(const e32_j1939_config_t* config)
+{
+    return config->source_address <= 0xFD &&
+           config->channel_count <= E32_CFG_MAX_CHANNELS &&
+           config->workers <= E32_CFG_MAX_WORKERS &&
+           (!config->can_fd || E32_CAN_MAX_DATA_LEN > E32_CAN_CLASSIC_DATA_LEN);
+}
+
+/* First cache-line boundary in base, so the RX ring indices land on their own lines */
+static struct e32_j1939_client* align_client(void* base)
+{
+    return (struct e32_j1939_client*)
+        (((uintptr_t)base + E32_CFG_CACHE_LINE - 1) & ~(uintptr_t)(E32_CFG_CACHE_LINE - 1));
+}
+
+static void init_client(struct e32_j1939_client* client, const e32_j1939_config_t* config,
+                        void* alloc_base)
+{
+    memset(client, 0, sizeof(*client));
+    memcpy(&client->config, config, sizeof(e32_j1939_config_t));
+    client->connected = false;
+    client->address = config->source_address;
+    e32_claim_init(&client->claim);
+    client->alloc_base = alloc_base;
+    client->channel_count = config->channel_count ? config->channel_count : 1;
+    client->event.fd = -1;
+    client->event.wake_fd = -1;
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        client->channels[i].client = client;
+        client->channels[i].index = i;
+        e32_tx_queue_init(&client->channels[i].tx_queue);
+        e32_names_init(&client->channels[i].names);
+    }
+    e32_dispatch_init(&client->dispatch);
+    e32_rx_ring_init(&client->rx_ring, config->rx_high_water);
+    tp_reset(client);
+    e32_cyclic_init(&client->cyclic);
+    e32_requests_init(&client->requests);
+    e32_signals_init(&client->signals);
+    e32_faults_init(&client->faults);
+    e32_gateway_init(&client->gateway);
+#ifndef E32_CFG_NO_STATS
+    e32_stats_init(&client->stats);
+#endif
+    e32_filter_plan_init(&client->filters, 0);
+}
+
+#ifndef E32_CFG_NO_HEAP
+e32_error_t e32_j1939_create(const e32_j1939_config_t* config, e32_j1939_client_t* client_out)
+{
+    if (!config || !client_out || !config_valid(config)) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    void* base = malloc(sizeof(struct e32_j1939_client) + E32_CFG_CACHE_LINE - 1);
+    if (!base) {
+        return E32_ERR_NO_MEMORY;
+    }
+    
+    struct e32_j1939_client* client = align_client(base);
+    init_client(client, config, base);
+    
+    *client_out = client;
+    return E32_OK;
+}
+#endif
+
+e32_error_t e32_j1939_create_static(const e32_j1939_config_t* config, void* buffer,
+                                    size_t size, e32_j1939_client_t* client_out)
+{
+    if (!config || !buffer || !client_out || !config_valid(config)) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    struct e32_j1939_client* client = align_client(buffer);
+    size_t used = (size_t)((uint8_t*)client - (uint8_t*)buffer) + sizeof(*client);
+    if (used > size) {
+        return E32_ERR_NO_MEMORY;
+    }
+    
+    init_client(client, config, NULL);
+    
+    *client_out = client;
+    return E32_OK;
+}
+
+size_t e32_j1939_footprint(e32_footprint_t* breakdown)
+{
+    if (breakdown) {
+        breakdown->total = sizeof(struct e32_j1939_client);
+        breakdown->rx_ring = sizeof(e32_rx_ring_t);
+        breakdown->dispatch = sizeof(e32_dispatch_table_t);
+        breakdown->tp = sizeof(e32_tp_t) * E32_CFG_MAX_CHANNELS;
+        breakdown->tx_queue = sizeof(e32_tx_queue_t) * E32_CFG_MAX_CHANNELS;
+        breakdown->cyclic = sizeof(e32_cyclic_t);
+        breakdown->signals = sizeof(e32_signals_t);
+        breakdown->stats = sizeof(e32_stats_block_t);
+        breakdown->busload = sizeof(e32_busload_t) * E32_CFG_MAX_CHANNELS;
+        breakdown->filters = sizeof(e32_filter_plan_t);
+        breakdown->names = sizeof(e32_names_t) * E32_CFG_MAX_CHANNELS;
+        breakdown->requests = sizeof(e32_requests_t);
+        breakdown->faults = sizeof(e32_faults_t);
+        breakdown->routes = sizeof(e32_gateway_t);
+    }
+    return sizeof(struct e32_j1939_client);
+}
+
+void e32_j1939_destroy(e32_j1939_client_t client)
+{
+    if (!client) return;
+    
+    if (client->connected) {
+        e32_j1939_disconnect(client);
+    }
+    stop_workers(client);
+    
+#ifndef E32_CFG_NO_HEAP
+    free(client->alloc_base);
+#endif
+}
+
+static void close_channels(e32_j1939_client_t client)
+{
+    e32_event_close(&client->event);
+    
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_transport_t* transport = &client->channels[i].transport;
+        if (transport->ops) {
+            transport->ops->close(transport);
+            transport->ops = NULL;
+        }
+    }
+}
+
+/**
+ * Collect every channel and a wake-up descriptor in one readiness set
+ * where the platform allows it, for e32_j1939_wait() and external event
+ * loops. With several channels poll also uses it to skip idle ones;
+ * otherwise poll visits every channel.
+ */
+static void watch_channels(e32_j1939_client_t client)
+{
+    client->multiplexed = false;
+    
+    if (e32_event_open(&client->event) != E32_OK ||
+        e32_event_add_wake(&client->event) != E32_OK) {
+        e32_event_close(&client->event);
+        return;
+    }
+    
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_transport_t* transport = &client->channels[i].transport;
+        if (!transport->ops) {
+            continue;   /* Frames are fed by the application */
+        }
+        
+        int fd = transport->ops->get_fd ? transport->ops->get_fd(transport) : -1;
+        if (fd < 0 || e32_event_add(&client->event, fd, i) != E32_OK) {
+            e32_event_close(&client->event);
+            return;
+        }
+    }
+    
+    client->multiplexed = client->channel_count > 1;
+}
+
+e32_error_t e32_j1939_connect(e32_j1939_client_t client)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (client->connected) {
+        return E32_ERR_ALREADY_CONNECTED;
+    }
+    
+    const e32_transport_ops_t* ops = select_transport(&client->config);
+    
+    if (ops) {
+        for (uint8_t i = 0; i < client->channel_count; i++) {
+            e32_j1939_config_t channel_config = client->config;
+            if (client->config.channel_count) {
+                channel_config.interface_name = client->config.channels[i];
+            }
+            
+            e32_error_t err = ops->open(&client->channels[i].transport, &channel_config);
+            if (err != E32_OK) {
+                close_channels(client);
+                return err;
+            }
+            client->channels[i].transport.ops = ops;
+        }
+    } else if (client->config.transport != E32_TRANSPORT_AUTO) {
+        return E32_ERR_NOT_SUPPORTED;
+    }
+    watch_channels(client);
+    
+    /* AUTO without a named interface or a platform backend: frames are fed by the application */
+    client->connected = true;
+    client->filters_pushed = false;
+    update_filters(client);
+    
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_names_init(&client->channels[i].names);
+    }
+    if (client->config.name) {
+        claim_start(client);    /* The contention window runs out in poll */
+    }
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_disconnect(e32_j1939_client_t client)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!client->connected) {
+        return E32_OK;  /* Already disconnected */
+    }
+    
+    close_channels(client);
+    stop_workers(client);      /* Handlers finish before the table is cleared */
+    
+    client->connected = false;
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_tx_queue_cancel(&client->channels[i].tx_queue, E32_ERR_NOT_CONNECTED);
+    }
+    e32_requests_cancel(&client->requests, E32_ERR_NOT_CONNECTED);
+    e32_dispatch_init(&client->dispatch);
+    e32_cyclic_init(&client->cyclic);
+    e32_claim_init(&client->claim);
+    client->address = client->config.source_address;
+    tp_reset(client);
+    
+    return E32_OK;
+}
+
+bool e32_j1939_is_connected(e32_j1939_client_t client)
+{
+    if (!client) return false;
+    return client->connected;
+}
+
+uint8_t e32_j1939_get_source_address(e32_j1939_client_t client)
+{
+    if (!client) return 0xFF;
+    return client->address;
+}
+
+uint8_t e32_j1939_get_channel_count(e32_j1939_client_t client)
+{
+    if (!client) return 0;
+    return client->channel_count;
+}
+
+/* ==========================================================================
+ * PGN SUBSCRIPTION
+ * ========================================================================== */
+
+e32_error_t e32_j1939_on_pgn(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_pgn_handler_t handler,
+    void* user_data,
+    e32_subscription_t* sub_out
+)
+{
+    if (pgn == E32_PGN_ANY) {
+        return e32_j1939_on_pgn_range(client, 0, E32_PGN_MAX, handler, user_data, sub_out);
+    }
+    
+    return e32_j1939_on_pgn_range(client, pgn, pgn, handler, user_data, sub_out);
+}
+
+/* Exactly one of handler / view_handler is set */
+static e32_error_t subscribe(
+    e32_j1939_client_t client,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_pgn_handler_t handler,
+    e32_view_handler_t view_handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    e32_subscription_t* sub_out
+)
+{
+    if (sub_out) {
+        *sub_out = E32_SUBSCRIPTION_NONE;
+    }
+    if (!client || (!handler && !view_handler) || pgn_first > pgn_last || pgn_last > E32_PGN_MAX) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_error_t quiesced = quiesce_workers(client);
+    if (quiesced != E32_OK) {
+        return quiesced;
+    }
+    
+    uint32_t handle;
+    e32_error_t err = handler
+        ? e32_dispatch_add(&client->dispatch, pgn_first, pgn_last, handler, user_data, options, &handle)
+        : e32_dispatch_add_view(&client->dispatch, pgn_first, pgn_last, view_handler, user_data, options, &handle);
+    if (err == E32_OK && client->connected) {
+        extend_filters(client, e32_filter_plan_add_pgns(&client->filters, pgn_first, pgn_last));
+    }
+    if (err == E32_OK && sub_out) {
+        *sub_out = handle;
+    }
+    return err;
+}
+
+e32_error_t e32_j1939_on_pgn_range(
+    e32_j1939_client_t client,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_pgn_handler_t handler,
+    void* user_data,
+    e32_subscription_t* sub_out
+)
+{
+    return subscribe(client, pgn_first, pgn_last, handler, NULL, user_data, NULL, sub_out);
+}
+
+e32_error_t e32_j1939_on_pgn_ex(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_pgn_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    e32_subscription_t* sub_out
+)
+{
+    if (pgn == E32_PGN_ANY) {
+        return subscribe(client, 0, E32_PGN_MAX, handler, NULL, user_data, options, sub_out);
+    }
+    
+    return subscribe(client, pgn, pgn, handler, NULL, user_data, options, sub_out);
+}
+
+e32_error_t e32_j1939_on_pgn_view(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_view_handler_t handler,
+    void* user_data,
+    e32_subscription_t* sub_out
+)
+{
+    if (pgn == E32_PGN_ANY) {
+        return e32_j1939_on_pgn_view_range(client, 0, E32_PGN_MAX, handler, user_data, sub_out);
+    }
+    
+    return e32_j1939_on_pgn_view_range(client, pgn, pgn, handler, user_data, sub_out);
+}
+
+e32_error_t e32_j1939_on_pgn_view_range(
+    e32_j1939_client_t client,
+    uint32_t pgn_first,
+    uint32_t pgn_last,
+    e32_view_handler_t handler,
+    void* user_data,
+    e32_subscription_t* sub_out
+)
+{
+    return subscribe(client, pgn_first, pgn_last, NULL, handler, user_data, NULL, sub_out);
+}
+
+e32_error_t e32_j1939_on_pgn_view_ex(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_view_handler_t handler,
+    void* user_data,
+    const e32_sub_options_t* options,
+    e32_subscription_t* sub_out
+)
+{
+    if (pgn == E32_PGN_ANY) {
+        return subscribe(client, 0, E32_PGN_MAX, NULL, handler, user_data, options, sub_out);
+    }
+    
+    return subscribe(client, pgn, pgn, NULL, handler, user_data, options, sub_out);
+}
+
+e32_error_t e32_j1939_unsubscribe(e32_j1939_client_t client, e32_subscription_t sub)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_error_t quiesced = quiesce_workers(client);
+    if (quiesced != E32_OK) {
+        return quiesced;
+    }
+    
+    if (!e32_dispatch_remove_handle(&client->dispatch, sub)) {
+        return E32_ERR_NOT_FOUND;
+    }
+    update_filters(client);
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_off_pgn(e32_j1939_client_t client, uint32_t pgn)
+{
+    if (pgn == E32_PGN_ANY) {
+        return e32_j1939_off_pgn_range(client, 0, E32_PGN_MAX);
+    }
+    
+    return e32_j1939_off_pgn_range(client, pgn, pgn);
+}
+
+e32_error_t e32_j1939_off_pgn_range(
+    e32_j1939_client_t client,
+    uint32_t pgn_first,
+    uint32_t pgn_last
+)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_error_t quiesced = quiesce_workers(client);
+    if (quiesced != E32_OK) {
+        return quiesced;
+    }
+    
+    if (e32_dispatch_remove(&client->dispatch, pgn_first, pgn_last) > 0) {
+        update_filters(client);
+    }
+    return E32_OK;  /* Not found is not an error */
+}
+
+/* ==========================================================================
+ * PGN REQUESTS
+ * ========================================================================== */
+
+e32_error_t e32_j1939_request_pgn(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    uint8_t destination
+)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!client->connected) {
+        return E32_ERR_NOT_CONNECTED;
+    }
+    
+    e32_can_frame_t frame;
+    e32_encode_request(pgn, client->address, destination, &frame);
+    
+    return send_frame(client, &frame);
+}
+
+static e32_error_t request_send(void* ctx, const e32_request_t* request)
+{
+    e32_j1939_client_t client = (e32_j1939_client_t)ctx;
+    e32_can_frame_t frame;
+    
+    e32_encode_request(request->pgn, client->address, request->destination, &frame);
+    frame.channel = request->channel;
+    return send_frame(client, &frame);
+}
+
+e32_error_t e32_j1939_request_async(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    uint8_t destination,
+    uint32_t timeout_ms,
+    e32_response_fn_t done,
+    void* user_data
+)
+{
+    if (!client || !done || channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!client->connected) {
+        return E32_ERR_NOT_CONNECTED;
+    }
+    
+    e32_error_t err = e32_requests_add(&client->requests, channel, pgn, destination,
+                                       timeout_ms, done, user_data);
+    if (err != E32_OK) {
+        return err;
+    }
+    
+    /* The response has to get through the filters before the request goes out */
+    extend_filters(client, filter_request(&client->filters, pgn, destination));
+    e32_requests_start(&client->requests, client_now(client), request_send, client);
+    return E32_OK;
+}
+
+/* ==========================================================================
+ * SIGNAL CACHE
+ * ========================================================================== */
+
+e32_error_t e32_j1939_track_signal(
+    e32_j1939_client_t client,
+    uint8_t source_address,
+    uint32_t pgn,
+    uint32_t spn,
+    uint32_t max_age_ms,
+    e32_signal_id_t* id_out
+)
+{
+    if (!client || !id_out || pgn > E32_PGN_MAX) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_error_t err = e32_signals_track(&client->signals, source_address, pgn, spn,
+                                        max_age_ms, id_out);
+    if (err == E32_OK && client->connected) {
+        extend_filters(client, e32_filter_plan_add_source(&client->filters, pgn, source_address));
+    }
+    return err;
+}
+
+e32_error_t e32_j1939_untrack_signal(e32_j1939_client_t client, e32_signal_id_t id)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_error_t err = e32_signals_untrack(&client->signals, id);
+    if (err == E32_OK) {
+        update_filters(client);
+    }
+    return err;
+}
+
+e32_error_t e32_j1939_find_signal(
+    e32_j1939_client_t client,
+    uint8_t source_address,
+    uint32_t pgn,
+    uint32_t spn,
+    e32_signal_id_t* id_out
+)
+{
+    if (!client || !id_out) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    return e32_signals_find(&client->signals, source_address, pgn, spn, id_out);
+}
+
+e32_error_t e32_j1939_read_signal(
+    e32_j1939_client_t client,
+    e32_signal_id_t id,
+    e32_signal_value_t* value
+)
+{
+    if (!client || !value) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    return e32_signals_read(&client->signals, id, client_now(client), value);
+}
+
+/* ==========================================================================
+ * DIAGNOSTIC TROUBLE CODES
+ * ========================================================================== */
+
+e32_error_t e32_j1939_on_dtc(
+    e32_j1939_client_t client,
+    e32_dtc_handler_t handler,
+    void* user_data
+)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!handler) {
+        e32_faults_init(&client->faults);
+        update_filters(client);
+        return E32_OK;
+    }
+    
+    bool tracking = client->faults.handler != NULL;
+    client->faults.handler = handler;
+    client->faults.user_data = user_data;
+    if (!tracking && client->connected) {
+        extend_filters(client, e32_filter_plan_add_pgns(&client->filters, E32_PGN_DM1, E32_PGN_DM2));
+    }
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_get_dtcs(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint8_t source_address,
+    uint32_t pgn,
+    e32_dtc_t* dtcs,
+    uint16_t max,
+    uint16_t* count
+)
+{
+    if (!client || !count || (max && !dtcs) || channel >= client->channel_count ||
+        (pgn != E32_PGN_DM1 && pgn != E32_PGN_DM2)) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    return e32_faults_get(&client->faults, channel, source_address, pgn, dtcs, max, count);
+}
+
+/* ==========================================================================
+ * PGN SENDING
+ * ========================================================================== */
+
+/* Largest single-frame payload: 64 bytes as CAN FD when config.can_fd is set */
+static uint16_t frame_capacity(e32_j1939_client_t client)
+{
+#ifdef E32_CFG_CAN_FD
+    return client->config.can_fd ? E32_CAN_MAX_DATA_LEN : E32_CAN_CLASSIC_DATA_LEN;
+#else
+    (void)client;
+    return E32_CAN_CLASSIC_DATA_LEN;
+#endif
+}
+
+/* Payloads over 8 bytes become an FD frame padded to the next FD length */
+static void set_payload(e32_can_frame_t* frame, const uint8_t* data, uint8_t len)
+{
+    memcpy(frame->data, data, len);
+    frame->dlc = len;
+#ifdef E32_CFG_CAN_FD
+    if (len > E32_CAN_CLASSIC_DATA_LEN) {
+        frame->dlc = e32_can_fd_len(len);
+        memset(&frame->data[len], E32_CPG_PADDING, (size_t)(frame->dlc - len));
+        frame->flags = E32_CAN_FLAG_FD | E32_CAN_FLAG_BRS;
+    }
+#endif
+}
+
+e32_error_t e32_j1939_send_raw(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint16_t len,
+    uint8_t destination,
+    uint8_t priority
+)
+{
+    return e32_j1939_send_raw_on(client, 0, pgn, data, len, destination, priority);
+}
+
+e32_error_t e32_j1939_send_raw_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint16_t len,
+    uint8_t destination,
+    uint8_t priority
+)
+{
+    if (!client || !data || len == 0 || len > E32_CFG_TP_MAX_LEN ||
+        channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!client->connected) {
+        return E32_ERR_NOT_CONNECTED;
+    }
+    
+    if (!e32_claim_may_send(&client->claim)) {
+        return E32_ERR_NO_ADDRESS;
+    }
+    
+    if (len > frame_capacity(client)) {
+        /* Multi-packet: queued, then paced out from e32_j1939_poll() */
+        return e32_tp_send(&client->channels[channel].tp, pgn, data, len, destination,
+                           priority, client_now(client));
+    }
+    
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    
+    frame.id = e32_build_j1939_id(pgn, client->address, priority, destination);
+    frame.is_extended = true;
+    frame.channel = channel;
+    set_payload(&frame, data, (uint8_t)len);
+    
+    return send_frame(client, &frame);
+}
+
+e32_error_t e32_j1939_send_async(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t destination,
+    uint8_t priority,
+    uint8_t flags,
+    e32_tx_done_t done,
+    void* user_data
+)
+{
+    return e32_j1939_send_async_on(client, 0, pgn, data, len, destination, priority,
+                                   flags, done, user_data);
+}
+
+e32_error_t e32_j1939_send_async_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t destination,
+    uint8_t priority,
+    uint8_t flags,
+    e32_tx_done_t done,
+    void* user_data
+)
+{
+    if (!client || !data || len == 0 || len > frame_capacity(client) ||
+        channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!client->connected) {
+        return E32_ERR_NOT_CONNECTED;
+    }
+    
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    
+    frame.id = e32_build_j1939_id(pgn, client->address, priority, destination);
+    frame.is_extended = true;
+    frame.channel = channel;
+    set_payload(&frame, data, len);
+    
+    return queue_frame(client, &frame, flags, done, user_data);
+}
+
+e32_error_t e32_j1939_send_multi_pg(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    const e32_cpg_t* pgs,
+    uint8_t count,
+    uint8_t destination,
+    uint8_t priority
+)
+{
+    if (!client || !pgs || count == 0 || channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+#ifdef E32_CFG_CAN_FD
+    for (uint8_t i = 0; i < count; i++) {
+        if (pgs[i].len > E32_CPG_MAX_DATA_LEN || (pgs[i].len && !pgs[i].data)) {
+            return E32_ERR_INVALID_PARAM;
+        }
+    }
+    
+    if (!client->config.can_fd) {
+        return E32_ERR_NOT_SUPPORTED;
+    }
+    
+    if (!client->connected) {
+        return E32_ERR_NOT_CONNECTED;
+    }
+    
+    if (!e32_claim_may_send(&client->claim)) {
+        return E32_ERR_NO_ADDRESS;
+    }
+    
+    e32_can_frame_t frame;
+    e32_mpg_begin(client->address, priority, destination, &frame);
+    frame.channel = channel;
+    
+    for (uint8_t i = 0; i < count; i++) {
+        if (e32_mpg_add(&frame, pgs[i].pgn, pgs[i].data, pgs[i].len) == E32_OK) {
+            continue;
+        }
+        
+        /* Full: send it and start the next container, where the PG always fits */
+        e32_mpg_finish(&frame);
+        e32_error_t err = send_frame(client, &frame);
+        if (err != E32_OK) {
+            return err;
+        }
+        e32_mpg_begin(client->address, priority, destination, &frame);
+        frame.channel = channel;
+        e32_mpg_add(&frame, pgs[i].pgn, pgs[i].data, pgs[i].len);
+    }
+    
+    e32_mpg_finish(&frame);
+    return send_frame(client, &frame);
+#else
+    (void)destination;
+    (void)priority;
+    return E32_ERR_NOT_SUPPORTED;
+#endif
+}
+
+e32_error_t e32_j1939_send_engine_control(
+    e32_j1939_client_t client,
+    const e32_engine_control_cmd_t* cmd
+)
+{
+    return e32_j1939_send_engine_control_on(client, 0, cmd);
+}
+
+e32_error_t e32_j1939_send_engine_control_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    const e32_engine_control_cmd_t* cmd
+)
+{
+    if (!client || !cmd || channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!client->connected) {
+        return E32_ERR_NOT_CONNECTED;
+    }
+    
+    e32_can_frame_t frame;
+    e32_encode_engine_control(cmd, client->address, &frame);
+    frame.channel = channel;
+    
+    /* A newer command replaces one still waiting for the bus */
+    return queue_frame(client, &frame, E32_TX_COALESCE, NULL, NULL);
+}
+
+/* ==========================================================================
+ * ADDRESS CLAIM (J1939-81)
+ * ========================================================================== */
+
+e32_address_state_t e32_j1939_get_address_state(e32_j1939_client_t client)
+{
+    if (!client) return E32_ADDRESS_NONE;
+    return (e32_address_state_t)client->claim.state;
+}
+
+e32_error_t e32_j1939_name_of(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint8_t source_address,
+    uint64_t* name
+)
+{
+    if (!client || !name || channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    if (!e32_names_name_of(&client->channels[channel].names, source_address, name)) {
+        return E32_ERR_NOT_FOUND;
+    }
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_address_of(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint64_t name,
+    uint8_t* source_address
+)
+{
+    if (!client || !source_address || channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    uint8_t sa = e32_names_address_of(&client->channels[channel].names, name);
+    if (sa == E32_SA_NULL) {
+        return E32_ERR_NOT_FOUND;
+    }
+    *source_address = sa;
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_send_to_name(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    const uint8_t* data,
+    uint16_t len,
+    uint64_t name,
+    uint8_t priority
+)
+{
+    uint8_t destination;
+    e32_error_t err = e32_j1939_address_of(client, channel, name, &destination);
+    if (err != E32_OK) {
+        return err;
+    }
+    
+    return e32_j1939_send_raw_on(client, channel, pgn, data, len, destination, priority);
+}
+
+/* ==========================================================================
+ * GATEWAY ROUTING
+ * ========================================================================== */
+
+e32_error_t e32_j1939_add_route(e32_j1939_client_t client, const e32_route_t* route)
+{
+    if (!client || !route) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_error_t err = e32_gateway_add(&client->gateway, route, client->channel_count);
+    if (err != E32_OK) {
+        return err;
+    }
+    
+    const e32_gateway_rule_t* rule = &client->gateway.rules[client->gateway.first[route->from_channel + 1] - 1];
+    if (rule->to && client->connected) {
+        extend_filters(client, e32_filter_plan_add(&client->filters, rule->value, rule->mask));
+    }
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_clear_routes(e32_j1939_client_t client)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_gateway_init(&client->gateway);
+    update_filters(client);
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_get_route_stats(e32_j1939_client_t client, e32_route_stats_t* stats)
+{
+    if (!client || !stats) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    *stats = client->gateway.stats;
+    return E32_OK;
+}
+
+/* ==========================================================================
+ * CYCLIC TRANSMISSION
+ * ========================================================================== */
+
+static e32_error_t cyclic_send(void* ctx, const e32_cyclic_entry_t* entry)
+{
+    e32_j1939_client_t client = (e32_j1939_client_t)ctx;
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    
+    if (entry->len > frame_capacity(client)) {
+        return E32_ERR_INVALID_PARAM;   /* FD payload from a classic client: skipped */
+    }
+    
+    frame.id = e32_build_j1939_id(entry->pgn, client->address,
+                                  entry->priority, entry->destination);
+    frame.is_extended = true;
+    frame.channel = entry->channel;
+    set_payload(&frame, entry->data, entry->len);
+    
+    /* A cycle still waiting for the bus is replaced by the fresher one */
+    return queue_frame(client, &frame, E32_TX_COALESCE, NULL, NULL);
+}
+
+e32_error_t e32_j1939_add_cyclic(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    uint32_t period_ms,
+    uint8_t priority,
+    uint8_t destination,
+    e32_cyclic_provider_t provider,
+    void* user_data
+)
+{
+    return e32_j1939_add_cyclic_on(client, 0, pgn, period_ms, priority, destination,
+                                   provider, user_data);
+}
+
+e32_error_t e32_j1939_add_cyclic_on(
+    e32_j1939_client_t client,
+    uint8_t channel,
+    uint32_t pgn,
+    uint32_t period_ms,
+    uint8_t priority,
+    uint8_t destination,
+    e32_cyclic_provider_t provider,
+    void* user_data
+)
+{
+    if (!client || !provider || period_ms == 0 || period_ms > 0x7FFFFFFF ||
+        pgn > E32_PGN_MAX || priority > 7 || channel >= client->channel_count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    return e32_cyclic_add(&client->cyclic, channel, pgn, period_ms, priority, destination,
+                          provider, user_data, client_now(client));
+}
+
+e32_error_t e32_j1939_remove_cyclic(e32_j1939_client_t client, uint32_t pgn)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    return e32_cyclic_remove(&client->cyclic, pgn);
+}
+
+e32_error_t e32_j1939_get_cyclic_stats(
+    e32_j1939_client_t client,
+    uint32_t pgn,
+    e32_cyclic_stats_t* stats
+)
+{
+    if (!client || !stats) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    return e32_cyclic_get_stats(&client->cyclic, pgn, stats);
+}
+
+/* ==========================================================================
+ * POLLING
+ * ========================================================================== */
+
+/**
+ * Receive one batch from a channel's backend straight into the ring's
+ * free slots, tagging each frame with the channel.
+ */
+static void receive_channel(e32_j1939_client_t client, e32_channel_t* channel)
+{
+    uint32_t room;
+    e32_can_frame_t* slots = e32_rx_ring_reserve(&client->rx_ring, &room);
+    
+    if (room > E32_CFG_RX_BATCH) {
+        room = E32_CFG_RX_BATCH;
+    }
+    if (room == 0 || !channel->transport.ops) {
+        return;
+    }
+    
+    int n = channel->transport.ops->recv(&channel->transport, slots, (int)room);
+    if (n > 0) {
+        for (int i = 0; i < n; i++) {
+            slots[i].channel = channel->index;
+        }
+        stats_stamp(client, (uint32_t)(slots - client->rx_ring.slots), (uint32_t)n);
+        e32_rx_ring_commit(&client->rx_ring, (uint32_t)n);
+    }
+}
 
-typedef struct {
-    uint32_t            pgn;
-    e32_pgn_handler_t   handler;
-    void*               user_data;
-    bool                active;
-} pgn_subscription_t;
+/**
+ * One receive batch per channel that has frames pending: the readiness
+ * set says which ones, without it every channel is tried.
+ */
+static void receive_batch(e32_j1939_client_t client)
+{
+    if (client->multiplexed) {
+        uint8_t ready[E32_CFG_MAX_CHANNELS + 1];
+        int n = e32_event_wait(&client->event, 0, ready, E32_CFG_MAX_CHANNELS + 1);
+        
+        for (int i = 0; i < n; i++) {
+            if (ready[i] != E32_EVENT_WAKE) {
+                receive_channel(client, &client->channels[ready[i]]);
+            }
+        }
+        return;
+    }
+    
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        receive_channel(client, &client->channels[i]);
+    }
+}
 
-struct e32_j1939_client {
-    e32_j1939_config_t  config;
-    bool                connected;
-    pgn_subscription_t  subscriptions[MAX_PGN_HANDLERS];
-    uint8_t             subscription_count;
+/**
+ * Send a run of routed frames to every channel in to. A run goes to the
+ * backend straight from the ring slots; only frames it cannot take, or
+ * all of them while the channel's queue holds frames they must not
+ * overtake, are copied into the transmit queue.
+ */
+static void forward_run(e32_j1939_client_t client, const e32_can_frame_t* frames, uint32_t n,
+                        uint16_t to)
+{
+    e32_route_stats_t* stats = &client->gateway.stats;
     
-    /* Platform-specific transport handle would go here */
-    void*               transport_handle;
-};
+    for (uint8_t c = 0; to; c++, to >>= 1) {
+        if (!(to & 1)) {
+            continue;
+        }
+        
+        e32_channel_t* channel = &client->channels[c];
+        uint32_t sent = 0;
+        if (channel->transport.ops && channel->tx_queue.depth == 0) {
+            int accepted = backend_send(channel, frames, (int)n);
+            sent = accepted > 0 ? (uint32_t)accepted : 0;
+        }
+        stats->forwarded += sent;
+        
+        for (uint32_t i = sent; i < n; i++) {
+            e32_can_frame_t frame = frames[i];
+            frame.channel = c;
+            if (e32_tx_queue_push(&channel->tx_queue, &frame, 0, NULL, NULL) == E32_OK) {
+                stats->queued++;
+            } else {
+                stats->dropped++;
+            }
+        }
+    }
+}
 
-/* ==========================================================================
- * CLIENT LIFECYCLE
- * ========================================================================== */
+/**
+ * Forward the routed frames of a dispatched batch: IDs are rewritten in
+ * their slots, and consecutive frames bound for the same channels go
+ * out together.
+ */
+static void forward_batch(e32_j1939_client_t client, e32_can_frame_t* frames, uint32_t n)
+{
+    uint32_t start = 0;
+    uint16_t run = 0;
+    
+    for (uint32_t i = 0; i < n; i++) {
+        uint16_t to = e32_gateway_route(&client->gateway, &frames[i]);
+        if (to != run) {
+            if (run) {
+                forward_run(client, &frames[start], i - start, run);
+            }
+            run = to;
+            start = i;
+        }
+    }
+    if (run) {
+        forward_run(client, &frames[start], n - start, run);
+    }
+}
 
-e32_error_t e32_j1939_create(const e32_j1939_config_t* config, e32_j1939_client_t* client_out)
+/**
+ * Dispatch up to one batch of queued frames in place, forward what the
+ * gateway rules route to other channels, then return the slots to the
+ * producer.
+ */
+static uint32_t drain_batch(e32_j1939_client_t client)
 {
-    if (!config || !client_out) {
-        return E32_ERR_INVALID_PARAM;
+    e32_can_frame_t* first;
+    uint32_t n = e32_rx_ring_peek(&client->rx_ring, &first);
+    
+    if (n > E32_CFG_RX_BATCH) {
+        n = E32_CFG_RX_BATCH;
     }
     
-    if (config->source_address > 0xFD) {
-        return E32_ERR_INVALID_PARAM;
+    uint32_t index = (uint32_t)(first - client->rx_ring.slots);
+    for (uint32_t i = 0; i < n; i++) {
+        stats_current(client, index + i);
+        e32_j1939_dispatch_frame(client, &first[i]);
     }
+    stats_current(client, UINT32_MAX);
     
-    struct e32_j1939_client* client = malloc(sizeof(struct e32_j1939_client));
-    if (!client) {
-        return E32_ERR_NO_MEMORY;
+    /* Handlers saw the frames as received; rewrites happen after them */
+    if (client->gateway.count) {
+        forward_batch(client, first, n);
     }
     
-    memset(client, 0, sizeof(*client));
-    memcpy(&client->config, config, sizeof(e32_j1939_config_t));
-    client->connected = false;
+    e32_rx_ring_release(&client->rx_ring, n);
+    return n;
+}
+
+/**
+ * Everything time-driven: cyclic PGNs, transport protocol timers and
+ * paced sends, then whatever the backend could not take at send time.
+ */
+static void run_timers(e32_j1939_client_t client)
+{
+    uint32_t now = client_now(client);
     
-    *client_out = client;
-    return E32_OK;
+    claim_flush(client, now);
+    if (e32_claim_poll(&client->claim, now)) {
+        claim_notify(client);
+    }
+    
+    e32_requests_expire(&client->requests, now);
+    e32_requests_start(&client->requests, now, request_send, client);
+    
+    e32_cyclic_run(&client->cyclic, now, cyclic_send, client);
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_tp_poll(&client->channels[i].tp, now);
+    }
+    flush_tx(client);
 }
 
-void e32_j1939_destroy(e32_j1939_client_t client)
+int e32_j1939_poll(e32_j1939_client_t client)
 {
-    if (!client) return;
+    if (!client || !client->connected) {
+        return 0;
+    }
     
-    if (client->connected) {
-        e32_j1939_disconnect(client);
+    int processed = 0;
+    
+    for (int batch = 1; ; batch++) {
+        receive_batch(client);
+        
+        uint32_t n = drain_batch(client);
+        if (n == 0) {
+            break;
+        }
+        processed += (int)n;
+        
+        /* Past the batch budget, keep going only while above high water */
+        if (batch >= E32_CFG_POLL_MAX_BATCHES &&
+            e32_rx_ring_depth(&client->rx_ring) < client->rx_ring.high_water) {
+            break;
+        }
     }
     
-    free(client);
+    run_timers(client);
+    return processed;
 }
 
-e32_error_t e32_j1939_connect(e32_j1939_client_t client)
+e32_error_t e32_j1939_tick(e32_j1939_client_t client)
 {
     if (!client) {
         return E32_ERR_INVALID_PARAM;
     }
     
-    if (client->connected) {
-        return E32_ERR_ALREADY_CONNECTED;
+    if (!client->connected) {
+        return E32_ERR_NOT_CONNECTED;
     }
     
-    /* 
-     * Platform-specific connection logic would go here.
-     * For now, we just mark as connected.
-     */
-    
-    client->connected = true;
+    run_timers(client);
     return E32_OK;
 }
 
-e32_error_t e32_j1939_disconnect(e32_j1939_client_t client)
+int e32_j1939_next_timeout(e32_j1939_client_t client)
+{
+    if (!client || !client->connected) {
+        return -1;
+    }
+    
+    uint32_t now = client_now(client);
+    uint32_t next = e32_cyclic_next_timeout(&client->cyclic, now);
+    uint32_t claim = e32_claim_next_timeout(&client->claim, now);
+    if (claim < next) next = claim;
+    uint32_t request = e32_requests_next_timeout(&client->requests, now);
+    if (request < next) next = request;
+    
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        uint32_t t = e32_tp_next_timeout(&client->channels[i].tp, now);
+        if (t < next) next = t;
+        
+        /* Frames the backend could not take: retry on the next tick */
+        if (client->channels[i].tx_queue.depth > 0 && next > 1) next = 1;
+    }
+    
+    if (next == UINT32_MAX) return -1;
+    return (next > INT32_MAX) ? INT32_MAX : (int)next;
+}
+
+int e32_j1939_wait(e32_j1939_client_t client, int timeout_ms)
 {
     if (!client) {
         return E32_ERR_INVALID_PARAM;
     }
     
     if (!client->connected) {
-        return E32_OK;  /* Already disconnected */
+        return E32_ERR_NOT_CONNECTED;
     }
     
-    /*
-     * Platform-specific disconnection logic would go here.
-     */
+    if (client->event.fd < 0) {
+        return E32_ERR_NOT_SUPPORTED;
+    }
     
-    client->connected = false;
-    client->subscription_count = 0;
-    memset(client->subscriptions, 0, sizeof(client->subscriptions));
+    /* Frames left in the ring by the batch budget need no wait */
+    if (e32_rx_ring_depth(&client->rx_ring) == 0) {
+        int budget = e32_j1939_next_timeout(client);
+        if (budget >= 0 && (timeout_ms < 0 || budget < timeout_ms)) {
+            timeout_ms = budget;
+        }
+        
+        uint8_t ready[E32_CFG_MAX_CHANNELS + 1];
+        int n = e32_event_wait(&client->event, timeout_ms, ready, E32_CFG_MAX_CHANNELS + 1);
+        if (n < 0) {
+            return n;
+        }
+    }
     
-    return E32_OK;
+    return e32_j1939_poll(client);
 }
 
-bool e32_j1939_is_connected(e32_j1939_client_t client)
+int e32_j1939_get_fd(e32_j1939_client_t client)
 {
-    if (!client) return false;
-    return client->connected;
+    if (!client) return -1;
+    return client->event.fd;
 }
 
-uint8_t e32_j1939_get_source_address(e32_j1939_client_t client)
+void e32_j1939_wake(e32_j1939_client_t client)
 {
-    if (!client) return 0xFF;
-    return client->config.source_address;
+    if (!client) return;
+    e32_event_wake(&client->event);
 }
 
 /* ==========================================================================
- * PGN SUBSCRIPTION
+ * DRIVER / ISR INTERFACE
  * ========================================================================== */
 
-e32_error_t e32_j1939_on_pgn(
-    e32_j1939_client_t client,
-    uint32_t pgn,
-    e32_pgn_handler_t handler,
-    void* user_data
-)
+e32_error_t e32_j1939_rx_push_isr(e32_j1939_client_t client, const e32_can_frame_t* frame)
 {
-    if (!client || !handler) {
+    if (!client || !frame || frame->channel >= client->channel_count) {
         return E32_ERR_INVALID_PARAM;
     }
     
-    /* Find free slot */
-    for (int i = 0; i < MAX_PGN_HANDLERS; i++) {
-        if (!client->subscriptions[i].active) {
-            client->subscriptions[i].pgn = pgn;
-            client->subscriptions[i].handler = handler;
-            client->subscriptions[i].user_data = user_data;
-            client->subscriptions[i].active = true;
-            client->subscription_count++;
-            return E32_OK;
-        }
+    /*
+     * The ring has one producer. An ISR that preempted another push on
+     * this core sees the flag and backs off; the one it interrupted
+     * resumes with the head untouched. Needs no atomic read-modify-write,
+     * so it works on cores without one.
+     */
+    if (E32_LOAD_RELAXED(&client->isr_active)) {
+        E32_STORE_RELAXED(&client->isr_nested, client->isr_nested + 1);
+        return E32_ERR_BUSY;
+    }
+    E32_STORE_RELAXED(&client->isr_active, 1);
+    
+    /* Stamp first (the push publishes the slot), unless a full ring still owns it */
+#ifdef STATS_TIMING
+    uint32_t head = client->rx_ring.head;
+    if ((head & STATS_SAMPLE_MASK) == 0 && e32_rx_ring_depth(&client->rx_ring) < E32_CFG_RX_RING_SIZE) {
+        stats_stamp(client, head, 1);
     }
+#endif
+    e32_error_t err = e32_rx_ring_push(&client->rx_ring, frame);
+    E32_STORE_RELAXED(&client->isr_active, 0);
     
-    return E32_ERR_NO_MEMORY;
+    /* Only the first frame of a burst wakes the consumer */
+    if (err == E32_OK && e32_rx_ring_depth(&client->rx_ring) == 1) {
+        if (client->config.rx_notify) {
+            client->config.rx_notify(client->config.rx_notify_ctx);
+        }
+        e32_event_wake(&client->event);
+    }
+    return err;
 }
 
-e32_error_t e32_j1939_off_pgn(e32_j1939_client_t client, uint32_t pgn)
+e32_error_t e32_j1939_get_rx_stats(e32_j1939_client_t client, e32_rx_stats_t* stats)
 {
-    if (!client) {
+    if (!client || !stats) {
         return E32_ERR_INVALID_PARAM;
     }
     
-    for (int i = 0; i < MAX_PGN_HANDLERS; i++) {
-        if (client->subscriptions[i].active && client->subscriptions[i].pgn == pgn) {
-            client->subscriptions[i].active = false;
-            client->subscription_count--;
-            return E32_OK;
-        }
+    const e32_rx_ring_t* ring = &client->rx_ring;
+    stats->depth = e32_rx_ring_depth(ring);
+    stats->peak_depth = E32_LOAD_RELAXED(&ring->peak_depth);
+    stats->high_water = ring->high_water;
+    stats->high_water_events = E32_LOAD_RELAXED(&ring->high_water_events);
+    stats->overflows = E32_LOAD_RELAXED(&ring->overflows);
+    stats->isr_nested = E32_LOAD_RELAXED(&client->isr_nested);
+    
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_get_tp_stats(e32_j1939_client_t client, e32_tp_stats_t* stats)
+{
+    if (!client || !stats) {
+        return E32_ERR_INVALID_PARAM;
     }
     
-    return E32_OK;  /* Not found is not an error */
+    memset(stats, 0, sizeof(*stats));
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_tp_stats_t ch;
+        e32_tp_get_stats(&client->channels[i].tp, &ch);
+        
+        stats->rx_completed += ch.rx_completed;
+        stats->rx_aborted += ch.rx_aborted;
+        stats->rx_timeouts += ch.rx_timeouts;
+        stats->rx_no_session += ch.rx_no_session;
+        stats->tx_completed += ch.tx_completed;
+        stats->tx_aborted += ch.tx_aborted;
+        stats->tx_timeouts += ch.tx_timeouts;
+        stats->rx_active += ch.rx_active;
+        stats->tx_active += ch.tx_active;
+    }
+    return E32_OK;
 }
 
-/* ==========================================================================
- * PGN REQUESTS
- * ========================================================================== */
+e32_error_t e32_j1939_get_tx_stats(e32_j1939_client_t client, e32_tx_stats_t* stats)
+{
+    if (!client || !stats) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    memset(stats, 0, sizeof(*stats));
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        const e32_tx_queue_t* queue = &client->channels[i].tx_queue;
+        
+        stats->depth += queue->depth;
+        stats->peak_depth += queue->stats.peak_depth;
+        stats->sent += queue->stats.sent;
+        stats->coalesced += queue->stats.coalesced;
+        stats->rejected += queue->stats.rejected;
+        stats->errors += queue->stats.errors;
+    }
+    return E32_OK;
+}
 
-e32_error_t e32_j1939_request_pgn(
-    e32_j1939_client_t client,
-    uint32_t pgn,
-    uint8_t destination
-)
+e32_error_t e32_j1939_get_worker_stats(e32_j1939_client_t client, uint8_t worker,
+                                       e32_worker_stats_t* stats)
 {
-    if (!client) {
+    if (!client || !stats) {
         return E32_ERR_INVALID_PARAM;
     }
     
-    if (!client->connected) {
-        return E32_ERR_NOT_CONNECTED;
+    if (!client->workers) {
+        return E32_ERR_NOT_FOUND;
     }
     
-    e32_can_frame_t frame;
-    e32_encode_request(pgn, client->config.source_address, destination, &frame);
+    return e32_workers_get_stats(client->workers, worker, stats);
+}
+
+e32_error_t e32_j1939_get_stats(e32_j1939_client_t client, e32_stats_t* stats)
+{
+    if (!client || !stats) {
+        return E32_ERR_INVALID_PARAM;
+    }
     
-    /*
-     * Platform-specific send logic would go here.
-     * e.g., can_send(client->transport_handle, &frame);
-     */
+#ifndef E32_CFG_NO_STATS
+    e32_stats_snapshot(&client->stats, stats);
+    e32_j1939_get_rx_stats(client, &stats->rx);
+    e32_j1939_get_tx_stats(client, &stats->tx);
+    
+    stats->worker_overflows = 0;
+    uint8_t workers = client->workers ? e32_workers_count(client->workers) : 0;
+    for (uint8_t i = 0; i < workers; i++) {
+        e32_worker_stats_t worker;
+        if (e32_workers_get_stats(client->workers, i, &worker) == E32_OK) {
+            stats->worker_overflows += worker.overflows;
+        }
+    }
+    return E32_OK;
+#else
+    return E32_ERR_NOT_SUPPORTED;
+#endif
+}
+
+e32_error_t e32_j1939_reset_stats(e32_j1939_client_t client)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
+    }
     
+#ifndef E32_CFG_NO_STATS
+    /* Keep the receive stamps: frames still queued in the ring own them */
+    e32_stats_block_t* stats = &client->stats;
+    stats->frames = stats->unwanted = stats->gated = 0;
+    stats->delivered = stats->handler_calls = stats->decode_errors = 0;
+    stats->pgn_overflow = 0;
+    memset(&stats->latency, 0, sizeof(stats->latency));
+    memset(&stats->handler, 0, sizeof(stats->handler));
+    memset(stats->pgns, 0, sizeof(stats->pgns));
+    for (uint32_t i = 0; i < E32_CFG_STATS_PGNS; i++) {
+        stats->pgns[i].pgn = E32_STATS_FREE_PGN;
+    }
     return E32_OK;
+#else
+    return E32_ERR_NOT_SUPPORTED;
+#endif
 }
 
 /* ==========================================================================
- * PGN SENDING
+ * BUS LOAD PROFILER
  * ========================================================================== */
 
-e32_error_t e32_j1939_send_raw(
-    e32_j1939_client_t client,
-    uint32_t pgn,
-    const uint8_t* data,
-    uint8_t len,
-    uint8_t destination,
-    uint8_t priority
-)
+e32_error_t e32_j1939_busload_start(e32_j1939_client_t client, e32_stuffing_t stuffing)
 {
-    if (!client || !data || len == 0 || len > 8) {
+    if (!client || stuffing > E32_STUFFING_NONE) {
         return E32_ERR_INVALID_PARAM;
     }
     
-    if (!client->connected) {
-        return E32_ERR_NOT_CONNECTED;
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        e32_channel_t* channel = &client->channels[i];
+        e32_busload_init(&channel->busload, client->config.bitrate, client->config.data_bitrate, stuffing);
+        channel->busload.enabled = true;
+        channel->busload_offset = 0;
+    }
+    update_filters(client);
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_busload_stop(e32_j1939_client_t client)
+{
+    if (!client) {
+        return E32_ERR_INVALID_PARAM;
     }
     
-    e32_can_frame_t frame;
-    memset(&frame, 0, sizeof(frame));
-    
-    frame.id = e32_build_j1939_id(pgn, client->config.source_address, priority, destination);
-    frame.dlc = len;
-    frame.is_extended = true;
-    memcpy(frame.data, data, len);
-    
-    /*
-     * Platform-specific send logic would go here.
-     */
-    
+    for (uint8_t i = 0; i < client->channel_count; i++) {
+        client->channels[i].busload.enabled = false;
+    }
+    update_filters(client);
     return E32_OK;
 }
 
-e32_error_t e32_j1939_send_engine_control(
-    e32_j1939_client_t client,
-    const e32_engine_control_cmd_t* cmd
-)
+/* Channel whose profile is read, moved up to the present */
+static e32_error_t busload_channel(e32_j1939_client_t client, uint8_t index,
+                                   e32_channel_t** out, uint32_t* now)
 {
-    if (!client || !cmd) {
+    if (!client || index >= client->channel_count) {
         return E32_ERR_INVALID_PARAM;
     }
     
-    if (!client->connected) {
-        return E32_ERR_NOT_CONNECTED;
+    e32_channel_t* channel = &client->channels[index];
+    if (!channel->busload.enabled) {
+        return E32_ERR_NOT_FOUND;
     }
     
-    e32_can_frame_t frame;
-    e32_encode_engine_control(cmd, client->config.source_address, &frame);
+    *now = busload_now(channel);
+    e32_busload_advance(&channel->busload, *now);
+    *out = channel;
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_get_busload(e32_j1939_client_t client, uint8_t channel,
+                                  e32_busload_stats_t* stats)
+{
+    e32_channel_t* ch;
+    uint32_t now;
     
-    /*
-     * Platform-specific send logic would go here.
-     */
+    if (!stats) {
+        return E32_ERR_INVALID_PARAM;
+    }
+    
+    e32_error_t err = busload_channel(client, channel, &ch, &now);
+    if (err != E32_OK) {
+        return err;
+    }
     
+    e32_busload_get(&ch->busload, now, stats);
     return E32_OK;
 }
 
-/* ==========================================================================
- * POLLING
- * ========================================================================== */
-
-int e32_j1939_poll(e32_j1939_client_t client)
+static e32_error_t busload_top(e32_j1939_client_t client, uint8_t channel, bool pgns,
+                               e32_busload_rate_t* rates, uint16_t max, uint16_t* count)
 {
-    if (!client || !client->connected) {
-        return 0;
-    }
+    e32_channel_t* ch;
+    uint32_t now;
     
-    int processed = 0;
+    if (!rates || !count) {
+        return E32_ERR_INVALID_PARAM;
+    }
     
-    /*
-     * Platform-specific receive logic would go here.
-     * Example:
-     * 
-     * e32_can_frame_t frame;
-     * while (can_receive(client->transport_handle, &frame, 0) == E32_OK) {
-     *     e32_j1939_message_t message;
-     *     if (e32_decode_frame(&frame, &message) == E32_OK) {
-     *         // Dispatch to handlers
-     *         for (int i = 0; i < MAX_PGN_HANDLERS; i++) {
-     *             if (client->subscriptions[i].active &&
-     *                 client->subscriptions[i].pgn == message.pgn) {
-     *                 client->subscriptions[i].handler(
-     *                     &message, client->subscriptions[i].user_data);
-     *             }
-     *         }
-     *         processed++;
-     *     }
-     * }
-     */
+    e32_error_t err = busload_channel(client, channel, &ch, &now);
+    if (err != E32_OK) {
+        return err;
+    }
     
-    return processed;
+    *count = e32_busload_top(&ch->busload, pgns, now, rates, max);
+    return E32_OK;
+}
+
+e32_error_t e32_j1939_busload_sources(e32_j1939_client_t client, uint8_t channel,
+                                      e32_busload_rate_t* rates, uint16_t max, uint16_t* count)
+{
+    return busload_top(client, channel, false, rates, max, count);
+}
+
+e32_error_t e32_j1939_busload_pgns(e32_j1939_client_t client, uint8_t channel,
+                                   e32_busload_rate_t* rates, uint16_t max, uint16_t* count)
+{
+    return busload_top(client, channel, true, rates, max, count);
 }
 
 /* ==========================================================================
  * INTERNAL: FRAME DISPATCH
  * ========================================================================== */
 
+#ifdef E32_CFG_CAN_FD
+/* Every PG of a Multi-PG container is routed like a message of its own */
+static void dispatch_contained(e32_j1939_client_t client, const e32_j1939_id_t* id,
+                               const e32_can_frame_t* frame)
+{
+    e32_j1939_view_t view;
+    view.frame = NULL;
+    view.source_address = id->source_address;
+    view.priority = id->priority;
+    view.timestamp = frame->timestamp;
+    view.channel = frame->channel;
+
+    e32_cpg_t cpg;
+    uint16_t at = 0;
+    uint8_t len = frame->dlc > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : frame->dlc;
+    while (e32_mpg_next(frame->data, len, &at, &cpg)) {
+        uint8_t wants = client_wants(client, cpg.pgn);
+        if (!wants && !client->requests.in_flight) {
+            continue;
+        }
+
+        view.data = cpg.data;
+        view.len = cpg.len;
+        view.pgn = cpg.pgn;
+        /* PDU1 PGs go where the container went, PDU2 PGs are broadcasts */
+        view.destination_address = (((cpg.pgn >> 8) & 0xFF) < 240) ? id->destination_address
+                                                                    : E32_SA_GLOBAL;
+
+        if (client->requests.in_flight) {
+            e32_requests_match(&client->requests, &view, client->address);
+        }
+        if (wants) {
+            route(client, &view, wants);
+        }
+    }
+}
+#endif
+
 /**
- * @brief Called by transport layer when a frame is received
+ * @brief Decode a received frame and call its handlers immediately
  * 
- * This function is called by the platform-specific transport
- * when a CAN frame is received.
+ * Runs in the caller's context, or queues the frame for its worker when
+ * config.workers is set. e32_j1939_poll() uses it for every frame
+ * drained from the receive ring; drivers running in interrupt context
+ * must use e32_j1939_rx_push_isr() instead.
  */
 void e32_j1939_dispatch_frame(e32_j1939_client_t client, const e32_can_frame_t* frame)
 {
     if (!client || !frame) return;
     
-    e32_j1939_message_t message;
-    if (e32_decode_frame(frame, &message) != E32_OK) {
+    e32_j1939_id_t id;
+    e32_parse_j1939_id(frame->id, &id);
+    
+    if (frame->channel < client->channel_count && client->channels[frame->channel].busload.enabled) {
+        busload_frame(&client->channels[frame->channel], frame, &id, frame->timestamp);
+    }
+    
+    /* Network management keeps the NAME tables and our claim current */
+    if ((id.pgn == E32_PGN_ADDRESS_CLAIMED || id.pgn == E32_PGN_REQUEST) &&
+        frame->channel < client->channel_count) {
+        claim_frame(client, &id, frame);
+    }
+    
+    /* Transport protocol frames feed session reassembly first */
+    if ((id.pgn == E32_PGN_TP_CM || id.pgn == E32_PGN_TP_DT) &&
+        frame->channel < client->channel_count) {
+        e32_tp_rx_frame(&client->channels[frame->channel].tp, &id, frame, client_now(client));
+    }
+    
+#ifdef E32_CFG_CAN_FD
+    if (id.pgn == E32_PGN_MULTI_PG) {
+        dispatch_contained(client, &id, frame);
+    }
+#endif
+    
+    /* Look up subscribers first - frames nobody wants are never decoded */
+    uint8_t wants = client_wants(client, id.pgn);
+    stats_frame(client, wants != 0);
+    if (!wants && !client->requests.in_flight) {
         return;
     }
     
-    /* Dispatch to handlers */
-    for (int i = 0; i < MAX_PGN_HANDLERS; i++) {
-        if (client->subscriptions[i].active &&
-            client->subscriptions[i].pgn == message.pgn) {
-            client->subscriptions[i].handler(&message, client->subscriptions[i].user_data);
-        }
+    /* The view borrows the frame; only message handlers pay for a decode */
+    e32_j1939_view_t view;
+    view.frame = frame;
+    view.data = frame->data;
+    view.len = frame->dlc > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : frame->dlc;
+    view.pgn = id.pgn;
+    view.source_address = id.source_address;
+    view.destination_address = id.destination_address;
+    view.priority = id.priority;
+    view.timestamp = frame->timestamp;
+    view.channel = frame->channel;
+    
+    if (client->requests.in_flight) {
+        e32_requests_match(&client->requests, &view, client->address);
+    }
+    if (wants) {
+        route(client, &view, wants);
     }
 }
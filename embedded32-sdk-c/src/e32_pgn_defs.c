@@ -0,0 +1,55 @@
+/**
+ * @file e32_pgn_defs.c
+ * @brief Embedded32 SDK - PGN/SPN Decoder Tables
+ *
+ * GENERATED FILE - DO NOT EDIT.
+ * Source: defs/j1939_pgns.json
+ * Regenerate with tools/gen_pgn_tables.py.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_pgn_defs.h"
+
+const e32_spn_def_t E32_SPN_DEFS[] E32_TABLE_ATTR = {
+    /*    0 */ {   2540, "requestedPGN",             0, 24, E32_SPN_TYPE_INT,   0, 1.0f,         0.0f,        1,      0,      1u },
+    /*    1 */ { 516096, "targetRpm",                0, 16, E32_SPN_TYPE_INT,   0, 1.0f,         0.0f,        1,      0,      1u },
+    /*    2 */ { 516097, "enable",                  16,  8, E32_SPN_TYPE_BOOL,  0, 1.0f,         0.0f,        1,      0,      1u },
+    /*    3 */ {    191, "outputShaftSpeed",         0, 16, E32_SPN_TYPE_FLOAT, 0, 0.125f,       0.0f,        1,      0,      8u },
+    /*    4 */ {    523, "gear",                    32,  8, E32_SPN_TYPE_INT,   0, 1.0f,         0.0f,        1,      0,      1u },
+    /*    5 */ {    190, "engineSpeed",             24, 16, E32_SPN_TYPE_FLOAT, 0, 0.125f,       0.0f,        1,      0,      8u },
+    /*    6 */ {    513, "torque",                  16,  8, E32_SPN_TYPE_INT,   0, 1.0f,         -125.0f,     1,   -125,      1u },
+    /*    7 */ {    512, "driverDemandTorque",       8,  8, E32_SPN_TYPE_INT,   0, 1.0f,         -125.0f,     1,   -125,      1u },
+    /*    8 */ {   1483, "controllingDeviceSA",     40,  8, E32_SPN_TYPE_INT,   0, 1.0f,         0.0f,        1,      0,      1u },
+    /*    9 */ {    110, "coolantTemp",              0,  8, E32_SPN_TYPE_INT,   0, 1.0f,         -40.0f,      1,    -40,      1u },
+    /*   10 */ {    174, "fuelTemp",                 8,  8, E32_SPN_TYPE_INT,   0, 1.0f,         -40.0f,      1,    -40,      1u },
+    /*   11 */ {    175, "oilTemp",                 16, 16, E32_SPN_TYPE_FLOAT, 0, 0.03125f,     -273.0f,     1,  -8736,     32u },
+    /*   12 */ {     84, "vehicleSpeed",             8, 16, E32_SPN_TYPE_FLOAT, 0, 0.00390625f,  0.0f,        1,      0,    256u },
+    /*   13 */ {    183, "fuelRate",                 0, 16, E32_SPN_TYPE_FLOAT, 0, 0.05f,        0.0f,        1,      0,     20u },
+    /*   14 */ {    184, "instantFuelEconomy",      16, 16, E32_SPN_TYPE_FLOAT, 0, 0.001953125f, 0.0f,        1,      0,    512u },
+    /*   15 */ {     51, "throttlePosition",        48,  8, E32_SPN_TYPE_FLOAT, 0, 0.4f,         0.0f,        2,      0,      5u },
+    /*   16 */ {    168, "batteryPotential",        32, 16, E32_SPN_TYPE_FLOAT, 0, 0.05f,        0.0f,        1,      0,     20u },
+    /*   17 */ {     96, "fuelLevel",                8,  8, E32_SPN_TYPE_FLOAT, 0, 0.4f,         0.0f,        2,      0,      5u },
+};
+
+/* Every known PGN, sorted by PGN for binary search */
+const e32_pgn_def_t E32_PGN_DEFS[] E32_TABLE_ATTR = {
+    { 0x0EA00, "Request",                                                  0,    3,   1 },
+    { 0x0EB00, "Transport Protocol - Data Transfer (TP.DT)",               0,    8,   0 },
+    { 0x0EC00, "Transport Protocol - Connection Management (TP.CM)",       0,    8,   0 },
+    { 0x0EE00, "Address Claimed",                                          0,    8,   0 },
+    { 0x0EF00, "Engine Control Command (Proprietary B)",                   1,    8,   2 },
+    { 0x0F000, "Proprietary Transmission Status",                          3,    8,   2 },
+    { 0x0F003, "Electronic Transmission Controller 1 (ETC1)",              3,    8,   2 },
+    { 0x0F004, "Electronic Engine Controller 1 (EEC1)",                    5,    8,   4 },
+    { 0x0FECA, "DM1 - Active Diagnostic Trouble Codes",                    0,    8,   0 },
+    { 0x0FECB, "DM2 - Previously Active DTCs",                             0,    8,   0 },
+    { 0x0FEEE, "Engine Temperature 1 (ET1)",                               9,    8,   3 },
+    { 0x0FEF1, "Cruise Control/Vehicle Speed (CCVS)",                     12,    8,   1 },
+    { 0x0FEF2, "Fuel Economy (FE)",                                       13,    8,   3 },
+    { 0x0FEF7, "Vehicle Electrical Power 1 (VEP1)",                       16,    8,   1 },
+    { 0x0FEFC, "Dash Display (DD)",                                       17,    8,   1 },
+};
+
+const size_t E32_SPN_DEFS_COUNT = 18;
+const size_t E32_PGN_DEFS_COUNT = 15;
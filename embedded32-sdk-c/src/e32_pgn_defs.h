@@ -0,0 +1,111 @@
+/**
+ * @file e32_pgn_defs.h
+ * @brief Embedded32 SDK - PGN/SPN Decoder Table Types (internal)
+ *
+ * Layout of the constant tables generated into e32_pgn_defs.c by
+ * tools/gen_pgn_tables.py. The tables are const so they are placed in
+ * flash on MCU targets; define E32_CFG_TABLE_SECTION to pin them to a
+ * specific linker section.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_PGN_DEFS_H
+#define E32_PGN_DEFS_H
+
+#include "e32_types.h"
+#include "e32_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Raw field is two's complement */
+#define E32_SPN_FLAG_SIGNED     0x01
+
+/**
+ * @brief Bit-field SPN: value = raw(start_bit, bit_length) * scale + offset
+ *
+ * Bit numbering is J1939-71 little-endian, bit 0 = LSB of data byte 1.
+ * The compact decoder uses the exact integer form of the same mapping:
+ * value * fixed_den = raw * fixed_num + fixed_offset.
+ */
+typedef struct {
+    uint32_t        spn;            /**< SPN number */
+    const char*     name;           /**< SDK name (e.g. "engineSpeed") */
+    uint16_t        start_bit;      /**< First bit in the PGN payload */
+    uint8_t         bit_length;     /**< Field width (1-32) */
+    uint8_t         type;           /**< e32_spn_type_t */
+    uint8_t         flags;          /**< E32_SPN_FLAG_* */
+    float           scale;          /**< Resolution per bit */
+    float           offset;         /**< Offset added after scaling */
+    int32_t         fixed_num;      /**< Resolution numerator */
+    int32_t         fixed_offset;   /**< Offset in 1/fixed_den units */
+    uint32_t        fixed_den;      /**< Common denominator of resolution and offset */
+} e32_spn_def_t;
+
+/**
+ * @brief One PGN of the catalogue
+ *
+ * Its SPNs are E32_SPN_DEFS[first_spn .. first_spn + spn_count);
+ * spn_count is 0 for PGNs that are named but not table-decoded.
+ */
+typedef struct {
+    uint32_t    pgn;
+    const char* name;
+    uint16_t    first_spn;
+    uint16_t    length;         /**< Nominal payload length in bytes */
+    uint8_t     spn_count;
+} e32_pgn_def_t;
+
+extern const e32_spn_def_t E32_SPN_DEFS[];
+extern const size_t        E32_SPN_DEFS_COUNT;
+
+/** Sorted by PGN */
+extern const e32_pgn_def_t E32_PGN_DEFS[];
+extern const size_t        E32_PGN_DEFS_COUNT;
+
+/**
+ * @brief Binary-search the decoder table for a PGN
+ *
+ * O(log n) in the catalogue size; one search yields both name and SPNs.
+ *
+ * @return Definition, or NULL if the PGN is not in the catalogue
+ */
+const e32_pgn_def_t* e32_find_pgn_def(uint32_t pgn);
+
+/**
+ * @brief Find an SPN among the SPNs of a PGN
+ *
+ * @return Definition, or NULL if pgn_def is NULL or has no such SPN
+ */
+const e32_spn_def_t* e32_find_spn_def(const e32_pgn_def_t* pgn_def, uint32_t spn);
+
+/**
+ * @brief Scale an extracted raw field into a typed SPN value
+ *
+ * Shared by the per-frame and batch decoders so both produce identical
+ * values (sign extension, scale/offset, bool as raw == 1).
+ */
+void e32_spn_from_raw(const e32_spn_def_t* def, uint32_t raw, e32_spn_t* out);
+
+/**
+ * @brief Integer-only counterpart of e32_spn_from_raw() for compact SPNs
+ */
+void e32_spn_compact_from_raw(const e32_spn_def_t* def, uint32_t raw, e32_spn_compact_t* out);
+
+/**
+ * @brief Extract and scale one compact SPN from a payload
+ *
+ * @return false if the field lies beyond len bytes
+ */
+bool e32_spn_decode_compact(const e32_spn_def_t* def, const uint8_t* data, uint16_t len,
+                            e32_spn_compact_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_PGN_DEFS_H */
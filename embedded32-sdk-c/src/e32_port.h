@@ -0,0 +1,83 @@
+/**
+ * @file e32_port.h
+ * @brief Embedded32 SDK - Compiler/Platform Portability Macros (internal)
+ *
+ * Alignment and memory-ordering primitives used by the lock-free
+ * structures shared between interrupt and thread context.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_PORT_H
+#define E32_PORT_H
+
+#include <stdint.h>
+
+/* ==========================================================================
+ * ALIGNMENT
+ * ========================================================================== */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define E32_ALIGNED(n)          __attribute__((aligned(n)))
+#elif defined(_MSC_VER)
+#define E32_ALIGNED(n)          __declspec(align(n))
+#else
+#define E32_ALIGNED(n)
+#endif
+
+/* ==========================================================================
+ * CONSTANT TABLE PLACEMENT
+ * ========================================================================== */
+
+#if defined(E32_CFG_TABLE_SECTION) && (defined(__GNUC__) || defined(__clang__))
+#define E32_TABLE_ATTR          __attribute__((section(E32_CFG_TABLE_SECTION)))
+#else
+#define E32_TABLE_ATTR
+#endif
+
+/* ==========================================================================
+ * MEMORY ORDERING
+ * ========================================================================== */
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#define E32_LOAD_RELAXED(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define E32_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define E32_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define E32_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define E32_CAS_WEAK(p, e, d)   __atomic_compare_exchange_n((p), (e), (d), 1, \
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define E32_FETCH_ADD(p, v)     __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define E32_FENCE_SEQ_CST()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define E32_FENCE_ACQUIRE()     __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define E32_FENCE_RELEASE()     __atomic_thread_fence(__ATOMIC_RELEASE)
+
+#elif defined(_MSC_VER)
+
+#include <intrin.h>
+/* x86/x64 loads and stores are already acquire/release; stop the compiler only */
+#define E32_LOAD_RELAXED(p)     (*(volatile uint32_t*)(p))
+#define E32_LOAD_ACQUIRE(p)     (_ReadWriteBarrier(), *(volatile uint32_t*)(p))
+#define E32_STORE_RELAXED(p, v) (*(volatile uint32_t*)(p) = (v))
+#define E32_STORE_RELEASE(p, v) do { _ReadWriteBarrier(); *(volatile uint32_t*)(p) = (v); } while (0)
+#define E32_CAS_WEAK(p, e, d)   e32_cas_msvc((volatile long*)(p), (long*)(e), (long)(d))
+#define E32_FETCH_ADD(p, v)     _InterlockedExchangeAdd((volatile long*)(p), (long)(v))
+#define E32_FENCE_SEQ_CST()     _mm_mfence()
+#define E32_FENCE_ACQUIRE()     _ReadWriteBarrier()
+#define E32_FENCE_RELEASE()     _ReadWriteBarrier()
+
+static __inline int e32_cas_msvc(volatile long* p, long* expected, long desired)
+{
+    long seen = _InterlockedCompareExchange(p, desired, *expected);
+    if (seen == *expected) return 1;
+    *expected = seen;
+    return 0;
+}
+
+#else
+#error "e32_port.h: no atomic primitives for this compiler"
+#endif
+
+#endif /* E32_PORT_H */
@@ -0,0 +1,243 @@
+/**
+ * @file e32_request.c
+ * @brief Embedded32 SDK - Request/Response Correlation Implementation
+ *
+ * The table is small, so in-flight requests are found by scanning it;
+ * the scan only runs while something is in flight.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_request.h"
+#include <string.h>
+
+/* Acknowledgment control byte (J1939-21) */
+#define ACK_POSITIVE        0
+#define ACK_CANNOT_RESPOND  3
+
+static bool addressed_to(const e32_j1939_view_t* view, uint8_t own_sa)
+{
+    return view->destination_address == E32_SA_GLOBAL || view->destination_address == own_sa;
+}
+
+static e32_error_t ack_status(uint8_t control)
+{
+    switch (control) {
+        case ACK_POSITIVE:
+            return E32_OK;
+        case ACK_CANNOT_RESPOND:
+            return E32_ERR_BUSY;
+        default:
+            return E32_ERR_NOT_SUPPORTED;   /* NACK, Access Denied */
+    }
+}
+
+/* Free a SENT entry, then call back (which may reuse it) */
+static void finish(e32_requests_t* reqs, uint16_t index, e32_error_t status,
+                   const e32_j1939_view_t* response)
+{
+    e32_request_t* request = &reqs->entries[index];
+    e32_response_fn_t done = request->done;
+    void* user_data = request->user_data;
+
+    request->state = E32_REQUEST_FREE;
+    reqs->in_flight--;
+    if (done) {
+        done(status, response, user_data);
+    }
+}
+
+void e32_requests_init(e32_requests_t* reqs)
+{
+    memset(reqs, 0, sizeof(*reqs));
+    reqs->wait_head = E32_REQUEST_NIL;
+    reqs->wait_tail = E32_REQUEST_NIL;
+}
+
+e32_error_t e32_requests_add(e32_requests_t* reqs, uint8_t channel, uint32_t pgn,
+                             uint8_t destination, uint32_t timeout_ms,
+                             e32_response_fn_t done, void* user_data)
+{
+    uint16_t i = 0;
+    while (i < E32_CFG_REQUEST_MAX && reqs->entries[i].state != E32_REQUEST_FREE) {
+        i++;
+    }
+    if (i == E32_CFG_REQUEST_MAX) {
+        return E32_ERR_NO_MEMORY;
+    }
+
+    e32_request_t* request = &reqs->entries[i];
+    request->state = E32_REQUEST_WAITING;
+    request->channel = channel;
+    request->destination = destination;
+    request->status = E32_ERR_TIMEOUT;
+    request->next = E32_REQUEST_NIL;
+    request->pgn = pgn;
+    request->timeout = timeout_ms ? timeout_ms : E32_REQUEST_TIMEOUT_MS;
+    request->deadline = 0;
+    request->done = done;
+    request->user_data = user_data;
+
+    if (reqs->wait_tail == E32_REQUEST_NIL) {
+        reqs->wait_head = i;
+    } else {
+        reqs->entries[reqs->wait_tail].next = i;
+    }
+    reqs->wait_tail = i;
+    return E32_OK;
+}
+
+static bool may_start(const e32_requests_t* reqs, const e32_request_t* request)
+{
+    if (reqs->in_flight >= E32_CFG_REQUEST_IN_FLIGHT) {
+        return false;
+    }
+
+    uint32_t to_destination = 0;
+    for (uint16_t i = 0; i < E32_CFG_REQUEST_MAX; i++) {
+        const e32_request_t* other = &reqs->entries[i];
+        if (other->state != E32_REQUEST_SENT || other->channel != request->channel ||
+            other->destination != request->destination) {
+            continue;
+        }
+        /* The response could not tell the two apart */
+        if (other->pgn == request->pgn || ++to_destination >= E32_CFG_REQUEST_PER_DEST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void e32_requests_start(e32_requests_t* reqs, uint32_t now,
+                        e32_request_send_fn_t send, void* ctx)
+{
+    uint16_t prev = E32_REQUEST_NIL;
+
+    for (uint16_t i = reqs->wait_head;
+         i != E32_REQUEST_NIL && reqs->in_flight < E32_CFG_REQUEST_IN_FLIGHT; ) {
+        e32_request_t* request = &reqs->entries[i];
+        uint16_t next = request->next;
+
+        if (!may_start(reqs, request)) {
+            prev = i;
+            i = next;
+            continue;
+        }
+
+        e32_error_t err = send(ctx, request);
+        if (err == E32_ERR_BUSY) {
+            return;                         /* Transmit queue full: retried from the next poll */
+        }
+
+        if (prev == E32_REQUEST_NIL) {
+            reqs->wait_head = next;
+        } else {
+            reqs->entries[prev].next = next;
+        }
+        if (reqs->wait_tail == i) {
+            reqs->wait_tail = prev;
+        }
+
+        request->state = E32_REQUEST_SENT;
+        if (err == E32_OK) {
+            request->deadline = now + request->timeout;
+        } else {
+            request->status = (int8_t)err;
+            request->deadline = now;
+        }
+        reqs->in_flight++;
+        i = next;
+    }
+}
+
+void e32_requests_expire(e32_requests_t* reqs, uint32_t now)
+{
+    for (uint16_t i = 0; i < E32_CFG_REQUEST_MAX && reqs->in_flight; i++) {
+        const e32_request_t* request = &reqs->entries[i];
+        if (request->state == E32_REQUEST_SENT && (int32_t)(now - request->deadline) >= 0) {
+            finish(reqs, i, (e32_error_t)request->status, NULL);
+        }
+    }
+}
+
+void e32_requests_match(e32_requests_t* reqs, const e32_j1939_view_t* view, uint8_t own_sa)
+{
+    if (!addressed_to(view, own_sa)) {
+        return;
+    }
+
+    uint32_t pgn = view->pgn;
+    bool ack = (pgn == E32_PGN_ACKNOWLEDGMENT && view->len >= 8);
+    if (ack) {
+        /* Byte 5 names the requester (0xFF from pre-2006 nodes) */
+        if (view->data[4] != own_sa && view->data[4] != E32_SA_GLOBAL) {
+            return;
+        }
+        pgn = view->data[5] | ((uint32_t)view->data[6] << 8) | ((uint32_t)(view->data[7] & 0x03) << 16);
+    }
+
+    for (uint16_t i = 0; i < E32_CFG_REQUEST_MAX && reqs->in_flight; i++) {
+        e32_request_t* request = &reqs->entries[i];
+        if (request->state != E32_REQUEST_SENT || request->pgn != pgn ||
+            request->channel != view->channel) {
+            continue;
+        }
+
+        if (request->destination == E32_SA_GLOBAL) {
+            /* Collecting until the deadline; nobody acknowledges a global request */
+            if (!ack && request->done) {
+                request->done(E32_OK, view, request->user_data);
+            }
+        } else if (request->destination == view->source_address) {
+            finish(reqs, i, ack ? ack_status(view->data[0]) : E32_OK, view);
+        }
+    }
+}
+
+bool e32_requests_expects(const e32_requests_t* reqs, uint32_t pgn)
+{
+    for (uint16_t i = 0; i < E32_CFG_REQUEST_MAX && reqs->in_flight; i++) {
+        if (reqs->entries[i].state == E32_REQUEST_SENT && reqs->entries[i].pgn == pgn) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t e32_requests_next_timeout(const e32_requests_t* reqs, uint32_t now)
+{
+    uint32_t next = UINT32_MAX;
+
+    for (uint16_t i = 0; i < E32_CFG_REQUEST_MAX && reqs->in_flight; i++) {
+        const e32_request_t* request = &reqs->entries[i];
+        if (request->state != E32_REQUEST_SENT) {
+            continue;
+        }
+        int32_t left = (int32_t)(request->deadline - now);
+        uint32_t t = left > 0 ? (uint32_t)left : 0;
+        if (t < next) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+void e32_requests_cancel(e32_requests_t* reqs, e32_error_t status)
+{
+    reqs->wait_head = E32_REQUEST_NIL;
+    reqs->wait_tail = E32_REQUEST_NIL;
+    reqs->in_flight = 0;
+
+    for (uint16_t i = 0; i < E32_CFG_REQUEST_MAX; i++) {
+        e32_request_t* request = &reqs->entries[i];
+        if (request->state == E32_REQUEST_FREE) {
+            continue;
+        }
+        e32_response_fn_t done = request->done;
+        void* user_data = request->user_data;
+        request->state = E32_REQUEST_FREE;
+        if (done) {
+            done(status, NULL, user_data);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file e32_request.h
+ * @brief Embedded32 SDK - Request/Response Correlation (internal)
+ *
+ * Tracks Requests (PGN 59904) until the destination answers, refuses
+ * with an Acknowledgment, or the timeout runs out. New requests wait in
+ * submission order and are started as soon as the in-flight window and
+ * the per-destination limit allow; a destination that is slow to answer
+ * holds up only the requests addressed to it.
+ *
+ * Callbacks run from e32_requests_match() and e32_requests_expire() and
+ * may submit new requests.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_REQUEST_H
+#define E32_REQUEST_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define E32_REQUEST_NIL     0xFFFF
+
+/**
+ * @brief Entry state
+ */
+typedef enum {
+    E32_REQUEST_FREE = 0,
+    E32_REQUEST_WAITING,    /**< Queued, not sent yet */
+    E32_REQUEST_SENT        /**< On the bus, waiting for the response */
+} e32_request_state_t;
+
+/**
+ * @brief One request
+ */
+typedef struct {
+    uint8_t           state;        /**< e32_request_state_t */
+    uint8_t           channel;
+    uint8_t           destination;
+    int8_t            status;       /**< Reported when the deadline passes */
+    uint16_t          next;         /**< Next waiting entry */
+    uint32_t          pgn;
+    uint32_t          timeout;      /**< ms */
+    uint32_t          deadline;     /**< While SENT, ms */
+    e32_response_fn_t done;
+    void*             user_data;
+} e32_request_t;
+
+/**
+ * @brief Request table
+ */
+typedef struct {
+    e32_request_t entries[E32_CFG_REQUEST_MAX];
+    uint16_t      wait_head;    /**< Waiting entries, oldest first */
+    uint16_t      wait_tail;
+    uint16_t      in_flight;    /**< Entries SENT */
+} e32_requests_t;
+
+/**
+ * @brief Puts one Request frame on the transmit path
+ *
+ * @return E32_OK, E32_ERR_BUSY to retry later, or an error for the request
+ */
+typedef e32_error_t (*e32_request_send_fn_t)(void* ctx, const e32_request_t* request);
+
+/**
+ * @brief Drop every entry without calling back
+ */
+void e32_requests_init(e32_requests_t* reqs);
+
+/**
+ * @brief Queue a request behind the ones already waiting
+ *
+ * @return E32_OK, E32_ERR_NO_MEMORY if all entries are in use
+ */
+e32_error_t e32_requests_add(e32_requests_t* reqs, uint8_t channel, uint32_t pgn,
+                             uint8_t destination, uint32_t timeout_ms,
+                             e32_response_fn_t done, void* user_data);
+
+/**
+ * @brief Send every waiting request the limits allow
+ *
+ * Stops at the first E32_ERR_BUSY. Other send errors are reported
+ * through the next e32_requests_expire().
+ */
+void e32_requests_start(e32_requests_t* reqs, uint32_t now,
+                        e32_request_send_fn_t send, void* ctx);
+
+/**
+ * @brief Complete requests whose deadline has passed
+ */
+void e32_requests_expire(e32_requests_t* reqs, uint32_t now);
+
+/**
+ * @brief Complete the requests a received message answers
+ *
+ * @param own_sa Our source address: PDU1 responses to others do not count
+ */
+void e32_requests_match(e32_requests_t* reqs, const e32_j1939_view_t* view, uint8_t own_sa);
+
+/**
+ * @brief Whether a request in flight waits for pgn (multi-packet responses)
+ */
+bool e32_requests_expects(const e32_requests_t* reqs, uint32_t pgn);
+
+/**
+ * @brief Milliseconds until the next deadline
+ *
+ * @return UINT32_MAX when nothing is in flight
+ */
+uint32_t e32_requests_next_timeout(const e32_requests_t* reqs, uint32_t now);
+
+/**
+ * @brief Complete every request with status
+ */
+void e32_requests_cancel(e32_requests_t* reqs, e32_error_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_REQUEST_H */
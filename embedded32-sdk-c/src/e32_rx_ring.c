@@ -0,0 +1,99 @@
+/**
+ * @file e32_rx_ring.c
+ * @brief Embedded32 SDK - Lock-Free SPSC Receive Ring Implementation
+ *
+ * Indices are free-running 32-bit counters; the slot is index & mask.
+ * The producer publishes with a release store of head, the consumer
+ * frees slots with a release store of tail.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_rx_ring.h"
+#include <string.h>
+
+static void note_depth(e32_rx_ring_t* ring, uint32_t depth)
+{
+    if (depth > ring->peak_depth) {
+        E32_STORE_RELAXED(&ring->peak_depth, depth);
+    }
+    if (depth == ring->high_water) {
+        E32_STORE_RELAXED(&ring->high_water_events, ring->high_water_events + 1);
+    }
+}
+
+void e32_rx_ring_init(e32_rx_ring_t* ring, uint32_t high_water)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    if (high_water == 0 || high_water > E32_CFG_RX_RING_SIZE) {
+        high_water = (E32_CFG_RX_RING_SIZE * 3) / 4;
+    }
+    ring->high_water = high_water;
+}
+
+e32_error_t e32_rx_ring_push(e32_rx_ring_t* ring, const e32_can_frame_t* frame)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = E32_LOAD_ACQUIRE(&ring->tail);
+
+    if (head - tail >= E32_CFG_RX_RING_SIZE) {
+        E32_STORE_RELAXED(&ring->overflows, ring->overflows + 1);
+        return E32_ERR_NO_MEMORY;
+    }
+
+    ring->slots[head & E32_RX_RING_MASK] = *frame;
+    E32_STORE_RELEASE(&ring->head, head + 1);
+
+    note_depth(ring, head + 1 - tail);
+    return E32_OK;
+}
+
+e32_can_frame_t* e32_rx_ring_reserve(e32_rx_ring_t* ring, uint32_t* count)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = E32_LOAD_ACQUIRE(&ring->tail);
+    uint32_t free_slots = E32_CFG_RX_RING_SIZE - (head - tail);
+    uint32_t to_end = E32_CFG_RX_RING_SIZE - (head & E32_RX_RING_MASK);
+
+    *count = (free_slots < to_end) ? free_slots : to_end;
+    return &ring->slots[head & E32_RX_RING_MASK];
+}
+
+void e32_rx_ring_commit(e32_rx_ring_t* ring, uint32_t n)
+{
+    if (n == 0) return;
+
+    uint32_t head = ring->head + n;
+    E32_STORE_RELEASE(&ring->head, head);
+
+    uint32_t depth = head - E32_LOAD_ACQUIRE(&ring->tail);
+    if (depth > ring->peak_depth) {
+        E32_STORE_RELAXED(&ring->peak_depth, depth);
+    }
+    /* A batch can jump across the threshold rather than land on it */
+    if (depth >= ring->high_water && depth - n < ring->high_water) {
+        E32_STORE_RELAXED(&ring->high_water_events, ring->high_water_events + 1);
+    }
+}
+
+uint32_t e32_rx_ring_peek(e32_rx_ring_t* ring, e32_can_frame_t** first)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = E32_LOAD_ACQUIRE(&ring->head);
+    uint32_t pending = head - tail;
+    uint32_t to_end = E32_CFG_RX_RING_SIZE - (tail & E32_RX_RING_MASK);
+
+    *first = &ring->slots[tail & E32_RX_RING_MASK];
+    return (pending < to_end) ? pending : to_end;
+}
+
+void e32_rx_ring_release(e32_rx_ring_t* ring, uint32_t n)
+{
+    E32_STORE_RELEASE(&ring->tail, ring->tail + n);
+}
+
+uint32_t e32_rx_ring_depth(const e32_rx_ring_t* ring)
+{
+    return E32_LOAD_ACQUIRE(&ring->head) - E32_LOAD_ACQUIRE(&ring->tail);
+}
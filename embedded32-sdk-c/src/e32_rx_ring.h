@@ -0,0 +1,97 @@
+/**
+ * @file e32_rx_ring.h
+ * @brief Embedded32 SDK - Lock-Free SPSC Receive Ring (internal)
+ *
+ * Fixed-capacity ring of raw CAN frames between exactly one producer
+ * (an ISR, a driver task, or the transport backend inside poll) and
+ * exactly one consumer (e32_j1939_poll). Producer and consumer indices
+ * sit on separate cache lines; no locks or interrupt masking are needed.
+ *
+ * Both sides work on contiguous slot runs so a backend can receive
+ * straight into the ring, and poll can dispatch straight out of it.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_RX_RING_H
+#define E32_RX_RING_H
+
+#include "e32_types.h"
+#include "e32_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define E32_RX_RING_MASK    (E32_CFG_RX_RING_SIZE - 1)
+
+/**
+ * @brief SPSC frame ring
+ */
+typedef struct {
+    /* Producer-owned line */
+    E32_ALIGNED(E32_CFG_CACHE_LINE) uint32_t head;
+    uint32_t overflows;         /**< Frames dropped because the ring was full */
+    uint32_t high_water_events; /**< Times the fill level reached high_water */
+    uint32_t peak_depth;        /**< Highest fill level observed */
+    uint32_t high_water;        /**< Threshold set at init */
+
+    /* Consumer-owned line */
+    E32_ALIGNED(E32_CFG_CACHE_LINE) uint32_t tail;
+
+    E32_ALIGNED(E32_CFG_CACHE_LINE) e32_can_frame_t slots[E32_CFG_RX_RING_SIZE];
+} e32_rx_ring_t;
+
+/**
+ * @brief Reset the ring
+ *
+ * @param high_water Fill level at which high_water_events is counted
+ *                   (0 selects 3/4 of the capacity)
+ */
+void e32_rx_ring_init(e32_rx_ring_t* ring, uint32_t high_water);
+
+/**
+ * @brief Producer: copy one frame into the ring
+ *
+ * @return E32_OK, or E32_ERR_NO_MEMORY if full (frame dropped and counted)
+ */
+e32_error_t e32_rx_ring_push(e32_rx_ring_t* ring, const e32_can_frame_t* frame);
+
+/**
+ * @brief Producer: get the contiguous run of free slots
+ *
+ * @param count Receives the number of free contiguous slots
+ * @return First free slot (valid when *count > 0)
+ */
+e32_can_frame_t* e32_rx_ring_reserve(e32_rx_ring_t* ring, uint32_t* count);
+
+/**
+ * @brief Producer: publish n slots previously obtained from reserve
+ */
+void e32_rx_ring_commit(e32_rx_ring_t* ring, uint32_t n);
+
+/**
+ * @brief Consumer: get the contiguous run of pending frames
+ *
+ * @param first Receives the first pending slot
+ * @return Number of contiguous pending frames
+ */
+uint32_t e32_rx_ring_peek(e32_rx_ring_t* ring, e32_can_frame_t** first);
+
+/**
+ * @brief Consumer: hand n slots back to the producer
+ */
+void e32_rx_ring_release(e32_rx_ring_t* ring, uint32_t n);
+
+/**
+ * @brief Current number of pending frames (either side)
+ */
+uint32_t e32_rx_ring_depth(const e32_rx_ring_t* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_RX_RING_H */
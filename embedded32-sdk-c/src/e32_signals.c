@@ -0,0 +1,187 @@
+/**
+ * @file e32_signals.c
+ * @brief Embedded32 SDK - Last-Value Signal Cache Implementation
+ *
+ * Classic sequence lock: the writer makes seq odd, stores the value
+ * words, then makes seq even again with release ordering. A reader
+ * copies the words between two loads of seq and keeps the copy only if
+ * both loads saw the same even number.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_signals.h"
+#include "e32_pgn_defs.h"
+#include "e32_port.h"
+#include <string.h>
+
+static uint64_t pgn_bit(uint32_t pgn)
+{
+    return (uint64_t)1 << ((pgn ^ (pgn >> 6) ^ (pgn >> 12)) & 63);
+}
+
+static void rebuild_pgn_bits(e32_signals_t* table)
+{
+    table->pgn_bits = 0;
+    for (uint16_t i = 0; i < E32_CFG_MAX_SIGNALS; i++) {
+        if (table->signals[i].used) {
+            table->pgn_bits |= pgn_bit(table->signals[i].pgn);
+        }
+    }
+}
+
+static int find_signal(const e32_signals_t* table, uint8_t sa, uint32_t pgn, uint16_t def_index)
+{
+    for (uint16_t i = 0; i < E32_CFG_MAX_SIGNALS; i++) {
+        const e32_signal_t* s = &table->signals[i];
+        if (s->used && s->sa == sa && s->pgn == pgn && s->def_index == def_index) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool lookup_def(uint32_t pgn, uint32_t spn, uint16_t* def_index)
+{
+    const e32_spn_def_t* def = e32_find_spn_def(e32_find_pgn_def(pgn), spn);
+    if (!def) {
+        return false;
+    }
+    *def_index = (uint16_t)(def - E32_SPN_DEFS);
+    return true;
+}
+
+void e32_signals_init(e32_signals_t* table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+e32_error_t e32_signals_track(e32_signals_t* table, uint8_t sa, uint32_t pgn, uint32_t spn,
+                              uint32_t max_age_ms, uint16_t* id_out)
+{
+    uint16_t def_index;
+    if (!lookup_def(pgn, spn, &def_index)) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    int found = find_signal(table, sa, pgn, def_index);
+    if (found >= 0) {
+        table->signals[found].max_age = max_age_ms;
+        *id_out = (uint16_t)found;
+        return E32_OK;
+    }
+
+    for (uint16_t i = 0; i < E32_CFG_MAX_SIGNALS; i++) {
+        e32_signal_t* s = &table->signals[i];
+        if (s->used) {
+            continue;
+        }
+
+        memset(s, 0, sizeof(*s));
+        s->pgn = pgn;
+        s->max_age = max_age_ms;
+        s->def_index = def_index;
+        s->sa = sa;
+        s->used = true;
+
+        table->pgn_bits |= pgn_bit(pgn);
+        table->count++;
+        *id_out = i;
+        return E32_OK;
+    }
+
+    return E32_ERR_NO_MEMORY;
+}
+
+e32_error_t e32_signals_find(const e32_signals_t* table, uint8_t sa, uint32_t pgn,
+                             uint32_t spn, uint16_t* id_out)
+{
+    uint16_t def_index;
+    int found;
+
+    if (!lookup_def(pgn, spn, &def_index) || (found = find_signal(table, sa, pgn, def_index)) < 0) {
+        return E32_ERR_NOT_FOUND;
+    }
+    *id_out = (uint16_t)found;
+    return E32_OK;
+}
+
+e32_error_t e32_signals_untrack(e32_signals_t* table, uint16_t id)
+{
+    if (id >= E32_CFG_MAX_SIGNALS || !table->signals[id].used) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    table->signals[id].used = false;
+    table->count--;
+    rebuild_pgn_bits(table);
+    return E32_OK;
+}
+
+void e32_signals_update(e32_signals_t* table, const e32_j1939_view_t* view, uint32_t now)
+{
+    for (uint16_t i = 0; i < E32_CFG_MAX_SIGNALS; i++) {
+        e32_signal_t* s = &table->signals[i];
+        if (!s->used || s->pgn != view->pgn || s->sa != view->source_address) {
+            continue;
+        }
+
+        e32_spn_compact_t v;
+        if (!e32_spn_decode_compact(&E32_SPN_DEFS[s->def_index], view->data, view->len, &v)) {
+            continue;   /* Short payload: keep the previous value */
+        }
+
+        uint32_t seq = s->seq;
+        E32_STORE_RELAXED(&s->seq, seq + 1);
+        E32_FENCE_RELEASE();
+        E32_STORE_RELAXED(&s->value, (uint32_t)v.value);
+        E32_STORE_RELAXED(&s->status, (uint32_t)v.status);
+        E32_STORE_RELAXED(&s->updated, now);
+        E32_STORE_RELAXED(&s->updates, s->updates + 1);
+        E32_STORE_RELEASE(&s->seq, seq + 2);
+    }
+}
+
+e32_error_t e32_signals_read(const e32_signals_t* table, uint16_t id, uint32_t now,
+                             e32_signal_value_t* out)
+{
+    if (id >= E32_CFG_MAX_SIGNALS || !table->signals[id].used) {
+        return E32_ERR_NOT_FOUND;
+    }
+
+    const e32_signal_t* s = &table->signals[id];
+    uint32_t value, status, updated, updates;
+
+    for (;;) {
+        uint32_t seq = E32_LOAD_ACQUIRE(&s->seq);
+        if (seq & 1) {
+            continue;   /* Writer is mid-update; it holds the lock for four stores */
+        }
+        value = E32_LOAD_RELAXED(&s->value);
+        status = E32_LOAD_RELAXED(&s->status);
+        updated = E32_LOAD_RELAXED(&s->updated);
+        updates = E32_LOAD_RELAXED(&s->updates);
+        E32_FENCE_ACQUIRE();
+        if (E32_LOAD_RELAXED(&s->seq) == seq) {
+            break;
+        }
+    }
+
+    out->spn.value = (int32_t)value;
+    out->spn.index = s->def_index;
+    out->spn.type = (uint8_t)E32_SPN_DEFS[s->def_index].type;
+    out->spn.status = (uint8_t)status;
+    out->pgn = s->pgn;
+    out->source_address = s->sa;
+    out->updated_ms = updated;
+    out->updates = updates;
+
+    if (updates == 0) {
+        out->age_ms = 0;
+        out->state = E32_SIGNAL_NO_DATA;
+    } else {
+        out->age_ms = now - updated;
+        out->state = (s->max_age && out->age_ms > s->max_age) ? E32_SIGNAL_STALE : E32_SIGNAL_FRESH;
+    }
+    return E32_OK;
+}
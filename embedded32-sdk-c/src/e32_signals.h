@@ -0,0 +1,118 @@
+/**
+ * @file e32_signals.h
+ * @brief Embedded32 SDK - Last-Value Signal Cache (internal)
+ *
+ * Fixed table of tracked (source address, PGN, SPN) signals holding the
+ * latest compact value of each. The thread that polls the client is the
+ * only writer; any number of reader threads copy a signal out under a
+ * per-signal sequence lock, so readers never block the dispatch path and
+ * the writer never waits for a reader.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_SIGNALS_H
+#define E32_SIGNALS_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One tracked signal
+ *
+ * The words after seq are written under the lock. Readers treat them as
+ * 32-bit atomics, hence uint32_t throughout.
+ */
+typedef struct {
+    uint32_t seq;           /**< Odd while an update is in progress */
+    uint32_t value;         /**< e32_spn_compact_t value bits */
+    uint32_t status;        /**< e32_spn_status_t */
+    uint32_t updated;       /**< Client clock at the last update, ms */
+    uint32_t updates;       /**< Frames that carried the signal */
+
+    /* Fixed while tracked */
+    uint32_t pgn;
+    uint32_t max_age;       /**< ms before the value counts as stale, 0 = never */
+    uint16_t def_index;     /**< Row in E32_SPN_DEFS */
+    uint8_t  sa;
+    bool     used;
+} e32_signal_t;
+
+/**
+ * @brief Signal table
+ *
+ * pgn_bits is a one-word summary of the tracked PGNs, so frames of
+ * other PGNs are turned away without scanning the table.
+ */
+typedef struct {
+    e32_signal_t signals[E32_CFG_MAX_SIGNALS];
+    uint64_t     pgn_bits;
+    uint16_t     count;     /**< Entries in use */
+} e32_signals_t;
+
+/**
+ * @brief Reset the table, dropping every signal
+ */
+void e32_signals_init(e32_signals_t* table);
+
+/**
+ * @brief Start tracking (sa, pgn, spn), or change the age of a tracked one
+ *
+ * @return E32_OK, E32_ERR_NOT_FOUND if the SPN is not in the catalogue
+ *         for pgn, E32_ERR_NO_MEMORY if the table is full
+ */
+e32_error_t e32_signals_track(e32_signals_t* table, uint8_t sa, uint32_t pgn, uint32_t spn,
+                              uint32_t max_age_ms, uint16_t* id_out);
+
+/**
+ * @brief Find a tracked signal
+ *
+ * @return E32_OK, E32_ERR_NOT_FOUND
+ */
+e32_error_t e32_signals_find(const e32_signals_t* table, uint8_t sa, uint32_t pgn,
+                             uint32_t spn, uint16_t* id_out);
+
+/**
+ * @brief Stop tracking a signal
+ *
+ * @return E32_OK, E32_ERR_NOT_FOUND
+ */
+e32_error_t e32_signals_untrack(e32_signals_t* table, uint16_t id);
+
+/**
+ * @brief Whether any tracked signal could belong to pgn
+ *
+ * May report false positives, never false negatives.
+ */
+static inline bool e32_signals_wants(const e32_signals_t* table, uint32_t pgn)
+{
+    return (table->pgn_bits >> ((pgn ^ (pgn >> 6) ^ (pgn >> 12)) & 63)) & 1;
+}
+
+/**
+ * @brief Store the signals a received message carries
+ *
+ * Writer side; call from the polling thread only.
+ */
+void e32_signals_update(e32_signals_t* table, const e32_j1939_view_t* view, uint32_t now);
+
+/**
+ * @brief Copy a signal's latest value
+ *
+ * Safe from any thread while the signal stays tracked.
+ *
+ * @return E32_OK, E32_ERR_NOT_FOUND if id is not tracked
+ */
+e32_error_t e32_signals_read(const e32_signals_t* table, uint16_t id, uint32_t now,
+                             e32_signal_value_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_SIGNALS_H */
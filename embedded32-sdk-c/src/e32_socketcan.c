@@ -0,0 +1,353 @@
+/**
+ * @file e32_socketcan.c
+ * @brief Embedded32 SDK - Linux SocketCAN Transport
+ *
+ * Raw CAN socket backend. Frames are moved E32_CFG_RX_BATCH at a time
+ * with recvmmsg()/sendmmsg(), acceptance filtering is pushed into the
+ * kernel with CAN_RAW_FILTER, and receive timestamps are the kernel's
+ * SO_TIMESTAMPING software stamps, moved from CLOCK_REALTIME onto the
+ * CLOCK_MONOTONIC base of e32_time_ms(). E32_CFG_CAN_FD builds enable CAN_RAW_FD_FRAMES
+ * and move struct canfd_frame, whose first CAN_MTU bytes are a classic
+ * frame; the message length tells the two apart.
+ *
+ * @version 1.0.0
+ */
+
+#if defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     /* recvmmsg / sendmmsg */
+#endif
+
+#include "e32_transport.h"
+#include "e32_codec.h"
+#include "embedded32.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+/* ==========================================================================
+ * BACKEND STATE
+ * ========================================================================== */
+
+/** Control buffer large enough for one SCM_TIMESTAMPING message */
+#define CMSG_BUF_LEN    CMSG_SPACE(sizeof(struct scm_timestamping))
+
+#ifdef E32_CFG_CAN_FD
+typedef struct canfd_frame  sc_frame_t;
+#define SC_MTU          CANFD_MTU
+#define SC_LEN(cf)      ((cf)->len)
+#else
+typedef struct can_frame    sc_frame_t;
+#define SC_MTU          CAN_MTU
+#define SC_LEN(cf)      ((cf)->can_dlc)
+#endif
+
+typedef struct {
+    int                 fd;
+    sc_frame_t          rx_frames[E32_CFG_RX_BATCH];
+    struct iovec        rx_iov[E32_CFG_RX_BATCH];
+    struct mmsghdr      rx_msgs[E32_CFG_RX_BATCH];
+    uint8_t             rx_cmsg[E32_CFG_RX_BATCH][CMSG_BUF_LEN];
+    sc_frame_t          tx_frames[E32_CFG_RX_BATCH];
+    struct iovec        tx_iov[E32_CFG_RX_BATCH];
+    struct mmsghdr      tx_msgs[E32_CFG_RX_BATCH];
+} socketcan_state_t;
+
+/* ==========================================================================
+ * HELPERS
+ * ========================================================================== */
+
+static int64_t timespec_to_ns(const struct timespec* ts)
+{
+    return (int64_t)ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+/* CLOCK_MONOTONIC minus CLOCK_REALTIME, taken once per receive batch */
+static int64_t realtime_offset_ns(void)
+{
+    struct timespec real, mono;
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    return timespec_to_ns(&mono) - timespec_to_ns(&real);
+}
+
+/*
+ * ts[0] is the kernel software stamp (CLOCK_REALTIME). Hardware stamps
+ * (ts[2]) run on the controller's own clock and are not requested: a
+ * mix of both would put frames of one socket on two time bases.
+ */
+static uint32_t rx_timestamp(struct msghdr* hdr, int64_t offset_ns)
+{
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPING) {
+            struct scm_timestamping ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+
+            if (ts.ts[0].tv_sec || ts.ts[0].tv_nsec) {
+                return (uint32_t)((uint64_t)(timespec_to_ns(&ts.ts[0]) + offset_ns) / 1000000u);
+            }
+        }
+    }
+
+    /* No stamp delivered: the time of reading, on the same clock */
+    return e32_time_ms();
+}
+
+static void prepare_rx(socketcan_state_t* s)
+{
+    memset(s->rx_msgs, 0, sizeof(s->rx_msgs));
+
+    for (int i = 0; i < E32_CFG_RX_BATCH; i++) {
+        s->rx_iov[i].iov_base = &s->rx_frames[i];
+        s->rx_iov[i].iov_len = SC_MTU;
+        s->rx_msgs[i].msg_hdr.msg_iov = &s->rx_iov[i];
+        s->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+        s->rx_msgs[i].msg_hdr.msg_control = s->rx_cmsg[i];
+        s->rx_msgs[i].msg_hdr.msg_controllen = CMSG_BUF_LEN;
+    }
+}
+
+/* ==========================================================================
+ * OPERATIONS
+ * ========================================================================== */
+
+static e32_error_t socketcan_open(e32_transport_t* transport, const e32_j1939_config_t* config)
+{
+    if (!config->interface_name) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    socketcan_state_t* s = calloc(1, sizeof(*s));
+    if (!s) {
+        return E32_ERR_NO_MEMORY;
+    }
+
+    s->fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (s->fd < 0) {
+        free(s);
+        return E32_ERR_TRANSPORT;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, config->interface_name, IFNAMSIZ - 1);
+    if (ioctl(s->fd, SIOCGIFINDEX, &ifr) < 0) {
+        close(s->fd);
+        free(s);
+        return E32_ERR_TRANSPORT;
+    }
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(s->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(s->fd);
+        free(s);
+        return E32_ERR_TRANSPORT;
+    }
+
+    /* Best effort: without stamps frames get the time they are read */
+    int ts_flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    setsockopt(s->fd, SOL_SOCKET, SO_TIMESTAMPING, &ts_flags, sizeof(ts_flags));
+
+    /* Error frames are not J1939 traffic */
+    can_err_mask_t err_mask = 0;
+    setsockopt(s->fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &err_mask, sizeof(err_mask));
+
+#ifdef E32_CFG_CAN_FD
+    /* Required to send FD frames; without it the socket stays classic */
+    int fd_frames = 1;
+    if (setsockopt(s->fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &fd_frames, sizeof(fd_frames)) < 0 &&
+        config->can_fd) {
+        close(s->fd);
+        free(s);
+        return E32_ERR_NOT_SUPPORTED;
+    }
+#endif
+
+    for (int i = 0; i < E32_CFG_RX_BATCH; i++) {
+        s->tx_iov[i].iov_base = &s->tx_frames[i];
+        s->tx_iov[i].iov_len = CAN_MTU;
+        s->tx_msgs[i].msg_hdr.msg_iov = &s->tx_iov[i];
+        s->tx_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    transport->handle = s;
+    return E32_OK;
+}
+
+static void socketcan_close(e32_transport_t* transport)
+{
+    socketcan_state_t* s = transport->handle;
+    if (!s) return;
+
+    close(s->fd);
+    free(s);
+    transport->handle = NULL;
+}
+
+static int socketcan_send(e32_transport_t* transport, const e32_can_frame_t* frames, int count)
+{
+    socketcan_state_t* s = transport->handle;
+    int sent = 0;
+
+    while (sent < count) {
+        int n = count - sent;
+        if (n > E32_CFG_RX_BATCH) {
+            n = E32_CFG_RX_BATCH;
+        }
+
+        for (int i = 0; i < n; i++) {
+            const e32_can_frame_t* f = &frames[sent + i];
+            sc_frame_t* cf = &s->tx_frames[i];
+
+            memset(cf, 0, sizeof(*cf));
+            cf->can_id = f->is_extended ? ((f->id & CAN_EFF_MASK) | CAN_EFF_FLAG)
+                                        : (f->id & CAN_SFF_MASK);
+#ifdef E32_CFG_CAN_FD
+            if (f->flags & E32_CAN_FLAG_FD) {
+                cf->len = e32_can_fd_len(f->dlc > CANFD_MAX_DLEN ? CANFD_MAX_DLEN : f->dlc);
+                cf->flags = (f->flags & E32_CAN_FLAG_BRS) ? CANFD_BRS : 0;
+                memcpy(cf->data, f->data, f->dlc < cf->len ? f->dlc : cf->len);
+                s->tx_iov[i].iov_len = CANFD_MTU;
+                continue;
+            }
+            s->tx_iov[i].iov_len = CAN_MTU;
+#endif
+            SC_LEN(cf) = f->dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : f->dlc;
+            memcpy(cf->data, f->data, SC_LEN(cf));
+        }
+
+        int rc = sendmmsg(s->fd, s->tx_msgs, (unsigned int)n, MSG_DONTWAIT);
+        if (rc < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                break;  /* Queue full - caller keeps the rest */
+            }
+            return sent ? sent : E32_ERR_TRANSPORT;
+        }
+
+        sent += rc;
+        if (rc < n) {
+            break;
+        }
+    }
+
+    return sent;
+}
+
+static int socketcan_recv(e32_transport_t* transport, e32_can_frame_t* frames, int max)
+{
+    socketcan_state_t* s = transport->handle;
+
+    if (max > E32_CFG_RX_BATCH) {
+        max = E32_CFG_RX_BATCH;
+    }
+
+    prepare_rx(s);
+
+    int rc = recvmmsg(s->fd, s->rx_msgs, (unsigned int)max, MSG_DONTWAIT, NULL);
+    if (rc < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        return E32_ERR_TRANSPORT;
+    }
+
+    int64_t offset_ns = rc > 0 ? realtime_offset_ns() : 0;
+    int out = 0;
+    for (int i = 0; i < rc; i++) {
+        const sc_frame_t* cf = &s->rx_frames[i];
+
+        if (s->rx_msgs[i].msg_len < CAN_MTU ||
+            (cf->can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG))) {
+            continue;
+        }
+
+        e32_can_frame_t* f = &frames[out++];
+        f->is_extended = (cf->can_id & CAN_EFF_FLAG) != 0;
+        f->id = cf->can_id & (f->is_extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+#ifdef E32_CFG_CAN_FD
+        if (s->rx_msgs[i].msg_len == CANFD_MTU) {
+            f->flags = (uint8_t)(E32_CAN_FLAG_FD | ((cf->flags & CANFD_BRS) ? E32_CAN_FLAG_BRS : 0) |
+                                 ((cf->flags & CANFD_ESI) ? E32_CAN_FLAG_ESI : 0));
+            f->dlc = cf->len > E32_CAN_MAX_DATA_LEN ? E32_CAN_MAX_DATA_LEN : cf->len;
+            memcpy(f->data, cf->data, f->dlc);
+            f->timestamp = rx_timestamp(&s->rx_msgs[i].msg_hdr, offset_ns);
+            continue;
+        }
+#endif
+        f->flags = 0;
+        f->dlc = SC_LEN(cf) > E32_CAN_CLASSIC_DATA_LEN ? E32_CAN_CLASSIC_DATA_LEN : SC_LEN(cf);
+        memcpy(f->data, cf->data, E32_CAN_CLASSIC_DATA_LEN);
+        f->timestamp = rx_timestamp(&s->rx_msgs[i].msg_hdr, offset_ns);
+    }
+
+    return out;
+}
+
+static e32_error_t socketcan_set_filters(
+    e32_transport_t* transport,
+    const e32_can_filter_t* filters,
+    int count
+)
+{
+    socketcan_state_t* s = transport->handle;
+
+    if (!filters) {
+        /* Accept every extended frame */
+        struct can_filter all = { CAN_EFF_FLAG, CAN_EFF_FLAG | CAN_RTR_FLAG };
+        return setsockopt(s->fd, SOL_CAN_RAW, CAN_RAW_FILTER, &all, sizeof(all)) == 0
+               ? E32_OK : E32_ERR_TRANSPORT;
+    }
+
+    if (count > CAN_RAW_FILTER_MAX) {
+        return E32_ERR_NOT_SUPPORTED;
+    }
+
+    struct can_filter kf[CAN_RAW_FILTER_MAX];
+    for (int i = 0; i < count; i++) {
+        kf[i].can_id = (filters[i].id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+        kf[i].can_mask = (filters[i].mask & CAN_EFF_MASK) | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    }
+
+    return setsockopt(s->fd, SOL_CAN_RAW, CAN_RAW_FILTER, kf,
+                      (socklen_t)(sizeof(struct can_filter) * (size_t)count)) == 0
+           ? E32_OK : E32_ERR_TRANSPORT;
+}
+
+static int socketcan_get_fd(e32_transport_t* transport)
+{
+    socketcan_state_t* s = transport->handle;
+    return s ? s->fd : -1;
+}
+
+const e32_transport_ops_t e32_socketcan_transport = {
+    .name        = "socketcan",
+    .open        = socketcan_open,
+    .close       = socketcan_close,
+    .send        = socketcan_send,
+    .recv        = socketcan_recv,
+    .set_filters = socketcan_set_filters,
+    .get_fd      = socketcan_get_fd,
+    .max_filters = CAN_RAW_FILTER_MAX,
+};
+
+#else
+
+/* Keep the translation unit non-empty on other platforms */
+typedef int e32_socketcan_unavailable_t;
+
+#endif /* __linux__ */
@@ -0,0 +1,181 @@
+/**
+ * @file e32_stats.c
+ * @brief Embedded32 SDK - Runtime Statistics Implementation
+ *
+ * The histogram index is computed with one count-leading-zeros: the
+ * octave comes from the highest set bit, the sub-bucket from the three
+ * bits below it.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_stats.h"
+#include "e32_j1939.h"
+#include <string.h>
+
+/* Largest sample with a bin of its own; larger ones share the last bin */
+#define HIST_LIMIT  ((1u << 24) - 1)
+
+/* Rows looked at per PGN: bounds the cost of PGNs that found no row */
+#define ROW_PROBES  (E32_CFG_STATS_PGNS < 4 ? E32_CFG_STATS_PGNS : 4)
+
+static uint32_t bin_low(uint32_t bin)
+{
+    if (bin < (1u << E32_HIST_SUB_BITS)) {
+        return bin;
+    }
+    uint32_t shift = (bin >> E32_HIST_SUB_BITS) - 1;
+    return ((bin & ((1u << E32_HIST_SUB_BITS) - 1)) + (1u << E32_HIST_SUB_BITS)) << shift;
+}
+
+static uint32_t bin_high(uint32_t bin)
+{
+    if (bin < (1u << E32_HIST_SUB_BITS)) {
+        return bin;
+    }
+    return bin_low(bin) + (1u << ((bin >> E32_HIST_SUB_BITS) - 1)) - 1;
+}
+
+uint32_t e32_histogram_percentile(const e32_histogram_t* hist, double percent)
+{
+    if (!hist || hist->count == 0) {
+        return 0;
+    }
+    if (percent < 0.0) percent = 0.0;
+    if (percent > 100.0) percent = 100.0;
+
+    uint32_t target = (uint32_t)(percent / 100.0 * (double)hist->count + 0.999999);
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < E32_HIST_BINS; i++) {
+        seen += hist->bins[i];
+        if (seen >= target) {
+            uint32_t high = bin_high(i);
+            return high < hist->max ? high : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+#ifndef E32_CFG_NO_STATS
+
+static uint32_t bin_index(uint32_t us)
+{
+    if (us < (1u << E32_HIST_SUB_BITS)) {
+        return us;
+    }
+    if (us > HIST_LIMIT) {
+        us = HIST_LIMIT;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    uint32_t msb = 31u - (uint32_t)__builtin_clz(us);
+#else
+    uint32_t msb = 0;
+    for (uint32_t v = us; v >>= 1; ) msb++;
+#endif
+    uint32_t shift = msb - E32_HIST_SUB_BITS;
+    return ((shift + 1) << E32_HIST_SUB_BITS) + (us >> shift) - (1u << E32_HIST_SUB_BITS);
+}
+
+void e32_stats_init(e32_stats_block_t* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    for (uint32_t i = 0; i < E32_CFG_STATS_PGNS; i++) {
+        stats->pgns[i].pgn = E32_STATS_FREE_PGN;
+    }
+}
+
+uint8_t e32_stats_row_find(e32_stats_block_t* stats, uint32_t pgn)
+{
+    uint32_t mask = E32_CFG_STATS_PGNS - 1;
+    uint32_t i = e32_stats_home(pgn);
+
+    for (uint32_t probe = 0; probe < ROW_PROBES; probe++, i = (i + 1) & mask) {
+        e32_pgn_stats_t* row = &stats->pgns[i];
+        if (row->pgn == pgn) {
+            return (uint8_t)i;
+        }
+        if (row->pgn == E32_STATS_FREE_PGN) {
+            /* Counters are zero from init; publishing the PGN claims the row */
+            E32_STORE_RELEASE(&row->pgn, pgn);
+            return (uint8_t)i;
+        }
+    }
+
+    e32_stats_bump(&stats->pgn_overflow);
+    return E32_STATS_NO_ROW;
+}
+
+void e32_stats_max(uint32_t* max, uint32_t value, bool shared)
+{
+    uint32_t seen = E32_LOAD_RELAXED(max);
+    if (!shared) {
+        if (value > seen) {
+            E32_STORE_RELAXED(max, value);
+        }
+        return;
+    }
+    while (value > seen) {
+        if (E32_CAS_WEAK(max, &seen, value)) {
+            break;
+        }
+    }
+}
+
+void e32_stats_record(e32_histogram_t* hist, uint32_t us, bool shared)
+{
+    e32_stats_add(&hist->bins[bin_index(us)], 1, shared);
+    e32_stats_add(&hist->count, 1, shared);
+    e32_stats_max(&hist->max, us, shared);
+}
+
+static void copy_words(uint32_t* dst, const uint32_t* src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = E32_LOAD_RELAXED(&src[i]);
+    }
+}
+
+static void copy_histogram(e32_histogram_t* dst, const e32_histogram_t* src)
+{
+    dst->count = E32_LOAD_RELAXED(&src->count);
+    dst->max = E32_LOAD_RELAXED(&src->max);
+    copy_words(dst->bins, src->bins, E32_HIST_BINS);
+}
+
+void e32_stats_snapshot(const e32_stats_block_t* stats, e32_stats_t* out)
+{
+    out->frames = E32_LOAD_RELAXED(&stats->frames);
+    out->unwanted = E32_LOAD_RELAXED(&stats->unwanted);
+    out->gated = E32_LOAD_RELAXED(&stats->gated);
+    out->delivered = E32_LOAD_RELAXED(&stats->delivered);
+    out->handler_calls = E32_LOAD_RELAXED(&stats->handler_calls);
+    out->decode_errors = E32_LOAD_RELAXED(&stats->decode_errors);
+    out->pgn_overflow = E32_LOAD_RELAXED(&stats->pgn_overflow);
+    copy_histogram(&out->latency, &stats->latency);
+    copy_histogram(&out->handler, &stats->handler);
+
+    /* Rows are returned packed, in table order */
+    uint16_t n = 0;
+    for (uint32_t i = 0; i < E32_CFG_STATS_PGNS; i++) {
+        const e32_pgn_stats_t* row = &stats->pgns[i];
+        uint32_t pgn = E32_LOAD_ACQUIRE(&row->pgn);
+        if (pgn == E32_STATS_FREE_PGN) {
+            continue;
+        }
+        e32_pgn_stats_t* copy = &out->pgns[n++];
+        copy->pgn = pgn;
+        copy->messages = E32_LOAD_RELAXED(&row->messages);
+        copy->gated = E32_LOAD_RELAXED(&row->gated);
+        copy->handler_calls = E32_LOAD_RELAXED(&row->handler_calls);
+        copy->decode_errors = E32_LOAD_RELAXED(&row->decode_errors);
+        copy->handler_max_us = E32_LOAD_RELAXED(&row->handler_max_us);
+    }
+    out->pgn_count = n;
+    memset(&out->pgns[n], 0, sizeof(out->pgns[0]) * (E32_CFG_STATS_PGNS - n));
+}
+
+#endif /* E32_CFG_NO_STATS */
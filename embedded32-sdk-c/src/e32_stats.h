@@ -0,0 +1,156 @@
+/**
+ * @file e32_stats.h
+ * @brief Embedded32 SDK - Runtime Statistics (internal)
+ *
+ * Client-wide counters, a per-PGN table and two log-linear histograms.
+ * The polling thread is the only writer of the frame counters and of
+ * row allocation. Counters touched while handlers run use relaxed
+ * atomic adds when handlers run on worker threads (shared) and plain
+ * stores otherwise. Readers copy everything with relaxed loads, so a
+ * snapshot taken while frames flow may be a few counts apart between
+ * fields but never shows a torn word.
+ *
+ * With E32_CFG_NO_STATS all of this compiles to nothing.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_STATS_H
+#define E32_STATS_H
+
+#include "e32_types.h"
+#include "e32_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** pgns[] row marker: no row for this message */
+#define E32_STATS_NO_ROW    0xFF
+
+/** pgns[].pgn of an unused row (0 is a real PGN) */
+#define E32_STATS_FREE_PGN  0xFFFFFFFFu
+
+/**
+ * @brief What a message carries from the polling thread to its handlers
+ */
+typedef struct {
+    uint32_t rx_us;         /**< When the frame entered the SDK, valid if stamped */
+    uint8_t  row;           /**< pgns[] row, E32_STATS_NO_ROW if none */
+    bool     stamped;       /**< Record the receive-to-handler latency */
+    bool     timed;         /**< Record the handler run time */
+} e32_stats_tag_t;
+
+#ifndef E32_CFG_NO_STATS
+
+/**
+ * @brief Statistics of one client
+ */
+typedef struct {
+    uint32_t        frames;
+    uint32_t        unwanted;
+    uint32_t        gated;
+    uint32_t        delivered;
+    uint32_t        handler_calls;
+    uint32_t        decode_errors;
+    uint32_t        pgn_overflow;
+    e32_histogram_t latency;
+    e32_histogram_t handler;
+    e32_pgn_stats_t pgns[E32_CFG_STATS_PGNS];
+
+    /* Receive timestamps: one per sampled ring slot, written by the ring producer */
+    uint32_t        rx_us[E32_CFG_RX_RING_SIZE];
+    uint32_t        current_us;     /**< Entry time of the frame being dispatched */
+    bool            from_ring;      /**< That frame came from the receive ring */
+    bool            current_stamped;/**< ... and its ring slot was sampled */
+    uint32_t        direct;         /**< Messages not from the ring, for sampling */
+} e32_stats_block_t;
+
+/**
+ * @brief Clear every counter and histogram and free all PGN rows
+ */
+void e32_stats_init(e32_stats_block_t* stats);
+
+/**
+ * @brief Slow path of e32_stats_row(): probe further, allocate on first sight
+ */
+uint8_t e32_stats_row_find(e32_stats_block_t* stats, uint32_t pgn);
+
+/**
+ * @brief Home row of pgn in the table
+ */
+static inline uint32_t e32_stats_home(uint32_t pgn)
+{
+    return (pgn ^ (pgn >> 8)) & (E32_CFG_STATS_PGNS - 1);
+}
+
+/**
+ * @brief Row for pgn, allocating one on first sight
+ *
+ * Polling thread only.
+ *
+ * @return Row index, or E32_STATS_NO_ROW if its candidate rows are taken
+ */
+static inline uint8_t e32_stats_row(e32_stats_block_t* stats, uint32_t pgn)
+{
+    uint32_t home = e32_stats_home(pgn);
+    if (stats->pgns[home].pgn == pgn) {
+        return (uint8_t)home;
+    }
+    return e32_stats_row_find(stats, pgn);
+}
+
+/**
+ * @brief Add one sample to a histogram
+ *
+ * @param shared Other threads may record at the same time
+ */
+void e32_stats_record(e32_histogram_t* hist, uint32_t us, bool shared);
+
+/**
+ * @brief Raise *max to value if it is larger
+ */
+void e32_stats_max(uint32_t* max, uint32_t value, bool shared);
+
+/**
+ * @brief Copy the counters, histograms and PGN rows into a snapshot
+ *
+ * Leaves the rx, tx and worker_overflows members of out untouched.
+ */
+void e32_stats_snapshot(const e32_stats_block_t* stats, e32_stats_t* out);
+
+/**
+ * @brief Count an event whose counter only the polling thread writes
+ */
+static inline void e32_stats_bump(uint32_t* counter)
+{
+    E32_STORE_RELAXED(counter, *counter + 1);
+}
+
+/**
+ * @brief Count n events, atomically if other threads may count too
+ */
+static inline void e32_stats_add(uint32_t* counter, uint32_t n, bool shared)
+{
+    if (shared) {
+        (void)E32_FETCH_ADD(counter, n);
+    } else {
+        E32_STORE_RELAXED(counter, *counter + n);
+    }
+}
+
+#else
+
+typedef struct {
+    uint8_t unused;
+} e32_stats_block_t;
+
+#endif /* E32_CFG_NO_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_STATS_H */
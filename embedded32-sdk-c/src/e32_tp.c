@@ -0,0 +1,529 @@
+/**
+ * @file e32_tp.c
+ * @brief Embedded32 SDK - J1939-21 Transport Protocol Engine Implementation
+ *
+ * Timers follow J1939-21: T1 between data packets, T2 after sending a
+ * CTS, T3 after sending the last packet of a window, T4 after a hold
+ * (CTS with zero packets). Time comparisons are wrap-safe.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_tp.h"
+#include <string.h>
+
+/* ==========================================================================
+ * PROTOCOL CONSTANTS
+ * ========================================================================== */
+
+#define TP_CM_RTS           16
+#define TP_CM_CTS           17
+#define TP_CM_EOM_ACK       19
+#define TP_CM_BAM           32
+#define TP_CM_ABORT         255
+
+#define TP_ABORT_BUSY       1   /* Already in one or more connection-managed sessions */
+#define TP_ABORT_RESOURCES  2   /* System resources were needed for another task */
+#define TP_ABORT_TIMEOUT    3   /* A timeout occurred */
+
+#define TP_T1_MS            750
+#define TP_T2_MS            1250
+#define TP_T3_MS            1250
+#define TP_T4_MS            1050
+
+#define TP_BYTES_PER_PACKET 7
+
+/* ==========================================================================
+ * HELPERS
+ * ========================================================================== */
+
+static bool expired(uint32_t now, uint32_t deadline)
+{
+    return (int32_t)(now - deadline) >= 0;
+}
+
+static e32_tp_session_t* find_session(e32_tp_session_t* pool, size_t n, uint8_t sa, uint8_t da)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (pool[i].state != E32_TP_IDLE && pool[i].sa == sa && pool[i].da == da) {
+            return &pool[i];
+        }
+    }
+    return NULL;
+}
+
+static e32_tp_session_t* alloc_session(e32_tp_session_t* pool, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (pool[i].state == E32_TP_IDLE) {
+            return &pool[i];
+        }
+    }
+    return NULL;
+}
+
+static void open_session(e32_tp_session_t* s, uint8_t state, uint8_t sa, uint8_t da,
+                         uint8_t priority, uint32_t pgn, uint16_t size)
+{
+    s->state = state;
+    s->sa = sa;
+    s->da = da;
+    s->priority = priority;
+    s->pgn = pgn;
+    s->size = size;
+    s->packets = (uint8_t)((size + TP_BYTES_PER_PACKET - 1) / TP_BYTES_PER_PACKET);
+    s->max_per_cts = 0xFF;
+    s->next_seq = 1;
+    s->window_end = 0;
+    s->resync = false;
+}
+
+static void close_session(e32_tp_session_t* s)
+{
+    s->state = E32_TP_IDLE;
+}
+
+static bool valid_announce(uint16_t size, uint8_t packets)
+{
+    return size > E32_CAN_CLASSIC_DATA_LEN && size <= E32_TP_MAX_DATA_LEN &&
+           packets == (size + TP_BYTES_PER_PACKET - 1) / TP_BYTES_PER_PACKET;
+}
+
+static e32_error_t send_cm(e32_tp_t* tp, uint8_t priority, uint8_t sa, uint8_t da,
+                           const uint8_t head[5], uint32_t pgn)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+
+    frame.id = e32_build_j1939_id(E32_PGN_TP_CM, sa, priority, da);
+    frame.dlc = 8;
+    frame.is_extended = true;
+    memcpy(frame.data, head, 5);
+    frame.data[5] = pgn & 0xFF;
+    frame.data[6] = (pgn >> 8) & 0xFF;
+    frame.data[7] = (pgn >> 16) & 0xFF;
+
+    return tp->hooks.send(tp->hooks.ctx, &frame);
+}
+
+static void send_abort(e32_tp_t* tp, uint8_t da, uint32_t pgn, uint8_t reason)
+{
+    const uint8_t head[5] = { TP_CM_ABORT, reason, 0xFF, 0xFF, 0xFF };
+    send_cm(tp, 7, tp->own_sa, da, head, pgn);
+}
+
+static e32_error_t send_dt(e32_tp_t* tp, const e32_tp_session_t* s, uint16_t seq)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+
+    frame.id = e32_build_j1939_id(E32_PGN_TP_DT, s->sa, s->priority, s->da);
+    frame.dlc = 8;
+    frame.is_extended = true;
+    frame.data[0] = (uint8_t)seq;
+
+    /* Bytes past the end of the message are padded with 0xFF */
+    uint16_t offset = (uint16_t)((seq - 1) * TP_BYTES_PER_PACKET);
+    uint16_t n = s->size - offset;
+    if (n > TP_BYTES_PER_PACKET) n = TP_BYTES_PER_PACKET;
+    memset(&frame.data[1], 0xFF, TP_BYTES_PER_PACKET);
+    memcpy(&frame.data[1], &s->data[offset], n);
+
+    return tp->hooks.send(tp->hooks.ctx, &frame);
+}
+
+/* ==========================================================================
+ * RECEIVE
+ * ========================================================================== */
+
+/**
+ * Grant the next window of an RTS/CTS transfer we are receiving.
+ */
+static void send_cts(e32_tp_t* tp, e32_tp_session_t* s, uint32_t now)
+{
+    uint16_t grant = s->packets - s->next_seq + 1;
+    if (grant > E32_CFG_TP_CTS_PACKETS) grant = E32_CFG_TP_CTS_PACKETS;
+    if (s->max_per_cts != 0 && grant > s->max_per_cts) grant = s->max_per_cts;
+
+    const uint8_t head[5] = { TP_CM_CTS, (uint8_t)grant, (uint8_t)s->next_seq, 0xFF, 0xFF };
+    send_cm(tp, 7, tp->own_sa, s->sa, head, s->pgn);
+
+    s->window_end = s->next_seq + grant - 1;
+    s->deadline = now + TP_T2_MS;
+}
+
+static void rx_control(e32_tp_t* tp, const e32_j1939_id_t* id, const e32_can_frame_t* frame, uint32_t now)
+{
+    const uint8_t* d = frame->data;
+    uint8_t  sa = id->source_address;
+    uint8_t  da = id->destination_address;
+    uint16_t size = (uint16_t)(d[1] | (d[2] << 8));
+    uint32_t pgn = d[5] | ((uint32_t)d[6] << 8) | ((uint32_t)d[7] << 16);
+    e32_tp_session_t* s;
+
+    switch (d[0]) {
+        case TP_CM_BAM:
+            if (da != E32_SA_GLOBAL || !valid_announce(size, d[3])) return;
+            if (!tp->hooks.accept(tp->hooks.ctx, pgn)) return;
+
+            s = find_session(tp->rx, E32_CFG_TP_RX_SESSIONS, sa, E32_SA_GLOBAL);
+            if (s) {
+                tp->stats.rx_aborted++;     /* A new BAM replaces an unfinished one */
+            } else {
+                s = alloc_session(tp->rx, E32_CFG_TP_RX_SESSIONS);
+            }
+            if (!s || size > E32_CFG_TP_MAX_LEN) {
+                if (s) close_session(s);
+                tp->stats.rx_no_session++;
+                return;
+            }
+
+            open_session(s, E32_TP_RX_BAM, sa, E32_SA_GLOBAL, id->priority, pgn, size);
+            s->deadline = now + TP_T1_MS;
+            break;
+
+        case TP_CM_RTS:
+            if (da != tp->own_sa || !valid_announce(size, d[3])) return;
+
+            s = find_session(tp->rx, E32_CFG_TP_RX_SESSIONS, sa, da);
+            if (s) {
+                tp->stats.rx_aborted++;     /* Sender restarted the transfer */
+            } else {
+                s = alloc_session(tp->rx, E32_CFG_TP_RX_SESSIONS);
+            }
+            if (!s || size > E32_CFG_TP_MAX_LEN) {
+                if (s) close_session(s);
+                tp->stats.rx_no_session++;
+                send_abort(tp, sa, pgn, s ? TP_ABORT_RESOURCES : TP_ABORT_BUSY);
+                return;
+            }
+
+            open_session(s, E32_TP_RX_DATA, sa, da, id->priority, pgn, size);
+            s->max_per_cts = d[4];
+            send_cts(tp, s, now);
+            break;
+
+        case TP_CM_CTS:
+            if (da != tp->own_sa) return;
+
+            s = find_session(tp->tx, E32_CFG_TP_TX_SESSIONS, tp->own_sa, sa);
+            /* After the last window a CTS asks for a retransmit */
+            if (!s || s->pgn != pgn ||
+                (s->state != E32_TP_TX_WAIT_CTS && s->state != E32_TP_TX_WAIT_EOM)) return;
+
+            if (d[1] == 0) {
+                s->deadline = now + TP_T4_MS;   /* Hold the connection open */
+                return;
+            }
+            if (d[2] == 0 || d[2] > s->packets) return;
+
+            s->next_seq = d[2];
+            s->window_end = d[2] + d[1] - 1;
+            if (s->window_end > s->packets) s->window_end = s->packets;
+            s->state = E32_TP_TX_DATA;
+            break;
+
+        case TP_CM_EOM_ACK:
+            if (da != tp->own_sa) return;
+
+            s = find_session(tp->tx, E32_CFG_TP_TX_SESSIONS, tp->own_sa, sa);
+            if (s && s->pgn == pgn &&
+                (s->state == E32_TP_TX_WAIT_EOM || s->state == E32_TP_TX_WAIT_CTS)) {
+                tp->stats.tx_completed++;
+                close_session(s);
+            }
+            break;
+
+        case TP_CM_ABORT:
+            s = find_session(tp->rx, E32_CFG_TP_RX_SESSIONS, sa, da);
+            if (s && s->pgn == pgn) {
+                tp->stats.rx_aborted++;
+                close_session(s);
+            }
+            if (da == tp->own_sa) {
+                s = find_session(tp->tx, E32_CFG_TP_TX_SESSIONS, tp->own_sa, sa);
+                if (s && s->pgn == pgn) {
+                    tp->stats.tx_aborted++;
+                    close_session(s);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void rx_data(e32_tp_t* tp, const e32_j1939_id_t* id, const e32_can_frame_t* frame, uint32_t now)
+{
+    e32_tp_session_t* s = find_session(tp->rx, E32_CFG_TP_RX_SESSIONS,
+                                       id->source_address, id->destination_address);
+    if (!s) return;
+
+    uint16_t seq = frame->data[0];
+
+    if (seq != s->next_seq) {
+        if (s->state == E32_TP_RX_DATA) {
+            /* Duplicates are dropped, a gap asks once for a retransmit */
+            if (seq > s->next_seq && !s->resync) {
+                send_cts(tp, s, now);
+                s->resync = true;
+            }
+            return;
+        }
+        tp->stats.rx_aborted++;     /* BAM has no retransmit: the message is lost */
+        close_session(s);
+        return;
+    }
+
+    uint16_t offset = (uint16_t)((seq - 1) * TP_BYTES_PER_PACKET);
+    uint16_t n = s->size - offset;
+    if (n > TP_BYTES_PER_PACKET) n = TP_BYTES_PER_PACKET;
+    memcpy(&s->data[offset], &frame->data[1], n);
+    s->timestamp = frame->timestamp;
+    s->next_seq++;
+    s->resync = false;
+
+    if (seq == s->packets) {
+        if (s->state == E32_TP_RX_DATA) {
+            const uint8_t head[5] = { TP_CM_EOM_ACK, s->size & 0xFF, s->size >> 8, s->packets, 0xFF };
+            send_cm(tp, 7, tp->own_sa, s->sa, head, s->pgn);
+        }
+        tp->stats.rx_completed++;
+        tp->hooks.deliver(tp->hooks.ctx, s);
+        close_session(s);
+        return;
+    }
+
+    if (s->state == E32_TP_RX_DATA && seq == s->window_end) {
+        send_cts(tp, s, now);
+    } else {
+        s->deadline = now + TP_T1_MS;
+    }
+}
+
+/* ==========================================================================
+ * TRANSMIT
+ * ========================================================================== */
+
+/**
+ * Move one send session forward as far as the transport allows. A packet
+ * the transport refuses stays queued and is retried on the next poll.
+ */
+static void pump_tx(e32_tp_t* tp, e32_tp_session_t* s, uint32_t now)
+{
+    switch (s->state) {
+        case E32_TP_TX_BAM:
+            if (s->next_seq == 0) {
+                const uint8_t head[5] = { TP_CM_BAM, s->size & 0xFF, s->size >> 8, s->packets, 0xFF };
+                if (send_cm(tp, s->priority, s->sa, E32_SA_GLOBAL, head, s->pgn) != E32_OK) return;
+                s->next_seq = 1;
+                s->last_tx = now;
+                return;
+            }
+
+            /* Receivers need the gap between BAM packets to keep up */
+            if (now - s->last_tx < E32_CFG_TP_BAM_INTERVAL_MS) return;
+            if (send_dt(tp, s, s->next_seq) != E32_OK) return;
+
+            s->last_tx = now;
+            if (s->next_seq == s->packets) {
+                tp->stats.tx_completed++;
+                close_session(s);
+            } else {
+                s->next_seq++;
+            }
+            break;
+
+        case E32_TP_TX_RTS: {
+            const uint8_t head[5] = { TP_CM_RTS, s->size & 0xFF, s->size >> 8, s->packets, 0xFF };
+            if (send_cm(tp, s->priority, s->sa, s->da, head, s->pgn) != E32_OK) return;
+            s->state = E32_TP_TX_WAIT_CTS;
+            s->deadline = now + TP_T3_MS;
+            break;
+        }
+
+        case E32_TP_TX_DATA:
+            while (s->next_seq <= s->window_end) {
+                if (send_dt(tp, s, s->next_seq) != E32_OK) return;
+                s->next_seq++;
+            }
+            s->state = (s->next_seq > s->packets) ? E32_TP_TX_WAIT_EOM : E32_TP_TX_WAIT_CTS;
+            s->deadline = now + TP_T3_MS;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* ==========================================================================
+ * PUBLIC (INTERNAL) API
+ * ========================================================================== */
+
+void e32_tp_init(e32_tp_t* tp, const e32_tp_hooks_t* hooks, uint8_t own_sa)
+{
+    for (size_t i = 0; i < E32_CFG_TP_RX_SESSIONS; i++) {
+        close_session(&tp->rx[i]);
+    }
+    for (size_t i = 0; i < E32_CFG_TP_TX_SESSIONS; i++) {
+        close_session(&tp->tx[i]);
+    }
+
+    tp->hooks = *hooks;
+    tp->own_sa = own_sa;
+    memset(&tp->stats, 0, sizeof(tp->stats));
+}
+
+void e32_tp_set_address(e32_tp_t* tp, uint8_t own_sa)
+{
+    if (own_sa == tp->own_sa) return;
+
+    for (size_t i = 0; i < E32_CFG_TP_RX_SESSIONS; i++) {
+        e32_tp_session_t* s = &tp->rx[i];
+        if (s->state != E32_TP_IDLE && s->da == tp->own_sa) {
+            close_session(s);
+            tp->stats.rx_aborted++;
+        }
+    }
+    for (size_t i = 0; i < E32_CFG_TP_TX_SESSIONS; i++) {
+        if (tp->tx[i].state != E32_TP_IDLE) {
+            close_session(&tp->tx[i]);
+            tp->stats.tx_aborted++;
+        }
+    }
+
+    tp->own_sa = own_sa;
+}
+
+void e32_tp_rx_frame(e32_tp_t* tp, const e32_j1939_id_t* id,
+                     const e32_can_frame_t* frame, uint32_t now)
+{
+    /* TP.CM and TP.DT are always sent with all 8 bytes */
+    if (frame->dlc < 8) return;
+
+    if (id->pgn == E32_PGN_TP_CM) {
+        rx_control(tp, id, frame, now);
+    } else if (id->pgn == E32_PGN_TP_DT) {
+        rx_data(tp, id, frame, now);
+    }
+
+    /* A CTS may have opened a window: start sending right away */
+    for (size_t i = 0; i < E32_CFG_TP_TX_SESSIONS; i++) {
+        if (tp->tx[i].state == E32_TP_TX_DATA) {
+            pump_tx(tp, &tp->tx[i], now);
+        }
+    }
+}
+
+e32_error_t e32_tp_send(e32_tp_t* tp, uint32_t pgn, const uint8_t* data,
+                        uint16_t len, uint8_t destination, uint8_t priority,
+                        uint32_t now)
+{
+    if (!data || len <= E32_CAN_CLASSIC_DATA_LEN || len > E32_CFG_TP_MAX_LEN) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    if (find_session(tp->tx, E32_CFG_TP_TX_SESSIONS, tp->own_sa, destination)) {
+        return E32_ERR_BUSY;
+    }
+
+    e32_tp_session_t* s = alloc_session(tp->tx, E32_CFG_TP_TX_SESSIONS);
+    if (!s) {
+        return E32_ERR_BUSY;
+    }
+
+    bool bam = (destination == E32_SA_GLOBAL);
+    open_session(s, bam ? E32_TP_TX_BAM : E32_TP_TX_RTS, tp->own_sa, destination,
+                 priority, pgn, len);
+    memcpy(s->data, data, len);
+    if (bam) {
+        s->next_seq = 0;    /* Announce first */
+    }
+
+    pump_tx(tp, s, now);
+    return E32_OK;
+}
+
+void e32_tp_poll(e32_tp_t* tp, uint32_t now)
+{
+    for (size_t i = 0; i < E32_CFG_TP_RX_SESSIONS; i++) {
+        e32_tp_session_t* s = &tp->rx[i];
+        if (s->state == E32_TP_IDLE || !expired(now, s->deadline)) continue;
+
+        if (s->state == E32_TP_RX_DATA) {
+            send_abort(tp, s->sa, s->pgn, TP_ABORT_TIMEOUT);
+        }
+        tp->stats.rx_timeouts++;
+        close_session(s);
+    }
+
+    for (size_t i = 0; i < E32_CFG_TP_TX_SESSIONS; i++) {
+        e32_tp_session_t* s = &tp->tx[i];
+
+        if ((s->state == E32_TP_TX_WAIT_CTS || s->state == E32_TP_TX_WAIT_EOM) &&
+            expired(now, s->deadline)) {
+            send_abort(tp, s->da, s->pgn, TP_ABORT_TIMEOUT);
+            tp->stats.tx_timeouts++;
+            close_session(s);
+            continue;
+        }
+
+        pump_tx(tp, s, now);
+    }
+}
+
+static uint32_t until(uint32_t now, uint32_t when)
+{
+    int32_t left = (int32_t)(when - now);
+    return (left > 0) ? (uint32_t)left : 0;
+}
+
+uint32_t e32_tp_next_timeout(const e32_tp_t* tp, uint32_t now)
+{
+    uint32_t next = UINT32_MAX;
+    uint32_t t;
+
+    for (size_t i = 0; i < E32_CFG_TP_RX_SESSIONS; i++) {
+        const e32_tp_session_t* s = &tp->rx[i];
+        if (s->state == E32_TP_IDLE) continue;
+        t = until(now, s->deadline);
+        if (t < next) next = t;
+    }
+
+    for (size_t i = 0; i < E32_CFG_TP_TX_SESSIONS; i++) {
+        const e32_tp_session_t* s = &tp->tx[i];
+
+        switch (s->state) {
+            case E32_TP_TX_BAM:
+                t = (s->next_seq == 0) ? 0 : until(now, s->last_tx + E32_CFG_TP_BAM_INTERVAL_MS);
+                break;
+            case E32_TP_TX_WAIT_CTS:
+            case E32_TP_TX_WAIT_EOM:
+                t = until(now, s->deadline);
+                break;
+            case E32_TP_IDLE:
+                continue;
+            default:
+                t = 0;      /* Frames waiting for the backend */
+                break;
+        }
+        if (t < next) next = t;
+    }
+
+    return next;
+}
+
+void e32_tp_get_stats(const e32_tp_t* tp, e32_tp_stats_t* stats)
+{
+    *stats = tp->stats;
+    stats->rx_active = 0;
+    stats->tx_active = 0;
+
+    for (size_t i = 0; i < E32_CFG_TP_RX_SESSIONS; i++) {
+        if (tp->rx[i].state != E32_TP_IDLE) stats->rx_active++;
+    }
+    for (size_t i = 0; i < E32_CFG_TP_TX_SESSIONS; i++) {
+        if (tp->tx[i].state != E32_TP_IDLE) stats->tx_active++;
+    }
+}
@@ -0,0 +1,146 @@
+/**
+ * @file e32_tp.h
+ * @brief Embedded32 SDK - J1939-21 Transport Protocol Engine (internal)
+ *
+ * Reassembles and sends multi-packet messages over TP.CM / TP.DT, both
+ * broadcast (BAM) and connection mode (RTS/CTS). All session state and
+ * buffers are preallocated; the engine never allocates. It is driven
+ * entirely from the caller's context: received TP frames are fed in with
+ * e32_tp_rx_frame(), and timers and paced transmission advance in
+ * e32_tp_poll().
+ *
+ * Sessions are keyed by (sender SA, receiver DA) - J1939-21 allows one
+ * BAM per sender and one RTS/CTS transfer per sender/receiver pair at a
+ * time - and the PGN is checked on every control message.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_TP_H
+#define E32_TP_H
+
+#include "e32_types.h"
+#include "e32_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Session state
+ */
+typedef enum {
+    E32_TP_IDLE = 0,
+    E32_TP_RX_BAM,          /**< Receiving broadcast data */
+    E32_TP_RX_DATA,         /**< Receiving data after our CTS */
+    E32_TP_TX_BAM,          /**< Sending broadcast (announce when next_seq == 0) */
+    E32_TP_TX_RTS,          /**< RTS queued, not yet on the bus */
+    E32_TP_TX_WAIT_CTS,     /**< Waiting for CTS (or hold expiry) */
+    E32_TP_TX_DATA,         /**< Sending the packets granted by the last CTS */
+    E32_TP_TX_WAIT_EOM      /**< All data sent, waiting for End of Message ACK */
+} e32_tp_state_t;
+
+/**
+ * @brief One transfer in either direction
+ */
+typedef struct {
+    uint8_t  state;         /**< e32_tp_state_t */
+    uint8_t  sa;            /**< Sender */
+    uint8_t  da;            /**< Receiver (0xFF for BAM) */
+    uint8_t  priority;      /**< Priority of the announcing frame */
+    uint32_t pgn;           /**< Transported PGN */
+    uint16_t size;          /**< Total payload bytes */
+    uint8_t  packets;       /**< Total data packets */
+    uint8_t  max_per_cts;   /**< Sender's packets-per-CTS limit (RTS byte 5) */
+    bool     resync;        /**< Retransmit requested, rest of the old window ignored */
+    uint16_t next_seq;      /**< Next sequence number expected / to send */
+    uint16_t window_end;    /**< Last sequence number of the current CTS window */
+    uint32_t deadline;      /**< Timer expiry, ms */
+    uint32_t last_tx;       /**< Time of the last BAM data packet sent, ms */
+    uint32_t timestamp;     /**< Timestamp of the latest received packet */
+    uint8_t  data[E32_CFG_TP_MAX_LEN];
+} e32_tp_session_t;
+
+/**
+ * @brief Callbacks into the owner of the engine
+ */
+typedef struct {
+    /** Put one frame on the bus; non-OK leaves the packet queued for the next poll */
+    e32_error_t (*send)(void* ctx, const e32_can_frame_t* frame);
+    /** Whether anyone wants this PGN; unwanted BAMs are not reassembled */
+    bool        (*accept)(void* ctx, uint32_t pgn);
+    /** A reassembled message (session data is valid during the call only) */
+    void        (*deliver)(void* ctx, const e32_tp_session_t* session);
+    void*       ctx;
+} e32_tp_hooks_t;
+
+/**
+ * @brief Engine state
+ */
+typedef struct {
+    e32_tp_session_t rx[E32_CFG_TP_RX_SESSIONS];
+    e32_tp_session_t tx[E32_CFG_TP_TX_SESSIONS];
+    e32_tp_hooks_t   hooks;
+    e32_tp_stats_t   stats;
+    uint8_t          own_sa;    /**< Our address: RTS/CTS to it are answered */
+} e32_tp_t;
+
+/**
+ * @brief Reset the engine, dropping every session
+ */
+void e32_tp_init(e32_tp_t* tp, const e32_tp_hooks_t* hooks, uint8_t own_sa);
+
+/**
+ * @brief Move the engine to a new source address
+ *
+ * Sessions bound to the old address (everything we send, and RTS/CTS
+ * transfers addressed to us) are dropped and counted as aborted.
+ */
+void e32_tp_set_address(e32_tp_t* tp, uint8_t own_sa);
+
+/**
+ * @brief Feed a received TP.CM or TP.DT frame
+ *
+ * @param id Parsed identifier of frame
+ * @param now Current time, ms
+ */
+void e32_tp_rx_frame(e32_tp_t* tp, const e32_j1939_id_t* id,
+                     const e32_can_frame_t* frame, uint32_t now);
+
+/**
+ * @brief Queue a multi-packet message
+ *
+ * Copies the payload and returns immediately; the transfer runs from
+ * e32_tp_poll(). Destination 0xFF selects BAM, anything else RTS/CTS.
+ *
+ * @return E32_OK when queued, E32_ERR_BUSY if a transfer to the same
+ *         destination is in progress or all send sessions are in use
+ */
+e32_error_t e32_tp_send(e32_tp_t* tp, uint32_t pgn, const uint8_t* data,
+                        uint16_t len, uint8_t destination, uint8_t priority,
+                        uint32_t now);
+
+/**
+ * @brief Advance timers and paced transmission
+ */
+void e32_tp_poll(e32_tp_t* tp, uint32_t now);
+
+/**
+ * @brief Milliseconds until e32_tp_poll() has work to do
+ *
+ * @return 0 if it is due now, UINT32_MAX with no open session
+ */
+uint32_t e32_tp_next_timeout(const e32_tp_t* tp, uint32_t now);
+
+/**
+ * @brief Copy the counters and count open sessions
+ */
+void e32_tp_get_stats(const e32_tp_t* tp, e32_tp_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_TP_H */
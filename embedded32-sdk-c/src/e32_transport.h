@@ -0,0 +1,87 @@
+/**
+ * @file e32_transport.h
+ * @brief Embedded32 SDK - Transport Backend Interface (internal)
+ *
+ * Each platform transport (SocketCAN, bxCAN, TWAI, virtual) implements
+ * this small operations table. The client only talks to its transport
+ * through these calls, in batches, so backends can move many frames per
+ * system call or mailbox interrupt.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_TRANSPORT_H
+#define E32_TRANSPORT_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct e32_transport e32_transport_t;
+
+/**
+ * @brief Backend operations
+ */
+typedef struct {
+    const char* name;
+
+    /** Open the interface named in config */
+    e32_error_t (*open)(e32_transport_t* transport, const e32_j1939_config_t* config);
+
+    /** Close the interface and release backend state */
+    void (*close)(e32_transport_t* transport);
+
+    /**
+     * Send up to count frames without blocking.
+     * @return Number of frames accepted (may be less than count), or negative e32_error_t
+     */
+    int (*send)(e32_transport_t* transport, const e32_can_frame_t* frames, int count);
+
+    /**
+     * Receive up to max frames without blocking.
+     * @return Number of frames received (0 if none pending), or negative e32_error_t
+     */
+    int (*recv)(e32_transport_t* transport, e32_can_frame_t* frames, int max);
+
+    /**
+     * Replace the acceptance filter set. count == 0 accepts nothing,
+     * filters == NULL accepts everything. Optional (may be NULL).
+     */
+    e32_error_t (*set_filters)(e32_transport_t* transport, const e32_can_filter_t* filters, int count);
+
+    /**
+     * File descriptor that becomes readable when frames are pending, so
+     * several channels can share one readiness wait. Optional (may be
+     * NULL, or return -1).
+     */
+    int (*get_fd)(e32_transport_t* transport);
+
+    /** Filters set_filters() can take at once (0 = up to E32_CFG_FILTER_MAX) */
+    int max_filters;
+} e32_transport_ops_t;
+
+/**
+ * @brief Transport instance owned by a client
+ */
+struct e32_transport {
+    const e32_transport_ops_t* ops;     /**< NULL when no backend is attached */
+    void*                      handle;  /**< Backend private state */
+};
+
+#if defined(__linux__)
+/** Linux SocketCAN backend (e32_socketcan.c) */
+extern const e32_transport_ops_t e32_socketcan_transport;
+#endif
+
+/** In-process virtual bus (e32_vbus.c) */
+extern const e32_transport_ops_t e32_vbus_transport;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_TRANSPORT_H */
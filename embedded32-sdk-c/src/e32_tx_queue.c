@@ -0,0 +1,184 @@
+/**
+ * @file e32_tx_queue.c
+ * @brief Embedded32 SDK - Prioritised Transmit Queue Implementation
+ *
+ * Entries are linked by 8-bit indices: one free list and one FIFO per
+ * priority level. Completion callbacks run only after the entries they
+ * belong to are back on the free list, so a callback may queue again.
+ *
+ * @version 1.0.0
+ */
+
+#include "e32_tx_queue.h"
+#include <string.h>
+
+static uint8_t frame_priority(const e32_can_frame_t* frame)
+{
+    /* Top three identifier bits: J1939 priority, or the leading bits of an 11-bit ID */
+    return frame->is_extended ? (uint8_t)((frame->id >> 26) & 0x07)
+                              : (uint8_t)((frame->id >> 8) & 0x07);
+}
+
+void e32_tx_queue_init(e32_tx_queue_t* queue)
+{
+    memset(queue, 0, sizeof(*queue));
+
+    for (int p = 0; p < E32_TX_PRIORITIES; p++) {
+        queue->head[p] = E32_TX_NONE;
+        queue->tail[p] = E32_TX_NONE;
+    }
+    for (int i = 0; i < E32_CFG_TX_QUEUE_SIZE; i++) {
+        queue->entries[i].next = (i + 1 < E32_CFG_TX_QUEUE_SIZE) ? (uint8_t)(i + 1) : E32_TX_NONE;
+    }
+    queue->free_head = 0;
+}
+
+e32_error_t e32_tx_queue_push(e32_tx_queue_t* queue, const e32_can_frame_t* frame,
+                              uint8_t flags, e32_tx_done_t done, void* user_data)
+{
+    uint8_t p = frame_priority(frame);
+
+    if (flags & E32_TX_COALESCE) {
+        for (uint8_t i = queue->head[p]; i != E32_TX_NONE; i = queue->entries[i].next) {
+            e32_tx_entry_t* e = &queue->entries[i];
+            if ((e->flags & E32_TX_COALESCE) && e->frame.id == frame->id &&
+                e->frame.is_extended == frame->is_extended) {
+                e32_can_frame_t old = e->frame;
+                e32_tx_done_t old_done = e->done;
+                void* old_user_data = e->user_data;
+
+                e->frame = *frame;
+                e->done = done;
+                e->user_data = user_data;
+                queue->stats.coalesced++;
+
+                if (old_done) {
+                    old_done(&old, E32_ERR_CANCELLED, old_user_data);
+                }
+                return E32_OK;
+            }
+        }
+    }
+
+    uint8_t i = queue->free_head;
+    if (i == E32_TX_NONE) {
+        queue->stats.rejected++;
+        return E32_ERR_BUSY;
+    }
+
+    e32_tx_entry_t* e = &queue->entries[i];
+    queue->free_head = e->next;
+
+    e->frame = *frame;
+    e->done = done;
+    e->user_data = user_data;
+    e->flags = flags;
+    e->next = E32_TX_NONE;
+
+    if (queue->tail[p] == E32_TX_NONE) {
+        queue->head[p] = i;
+    } else {
+        queue->entries[queue->tail[p]].next = i;
+    }
+    queue->tail[p] = i;
+
+    queue->depth++;
+    if (queue->depth > queue->stats.peak_depth) {
+        queue->stats.peak_depth = queue->depth;
+    }
+    return E32_OK;
+}
+
+/**
+ * Unlink the head of priority list p and return it to the free list.
+ */
+static uint8_t pop_head(e32_tx_queue_t* queue, uint8_t p)
+{
+    uint8_t i = queue->head[p];
+    e32_tx_entry_t* e = &queue->entries[i];
+
+    queue->head[p] = e->next;
+    if (queue->head[p] == E32_TX_NONE) {
+        queue->tail[p] = E32_TX_NONE;
+    }
+
+    e->next = queue->free_head;
+    queue->free_head = i;
+    queue->depth--;
+    return i;
+}
+
+uint32_t e32_tx_queue_flush(e32_tx_queue_t* queue, e32_tx_send_fn_t send,
+                            void* ctx, uint32_t burst)
+{
+    e32_can_frame_t frames[E32_CFG_TX_BURST];
+    e32_tx_done_t done[E32_CFG_TX_BURST];
+    void* user_data[E32_CFG_TX_BURST];
+    uint8_t prio[E32_CFG_TX_BURST];
+    uint32_t total = 0;
+
+    if (burst == 0 || burst > E32_CFG_TX_BURST) {
+        burst = E32_CFG_TX_BURST;
+    }
+
+    while (queue->depth > 0) {
+        /* Gather the next burst in arbitration order */
+        uint32_t n = 0;
+        for (uint8_t p = 0; p < E32_TX_PRIORITIES && n < burst; p++) {
+            for (uint8_t i = queue->head[p]; i != E32_TX_NONE && n < burst; i = queue->entries[i].next) {
+                frames[n] = queue->entries[i].frame;
+                prio[n] = p;
+                n++;
+            }
+        }
+
+        int rc = send ? send(ctx, frames, (int)n) : (int)n;
+        uint32_t accepted = rc > 0 ? (uint32_t)rc : 0;
+        if (accepted > n) {
+            accepted = n;
+        }
+
+        /* A hard error fails the first frame so one bad frame cannot wedge the queue */
+        uint32_t popped = (rc < 0) ? 1 : accepted;
+        for (uint32_t k = 0; k < popped; k++) {
+            uint8_t i = pop_head(queue, prio[k]);
+            done[k] = queue->entries[i].done;
+            user_data[k] = queue->entries[i].user_data;
+        }
+
+        if (rc < 0) {
+            queue->stats.errors++;
+        } else {
+            queue->stats.sent += accepted;
+            total += accepted;
+        }
+
+        for (uint32_t k = 0; k < popped; k++) {
+            if (done[k]) {
+                done[k](&frames[k], rc < 0 ? (e32_error_t)rc : E32_OK, user_data[k]);
+            }
+        }
+
+        if (rc < 0 || accepted < n) {
+            break;      /* Backend full or failing: retry on the next flush */
+        }
+    }
+
+    return total;
+}
+
+void e32_tx_queue_cancel(e32_tx_queue_t* queue, e32_error_t status)
+{
+    for (uint8_t p = 0; p < E32_TX_PRIORITIES; p++) {
+        while (queue->head[p] != E32_TX_NONE) {
+            uint8_t i = pop_head(queue, p);
+            e32_can_frame_t frame = queue->entries[i].frame;
+            e32_tx_done_t done = queue->entries[i].done;
+            void* user_data = queue->entries[i].user_data;
+
+            if (done) {
+                done(&frame, status, user_data);
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @file e32_tx_queue.h
+ * @brief Embedded32 SDK - Prioritised Transmit Queue (internal)
+ *
+ * One FIFO per J1939 priority level (0 = highest), all sharing a fixed
+ * pool of E32_CFG_TX_QUEUE_SIZE entries. Flushing walks the levels from
+ * priority 0 down, the same order in which the frames would win CAN
+ * arbitration, and hands the backend contiguous bursts. A burst never
+ * contains a lower-priority frame while a higher one is waiting, so
+ * control traffic does not queue behind bulk transfers.
+ *
+ * Entries flagged E32_TX_COALESCE are replaced in place by a newer
+ * coalescing frame with the same identifier (same PGN, priority, source
+ * and destination): the newest payload keeps the older frame's place in
+ * line.
+ *
+ * Single-threaded: push and flush run in the client's poll context.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_TX_QUEUE_H
+#define E32_TX_QUEUE_H
+
+#include "e32_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define E32_TX_PRIORITIES   8
+#define E32_TX_NONE         0xFF
+
+/**
+ * @brief One queued frame
+ */
+typedef struct {
+    e32_can_frame_t frame;
+    e32_tx_done_t   done;       /**< Completion callback (may be NULL) */
+    void*           user_data;
+    uint8_t         next;       /**< Next entry in the same list */
+    uint8_t         flags;      /**< E32_TX_* */
+} e32_tx_entry_t;
+
+/**
+ * @brief Queue state
+ */
+typedef struct {
+    e32_tx_entry_t entries[E32_CFG_TX_QUEUE_SIZE];
+    uint8_t        head[E32_TX_PRIORITIES];
+    uint8_t        tail[E32_TX_PRIORITIES];
+    uint8_t        free_head;
+    uint32_t       depth;
+    e32_tx_stats_t stats;
+} e32_tx_queue_t;
+
+/**
+ * @brief Backend send call used by flush
+ *
+ * @return Frames accepted (may be less than count), or negative e32_error_t
+ */
+typedef int (*e32_tx_send_fn_t)(void* ctx, const e32_can_frame_t* frames, int count);
+
+/**
+ * @brief Reset the queue (pending callbacks are not called)
+ */
+void e32_tx_queue_init(e32_tx_queue_t* queue);
+
+/**
+ * @brief Queue a frame at the priority encoded in its identifier
+ *
+ * @return E32_OK, or E32_ERR_BUSY if the queue is full
+ */
+e32_error_t e32_tx_queue_push(e32_tx_queue_t* queue, const e32_can_frame_t* frame,
+                              uint8_t flags, e32_tx_done_t done, void* user_data);
+
+/**
+ * @brief Send queued frames in priority order, burst frames at a time
+ *
+ * Stops when the queue is empty or the backend accepts less than a full
+ * burst. send == NULL discards every frame as sent (no backend attached).
+ *
+ * @return Frames handed to the backend
+ */
+uint32_t e32_tx_queue_flush(e32_tx_queue_t* queue, e32_tx_send_fn_t send,
+                            void* ctx, uint32_t burst);
+
+/**
+ * @brief Drop every queued frame, completing each with status
+ */
+void e32_tx_queue_cancel(e32_tx_queue_t* queue, e32_error_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_TX_QUEUE_H */
@@ -0,0 +1,742 @@
+/**
+ * @file e32_vbus.c
+ * @brief Embedded32 SDK - In-Process Virtual CAN Bus Implementation
+ *
+ * Node 0 of every bus carries the frames the application injects or
+ * replays; attached channels take the others. Each node's transmit ring
+ * has one producer (the channel's send, or for node 0 the caller
+ * holding the bus lock) and the bus as consumer; each receive ring has
+ * the bus as producer and the channel's recv as consumer. The bus
+ * itself only runs under its lock, so the rings stay single-producer,
+ * single-consumer whatever thread drives it.
+ *
+ * Frames waiting when the bus runs are treated as queued at the bus
+ * time it got to last, so a channel that is serviced rarely sees its
+ * frames start a little early rather than late.
+ *
+ * @version 1.0.0
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "e32_vbus.h"
+#include "e32_capture.h"
+#include "e32_transport.h"
+#include "e32_rx_ring.h"
+#include "e32_busload.h"
+#include "embedded32.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/eventfd.h>
+#define VBUS_HAVE_EVENTFD 1
+#endif
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(E32_CFG_NO_THREADS)
+#include <pthread.h>
+typedef pthread_mutex_t vbus_lock_t;
+#define VBUS_LOCK_INITIALIZER   PTHREAD_MUTEX_INITIALIZER
+#define vbus_lock_init(l)       pthread_mutex_init((l), NULL)
+#define vbus_lock_destroy(l)    pthread_mutex_destroy(l)
+#define vbus_lock(l)            pthread_mutex_lock(l)
+#define vbus_unlock(l)          pthread_mutex_unlock(l)
+#else
+typedef int vbus_lock_t;
+#define VBUS_LOCK_INITIALIZER   0
+#define vbus_lock_init(l)       ((void)(l))
+#define vbus_lock_destroy(l)    ((void)(l))
+#define vbus_lock(l)            ((void)(l))
+#define vbus_unlock(l)          ((void)(l))
+#endif
+
+/** Error flag, delimiter and intermission after a destroyed transmission */
+#define VBUS_ERROR_BITS     20
+
+/** Node carrying injected and replayed frames */
+#define VBUS_INJECT_NODE    0
+
+/* ==========================================================================
+ * BUS STATE
+ * ========================================================================== */
+
+typedef struct {
+    e32_rx_ring_t      tx;              /* Frames waiting for arbitration */
+    e32_rx_ring_t      rx;              /* Frames delivered to the channel */
+    e32_vbus_t*        bus;
+    bool               attached;
+    bool               accept_all;
+    uint16_t           filter_count;
+    e32_can_filter_t   filters[E32_CFG_FILTER_MAX];
+    int                fd;              /* eventfd, readable while rx holds frames; -1 if none */
+    uint32_t           signalled;       /* fd holds a count */
+} vbus_node_t;
+
+struct e32_vbus {
+    vbus_node_t          nodes[E32_CFG_VBUS_NODES];
+    e32_vbus_config_t    config;
+    vbus_lock_t          lock;
+    uint64_t             now_ns;        /* Bus time simulated so far */
+    uint64_t             target_ns;     /* E32_VBUS_CLOCK_MANUAL: time advance() reached */
+    uint64_t             wall_ns;       /* E32_VBUS_CLOCK_WALL: time since create */
+    uint32_t             wall_last;     /* e32_time_us() when wall_ns was updated */
+    uint64_t             busy_ns;
+    uint32_t             rng;
+    uint32_t             burst_left;
+    e32_vbus_stats_t     stats;
+
+    e32_capture_reader_t replay;
+    bool                 replaying;
+    uint32_t             replay_next;
+    uint32_t             replay_count;
+    uint32_t             replay_speed;  /* Percent, 0 = back to back */
+    uint32_t             replay_first;  /* Timestamp of the first record, ms */
+    uint64_t             replay_start;  /* Bus time it went out at, ns */
+
+    void*                alloc_base;
+};
+
+static e32_vbus_t* g_buses[E32_CFG_VBUS_MAX];
+static vbus_lock_t g_buses_lock = VBUS_LOCK_INITIALIZER;
+
+/* ==========================================================================
+ * HELPERS
+ * ========================================================================== */
+
+static uint32_t next_random(e32_vbus_t* bus)
+{
+    /* xorshift32: cheap and the same sequence on every platform */
+    uint32_t x = bus->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    bus->rng = x;
+    return x;
+}
+
+static bool chance(e32_vbus_t* bus, uint32_t ppm)
+{
+    return ppm && next_random(bus) % 1000000u < ppm;
+}
+
+/* Arbitration field as a number: lower wins, a base frame beats an extended one with its base ID */
+static uint32_t arbitration_key(const e32_can_frame_t* frame)
+{
+    if (frame->is_extended) {
+        return ((frame->id >> 18) << 20) | (3u << 18) | (frame->id & 0x3FFFF);
+    }
+    return (frame->id & 0x7FF) << 20;
+}
+
+static uint64_t bits_to_ns(const e32_vbus_t* bus, uint32_t bits)
+{
+    return (uint64_t)bits * 1000000000u / bus->config.bitrate;
+}
+
+static uint64_t frame_ns(const e32_vbus_t* bus, const e32_can_frame_t* frame)
+{
+    if (!bus->config.bitrate) {
+        return 0;
+    }
+#ifdef E32_CFG_CAN_FD
+    if (frame->flags & E32_CAN_FLAG_FD) {
+        return bits_to_ns(bus, e32_busload_fd_frame_bits(frame, bus->config.stuffing,
+                                                         bus->config.bitrate,
+                                                         bus->config.data_bitrate));
+    }
+#endif
+    return bits_to_ns(bus, e32_busload_frame_bits(frame, bus->config.stuffing));
+}
+
+static bool node_accepts(const vbus_node_t* node, const e32_can_frame_t* frame)
+{
+    if (node->accept_all) {
+        return true;
+    }
+    if (!frame->is_extended) {
+        return false;   /* Filters are for J1939 traffic, as on SocketCAN */
+    }
+    for (uint16_t i = 0; i < node->filter_count; i++) {
+        if (((frame->id ^ node->filters[i].id) & node->filters[i].mask) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void node_signal(vbus_node_t* node)
+{
+#ifdef VBUS_HAVE_EVENTFD
+    if (node->fd >= 0 && !node->signalled) {
+        uint64_t one = 1;
+        E32_STORE_RELAXED(&node->signalled, 1);
+        (void)!write(node->fd, &one, sizeof(one));
+    }
+#else
+    (void)node;
+#endif
+}
+
+/* ==========================================================================
+ * BUS TIME AND ARBITRATION
+ * ========================================================================== */
+
+/* Bus time the simulation may reach on this run */
+static uint64_t horizon(e32_vbus_t* bus)
+{
+    switch (bus->config.clock) {
+        case E32_VBUS_CLOCK_WALL: {
+            uint32_t now = e32_time_us();
+            bus->wall_ns += (uint64_t)(uint32_t)(now - bus->wall_last) * 1000u;
+            bus->wall_last = now;
+            return bus->wall_ns;
+        }
+        case E32_VBUS_CLOCK_MANUAL:
+            return bus->target_ns;
+        default:
+            return UINT64_MAX;
+    }
+}
+
+static uint64_t replay_due(const e32_vbus_t* bus, uint32_t timestamp)
+{
+    uint64_t offset_ms = (uint32_t)(timestamp - bus->replay_first);
+    return bus->replay_start + offset_ms * 1000000u * 100u / bus->replay_speed;
+}
+
+static void replay_stop(e32_vbus_t* bus)
+{
+    if (bus->replaying) {
+        e32_capture_reader_close(&bus->replay);
+        bus->replaying = false;
+    }
+}
+
+/**
+ * Move the capture records due by now into the injection ring, while it
+ * has room.
+ *
+ * @return Bus time the next record is due, UINT64_MAX if none is waiting for time
+ */
+static uint64_t replay_feed(e32_vbus_t* bus)
+{
+    e32_rx_ring_t* ring = &bus->nodes[VBUS_INJECT_NODE].tx;
+
+    while (bus->replaying && bus->replay_next < bus->replay_count) {
+        e32_can_frame_t frame;
+        if (e32_capture_get_frame(&bus->replay, bus->replay_next, &frame) != E32_OK) {
+            break;
+        }
+        if (bus->replay_speed) {
+            uint64_t due = replay_due(bus, frame.timestamp);
+            if (due > bus->now_ns) {
+                return due;
+            }
+        }
+        if (e32_rx_ring_depth(ring) >= E32_CFG_RX_RING_SIZE) {
+            return UINT64_MAX;
+        }
+        e32_rx_ring_push(ring, &frame);
+        bus->replay_next++;
+        bus->stats.replayed++;
+    }
+
+    replay_stop(bus);
+    return UINT64_MAX;
+}
+
+/**
+ * Node whose waiting frame wins arbitration, -1 if none waits
+ *
+ * @param waiting Receives the number of nodes with a frame waiting
+ */
+static int arbitrate(e32_vbus_t* bus, uint32_t* waiting)
+{
+    int winner = -1;
+    uint32_t best = UINT32_MAX;
+
+    *waiting = 0;
+    for (int i = 0; i < E32_CFG_VBUS_NODES; i++) {
+        vbus_node_t* node = &bus->nodes[i];
+        e32_can_frame_t* head;
+
+        if ((i != VBUS_INJECT_NODE && !node->attached) || !e32_rx_ring_peek(&node->tx, &head)) {
+            continue;
+        }
+        (*waiting)++;
+
+        uint32_t key = arbitration_key(head);
+        if (key < best) {
+            best = key;
+            winner = i;
+        }
+    }
+    return winner;
+}
+
+/* E32_VBUS_CLOCK_FREE holds the bus while a receiver of the frame has no room */
+static bool receivers_full(const e32_vbus_t* bus, int sender, const e32_can_frame_t* frame)
+{
+    for (int i = 0; i < E32_CFG_VBUS_NODES; i++) {
+        const vbus_node_t* node = &bus->nodes[i];
+        if (i != sender && node->attached && node_accepts(node, frame) &&
+            e32_rx_ring_depth(&node->rx) >= E32_CFG_RX_RING_SIZE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Error frames: a burst in progress, one starting, or a single error */
+static bool transmission_destroyed(e32_vbus_t* bus)
+{
+    if (bus->burst_left) {
+        bus->burst_left--;
+        return true;
+    }
+    if (chance(bus, bus->config.burst_ppm)) {
+        bus->burst_left = bus->config.burst_length ? bus->config.burst_length - 1u : 0;
+        return true;
+    }
+    return chance(bus, bus->config.error_ppm);
+}
+
+static void deliver(e32_vbus_t* bus, int sender, const e32_can_frame_t* frame)
+{
+    for (int i = 0; i < E32_CFG_VBUS_NODES; i++) {
+        vbus_node_t* node = &bus->nodes[i];
+
+        if (i == sender || !node->attached || !node_accepts(node, frame)) {
+            continue;
+        }
+        if (chance(bus, bus->config.drop_ppm)) {
+            bus->stats.dropped++;
+            continue;
+        }
+        if (e32_rx_ring_push(&node->rx, frame) != E32_OK) {
+            bus->stats.overflows++;
+            continue;
+        }
+        node_signal(node);
+    }
+}
+
+/**
+ * Run the bus up to the horizon of its clock: arbitrate, transmit and
+ * deliver until no frame waits, the next one would complete too late,
+ * or (free clock) a receiver is full. Call with the lock held.
+ */
+static void run(e32_vbus_t* bus)
+{
+    uint64_t until = horizon(bus);
+    bool free_clock = bus->config.clock == E32_VBUS_CLOCK_FREE;
+
+    for (;;) {
+        uint64_t due = replay_feed(bus);
+        uint32_t waiting;
+        int sender = arbitrate(bus, &waiting);
+
+        if (sender < 0) {
+            /* Idle until the next replayed record, or the horizon */
+            if (due != UINT64_MAX && due <= until) {
+                bus->now_ns = due;
+                continue;
+            }
+            if (!free_clock && bus->now_ns < until) {
+                bus->now_ns = until;
+            }
+            return;
+        }
+
+        e32_can_frame_t* head;
+        e32_rx_ring_peek(&bus->nodes[sender].tx, &head);
+
+        uint64_t ns = frame_ns(bus, head);
+        if (!free_clock && bus->now_ns + ns > until) {
+            return;     /* Still on the wire at the horizon */
+        }
+        if (free_clock && receivers_full(bus, sender, head)) {
+            return;
+        }
+        bus->stats.arbitration_lost += waiting - 1;
+
+        if (transmission_destroyed(bus)) {
+            uint64_t lost = ns / 2 + (bus->config.bitrate ? bits_to_ns(bus, VBUS_ERROR_BITS) : 0);
+            bus->now_ns += lost;
+            bus->busy_ns += lost;
+            bus->stats.error_frames++;
+            continue;   /* The sender retries: arbitration again */
+        }
+
+        bus->now_ns += ns;
+        bus->busy_ns += ns;
+
+        e32_can_frame_t frame = *head;
+        frame.timestamp = bus->config.epoch_ms + (uint32_t)(bus->now_ns / 1000000u);
+        e32_rx_ring_release(&bus->nodes[sender].tx, 1);
+        bus->stats.frames++;
+
+        deliver(bus, sender, &frame);
+    }
+}
+
+/* ==========================================================================
+ * BUS MANAGEMENT
+ * ========================================================================== */
+
+static void node_init(vbus_node_t* node, e32_vbus_t* bus)
+{
+    e32_rx_ring_init(&node->tx, 0);
+    e32_rx_ring_init(&node->rx, 0);
+    node->bus = bus;
+    node->attached = false;
+    node->accept_all = true;
+    node->filter_count = 0;
+    node->fd = -1;
+    node->signalled = 0;
+}
+
+e32_error_t e32_vbus_create(const e32_vbus_config_t* config, e32_vbus_t** bus)
+{
+    if (!config || !bus || !config->name ||
+        config->error_ppm >= 1000000u || config->burst_ppm >= 1000000u) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    vbus_lock(&g_buses_lock);
+
+    int slot = -1;
+    for (int i = 0; i < E32_CFG_VBUS_MAX; i++) {
+        if (g_buses[i] && strcmp(g_buses[i]->config.name, config->name) == 0) {
+            vbus_unlock(&g_buses_lock);
+            return E32_ERR_BUSY;
+        }
+        if (!g_buses[i] && slot < 0) {
+            slot = i;
+        }
+    }
+
+    /* The rings want their indices on separate cache lines */
+    void* base = slot < 0 ? NULL : malloc(sizeof(struct e32_vbus) + E32_CFG_CACHE_LINE - 1);
+    if (!base) {
+        vbus_unlock(&g_buses_lock);
+        return E32_ERR_NO_MEMORY;
+    }
+
+    e32_vbus_t* b = (e32_vbus_t*)(((uintptr_t)base + E32_CFG_CACHE_LINE - 1) &
+                                  ~(uintptr_t)(E32_CFG_CACHE_LINE - 1));
+    memset(b, 0, sizeof(*b));
+    b->alloc_base = base;
+    b->config = *config;
+    if (!b->config.data_bitrate) {
+        b->config.data_bitrate = 2000000;
+    }
+    if (b->config.clock == E32_VBUS_CLOCK_WALL) {
+        b->config.epoch_ms = e32_time_ms();
+        b->wall_last = e32_time_us();
+    }
+    b->rng = config->seed ? config->seed : 1;
+    for (int i = 0; i < E32_CFG_VBUS_NODES; i++) {
+        node_init(&b->nodes[i], b);
+    }
+    vbus_lock_init(&b->lock);
+
+    g_buses[slot] = b;
+    vbus_unlock(&g_buses_lock);
+
+    *bus = b;
+    return E32_OK;
+}
+
+void e32_vbus_destroy(e32_vbus_t* bus)
+{
+    if (!bus) {
+        return;
+    }
+
+    vbus_lock(&g_buses_lock);
+    for (int i = 0; i < E32_CFG_VBUS_MAX; i++) {
+        if (g_buses[i] == bus) {
+            g_buses[i] = NULL;
+        }
+    }
+    vbus_unlock(&g_buses_lock);
+
+    replay_stop(bus);
+#ifdef VBUS_HAVE_EVENTFD
+    for (int i = 0; i < E32_CFG_VBUS_NODES; i++) {
+        if (bus->nodes[i].fd >= 0) {
+            close(bus->nodes[i].fd);
+        }
+    }
+#endif
+    vbus_lock_destroy(&bus->lock);
+    free(bus->alloc_base);
+}
+
+int e32_vbus_inject(e32_vbus_t* bus, const e32_can_frame_t* frames, int count)
+{
+    if (!bus || (!frames && count > 0) || count < 0) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    vbus_lock(&bus->lock);
+
+    /* Replayed records share the ring, so injecting needs the lock too */
+    e32_rx_ring_t* ring = &bus->nodes[VBUS_INJECT_NODE].tx;
+    int accepted = 0;
+    while (accepted < count) {
+        uint32_t room;
+        e32_can_frame_t* slots = e32_rx_ring_reserve(ring, &room);
+        uint32_t n = (uint32_t)(count - accepted) < room ? (uint32_t)(count - accepted) : room;
+        if (n == 0) {
+            break;
+        }
+        memcpy(slots, &frames[accepted], sizeof(*slots) * n);
+        e32_rx_ring_commit(ring, n);
+        accepted += (int)n;
+    }
+    bus->stats.injected += (uint32_t)accepted;
+
+    run(bus);
+    vbus_unlock(&bus->lock);
+    return accepted;
+}
+
+e32_error_t e32_vbus_advance(e32_vbus_t* bus, uint32_t us)
+{
+    if (!bus) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    vbus_lock(&bus->lock);
+    bus->target_ns += (uint64_t)us * 1000u;
+    run(bus);
+    vbus_unlock(&bus->lock);
+    return E32_OK;
+}
+
+e32_error_t e32_vbus_replay(e32_vbus_t* bus, const char* path, uint32_t speed_pct)
+{
+    if (!bus || !path) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    vbus_lock(&bus->lock);
+    replay_stop(bus);
+
+    e32_error_t err = e32_capture_reader_open(&bus->replay, path);
+    if (err == E32_OK) {
+        const e32_capture_record_t* records = e32_capture_records(&bus->replay, &bus->replay_count);
+        bus->replaying = true;
+        bus->replay_next = 0;
+        bus->replay_speed = speed_pct;
+        bus->replay_first = bus->replay_count ? records[0].timestamp : 0;
+        bus->replay_start = bus->now_ns;
+        run(bus);
+    }
+
+    vbus_unlock(&bus->lock);
+    return err;
+}
+
+uint64_t e32_vbus_time_us(e32_vbus_t* bus)
+{
+    if (!bus) {
+        return 0;
+    }
+
+    vbus_lock(&bus->lock);
+    uint64_t us = bus->now_ns / 1000u;
+    vbus_unlock(&bus->lock);
+    return us;
+}
+
+e32_error_t e32_vbus_get_stats(e32_vbus_t* bus, e32_vbus_stats_t* stats)
+{
+    if (!bus || !stats) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    vbus_lock(&bus->lock);
+    *stats = bus->stats;
+    stats->replay_pending = bus->replaying ? bus->replay_count - bus->replay_next : 0;
+    stats->time_us = bus->now_ns / 1000u;
+    stats->busy_us = bus->busy_ns / 1000u;
+    vbus_unlock(&bus->lock);
+    return E32_OK;
+}
+
+/* ==========================================================================
+ * TRANSPORT OPERATIONS
+ * ========================================================================== */
+
+static e32_error_t vbus_open(e32_transport_t* transport, const e32_j1939_config_t* config)
+{
+    if (!config->interface_name) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    vbus_lock(&g_buses_lock);
+
+    e32_vbus_t* bus = NULL;
+    for (int i = 0; i < E32_CFG_VBUS_MAX && !bus; i++) {
+        if (g_buses[i] && strcmp(g_buses[i]->config.name, config->interface_name) == 0) {
+            bus = g_buses[i];
+        }
+    }
+    if (!bus) {
+        vbus_unlock(&g_buses_lock);
+        return E32_ERR_NOT_FOUND;
+    }
+
+    vbus_lock(&bus->lock);
+    vbus_node_t* node = NULL;
+    for (int i = VBUS_INJECT_NODE + 1; i < E32_CFG_VBUS_NODES && !node; i++) {
+        if (!bus->nodes[i].attached) {
+            node = &bus->nodes[i];
+        }
+    }
+
+    e32_error_t err = E32_ERR_NO_MEMORY;
+    if (node) {
+        node_init(node, bus);
+#ifdef VBUS_HAVE_EVENTFD
+        node->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+        node->attached = true;
+        bus->stats.nodes++;
+        transport->handle = node;
+        err = E32_OK;
+    }
+
+    vbus_unlock(&bus->lock);
+    vbus_unlock(&g_buses_lock);
+    return err;
+}
+
+static void vbus_close(e32_transport_t* transport)
+{
+    vbus_node_t* node = transport->handle;
+    if (!node) return;
+
+    e32_vbus_t* bus = node->bus;
+    vbus_lock(&bus->lock);
+#ifdef VBUS_HAVE_EVENTFD
+    if (node->fd >= 0) {
+        close(node->fd);
+    }
+#endif
+    node_init(node, bus);   /* Frames still waiting never make it onto the bus */
+    bus->stats.nodes--;
+    vbus_unlock(&bus->lock);
+
+    transport->handle = NULL;
+}
+
+static int vbus_send(e32_transport_t* transport, const e32_can_frame_t* frames, int count)
+{
+    vbus_node_t* node = transport->handle;
+    int accepted = 0;
+
+    while (accepted < count) {
+        uint32_t room;
+        e32_can_frame_t* slots = e32_rx_ring_reserve(&node->tx, &room);
+        uint32_t n = (uint32_t)(count - accepted) < room ? (uint32_t)(count - accepted) : room;
+        if (n == 0) {
+            break;  /* Ring full - caller keeps the rest */
+        }
+        memcpy(slots, &frames[accepted], sizeof(*slots) * n);
+        e32_rx_ring_commit(&node->tx, n);
+        accepted += (int)n;
+    }
+
+    vbus_lock(&node->bus->lock);
+    run(node->bus);
+    vbus_unlock(&node->bus->lock);
+    return accepted;
+}
+
+static int vbus_recv(e32_transport_t* transport, e32_can_frame_t* frames, int max)
+{
+    vbus_node_t* node = transport->handle;
+    e32_vbus_t* bus = node->bus;
+
+    vbus_lock(&bus->lock);
+    run(bus);
+    vbus_unlock(&bus->lock);
+
+    int out = 0;
+    while (out < max) {
+        e32_can_frame_t* first;
+        uint32_t n = e32_rx_ring_peek(&node->rx, &first);
+        if ((uint32_t)(max - out) < n) {
+            n = (uint32_t)(max - out);
+        }
+        if (n == 0) {
+            break;
+        }
+        memcpy(&frames[out], first, sizeof(*first) * n);
+        e32_rx_ring_release(&node->rx, n);
+        out += (int)n;
+    }
+
+#ifdef VBUS_HAVE_EVENTFD
+    /* Drained: clear the descriptor, unless the bus delivered meanwhile */
+    if (E32_LOAD_RELAXED(&node->signalled) && e32_rx_ring_depth(&node->rx) == 0) {
+        vbus_lock(&bus->lock);
+        if (e32_rx_ring_depth(&node->rx) == 0) {
+            uint64_t count;
+            (void)!read(node->fd, &count, sizeof(count));
+            node->signalled = 0;
+        }
+        vbus_unlock(&bus->lock);
+    }
+#endif
+
+    /* A receiver that made room may let a held bus move on */
+    if (out > 0 && bus->config.clock == E32_VBUS_CLOCK_FREE) {
+        vbus_lock(&bus->lock);
+        run(bus);
+        vbus_unlock(&bus->lock);
+    }
+    return out;
+}
+
+static e32_error_t vbus_set_filters(e32_transport_t* transport, const e32_can_filter_t* filters, int count)
+{
+    vbus_node_t* node = transport->handle;
+
+    if (count < 0 || count > E32_CFG_FILTER_MAX) {
+        return E32_ERR_NOT_SUPPORTED;
+    }
+
+    vbus_lock(&node->bus->lock);
+    node->accept_all = filters == NULL;
+    node->filter_count = filters ? (uint16_t)count : 0;
+    if (filters) {
+        memcpy(node->filters, filters, sizeof(*filters) * (size_t)count);
+    }
+    vbus_unlock(&node->bus->lock);
+    return E32_OK;
+}
+
+static int vbus_get_fd(e32_transport_t* transport)
+{
+    vbus_node_t* node = transport->handle;
+    return node ? node->fd : -1;
+}
+
+const e32_transport_ops_t e32_vbus_transport = {
+    .name        = "virtual",
+    .open        = vbus_open,
+    .close       = vbus_close,
+    .send        = vbus_send,
+    .recv        = vbus_recv,
+    .set_filters = vbus_set_filters,
+    .get_fd      = vbus_get_fd,
+    .max_filters = E32_CFG_FILTER_MAX,
+};
@@ -0,0 +1,307 @@
+/**
+ * @file e32_workers.c
+ * @brief Embedded32 SDK - Threaded Dispatch Workers Implementation
+ *
+ * Every slot's sequence number tells producers and the consumer whose
+ * turn it is: seq == pos means free for the producer claiming pos,
+ * seq == pos + 1 means filled and ready for the consumer. The consumer
+ * hands the slot back by setting seq = pos + size after the handler
+ * returns, so items are dispatched in place without a copy. Every slot
+ * carries room for a transport payload; the queues, payload space
+ * included, are allocated once when the pool starts.
+ *
+ * @version 1.0.0
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "e32_workers.h"
+#include "e32_port.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(E32_CFG_NO_THREADS)
+
+#include <pthread.h>
+
+#define QUEUE_MASK  (E32_CFG_WORKER_QUEUE_SIZE - 1)
+
+typedef struct {
+    uint32_t        seq;
+    e32_work_item_t item;
+    uint8_t         payload[E32_CFG_TP_MAX_LEN];    /**< item.payload points here */
+} work_slot_t;
+
+typedef struct {
+    /* Producer-owned line */
+    E32_ALIGNED(E32_CFG_CACHE_LINE) uint32_t enqueue_pos;
+    uint32_t        overflows;
+    uint32_t        peak_depth;
+
+    /* Consumer-owned line */
+    E32_ALIGNED(E32_CFG_CACHE_LINE) uint32_t dequeue_pos;
+    uint32_t        dispatched;
+    uint32_t        sleeping;       /**< Set while the worker is about to wait */
+
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    pthread_t       thread;
+    e32_workers_t*  pool;
+
+    E32_ALIGNED(E32_CFG_CACHE_LINE) work_slot_t slots[E32_CFG_WORKER_QUEUE_SIZE];
+} worker_t;
+
+struct e32_workers {
+    worker_t*       workers;        /* count entries, cache-line aligned */
+    uint8_t         count;
+    uint32_t        stop;
+    e32_work_fn_t   fn;
+    void*           ctx;
+};
+
+/* ==========================================================================
+ * WORKER THREAD
+ * ========================================================================== */
+
+static bool slot_ready(const worker_t* w, uint32_t pos)
+{
+    uint32_t seq = E32_LOAD_ACQUIRE(&w->slots[pos & QUEUE_MASK].seq);
+    return seq == pos + 1;
+}
+
+static void* worker_main(void* arg)
+{
+    worker_t* w = (worker_t*)arg;
+    e32_workers_t* pool = w->pool;
+
+    for (;;) {
+        uint32_t pos = w->dequeue_pos;
+
+        if (slot_ready(w, pos)) {
+            work_slot_t* slot = &w->slots[pos & QUEUE_MASK];
+
+            pool->fn(pool->ctx, &slot->item);
+
+            E32_STORE_RELEASE(&slot->seq, pos + E32_CFG_WORKER_QUEUE_SIZE);
+            E32_STORE_RELAXED(&w->dequeue_pos, pos + 1);
+            E32_STORE_RELAXED(&w->dispatched, w->dispatched + 1);
+            continue;
+        }
+
+        /* Empty: finish only once stop is set, so queued work is never lost */
+        if (E32_LOAD_ACQUIRE(&pool->stop)) {
+            break;
+        }
+
+        pthread_mutex_lock(&w->lock);
+        E32_STORE_RELAXED(&w->sleeping, 1);
+        E32_FENCE_SEQ_CST();
+        if (!slot_ready(w, pos) && !E32_LOAD_ACQUIRE(&pool->stop)) {
+            pthread_cond_wait(&w->wake, &w->lock);
+        }
+        E32_STORE_RELAXED(&w->sleeping, 0);
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    return NULL;
+}
+
+static void wake(worker_t* w)
+{
+    pthread_mutex_lock(&w->lock);
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+}
+
+/* ==========================================================================
+ * POOL
+ * ========================================================================== */
+
+e32_error_t e32_workers_start(e32_workers_t** out, uint8_t count,
+                              e32_work_fn_t fn, void* ctx)
+{
+    if (!out || !fn || count == 0 || count > E32_CFG_MAX_WORKERS) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    e32_workers_t* pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return E32_ERR_NO_MEMORY;
+    }
+
+    void* mem = NULL;
+    if (posix_memalign(&mem, E32_CFG_CACHE_LINE, sizeof(worker_t) * count) != 0) {
+        free(pool);
+        return E32_ERR_NO_MEMORY;
+    }
+    memset(mem, 0, sizeof(worker_t) * count);
+
+    pool->workers = (worker_t*)mem;
+    pool->fn = fn;
+    pool->ctx = ctx;
+
+    for (uint8_t i = 0; i < count; i++) {
+        worker_t* w = &pool->workers[i];
+        w->pool = pool;
+        for (uint32_t k = 0; k < E32_CFG_WORKER_QUEUE_SIZE; k++) {
+            w->slots[k].seq = k;
+        }
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->wake, NULL);
+
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            pthread_mutex_destroy(&w->lock);
+            pthread_cond_destroy(&w->wake);
+            e32_workers_stop(pool);     /* Joins the ones already running */
+            return E32_ERR_NO_MEMORY;
+        }
+        pool->count = i + 1;
+    }
+
+    *out = pool;
+    return E32_OK;
+}
+
+e32_error_t e32_workers_push(e32_workers_t* pool, uint32_t key, const e32_work_item_t* item)
+{
+    /* Fibonacci hash, then scale onto [0, count) without a division */
+    uint32_t h = key * 0x9E3779B1u;
+    worker_t* w = &pool->workers[((uint64_t)h * pool->count) >> 32];
+
+    if (item->payload && item->payload_len > E32_CFG_TP_MAX_LEN) {
+        E32_FETCH_ADD(&w->overflows, 1);    /* No slot can hold it: dropped */
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    uint32_t pos = E32_LOAD_RELAXED(&w->enqueue_pos);
+    work_slot_t* slot;
+
+    for (;;) {
+        slot = &w->slots[pos & QUEUE_MASK];
+        int32_t diff = (int32_t)(E32_LOAD_ACQUIRE(&slot->seq) - pos);
+
+        if (diff == 0) {
+            if (E32_CAS_WEAK(&w->enqueue_pos, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            E32_FETCH_ADD(&w->overflows, 1);
+            return E32_ERR_BUSY;
+        } else {
+            pos = E32_LOAD_RELAXED(&w->enqueue_pos);
+        }
+    }
+
+    slot->item = *item;
+    if (item->payload) {
+        memcpy(slot->payload, item->payload, item->payload_len);
+        slot->item.payload = slot->payload;
+    }
+    E32_STORE_RELEASE(&slot->seq, pos + 1);
+
+    uint32_t depth = pos + 1 - E32_LOAD_RELAXED(&w->dequeue_pos);
+    if (depth > E32_LOAD_RELAXED(&w->peak_depth)) {
+        E32_STORE_RELAXED(&w->peak_depth, depth);
+    }
+
+    /* Pairs with the fence in worker_main: one side sees the other */
+    E32_FENCE_SEQ_CST();
+    if (E32_LOAD_RELAXED(&w->sleeping)) {
+        wake(w);
+    }
+    return E32_OK;
+}
+
+void e32_workers_stop(e32_workers_t* pool)
+{
+    if (!pool) return;
+
+    E32_STORE_RELEASE(&pool->stop, 1);
+
+    for (uint8_t i = 0; i < pool->count; i++) {
+        worker_t* w = &pool->workers[i];
+        wake(w);
+        pthread_join(w->thread, NULL);
+        pthread_mutex_destroy(&w->lock);
+        pthread_cond_destroy(&w->wake);
+    }
+
+    free(pool->workers);
+    free(pool);
+}
+
+bool e32_workers_on_worker(const e32_workers_t* pool)
+{
+    if (!pool) return false;
+
+    pthread_t self = pthread_self();
+    for (uint8_t i = 0; i < pool->count; i++) {
+        if (pthread_equal(pool->workers[i].thread, self)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t e32_workers_count(const e32_workers_t* pool)
+{
+    return pool ? pool->count : 0;
+}
+
+e32_error_t e32_workers_get_stats(const e32_workers_t* pool, uint8_t index,
+                                  e32_worker_stats_t* stats)
+{
+    if (!pool || !stats || index >= pool->count) {
+        return E32_ERR_INVALID_PARAM;
+    }
+
+    const worker_t* w = &pool->workers[index];
+    stats->depth = E32_LOAD_RELAXED(&w->enqueue_pos) - E32_LOAD_RELAXED(&w->dequeue_pos);
+    stats->peak_depth = E32_LOAD_RELAXED(&w->peak_depth);
+    stats->dispatched = E32_LOAD_RELAXED(&w->dispatched);
+    stats->overflows = E32_LOAD_RELAXED(&w->overflows);
+    return E32_OK;
+}
+
+#else /* no threads */
+
+e32_error_t e32_workers_start(e32_workers_t** out, uint8_t count,
+                              e32_work_fn_t fn, void* ctx)
+{
+    (void)out; (void)count; (void)fn; (void)ctx;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+e32_error_t e32_workers_push(e32_workers_t* pool, uint32_t key, const e32_work_item_t* item)
+{
+    (void)pool; (void)key; (void)item;     /* No pool can exist to push to */
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+void e32_workers_stop(e32_workers_t* pool)
+{
+    (void)pool;
+}
+
+bool e32_workers_on_worker(const e32_workers_t* pool)
+{
+    (void)pool;
+    return false;
+}
+
+uint8_t e32_workers_count(const e32_workers_t* pool)
+{
+    (void)pool;
+    return 0;
+}
+
+e32_error_t e32_workers_get_stats(const e32_workers_t* pool, uint8_t index,
+                                  e32_worker_stats_t* stats)
+{
+    (void)pool; (void)index; (void)stats;
+    return E32_ERR_NOT_SUPPORTED;
+}
+
+#endif
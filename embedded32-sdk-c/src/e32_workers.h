@@ -0,0 +1,109 @@
+/**
+ * @file e32_workers.h
+ * @brief Embedded32 SDK - Threaded Dispatch Workers (internal)
+ *
+ * A fixed pool of POSIX threads, each fed by its own bounded lock-free
+ * MPSC queue. The poll thread (or any other producer) hashes every
+ * message key to one worker, so messages with equal keys are handled
+ * by one thread in the order they were queued while different keys run
+ * in parallel.
+ *
+ * Queue slots carry a sequence number (Vyukov bounded queue): producers
+ * claim a slot with one CAS, the single consumer needs no atomic
+ * read-modify-write at all. A worker with nothing to do sleeps on a
+ * condition variable; producers only touch the mutex when the worker
+ * has announced that it is going to sleep.
+ *
+ * @internal Not part of the public SDK API.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_WORKERS_H
+#define E32_WORKERS_H
+
+#include "e32_types.h"
+#include "e32_codec.h"
+#include "e32_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One queued message
+ *
+ * Single frames are copied whole. The payload of a reassembled transport
+ * message is copied into the queue slot, which has room for
+ * E32_CFG_TP_MAX_LEN bytes, so queueing never allocates.
+ */
+typedef struct {
+    e32_can_frame_t frame;          /**< Single-frame messages */
+    const uint8_t*  payload;        /**< Multi-packet data, NULL for single frames */
+    uint16_t        payload_len;
+    uint8_t         source_address;
+    uint8_t         destination_address;
+    uint8_t         priority;
+    uint8_t         channel;
+    uint32_t        pgn;
+    uint32_t        timestamp;
+    uint32_t        gate_pass;      /**< Gated subscriptions the message passed */
+    uint8_t         wants;          /**< Handler kinds that will see it */
+    e32_stats_tag_t tag;            /**< Statistics context from the polling thread */
+} e32_work_item_t;
+
+/**
+ * @brief Handles one item on a worker thread
+ */
+typedef void (*e32_work_fn_t)(void* ctx, const e32_work_item_t* item);
+
+typedef struct e32_workers e32_workers_t;
+
+/**
+ * @brief Start count worker threads
+ *
+ * @param out Receives the pool (allocated)
+ * @return E32_OK, E32_ERR_NO_MEMORY, E32_ERR_NOT_SUPPORTED without
+ *         thread support, E32_ERR_INVALID_PARAM for a bad count
+ */
+e32_error_t e32_workers_start(e32_workers_t** out, uint8_t count,
+                              e32_work_fn_t fn, void* ctx);
+
+/**
+ * @brief Queue an item for the worker that owns key
+ *
+ * The item and its payload are copied into the queue, so the caller's
+ * buffers may be reused as soon as this returns.
+ *
+ * @return E32_OK, E32_ERR_BUSY if that worker's queue is full,
+ *         E32_ERR_INVALID_PARAM for a payload over E32_CFG_TP_MAX_LEN
+ *         bytes (both dropped and counted as overflows)
+ */
+e32_error_t e32_workers_push(e32_workers_t* workers, uint32_t key, const e32_work_item_t* item);
+
+/**
+ * @brief Let every worker finish its queue, then join and free the pool
+ */
+void e32_workers_stop(e32_workers_t* workers);
+
+/**
+ * @brief Whether the calling thread is one of the pool's workers
+ */
+bool e32_workers_on_worker(const e32_workers_t* workers);
+
+/**
+ * @brief Number of workers in the pool
+ */
+uint8_t e32_workers_count(const e32_workers_t* workers);
+
+/**
+ * @brief Snapshot of one worker's counters
+ */
+e32_error_t e32_workers_get_stats(const e32_workers_t* workers, uint8_t index,
+                                  e32_worker_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E32_WORKERS_H */
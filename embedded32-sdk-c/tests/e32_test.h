@@ -0,0 +1,43 @@
+/**
+ * @file e32_test.h
+ * @brief Embedded32 SDK - Minimal Test Harness
+ *
+ * Every tests/test_*.c is one ctest executable: it RUN()s its cases,
+ * prints one line per case and exits non-zero if any CHECK failed.
+ * Checks report and continue, so one run lists every failure.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_TEST_H
+#define E32_TEST_H
+
+#include <stdio.h>
+
+static int e32_test_failures;
+
+#define CHECK(cond) do {                                                    \
+    if (!(cond)) {                                                          \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        e32_test_failures++;                                                \
+    }                                                                       \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do {                                     \
+    long long a_ = (long long)(actual), e_ = (long long)(expected);         \
+    if (a_ != e_) {                                                         \
+        fprintf(stderr, "%s:%d: %s == %lld, expected %s == %lld\n",         \
+                __FILE__, __LINE__, #actual, a_, #expected, e_);            \
+        e32_test_failures++;                                                \
+    }                                                                       \
+} while (0)
+
+#define RUN(test) do {                                                      \
+    int before_ = e32_test_failures;                                        \
+    test();                                                                 \
+    printf("%-4s %s\n", e32_test_failures == before_ ? "ok" : "FAIL", #test); \
+} while (0)
+
+#define TEST_RESULT()   (e32_test_failures ? 1 : 0)
+
+#endif /* E32_TEST_H */
@@ -0,0 +1,122 @@
+/**
+ * @file e32_test_bus.h
+ * @brief Embedded32 SDK - Virtual Bus Test Fixture
+ *
+ * Clients on E32_VBUS_CLOCK_MANUAL buses whose protocol timers run on
+ * bus time, so timeouts are exact and every run is the same. test_run()
+ * moves every bus one millisecond at a time and polls every client in
+ * between. Frames take no bus time unless test_bus_ex() sets a bitrate.
+ *
+ * @version 1.0.0
+ */
+
+#ifndef E32_TEST_BUS_H
+#define E32_TEST_BUS_H
+
+#include "embedded32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_BUSES      4
+#define TEST_MAX_CLIENTS    8
+
+static e32_vbus_t*         test_buses[TEST_MAX_BUSES];
+static int                 test_bus_count;
+static e32_j1939_client_t  test_clients[TEST_MAX_CLIENTS];
+static int                 test_client_count;
+
+/* Bus time of the first bus, offset so no timestamp is 0 */
+static uint32_t test_clock_ms(void)
+{
+    return 1000u + (uint32_t)(e32_vbus_time_us(test_buses[0]) / 1000u);
+}
+
+/* A bus; config may be pre-filled (the clock is set here) */
+static e32_vbus_t* test_bus_ex(e32_vbus_config_t* config)
+{
+    config->clock = E32_VBUS_CLOCK_MANUAL;
+
+    e32_vbus_t* bus = NULL;
+    if (test_bus_count >= TEST_MAX_BUSES || e32_vbus_create(config, &bus) != E32_OK) {
+        fprintf(stderr, "cannot create virtual bus %s\n", config->name);
+        exit(2);
+    }
+    test_buses[test_bus_count++] = bus;
+    return bus;
+}
+
+static e32_vbus_t* test_bus(const char* name)
+{
+    e32_vbus_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.name = name;
+    return test_bus_ex(&config);
+}
+
+/* A connected client; config may be pre-filled (transport, clock and address are set here) */
+static e32_j1939_client_t test_client_ex(e32_j1939_config_t* config, uint8_t sa)
+{
+    config->source_address = sa;
+    config->transport = E32_TRANSPORT_VIRTUAL;
+    config->clock_ms = test_clock_ms;
+
+    e32_j1939_client_t client = NULL;
+    if (test_client_count >= TEST_MAX_CLIENTS ||
+        e32_j1939_create(config, &client) != E32_OK ||
+        e32_j1939_connect(client) != E32_OK) {
+        fprintf(stderr, "cannot connect client 0x%02X\n", sa);
+        exit(2);
+    }
+    test_clients[test_client_count++] = client;
+    return client;
+}
+
+static e32_j1939_client_t test_client(const char* bus, uint8_t sa)
+{
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.interface_name = bus;
+    return test_client_ex(&config, sa);
+}
+
+/* Let ms milliseconds of bus time pass */
+static void test_run(uint32_t ms)
+{
+    for (uint32_t t = 0; t <= ms; t++) {
+        for (int b = 0; b < test_bus_count; b++) {
+            e32_vbus_advance(test_buses[b], t ? 1000 : 0);
+        }
+        for (int c = 0; c < test_client_count; c++) {
+            e32_j1939_poll(test_clients[c]);
+        }
+    }
+}
+
+/* Put one 8-byte frame on a bus as some other node */
+static void test_inject(e32_vbus_t* bus, uint32_t pgn, uint8_t sa, uint8_t da, uint8_t priority,
+                        const uint8_t data[8])
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = e32_build_j1939_id(pgn, sa, priority, da);
+    frame.is_extended = true;
+    frame.dlc = 8;
+    memcpy(frame.data, data, 8);
+    e32_vbus_inject(bus, &frame, 1);
+    test_run(0);
+}
+
+static void test_teardown(void)
+{
+    for (int c = 0; c < test_client_count; c++) {
+        e32_j1939_destroy(test_clients[c]);
+    }
+    for (int b = 0; b < test_bus_count; b++) {
+        e32_vbus_destroy(test_buses[b]);
+    }
+    test_client_count = 0;
+    test_bus_count = 0;
+}
+
+#endif /* E32_TEST_BUS_H */
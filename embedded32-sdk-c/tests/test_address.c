@@ -0,0 +1,272 @@
+/**
+ * @file test_address.c
+ * @brief Embedded32 SDK - Address Claim Tests
+ *
+ * Clients with a NAME on manual-clock virtual buses.
+ *
+ * Tests:
+ * - A lower-priority NAME on our address is answered with our claim
+ * - A higher-priority NAME takes the address: Cannot Claim, sends refused
+ * - An arbitrary-address NAME moves to a free address, skipping addresses
+ *   any bus has seen claimed
+ * - Address and NAME tables follow claims that move
+ * - A claim that finds one bus's transmit queue full goes out once on
+ *   every bus, the full one as soon as its queue drains
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include "e32_address.h"
+
+#define NAME_OURS       0x0000000000001234ull
+#define NAME_LOWER      0x0000000000001000ull  /* Wins against NAME_OURS */
+#define NAME_HIGHER     0x0000000000002000ull  /* Loses against NAME_OURS */
+#define PGN_PROP_B      0xFF20
+
+/* Address Claimed frames per bus from the client under test */
+static uint64_t g_name = NAME_OURS;
+static uint32_t g_claims[2];
+static uint8_t  g_claimed_sa[2];
+
+/* Claim states reported through config.on_address */
+static e32_address_state_t g_states[8];
+static uint8_t             g_addresses[8];
+static int                 g_state_count;
+
+static void count_claim(const e32_j1939_view_t* view, void* user)
+{
+    int bus = (int)(intptr_t)user;
+    if (view->len >= 8 && e32_decode_name(view->data) == g_name) {
+        g_claims[bus]++;
+        g_claimed_sa[bus] = view->source_address;
+    }
+}
+
+static void listen_for_claims(e32_j1939_client_t listener, int bus)
+{
+    e32_j1939_on_pgn_view(listener, E32_PGN_ADDRESS_CLAIMED, count_claim, (void*)(intptr_t)bus, NULL);
+}
+
+static void record_state(void* ctx, e32_address_state_t state, uint8_t address)
+{
+    (void)ctx;
+    if (g_state_count < 8) {
+        g_states[g_state_count] = state;
+        g_addresses[g_state_count++] = address;
+    }
+}
+
+/* Another node claims sa */
+static void inject_claim(e32_vbus_t* bus, uint8_t sa, uint64_t name)
+{
+    e32_can_frame_t frame;
+    e32_encode_address_claimed(name, sa, &frame);
+    e32_vbus_inject(bus, &frame, 1);
+    test_run(0);
+}
+
+/* A listener on vaddr0, then a client claiming 0x20 with name; claimed once run returns */
+static e32_j1939_client_t claiming_client(e32_vbus_t** bus, uint64_t name)
+{
+    *bus = test_bus("vaddr0");
+    listen_for_claims(test_client("vaddr0", 0x30), 0);
+    g_name = name;
+    memset(g_claims, 0, sizeof(g_claims));
+    g_state_count = 0;
+
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.interface_name = "vaddr0";
+    config.name = name;
+    config.on_address = record_state;
+    e32_j1939_client_t client = test_client_ex(&config, 0x20);
+    test_run(E32_CLAIM_WINDOW_MS + 10);
+    return client;
+}
+
+static void defends_against_higher_name(void)
+{
+    e32_vbus_t* bus;
+    e32_j1939_client_t client = claiming_client(&bus, NAME_OURS);
+    CHECK_EQ(e32_j1939_get_address_state(client), E32_ADDRESS_CLAIMED);
+    CHECK_EQ(g_claims[0], 1);
+
+    inject_claim(bus, 0x20, NAME_HIGHER);
+    test_run(5);
+    CHECK_EQ(g_claims[0], 2);
+    CHECK_EQ(g_claimed_sa[0], 0x20);
+    CHECK_EQ(e32_j1939_get_address_state(client), E32_ADDRESS_CLAIMED);
+    CHECK_EQ(e32_j1939_get_source_address(client), 0x20);
+
+    /* Our own claim took the table entry back */
+    uint64_t name = 0;
+    CHECK_EQ(e32_j1939_name_of(client, 0, 0x20, &name), E32_OK);
+    CHECK_EQ(name, NAME_OURS);
+    test_teardown();
+}
+
+static void loses_to_lower_name(void)
+{
+    e32_vbus_t* bus;
+    e32_j1939_client_t client = claiming_client(&bus, NAME_OURS);
+
+    inject_claim(bus, 0x20, NAME_LOWER);
+    CHECK_EQ(e32_j1939_get_address_state(client), E32_ADDRESS_LOST);
+    CHECK_EQ(e32_j1939_get_source_address(client), E32_SA_NULL);
+    CHECK_EQ(g_states[g_state_count - 1], E32_ADDRESS_LOST);
+    CHECK_EQ(g_addresses[g_state_count - 1], E32_SA_NULL);
+
+    /* Cannot Claim: our NAME from the null address, after a short random delay */
+    test_run(200);
+    CHECK_EQ(g_claims[0], 2);
+    CHECK_EQ(g_claimed_sa[0], E32_SA_NULL);
+
+    const uint8_t data[8] = { 0 };
+    CHECK_EQ(e32_j1939_send_raw(client, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6), E32_ERR_NO_ADDRESS);
+
+    uint8_t sa = 0;
+    CHECK_EQ(e32_j1939_address_of(client, 0, NAME_LOWER, &sa), E32_OK);
+    CHECK_EQ(sa, 0x20);
+    CHECK_EQ(e32_j1939_address_of(client, 0, NAME_OURS, &sa), E32_ERR_NOT_FOUND);
+    test_teardown();
+}
+
+static void arbitrary_address_skips_used(void)
+{
+    e32_vbus_t* bus;
+    const uint64_t ours = E32_NAME_ARBITRARY_ADDRESS | NAME_OURS;
+    e32_j1939_client_t client = claiming_client(&bus, ours);
+
+    /* 128, 129 and 131 are taken; the node that claimed 130 moved on to 131 */
+    inject_claim(bus, 128, 0x0000000000003000ull);
+    inject_claim(bus, 129, 0x0000000000004000ull);
+    inject_claim(bus, 130, 0x0000000000005000ull);
+    inject_claim(bus, 131, 0x0000000000005000ull);
+
+    inject_claim(bus, 0x20, NAME_LOWER);                /* Lower than any arbitrary NAME */
+    CHECK_EQ(e32_j1939_get_address_state(client), E32_ADDRESS_CLAIMING);
+    CHECK_EQ(e32_j1939_get_source_address(client), 130);
+    CHECK_EQ(g_addresses[g_state_count - 1], 130);
+
+    /* Claimed only after the window: sends from 128-247 wait for it */
+    const uint8_t data[8] = { 0 };
+    CHECK_EQ(e32_j1939_send_raw(client, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6), E32_ERR_NO_ADDRESS);
+    test_run(E32_CLAIM_WINDOW_MS + 10);
+    CHECK_EQ(e32_j1939_get_address_state(client), E32_ADDRESS_CLAIMED);
+    CHECK_EQ(g_claimed_sa[0], 130);
+    CHECK_EQ(e32_j1939_send_raw(client, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6), E32_OK);
+
+    uint8_t sa = 0;
+    CHECK_EQ(e32_j1939_address_of(client, 0, ours, &sa), E32_OK);
+    CHECK_EQ(sa, 130);
+    CHECK_EQ(e32_j1939_address_of(client, 0, 0x0000000000005000ull, &sa), E32_OK);
+    CHECK_EQ(sa, 131);
+    test_teardown();
+}
+
+static void in_use_on_any_channel(void)
+{
+    e32_vbus_t* first = test_bus("vaddr0");
+    e32_vbus_t* second = test_bus("vaddr1");
+    g_name = E32_NAME_ARBITRARY_ADDRESS | NAME_OURS;
+    g_state_count = 0;
+
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.channel_count = 2;
+    config.channels[0] = "vaddr0";
+    config.channels[1] = "vaddr1";
+    config.name = g_name;
+    config.on_address = record_state;
+    e32_j1939_client_t client = test_client_ex(&config, 0x20);
+    test_run(E32_CLAIM_WINDOW_MS + 10);
+
+    /* 128 is only taken on the second bus, yet avoided on both */
+    inject_claim(second, 128, 0x0000000000003000ull);
+    inject_claim(first, 0x20, NAME_LOWER);
+    CHECK_EQ(e32_j1939_get_source_address(client), 129);
+
+    uint64_t name = 0;
+    CHECK_EQ(e32_j1939_name_of(client, 0, 128, &name), E32_ERR_NOT_FOUND);
+    CHECK_EQ(e32_j1939_name_of(client, 1, 128, &name), E32_OK);
+    test_teardown();
+}
+
+/* Advance one bus only, polling every client in between */
+static void run_bus(e32_vbus_t* bus, uint32_t ms)
+{
+    for (uint32_t t = 0; t <= ms; t++) {
+        e32_vbus_advance(bus, t ? 1000 : 0);
+        for (int c = 0; c < test_client_count; c++) {
+            e32_j1939_poll(test_clients[c]);
+        }
+    }
+}
+
+static void retries_only_the_full_channel(void)
+{
+    e32_vbus_t* fast = test_bus("vaddr0");
+    e32_vbus_config_t slow_config;
+    memset(&slow_config, 0, sizeof(slow_config));
+    slow_config.name = "vaddr1";
+    slow_config.bitrate = 250000;
+    e32_vbus_t* slow = test_bus_ex(&slow_config);
+
+    listen_for_claims(test_client("vaddr0", 0x30), 0);
+    listen_for_claims(test_client("vaddr1", 0x31), 1);
+    g_name = NAME_OURS;
+    memset(g_claims, 0, sizeof(g_claims));
+
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.channel_count = 2;
+    config.channels[0] = "vaddr0";
+    config.channels[1] = "vaddr1";
+    config.name = NAME_OURS;
+    e32_j1939_client_t client = test_client_ex(&config, 0x20);
+
+    test_run(E32_CLAIM_WINDOW_MS + 10);
+    CHECK_EQ(e32_j1939_get_address_state(client), E32_ADDRESS_CLAIMED);
+    CHECK_EQ(g_claims[0], 1);
+    CHECK_EQ(g_claims[1], 1);
+
+    /* Time stands still on the slow bus: fill its transmit path */
+    const uint8_t data[8] = { 0 };
+    int queued = 0;
+    while (queued < 1000 &&
+           e32_j1939_send_raw_on(client, 1, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 7) == E32_OK) {
+        queued++;
+    }
+    CHECK(queued < 1000);
+
+    /* Asked again: bus 0 gets the claim at once, bus 1 has no room */
+    const uint8_t request[8] = { (uint8_t)E32_PGN_ADDRESS_CLAIMED, (uint8_t)(E32_PGN_ADDRESS_CLAIMED >> 8),
+                                 (uint8_t)(E32_PGN_ADDRESS_CLAIMED >> 16), 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = e32_build_j1939_id(E32_PGN_REQUEST, 0x40, 6, E32_SA_GLOBAL);
+    frame.is_extended = true;
+    frame.dlc = 3;
+    memcpy(frame.data, request, 8);
+    e32_vbus_inject(fast, &frame, 1);
+    run_bus(fast, 20);
+    CHECK_EQ(g_claims[0], 2);       /* Not repeated while bus 1 is retried */
+    CHECK_EQ(g_claims[1], 1);
+
+    /* Bus 1 drains: the claim follows the queued frames there, once */
+    run_bus(slow, 1000);
+    CHECK_EQ(g_claims[0], 2);
+    CHECK_EQ(g_claims[1], 2);
+    CHECK_EQ(g_claimed_sa[1], 0x20);
+    test_teardown();
+}
+
+int main(void)
+{
+    RUN(defends_against_higher_name);
+    RUN(loses_to_lower_name);
+    RUN(arbitrary_address_skips_used);
+    RUN(in_use_on_any_channel);
+    RUN(retries_only_the_full_channel);
+    return TEST_RESULT();
+}
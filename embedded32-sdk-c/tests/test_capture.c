@@ -0,0 +1,215 @@
+/**
+ * @file test_capture.c
+ * @brief Embedded32 SDK - Capture File Tests
+ *
+ * Rings of small capture files in the working directory, read back with
+ * the capture reader.
+ *
+ * Tests:
+ * - Frames written across rotations read back in order, with seek
+ * - Files have their blocks allocated (not sparse)
+ * - The file after the current one is prepared by flush
+ * - Switching without a flush in between still rotates correctly
+ * - A bus recorded by a client replays onto another bus with its spacing
+ */
+
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define BASE        "test_capture_ring"
+#define PER_FILE    300
+
+static void path_of(char* path, size_t size, unsigned n)
+{
+    snprintf(path, size, "%s.%u.e32cap", BASE, n);
+}
+
+static void remove_files(unsigned count)
+{
+    char path[64];
+    for (unsigned n = 0; n < count; n++) {
+        path_of(path, sizeof(path), n);
+        remove(path);
+    }
+}
+
+static e32_can_frame_t frame_n(uint32_t n)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = e32_build_j1939_id(E32_PGN_EEC1, (uint8_t)n, 3, E32_SA_GLOBAL);
+    frame.is_extended = true;
+    frame.dlc = 8;
+    frame.channel = (uint8_t)(n & 1);
+    frame.timestamp = 1000 + n * 2;
+    memcpy(frame.data, &n, sizeof(n));
+    return frame;
+}
+
+/* Checks file n holds count frames starting at frame first */
+static void check_file(unsigned n, uint32_t sequence, uint32_t first, uint32_t count)
+{
+    char path[64];
+    path_of(path, sizeof(path), n);
+    e32_capture_reader_t reader;
+    CHECK_EQ(e32_capture_reader_open(&reader, path), E32_OK);
+
+    uint32_t stored = 0;
+    CHECK(e32_capture_records(&reader, &stored) != NULL);
+    CHECK_EQ(stored, count);
+    CHECK_EQ(reader.header->sequence, sequence);
+
+    int mismatched = 0;
+    for (uint32_t i = 0; i < stored; i++) {
+        e32_can_frame_t expected = frame_n(first + i);
+        e32_can_frame_t frame;
+        CHECK_EQ(e32_capture_get_frame(&reader, i, &frame), E32_OK);
+        mismatched += frame.id != expected.id || frame.timestamp != expected.timestamp ||
+                      frame.channel != expected.channel || frame.dlc != 8 || !frame.is_extended ||
+                      memcmp(frame.data, expected.data, 8) != 0;
+    }
+    CHECK_EQ(mismatched, 0);
+
+    if (count > 10) {
+        /* Timestamps step by 2: an odd time finds the next record */
+        CHECK_EQ(e32_capture_seek(&reader, frame_n(first + 10).timestamp - 1), 10);
+        CHECK_EQ(e32_capture_seek(&reader, 0), 0);
+        CHECK_EQ(e32_capture_seek(&reader, 0xFFFFFFFFu), count);
+    }
+    e32_capture_reader_close(&reader);
+}
+
+static void reads_back_across_rotations(void)
+{
+    e32_capture_writer_t writer;
+    CHECK_EQ(e32_capture_writer_open(&writer, BASE, 4, PER_FILE), E32_OK);
+
+    for (uint32_t n = 0; n < 2 * PER_FILE + 100; n++) {
+        e32_can_frame_t frame = frame_n(n);
+        CHECK_EQ(e32_capture_write(&writer, &frame), E32_OK);
+        if (n % 100 == 99) {
+            CHECK_EQ(e32_capture_writer_flush(&writer), E32_OK);
+        }
+    }
+    CHECK_EQ(writer.dropped, 0);
+    e32_capture_writer_close(&writer);
+
+    check_file(0, 0, 0, PER_FILE);
+    check_file(1, 1, PER_FILE, PER_FILE);
+    check_file(2, 2, 2 * PER_FILE, 100);
+    check_file(3, 0, 0, 0);     /* Prepared by the last flush, not yet used */
+
+    /* Blocks allocated when the file is created */
+    char path[64];
+    struct stat st;
+    path_of(path, sizeof(path), 2);
+    CHECK_EQ(stat(path, &st), 0);
+    CHECK((long long)st.st_blocks * 512 >= (long long)st.st_size);
+    remove_files(4);
+}
+
+static void rotates_without_flush(void)
+{
+    e32_capture_writer_t writer;
+    CHECK_EQ(e32_capture_writer_open(&writer, BASE, 2, 10), E32_OK);
+
+    /* File 1 was prepared at open; the move back to file 0 creates it inline */
+    for (uint32_t n = 0; n < 25; n++) {
+        e32_can_frame_t frame = frame_n(n);
+        CHECK_EQ(e32_capture_write(&writer, &frame), E32_OK);
+    }
+    e32_capture_writer_close(&writer);
+
+    check_file(0, 2, 20, 5);
+    check_file(1, 1, 10, 10);
+    remove_files(2);
+}
+
+static void single_file_ring(void)
+{
+    e32_capture_writer_t writer;
+    CHECK_EQ(e32_capture_writer_open(&writer, BASE, 1, 10), E32_OK);
+    for (uint32_t n = 0; n < 13; n++) {
+        e32_can_frame_t frame = frame_n(n);
+        CHECK_EQ(e32_capture_write(&writer, &frame), E32_OK);
+        CHECK_EQ(e32_capture_writer_flush(&writer), E32_OK);
+    }
+    e32_capture_writer_close(&writer);
+
+    check_file(0, 1, 10, 3);
+    remove_files(1);
+}
+
+#define REPLAYED    20
+
+static uint8_t  g_replayed_sa[REPLAYED];
+static uint32_t g_replayed_at[REPLAYED];
+static int      g_replayed;
+
+static void replayed(const e32_j1939_view_t* view, void* user_data)
+{
+    (void)user_data;
+    if (g_replayed < REPLAYED) {
+        g_replayed_sa[g_replayed] = view->source_address;
+        g_replayed_at[g_replayed] = view->timestamp;
+    }
+    g_replayed++;
+}
+
+static void records_and_replays_a_bus(void)
+{
+    e32_capture_writer_t writer;
+    CHECK_EQ(e32_capture_writer_open(&writer, "test_capture_replay", 2, 100), E32_OK);
+
+    /* Record frames 5 ms apart, as a client on the bus sees them */
+    e32_vbus_t* recorded = test_bus("vcap0");
+    e32_j1939_client_t recorder = test_client("vcap0", 0x20);
+    CHECK_EQ(e32_j1939_on_pgn_view(recorder, E32_PGN_ANY, e32_capture_view_handler, &writer, NULL), E32_OK);
+    for (int n = 0; n < REPLAYED; n++) {
+        const uint8_t data[8] = { (uint8_t)n };
+        test_inject(recorded, E32_PGN_EEC1, (uint8_t)n, E32_SA_GLOBAL, 3, data);
+        test_run(5);
+    }
+    e32_capture_writer_close(&writer);
+
+    /* Replayed at the recorded speed onto a bus of its own */
+    e32_vbus_t* replay = test_bus("vcap1");
+    e32_j1939_client_t listener = test_client("vcap1", 0x30);
+    CHECK_EQ(e32_j1939_on_pgn_view(listener, E32_PGN_EEC1, replayed, NULL, NULL), E32_OK);
+    g_replayed = 0;
+    CHECK_EQ(e32_vbus_replay(replay, "test_capture_replay.0.e32cap", 100), E32_OK);
+    test_run(50);
+    CHECK(g_replayed > 5 && g_replayed < REPLAYED);     /* Still going */
+    test_run(100);
+    CHECK_EQ(g_replayed, REPLAYED);
+
+    e32_vbus_stats_t stats;
+    CHECK_EQ(e32_vbus_get_stats(replay, &stats), E32_OK);
+    CHECK_EQ(stats.replayed, REPLAYED);
+    CHECK_EQ(stats.replay_pending, 0);
+    for (int n = 0; n < REPLAYED; n++) {
+        CHECK_EQ(g_replayed_sa[n], n);
+        if (n) {
+            CHECK_EQ(g_replayed_at[n] - g_replayed_at[n - 1], 5);
+        }
+    }
+    test_teardown();
+    remove("test_capture_replay.0.e32cap");
+    remove("test_capture_replay.1.e32cap");
+}
+
+int main(void)
+{
+    RUN(reads_back_across_rotations);
+    RUN(rotates_without_flush);
+    RUN(single_file_ring);
+    RUN(records_and_replays_a_bus);
+    return TEST_RESULT();
+}
@@ -0,0 +1,112 @@
+/**
+ * @file test_codec.c
+ * @brief Embedded32 SDK - Codec Tests
+ *
+ * Identifier parsing and building, PDU1/PDU2 handling and SPN decoding.
+ */
+
+#include "embedded32.h"
+#include "e32_test.h"
+#include <string.h>
+
+static void parses_pdu2_broadcast_id(void)
+{
+    e32_j1939_id_t id;
+    e32_parse_j1939_id(0x0CF00400, &id);
+
+    CHECK_EQ(id.priority, 3);
+    CHECK_EQ(id.pgn, E32_PGN_EEC1);
+    CHECK_EQ(id.source_address, 0x00);
+    CHECK_EQ(id.destination_address, E32_SA_GLOBAL);
+    CHECK(!id.pdu1);
+}
+
+static void parses_pdu1_destination(void)
+{
+    e32_j1939_id_t id;
+    e32_parse_j1939_id(0x18EA0BF9, &id);
+
+    CHECK_EQ(id.priority, 6);
+    CHECK_EQ(id.pgn, E32_PGN_REQUEST);
+    CHECK_EQ(id.destination_address, 0x0B);
+    CHECK_EQ(id.source_address, 0xF9);
+    CHECK(id.pdu1);
+}
+
+static void keeps_data_page_in_pgn(void)
+{
+    uint32_t can_id = e32_build_j1939_id(0x1F004, 0x21, 3, E32_SA_GLOBAL);
+    e32_j1939_id_t id;
+    e32_parse_j1939_id(can_id, &id);
+
+    CHECK_EQ(id.pgn, 0x1F004);
+    CHECK(id.pgn != E32_PGN_EEC1);
+}
+
+static void build_and_parse_round_trip(void)
+{
+    static const uint32_t pgns[] = { E32_PGN_EEC1, E32_PGN_ET1, E32_PGN_REQUEST, E32_PGN_ENGINE_CONTROL_CMD, 0x3FF00 };
+
+    for (unsigned i = 0; i < sizeof(pgns) / sizeof(pgns[0]); i++) {
+        for (uint8_t priority = 0; priority < 8; priority++) {
+            uint32_t can_id = e32_build_j1939_id(pgns[i], 0x42, priority, 0x17);
+            e32_j1939_id_t id;
+            e32_parse_j1939_id(can_id, &id);
+
+            CHECK_EQ(id.priority, priority);
+            CHECK_EQ(id.source_address, 0x42);
+            if (id.pdu1) {
+                CHECK_EQ(id.pgn, pgns[i] & 0x3FF00);
+                CHECK_EQ(id.destination_address, 0x17);
+            } else {
+                CHECK_EQ(id.pgn, pgns[i]);
+            }
+        }
+    }
+}
+
+static void decodes_engine_speed(void)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = e32_build_j1939_id(E32_PGN_EEC1, 0x00, 3, E32_SA_GLOBAL);
+    frame.is_extended = true;
+    frame.dlc = 8;
+    memset(frame.data, 0xFF, 8);
+    frame.data[3] = 0x40;   /* 0x1F40 * 0.125 = 1000 rpm */
+    frame.data[4] = 0x1F;
+
+    e32_j1939_message_t msg;
+    CHECK_EQ(e32_decode_frame(&frame, &msg), E32_OK);
+    CHECK_EQ(msg.pgn, E32_PGN_EEC1);
+
+    e32_spn_t rpm;
+    CHECK_EQ(e32_msg_get_spn(&msg, E32_SPN_ENGINE_SPEED, &rpm), E32_OK);
+    CHECK(rpm.value.f32 > 999.9f && rpm.value.f32 < 1000.1f);
+}
+
+static void names_catalogue_pgns(void)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = e32_build_j1939_id(E32_PGN_ET1, 0x00, 6, E32_SA_GLOBAL);
+    frame.is_extended = true;
+    frame.dlc = 8;
+
+    e32_j1939_message_t msg;
+    CHECK_EQ(e32_decode_frame(&frame, &msg), E32_OK);
+    CHECK(msg.pgn_name != NULL);
+    CHECK(strcmp(msg.pgn_name, e32_get_pgn_name(E32_PGN_ET1)) == 0);
+    CHECK_EQ(msg.raw_len, 8);
+}
+
+int main(void)
+{
+    RUN(parses_pdu2_broadcast_id);
+    RUN(parses_pdu1_destination);
+    RUN(keeps_data_page_in_pgn);
+    RUN(build_and_parse_round_trip);
+    RUN(decodes_engine_speed);
+    RUN(names_catalogue_pgns);
+    return TEST_RESULT();
+}
@@ -0,0 +1,277 @@
+/**
+ * @file test_cyclic.c
+ * @brief Embedded32 SDK - Cyclic Scheduler Tests
+ *
+ * The timer wheel on its own, driven by an explicit millisecond clock.
+ *
+ * Tests:
+ * - Late ticks stay phase-locked; stalls count missed periods, including
+ *   stalls longer than the wheel, and never send catch-up bursts
+ * - The schedule carries across the 32-bit clock wrap
+ * - Providers may decline, keep their buffer, and add or remove entries
+ *   (themselves included) while the wheel turns
+ * - Interval and jitter statistics; next_timeout
+ */
+
+#include "e32_test.h"
+#include "e32_cyclic.h"
+#include <string.h>
+
+#define PGN_A   0xFF01
+#define PGN_B   0xFF02
+#define PGN_C   0xFF03
+
+static e32_cyclic_t g_sched;
+
+/* Recorded transmissions */
+static uint32_t g_now;
+static uint32_t g_sent_pgn[256];
+static uint32_t g_sent_at[256];
+static int      g_sent_count;
+static bool     g_refuse;           /* Backend refuses every frame */
+
+static e32_error_t record_send(void* ctx, const e32_cyclic_entry_t* entry)
+{
+    (void)ctx;
+    if (g_refuse) {
+        return E32_ERR_BUSY;
+    }
+    if (g_sent_count < 256) {
+        g_sent_pgn[g_sent_count] = entry->pgn;
+        g_sent_at[g_sent_count++] = g_now;
+    }
+    return E32_OK;
+}
+
+static bool counter(uint32_t pgn, uint8_t* data, uint8_t* len, void* user_data)
+{
+    (void)pgn; (void)user_data;
+    data[0]++;
+    *len = 8;
+    return true;
+}
+
+static void reset(void)
+{
+    e32_cyclic_init(&g_sched);
+    g_sent_count = 0;
+    g_refuse = false;
+}
+
+static void run_at(uint32_t now)
+{
+    g_now = now;
+    e32_cyclic_run(&g_sched, now, record_send, NULL);
+}
+
+/* Runs every millisecond from..to inclusive */
+static void run_every_ms(uint32_t from, uint32_t to)
+{
+    for (uint32_t t = from; ; t++) {
+        run_at(t);
+        if (t == to) {
+            break;
+        }
+    }
+}
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void stays_phase_locked(void)
+{
+    reset();
+    CHECK_EQ(e32_cyclic_add(&g_sched, 0, PGN_A, 10, 6, E32_SA_GLOBAL, counter, NULL, 0), E32_OK);
+    run_every_ms(0, 100);
+    CHECK_EQ(g_sent_count, 11);
+    CHECK_EQ(g_sent_at[10], 100);
+
+    /* Three milliseconds late: the next one is still due at 120 */
+    run_at(113);
+    run_every_ms(114, 120);
+    CHECK_EQ(g_sent_count, 13);
+    CHECK_EQ(g_sent_at[11], 113);
+    CHECK_EQ(g_sent_at[12], 120);
+
+    e32_cyclic_stats_t stats;
+    CHECK_EQ(e32_cyclic_get_stats(&g_sched, PGN_A, &stats), E32_OK);
+    CHECK_EQ(stats.sent, 13);
+    CHECK_EQ(stats.missed, 0);
+    CHECK_EQ(stats.min_interval_ms, 7);
+    CHECK_EQ(stats.max_interval_ms, 13);
+    CHECK_EQ(stats.max_jitter_ms, 3);
+    CHECK_EQ(stats.last_interval_ms, 7);
+    CHECK_EQ(stats.mean_jitter_us, 6 * 1000 / 12);
+}
+
+static void stalls_skip_ahead(void)
+{
+    reset();
+    e32_cyclic_add(&g_sched, 0, PGN_A, 10, 6, E32_SA_GLOBAL, counter, NULL, 0);
+    run_at(0);
+
+    /* 10 .. 50 lost: one frame, then the schedule resumes at 60 */
+    run_at(55);
+    CHECK_EQ(g_sent_count, 2);
+    e32_cyclic_stats_t stats;
+    e32_cyclic_get_stats(&g_sched, PGN_A, &stats);
+    CHECK_EQ(stats.missed, 4);
+    CHECK_EQ(e32_cyclic_next_timeout(&g_sched, 55), 5);
+    run_every_ms(56, 60);
+    CHECK_EQ(g_sent_count, 3);
+    CHECK_EQ(g_sent_at[2], 60);
+
+    /* Longer than a turn of the wheel */
+    run_at(60 + 3 * E32_CFG_CYCLIC_WHEEL_SLOTS + 5);
+    CHECK_EQ(g_sent_count, 4);
+    e32_cyclic_get_stats(&g_sched, PGN_A, &stats);
+    CHECK_EQ(stats.missed, 4 + (3 * E32_CFG_CYCLIC_WHEEL_SLOTS + 5 - 10) / 10);
+    CHECK_EQ(e32_cyclic_next_timeout(&g_sched, g_now), 10 - (3 * E32_CFG_CYCLIC_WHEEL_SLOTS + 5) % 10);
+}
+
+static void crosses_clock_wrap(void)
+{
+    reset();
+    const uint32_t start = 0xFFFFFFFFu - 25;
+    e32_cyclic_add(&g_sched, 0, PGN_A, 10, 6, E32_SA_GLOBAL, counter, NULL, start);
+    e32_cyclic_add(&g_sched, 0, PGN_B, 2 * E32_CFG_CYCLIC_WHEEL_SLOTS, 6, E32_SA_GLOBAL, counter, NULL, start);
+    run_every_ms(start, start + 60);
+    CHECK_EQ(g_sent_count, 8);          /* PGN_A 7 times, PGN_B once */
+    for (int i = 1; i < g_sent_count; i++) {
+        CHECK_EQ(g_sent_pgn[i], PGN_A);
+        CHECK_EQ(g_sent_at[i] - g_sent_at[i - 1], i == 1 ? 0 : 10);
+    }
+
+    /* A period longer than the wheel waits out its extra turns */
+    run_every_ms(start + 61, start + 2 * E32_CFG_CYCLIC_WHEEL_SLOTS);
+    CHECK_EQ(g_sent_pgn[g_sent_count - 1], PGN_B);
+    CHECK_EQ(g_sent_at[g_sent_count - 1], start + 2 * E32_CFG_CYCLIC_WHEEL_SLOTS);
+}
+
+static uint8_t g_decline_len;
+
+static bool declines(uint32_t pgn, uint8_t* data, uint8_t* len, void* user_data)
+{
+    (void)pgn; (void)user_data;
+    if (g_decline_len == 0xFF) {
+        return false;
+    }
+    data[0]++;                          /* Buffer keeps the previous contents */
+    *len = g_decline_len;
+    return true;
+}
+
+static void provider_decides(void)
+{
+    reset();
+    e32_cyclic_add(&g_sched, 0, PGN_A, 1, 6, E32_SA_GLOBAL, declines, NULL, 0);
+    const e32_cyclic_entry_t* entry = &g_sched.entries[0];
+
+    g_decline_len = 3;
+    run_every_ms(0, 2);
+    CHECK_EQ(g_sent_count, 3);
+    CHECK_EQ(entry->data[0], 3);
+    CHECK_EQ(entry->len, 3);
+
+    g_decline_len = 0xFF;
+    run_at(3);
+    g_decline_len = 0;
+    run_at(4);
+    g_refuse = true;
+    g_decline_len = 5;
+    run_at(5);
+    g_refuse = false;
+    run_at(6);
+
+    e32_cyclic_stats_t stats;
+    e32_cyclic_get_stats(&g_sched, PGN_A, &stats);
+    CHECK_EQ(stats.sent, 4);
+    CHECK_EQ(stats.skipped, 3);
+    CHECK_EQ(stats.missed, 0);
+    CHECK_EQ(stats.last_interval_ms, 4);
+
+#ifdef E32_CFG_CAN_FD
+    /* The entry holds a whole FD payload; the client decides if it can send it */
+    g_decline_len = E32_CAN_MAX_DATA_LEN;
+    run_at(7);
+    CHECK_EQ(entry->len, E32_CAN_MAX_DATA_LEN);
+    g_decline_len = E32_CAN_MAX_DATA_LEN + 1;
+    run_at(8);
+    e32_cyclic_get_stats(&g_sched, PGN_A, &stats);
+    CHECK_EQ(stats.sent, 5);
+    CHECK_EQ(stats.skipped, 4);
+#endif
+}
+
+/* PGN_A removes itself and registers PGN_C; PGN_B is removed from under its own slot */
+static bool edits_wheel(uint32_t pgn, uint8_t* data, uint8_t* len, void* user_data)
+{
+    (void)data; (void)user_data;
+    *len = 8;
+    if (pgn == PGN_A) {
+        CHECK_EQ(e32_cyclic_remove(&g_sched, PGN_A), E32_OK);
+        CHECK_EQ(e32_cyclic_remove(&g_sched, PGN_B), E32_OK);
+        CHECK_EQ(e32_cyclic_add(&g_sched, 0, PGN_C, 5, 6, E32_SA_GLOBAL, counter, NULL, g_now), E32_OK);
+    }
+    return true;
+}
+
+static void providers_edit_the_wheel(void)
+{
+    reset();
+    /* Both due at 0, so both sit in the same slot */
+    e32_cyclic_add(&g_sched, 0, PGN_B, 10, 6, E32_SA_GLOBAL, edits_wheel, NULL, 0);
+    e32_cyclic_add(&g_sched, 0, PGN_A, 10, 6, E32_SA_GLOBAL, edits_wheel, NULL, 0);
+    run_every_ms(0, 30);
+
+    /* PGN_A went first (newest at the head), so PGN_B never sends */
+    CHECK_EQ(g_sent_pgn[0], PGN_A);
+    e32_cyclic_stats_t stats;
+    CHECK_EQ(e32_cyclic_get_stats(&g_sched, PGN_A, &stats), E32_ERR_NOT_FOUND);
+    CHECK_EQ(e32_cyclic_get_stats(&g_sched, PGN_B, &stats), E32_ERR_NOT_FOUND);
+    CHECK_EQ(e32_cyclic_get_stats(&g_sched, PGN_C, &stats), E32_OK);
+    CHECK_EQ(stats.sent, 6);            /* 1, 6, 11, ... 26 */
+    CHECK_EQ(g_sent_count, 7);
+
+    /* Both freed entries are reusable */
+    int free_entries = 0;
+    for (int i = 0; i < E32_CFG_CYCLIC_MAX; i++) {
+        free_entries += g_sched.entries[i].state == E32_CYCLIC_FREE;
+    }
+    CHECK_EQ(free_entries, E32_CFG_CYCLIC_MAX - 1);
+}
+
+static void reregister_and_capacity(void)
+{
+    reset();
+    CHECK_EQ(e32_cyclic_next_timeout(&g_sched, 0), UINT32_MAX);
+    for (uint32_t i = 0; i < E32_CFG_CYCLIC_MAX; i++) {
+        CHECK_EQ(e32_cyclic_add(&g_sched, 0, 0xFF00 + i, 100, 6, E32_SA_GLOBAL, counter, NULL, 0), E32_OK);
+    }
+    CHECK_EQ(e32_cyclic_add(&g_sched, 0, 0xFEFF, 100, 6, E32_SA_GLOBAL, counter, NULL, 0), E32_ERR_NO_MEMORY);
+    run_at(0);
+    CHECK_EQ(g_sent_count, E32_CFG_CYCLIC_MAX);
+    CHECK_EQ(e32_cyclic_next_timeout(&g_sched, 40), 60);
+
+    /* A new period takes effect from the next tick, on the new channel */
+    CHECK_EQ(e32_cyclic_add(&g_sched, 1, 0xFF00, 20, 3, E32_SA_GLOBAL, counter, NULL, 40), E32_OK);
+    CHECK_EQ(e32_cyclic_next_timeout(&g_sched, 40), 0);
+    run_every_ms(1, 80);
+    CHECK_EQ(g_sent_count, E32_CFG_CYCLIC_MAX + 3);
+    CHECK_EQ(g_sent_at[E32_CFG_CYCLIC_MAX], 40);
+    CHECK_EQ(g_sent_at[E32_CFG_CYCLIC_MAX + 2], 80);
+    CHECK_EQ(g_sched.entries[0].channel, 1);
+    CHECK_EQ(g_sched.entries[0].priority, 3);
+}
+
+int main(void)
+{
+    RUN(stays_phase_locked);
+    RUN(stalls_skip_ahead);
+    RUN(crosses_clock_wrap);
+    RUN(provider_decides);
+    RUN(providers_edit_the_wheel);
+    RUN(reregister_and_capacity);
+    return TEST_RESULT();
+}
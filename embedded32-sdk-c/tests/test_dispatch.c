@@ -0,0 +1,324 @@
+/**
+ * @file test_dispatch.c
+ * @brief Embedded32 SDK - Dispatch Table Tests
+ *
+ * The subscription table on its own, then subscriptions of a client on a
+ * manual-clock virtual bus.
+ *
+ * Tests:
+ * - Exact handlers run in registration order, then range handlers
+ * - A handle removes its own subscription only; stale handles miss even
+ *   after the node is reused; the PGN's handler kinds follow removals
+ * - A handler may remove itself while it runs
+ * - Gates: on-change (short and long payloads), interval, decimation,
+ *   per sender; gates and their histories are freed with the node
+ * - Client: two modules on one PGN unsubscribe independently
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include "e32_dispatch.h"
+
+#define PGN_PROP_B  0xFF20
+
+static e32_dispatch_table_t g_table;
+
+/* Calls in order: tag of each handler called */
+static int g_calls[64];
+static int g_call_count;
+
+static void note_message(const e32_j1939_message_t* message, void* user_data)
+{
+    (void)message;
+    if (g_call_count < 64) {
+        g_calls[g_call_count++] = (int)(intptr_t)user_data;
+    }
+}
+
+static void note_view(const e32_j1939_view_t* view, void* user_data)
+{
+    (void)view;
+    if (g_call_count < 64) {
+        g_calls[g_call_count++] = (int)(intptr_t)user_data;
+    }
+}
+
+static uint8_t g_data[64];
+
+static e32_j1939_view_t view_of(uint32_t pgn, uint8_t sa, uint16_t len)
+{
+    e32_j1939_view_t view;
+    memset(&view, 0, sizeof(view));
+    view.data = g_data;
+    view.len = len;
+    view.pgn = pgn;
+    view.source_address = sa;
+    view.destination_address = E32_SA_GLOBAL;
+    return view;
+}
+
+/* Gate, then invoke, as the client does; returns handlers called */
+static int deliver(const e32_j1939_view_t* view, uint32_t now)
+{
+    static const e32_j1939_message_t message;
+    uint32_t pass = 0;
+    if (g_table.gates_used) {
+        e32_dispatch_gate(&g_table, view, now, &pass);
+    }
+    g_call_count = 0;
+    return e32_dispatch_invoke(&g_table, view, &message, pass);
+}
+
+static uint32_t add_message(uint32_t first, uint32_t last, int tag, const e32_sub_options_t* options)
+{
+    uint32_t handle = 0;
+    CHECK_EQ(e32_dispatch_add(&g_table, first, last, note_message, (void*)(intptr_t)tag, options, &handle), E32_OK);
+    CHECK(handle != E32_SUBSCRIPTION_NONE);
+    return handle;
+}
+
+static uint32_t add_view(uint32_t first, uint32_t last, int tag, const e32_sub_options_t* options)
+{
+    uint32_t handle = 0;
+    CHECK_EQ(e32_dispatch_add_view(&g_table, first, last, note_view, (void*)(intptr_t)tag, options, &handle), E32_OK);
+    CHECK(handle != E32_SUBSCRIPTION_NONE);
+    return handle;
+}
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void runs_in_order(void)
+{
+    e32_dispatch_init(&g_table);
+    add_message(0xFF00, 0xFFFF, 1, NULL);
+    add_message(E32_PGN_EEC1, E32_PGN_EEC1, 2, NULL);
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 3, NULL);
+    add_message(PGN_PROP_B, PGN_PROP_B, 4, NULL);
+    add_message(E32_PGN_EEC1, E32_PGN_EEC1, 5, NULL);
+    add_view(0, E32_PGN_MAX, 6, NULL);
+
+    e32_j1939_view_t view = view_of(E32_PGN_EEC1, 0x00, 8);
+    CHECK_EQ(deliver(&view, 0), 4);
+    static const int eec1[] = { 2, 3, 5, 6 };
+    for (int i = 0; i < 4; i++) {
+        CHECK_EQ(g_calls[i], eec1[i]);
+    }
+
+    view = view_of(PGN_PROP_B, 0x00, 8);
+    CHECK_EQ(deliver(&view, 0), 3);
+    CHECK_EQ(g_calls[0], 4);            /* Exact first, then ranges in registration order */
+    CHECK_EQ(g_calls[1], 1);
+    CHECK_EQ(g_calls[2], 6);
+
+    CHECK_EQ(e32_dispatch_wants(&g_table, E32_PGN_ET1), E32_DISPATCH_WANT_VIEW);
+    CHECK_EQ(e32_dispatch_wants(&g_table, E32_PGN_EEC1), E32_DISPATCH_WANT_MESSAGE | E32_DISPATCH_WANT_VIEW);
+    CHECK_EQ(g_table.count, 6);
+}
+
+static void removes_by_handle(void)
+{
+    e32_dispatch_init(&g_table);
+    uint32_t first = add_message(E32_PGN_EEC1, E32_PGN_EEC1, 1, NULL);
+    uint32_t viewer = add_view(E32_PGN_EEC1, E32_PGN_EEC1, 2, NULL);
+    uint32_t second = add_message(E32_PGN_EEC1, E32_PGN_EEC1, 3, NULL);
+    uint32_t range = add_view(0xFF00, 0xFFFF, 4, NULL);
+    uint32_t other_range = add_view(0xFF00, 0xFFFF, 5, NULL);
+
+    /* The same handler and PGN twice still gives two handles */
+    CHECK(first != second);
+
+    CHECK(e32_dispatch_remove_handle(&g_table, first));
+    CHECK(!e32_dispatch_remove_handle(&g_table, first));
+    e32_j1939_view_t view = view_of(E32_PGN_EEC1, 0x00, 8);
+    CHECK_EQ(deliver(&view, 0), 2);
+    CHECK_EQ(g_calls[0], 2);
+    CHECK_EQ(g_calls[1], 3);
+
+    /* The kinds follow the handlers that remain */
+    CHECK(e32_dispatch_remove_handle(&g_table, viewer));
+    CHECK_EQ(e32_dispatch_wants(&g_table, E32_PGN_EEC1), E32_DISPATCH_WANT_MESSAGE);
+    CHECK(e32_dispatch_remove_handle(&g_table, second));
+    CHECK_EQ(e32_dispatch_wants(&g_table, E32_PGN_EEC1), 0);
+    CHECK_EQ(e32_dispatch_lookup(&g_table, E32_PGN_EEC1), E32_DISPATCH_NIL);
+
+    CHECK(e32_dispatch_remove_handle(&g_table, range));
+    view = view_of(0xFF42, 0x00, 8);
+    CHECK_EQ(deliver(&view, 0), 1);
+    CHECK_EQ(g_calls[0], 5);
+
+    /* A freed node handed out again gets a new handle; the old one misses */
+    uint32_t reused = add_message(PGN_PROP_B, PGN_PROP_B, 6, NULL);
+    CHECK_EQ(reused & 0xFFFF, range & 0xFFFF);
+    CHECK(reused != range);
+    CHECK(!e32_dispatch_remove_handle(&g_table, range));
+    CHECK_EQ(e32_dispatch_wants(&g_table, PGN_PROP_B), E32_DISPATCH_WANT_MESSAGE | E32_DISPATCH_WANT_VIEW);
+
+    CHECK(!e32_dispatch_remove_handle(&g_table, E32_SUBSCRIPTION_NONE));
+    CHECK(!e32_dispatch_remove_handle(&g_table, 0xFFFFFFFFu));
+    CHECK(e32_dispatch_remove_handle(&g_table, other_range));
+    CHECK(e32_dispatch_remove_handle(&g_table, reused));
+    CHECK_EQ(g_table.count, 0);
+}
+
+static uint32_t g_self;
+
+static void remove_self(const e32_j1939_view_t* view, void* user_data)
+{
+    note_view(view, user_data);
+    CHECK(e32_dispatch_remove_handle(&g_table, g_self));
+}
+
+static void removes_itself_while_running(void)
+{
+    e32_dispatch_init(&g_table);
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 1, NULL);
+    CHECK_EQ(e32_dispatch_add_view(&g_table, E32_PGN_EEC1, E32_PGN_EEC1, remove_self,
+                                   (void*)(intptr_t)2, NULL, &g_self), E32_OK);
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 3, NULL);
+
+    e32_j1939_view_t view = view_of(E32_PGN_EEC1, 0x00, 8);
+    CHECK_EQ(deliver(&view, 0), 3);
+    CHECK_EQ(deliver(&view, 0), 2);
+    CHECK_EQ(g_calls[0], 1);
+    CHECK_EQ(g_calls[1], 3);
+}
+
+static void gates_filter_per_sender(void)
+{
+    e32_dispatch_init(&g_table);
+    const e32_sub_options_t on_change = { E32_SUB_ON_CHANGE, 0, 0 };
+    const e32_sub_options_t one_hz = { 0, 0, 1000 };
+    const e32_sub_options_t every_third = { 0, 3, 0 };
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 1, &on_change);
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 2, &one_hz);
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 3, &every_third);
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 4, NULL);
+
+    /* Ungated sees all 11; interval passes at 0 and 1000 (frames 100 ms apart) */
+    int seen[5] = { 0 };
+    memset(g_data, 0, sizeof(g_data));
+    for (uint32_t t = 0; t <= 1000; t += 100) {
+        g_data[0] = (uint8_t)(t < 500 ? 0 : 1);     /* Changes once, at 500 */
+        e32_j1939_view_t view = view_of(E32_PGN_EEC1, 0x00, 8);
+        deliver(&view, t);
+        for (int i = 0; i < g_call_count; i++) {
+            seen[g_calls[i]]++;
+        }
+    }
+    CHECK_EQ(seen[1], 2);
+    CHECK_EQ(seen[2], 2);
+    CHECK_EQ(seen[3], 4);               /* 0, 300, 600, 900 */
+    CHECK_EQ(seen[4], 11);
+
+    /* A second sender has histories of its own */
+    e32_j1939_view_t view = view_of(E32_PGN_EEC1, 0x01, 8);
+    deliver(&view, 1050);
+    CHECK_EQ(g_call_count, 4);
+
+    /* Longer payloads: a change in the last byte, or in the length, counts */
+    e32_dispatch_init(&g_table);
+    add_view(PGN_PROP_B, PGN_PROP_B, 1, &on_change);
+    view = view_of(PGN_PROP_B, 0x00, 40);
+    memset(g_data, 0x55, sizeof(g_data));
+    CHECK_EQ(deliver(&view, 0), 1);
+    CHECK_EQ(deliver(&view, 1), 0);
+    g_data[39] = 0x56;
+    CHECK_EQ(deliver(&view, 2), 1);
+    view.len = 41;
+    CHECK_EQ(deliver(&view, 3), 1);
+    CHECK_EQ(deliver(&view, 4), 0);
+}
+
+static void gates_are_freed(void)
+{
+    e32_dispatch_init(&g_table);
+    const e32_sub_options_t on_change = { E32_SUB_ON_CHANGE, 0, 0 };
+    const e32_sub_options_t none = { 0, 1, 0 };     /* Filters nothing: no gate needed */
+    uint32_t handles[E32_CFG_GATED_SUBS_MAX];
+    for (int i = 0; i < E32_CFG_GATED_SUBS_MAX; i++) {
+        handles[i] = add_view(E32_PGN_EEC1, E32_PGN_EEC1, i, &on_change);
+    }
+    uint32_t handle;
+    CHECK_EQ(e32_dispatch_add_view(&g_table, E32_PGN_ET1, E32_PGN_ET1, note_view, NULL, &on_change, &handle),
+             E32_ERR_NO_MEMORY);
+    add_view(E32_PGN_ET1, E32_PGN_ET1, 99, &none);
+
+    /* Histories for five senders, then the first gate goes away with its node */
+    for (uint8_t sa = 0; sa < 5; sa++) {
+        e32_j1939_view_t view = view_of(E32_PGN_EEC1, sa, 8);
+        deliver(&view, 0);
+    }
+    CHECK_EQ(g_table.state_count, 5 * E32_CFG_GATED_SUBS_MAX);
+    CHECK(e32_dispatch_remove_handle(&g_table, handles[0]));
+    CHECK_EQ(g_table.state_count, 5 * (E32_CFG_GATED_SUBS_MAX - 1));
+    CHECK_EQ(g_table.gates_used & 1u, 0);
+
+    /* The freed gate starts with no history */
+    add_view(E32_PGN_EEC1, E32_PGN_EEC1, 100, &on_change);
+    e32_j1939_view_t view = view_of(E32_PGN_EEC1, 0x00, 8);
+    CHECK_EQ(deliver(&view, 1), 1);
+    CHECK_EQ(g_calls[0], 100);
+}
+
+/* Client level: two modules on one PGN */
+static int g_module_a, g_module_b;
+
+static void module_a(const e32_j1939_message_t* message, void* user_data)
+{
+    (void)message; (void)user_data;
+    g_module_a++;
+}
+
+static void module_b(const e32_j1939_view_t* view, void* user_data)
+{
+    (void)view; (void)user_data;
+    g_module_b++;
+}
+
+static void client_modules_share_a_pgn(void)
+{
+    e32_vbus_t* bus = test_bus("vdisp0");
+    e32_j1939_client_t client = test_client("vdisp0", 0x20);
+    e32_subscription_t a, b;
+    g_module_a = g_module_b = 0;
+    CHECK_EQ(e32_j1939_on_pgn(client, E32_PGN_EEC1, module_a, NULL, &a), E32_OK);
+    CHECK_EQ(e32_j1939_on_pgn_view(client, E32_PGN_EEC1, module_b, NULL, &b), E32_OK);
+    CHECK(a != b);
+
+    const uint8_t data[8] = { 0 };
+    test_inject(bus, E32_PGN_EEC1, 0x00, E32_SA_GLOBAL, 3, data);
+    CHECK_EQ(g_module_a, 1);
+    CHECK_EQ(g_module_b, 1);
+
+    /* Module A leaves: B keeps receiving */
+    CHECK_EQ(e32_j1939_unsubscribe(client, a), E32_OK);
+    CHECK_EQ(e32_j1939_unsubscribe(client, a), E32_ERR_NOT_FOUND);
+    test_inject(bus, E32_PGN_EEC1, 0x00, E32_SA_GLOBAL, 3, data);
+    CHECK_EQ(g_module_a, 1);
+    CHECK_EQ(g_module_b, 2);
+
+    /* Errors leave no handle behind */
+    e32_subscription_t none = 1234;
+    CHECK_EQ(e32_j1939_on_pgn(client, E32_PGN_MAX + 1, module_a, NULL, &none), E32_ERR_INVALID_PARAM);
+    CHECK_EQ(none, E32_SUBSCRIPTION_NONE);
+    CHECK_EQ(e32_j1939_on_pgn(client, E32_PGN_ET1, NULL, NULL, NULL), E32_ERR_INVALID_PARAM);
+
+    CHECK_EQ(e32_j1939_off_pgn(client, E32_PGN_EEC1), E32_OK);
+    CHECK_EQ(e32_j1939_unsubscribe(client, b), E32_ERR_NOT_FOUND);
+    test_inject(bus, E32_PGN_EEC1, 0x00, E32_SA_GLOBAL, 3, data);
+    CHECK_EQ(g_module_b, 2);
+    test_teardown();
+}
+
+int main(void)
+{
+    RUN(runs_in_order);
+    RUN(removes_by_handle);
+    RUN(removes_itself_while_running);
+    RUN(gates_filter_per_sender);
+    RUN(gates_are_freed);
+    RUN(client_modules_share_a_pgn);
+    return TEST_RESULT();
+}
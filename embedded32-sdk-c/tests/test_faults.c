@@ -0,0 +1,307 @@
+/**
+ * @file test_faults.c
+ * @brief Embedded32 SDK - DM1/DM2 Fault Set Tests
+ *
+ * e32_faults_update() fed with hand-built DM1/DM2 payloads, and one
+ * client on a manual-clock virtual bus for the e32_j1939_on_dtc() path.
+ *
+ * Tests:
+ * - Raised and cleared events, DM1 and DM2 kept apart
+ * - The unchanged repeat is dismissed (byte for byte); an occurrence
+ *   change is quiet; lists too long to keep are applied every time
+ * - A list that did not fit the pool is retried on its next repeat
+ * - A handler turning tracking off stops the remaining events
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include "e32_faults.h"
+
+#define MAX_EVENTS  (E32_CFG_DTC_MAX * 2)
+
+typedef struct {
+    uint32_t spn;
+    uint8_t  fmi;
+} dtc_ref_t;
+
+static e32_dtc_event_t g_events[MAX_EVENTS];
+static int             g_event_count;
+
+static void record(const e32_dtc_event_t* event, void* user)
+{
+    (void)user;
+    if (g_event_count < MAX_EVENTS) {
+        g_events[g_event_count++] = *event;
+    }
+}
+
+static int count_events(uint8_t change)
+{
+    int n = 0;
+    for (int i = 0; i < g_event_count; i++) {
+        n += g_events[i].change == change;
+    }
+    return n;
+}
+
+static bool has_event(uint8_t change, uint32_t spn, uint8_t fmi)
+{
+    for (int i = 0; i < g_event_count; i++) {
+        if (g_events[i].change == change && g_events[i].dtc.spn == spn && g_events[i].dtc.fmi == fmi) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Lamps, flash codes, then one SPN conversion method 4 field per DTC */
+static uint16_t build_dm(uint8_t* data, const dtc_ref_t* dtcs, int count, uint8_t occurrence)
+{
+    data[0] = 0x44;     /* MIL on */
+    data[1] = 0xFF;
+    uint16_t len = 2;
+    for (int i = 0; i < count; i++) {
+        data[len++] = (uint8_t)dtcs[i].spn;
+        data[len++] = (uint8_t)(dtcs[i].spn >> 8);
+        data[len++] = (uint8_t)(((dtcs[i].spn >> 16) & 0x07) << 5 | dtcs[i].fmi);
+        data[len++] = occurrence;
+    }
+    if (count == 0) {
+        memset(&data[2], 0, 4);     /* "No DTC" filler */
+        len = 6;
+    }
+    return len;
+}
+
+static void apply(e32_faults_t* faults, uint32_t pgn, uint8_t sa,
+                  const dtc_ref_t* dtcs, int count, uint8_t occurrence)
+{
+    uint8_t data[2 + 4 * (E32_CFG_DTC_MAX + 8)];
+    e32_j1939_view_t view;
+    memset(&view, 0, sizeof(view));
+    view.pgn = pgn;
+    view.source_address = sa;
+    view.destination_address = E32_SA_GLOBAL;
+    view.data = data;
+    view.len = build_dm(data, dtcs, count, occurrence);
+
+    g_event_count = 0;
+    e32_faults_update(faults, &view);
+}
+
+static e32_faults_t* tracking(void)
+{
+    static e32_faults_t faults;
+    e32_faults_init(&faults);
+    faults.handler = record;
+    return &faults;
+}
+
+static uint16_t listed(const e32_faults_t* faults, uint8_t sa, uint32_t pgn)
+{
+    e32_dtc_t dtcs[4];
+    uint16_t count = 0xFFFF;
+    if (e32_faults_get(faults, 0, sa, pgn, dtcs, 4, &count) != E32_OK) {
+        return 0xFFFF;
+    }
+    return count;
+}
+
+static e32_fault_source_t* source_of(e32_faults_t* faults, uint8_t sa)
+{
+    for (int i = 0; i < E32_CFG_DTC_SOURCES; i++) {
+        if (faults->sources[i].used && faults->sources[i].sa == sa) {
+            return &faults->sources[i];
+        }
+    }
+    return NULL;
+}
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void reports_raised_and_cleared(void)
+{
+    e32_faults_t* faults = tracking();
+    const dtc_ref_t first[] = { { 100, 1 }, { 110, 3 } };
+    const dtc_ref_t second[] = { { 110, 3 }, { 0x7FF01, 31 } };
+
+    apply(faults, E32_PGN_DM1, 0x00, first, 2, 1);
+    CHECK_EQ(g_event_count, 2);
+    CHECK(has_event(E32_DTC_RAISED, 100, 1));
+    CHECK(has_event(E32_DTC_RAISED, 110, 3));
+    CHECK_EQ(g_events[0].lamp_status, 0x44);
+    CHECK_EQ(g_events[0].pgn, E32_PGN_DM1);
+
+    apply(faults, E32_PGN_DM1, 0x00, second, 2, 1);
+    CHECK_EQ(g_event_count, 2);
+    CHECK(has_event(E32_DTC_CLEARED, 100, 1));
+    CHECK(has_event(E32_DTC_RAISED, 0x7FF01, 31));
+    CHECK_EQ(g_events[0].change, E32_DTC_CLEARED);     /* Clears come first */
+    CHECK_EQ(listed(faults, 0x00, E32_PGN_DM1), 2);
+
+    apply(faults, E32_PGN_DM1, 0x00, NULL, 0, 0);
+    CHECK_EQ(count_events(E32_DTC_CLEARED), 2);
+    CHECK_EQ(count_events(E32_DTC_RAISED), 0);
+    CHECK_EQ(listed(faults, 0x00, E32_PGN_DM1), 0);
+}
+
+static void keeps_lists_apart(void)
+{
+    e32_faults_t* faults = tracking();
+    const dtc_ref_t dtc[] = { { 100, 1 } };
+
+    apply(faults, E32_PGN_DM1, 0x00, dtc, 1, 1);
+    apply(faults, E32_PGN_DM2, 0x00, dtc, 1, 1);
+    CHECK_EQ(count_events(E32_DTC_RAISED), 1);
+    CHECK_EQ(g_events[0].pgn, E32_PGN_DM2);
+    apply(faults, E32_PGN_DM1, 0x03, dtc, 1, 1);
+    CHECK_EQ(count_events(E32_DTC_RAISED), 1);
+
+    apply(faults, E32_PGN_DM1, 0x00, NULL, 0, 0);
+    CHECK_EQ(listed(faults, 0x00, E32_PGN_DM1), 0);
+    CHECK_EQ(listed(faults, 0x00, E32_PGN_DM2), 1);
+    CHECK_EQ(listed(faults, 0x03, E32_PGN_DM1), 1);
+    CHECK_EQ(listed(faults, 0x04, E32_PGN_DM1), 0xFFFF);
+}
+
+static void dismisses_repeats(void)
+{
+    e32_faults_t* faults = tracking();
+    const dtc_ref_t dtcs[] = { { 100, 1 }, { 110, 3 } };
+
+    apply(faults, E32_PGN_DM1, 0x00, dtcs, 2, 1);
+    CHECK_EQ(g_event_count, 2);
+    apply(faults, E32_PGN_DM1, 0x00, dtcs, 2, 1);
+    CHECK_EQ(g_event_count, 0);
+
+    /* Different bytes, same faults: applied, but nothing to report */
+    apply(faults, E32_PGN_DM1, 0x00, dtcs, 2, 5);
+    CHECK_EQ(g_event_count, 0);
+
+    e32_dtc_t copy[2];
+    uint16_t count = 0;
+    CHECK_EQ(e32_faults_get(faults, 0, 0x00, E32_PGN_DM1, copy, 2, &count), E32_OK);
+    CHECK_EQ(count, 2);
+    CHECK_EQ(copy[0].occurrence, 5);
+    CHECK_EQ(copy[1].occurrence, 5);
+
+    /* A dismissed repeat is not read: a planted occurrence survives it */
+    e32_fault_t* head = &faults->faults[source_of(faults, 0x00)->head];
+    head->dtc.occurrence = 99;
+    apply(faults, E32_PGN_DM1, 0x00, dtcs, 2, 5);
+    CHECK_EQ(g_event_count, 0);
+    CHECK_EQ(head->dtc.occurrence, 99);
+
+    /* Same length, one DTC swapped */
+    const dtc_ref_t swapped[] = { { 100, 1 }, { 111, 3 } };
+    apply(faults, E32_PGN_DM1, 0x00, swapped, 2, 5);
+    CHECK_EQ(count_events(E32_DTC_CLEARED), 1);
+    CHECK_EQ(count_events(E32_DTC_RAISED), 1);
+    CHECK(has_event(E32_DTC_RAISED, 111, 3));
+
+    /* A list too long to keep is applied on every repeat */
+    static dtc_ref_t longer[E32_CFG_DTC_REPEAT_BYTES / 4 + 1];
+    int n = (int)(sizeof(longer) / sizeof(longer[0]));
+    for (int i = 0; i < n; i++) {
+        longer[i].spn = 2000 + (uint32_t)i;
+        longer[i].fmi = 7;
+    }
+    apply(faults, E32_PGN_DM1, 0x05, longer, n, 1);
+    CHECK_EQ(g_event_count, n);
+    CHECK_EQ(source_of(faults, 0x05)->len, 0xFFFF);
+    head = &faults->faults[source_of(faults, 0x05)->head];
+    head->dtc.occurrence = 99;
+    apply(faults, E32_PGN_DM1, 0x05, longer, n, 1);
+    CHECK_EQ(g_event_count, 0);
+    CHECK_EQ(head->dtc.occurrence, 1);
+}
+
+static void retries_when_pool_was_full(void)
+{
+    e32_faults_t* faults = tracking();
+    static dtc_ref_t many[E32_CFG_DTC_MAX];
+    for (int i = 0; i < E32_CFG_DTC_MAX; i++) {
+        many[i].spn = 1000 + (uint32_t)i;
+        many[i].fmi = 2;
+    }
+    const dtc_ref_t late[] = { { 200, 4 }, { 201, 4 } };
+
+    apply(faults, E32_PGN_DM1, 0x00, many, E32_CFG_DTC_MAX - 1, 1);
+    CHECK_EQ(g_event_count, E32_CFG_DTC_MAX - 1);
+
+    apply(faults, E32_PGN_DM1, 0x01, late, 2, 1);      /* Room for one */
+    CHECK_EQ(g_event_count, 1);
+    CHECK_EQ(listed(faults, 0x01, E32_PGN_DM1), 1);
+
+    apply(faults, E32_PGN_DM1, 0x01, late, 2, 1);      /* Still full: still not dismissed */
+    CHECK_EQ(g_event_count, 0);
+
+    apply(faults, E32_PGN_DM1, 0x00, NULL, 0, 0);
+    CHECK_EQ(g_event_count, E32_CFG_DTC_MAX - 1);
+
+    apply(faults, E32_PGN_DM1, 0x01, late, 2, 1);
+    CHECK_EQ(g_event_count, 1);
+    CHECK_EQ(listed(faults, 0x01, E32_PGN_DM1), 2);
+
+    apply(faults, E32_PGN_DM1, 0x01, late, 2, 1);      /* Complete now: a plain repeat */
+    CHECK_EQ(g_event_count, 0);
+}
+
+/* ==========================================================================
+ * CLIENT
+ * ========================================================================== */
+
+static e32_j1939_client_t g_client;
+static int                g_calls;
+
+static void stop_tracking(const e32_dtc_event_t* event, void* user)
+{
+    (void)event; (void)user;
+    g_calls++;
+    CHECK_EQ(e32_j1939_on_dtc(g_client, NULL, NULL), E32_OK);
+}
+
+static void handler_can_stop_tracking(void)
+{
+    e32_vbus_t* bus = test_bus("vdm");
+    g_client = test_client("vdm", 0x20);
+    CHECK_EQ(e32_j1939_on_dtc(g_client, record, NULL), E32_OK);
+
+    uint8_t data[8];
+    const dtc_ref_t one[] = { { 100, 1 } };
+    build_dm(data, one, 1, 1);
+    g_event_count = 0;
+    test_inject(bus, E32_PGN_DM1, 0x00, E32_SA_GLOBAL, 6, data);
+    CHECK_EQ(g_event_count, 1);
+
+    e32_dtc_t dtcs[2];
+    uint16_t count = 0;
+    CHECK_EQ(e32_j1939_get_dtcs(g_client, 0, 0x00, E32_PGN_DM1, dtcs, 2, &count), E32_OK);
+    CHECK_EQ(count, 1);
+
+    /* One CLEARED and one RAISED pending; the first call turns tracking off */
+    CHECK_EQ(e32_j1939_on_dtc(g_client, stop_tracking, NULL), E32_OK);
+    const dtc_ref_t other[] = { { 300, 7 } };
+    build_dm(data, other, 1, 1);
+    g_calls = 0;
+    test_inject(bus, E32_PGN_DM1, 0x00, E32_SA_GLOBAL, 6, data);
+    CHECK_EQ(g_calls, 1);
+    CHECK_EQ(e32_j1939_get_dtcs(g_client, 0, 0x00, E32_PGN_DM1, dtcs, 2, &count), E32_ERR_NOT_FOUND);
+
+    /* Off means off: later lists are not tracked */
+    test_inject(bus, E32_PGN_DM1, 0x00, E32_SA_GLOBAL, 6, data);
+    CHECK_EQ(g_calls, 1);
+    test_teardown();
+}
+
+int main(void)
+{
+    RUN(reports_raised_and_cleared);
+    RUN(keeps_lists_apart);
+    RUN(dismisses_repeats);
+    RUN(retries_when_pool_was_full);
+    RUN(handler_can_stop_tracking);
+    return TEST_RESULT();
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_filter.c
+ * @brief Embedded32 SDK - Acceptance Filter Planner Tests
+ *
+ * Tests:
+ * - Random PGN ranges and (SA, PGN) sources on tight bank budgets: the
+ *   plan stays within budget and lets every wanted identifier through
+ * - Plans within budget are exact
+ * - bxCAN and TWAI register encodings against hand-computed values
+ */
+
+#include "e32_test.h"
+#include "e32_filter.h"
+#include "embedded32.h"
+#include <string.h>
+
+#define TRIALS          200
+#define MAX_RANGES      6
+#define MAX_SOURCES     10
+#define SAMPLES         64
+
+/* Fixed seed: every run plans the same sets */
+static uint32_t g_rng = 0x2545F491u;
+
+static uint32_t next_random(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+/* A frame of pgn with random priority, source and destination */
+static uint32_t frame_id(uint32_t pgn, int sa)
+{
+    uint8_t source = sa >= 0 ? (uint8_t)sa : (uint8_t)next_random();
+    return e32_build_j1939_id(pgn, source, (uint8_t)(next_random() & 7), (uint8_t)next_random());
+}
+
+/* Parsed PGN of a frame sent as pgn: PDU1 PGNs lose their low byte */
+static uint32_t as_parsed(uint32_t pgn)
+{
+    e32_j1939_id_t id;
+    e32_parse_j1939_id(e32_build_j1939_id(pgn, 0, 6, 0), &id);
+    return id.pgn;
+}
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} range_t;
+
+typedef struct {
+    uint32_t pgn;
+    uint8_t  sa;
+} source_t;
+
+static void plans_accept_every_wanted_id(void)
+{
+    static const int budgets[] = { 1, 2, 3, 4, 8 };
+
+    for (unsigned b = 0; b < sizeof(budgets) / sizeof(budgets[0]); b++) {
+        for (int trial = 0; trial < TRIALS; trial++) {
+            e32_filter_plan_t plan;
+            range_t ranges[MAX_RANGES];
+            source_t sources[MAX_SOURCES];
+            int range_count = (int)(next_random() % (MAX_RANGES + 1));
+            int source_count = (int)(next_random() % (MAX_SOURCES + 1));
+
+            e32_filter_plan_init(&plan, budgets[b]);
+            for (int i = 0; i < range_count; i++) {
+                /* Mostly short ranges, now and then a wide one */
+                uint32_t span = (next_random() & 7) ? next_random() % 300 : next_random() % 0x8000;
+                ranges[i].first = next_random() % (E32_PGN_MAX + 1);
+                ranges[i].last = ranges[i].first + span > E32_PGN_MAX ? E32_PGN_MAX : ranges[i].first + span;
+                e32_filter_plan_add_pgns(&plan, ranges[i].first, ranges[i].last);
+            }
+            for (int i = 0; i < source_count; i++) {
+                sources[i].pgn = next_random() % (E32_PGN_MAX + 1);
+                sources[i].sa = (uint8_t)next_random();
+                e32_filter_plan_add_source(&plan, sources[i].pgn, sources[i].sa);
+            }
+
+            CHECK(plan.count <= budgets[b]);
+
+            int missed = 0;
+            for (int i = 0; i < range_count; i++) {
+                uint32_t span = ranges[i].last - ranges[i].first + 1;
+                for (int k = 0; k < SAMPLES; k++) {
+                    uint32_t pgn = k == 0 ? ranges[i].first
+                                 : k == 1 ? ranges[i].last
+                                 : ranges[i].first + next_random() % span;
+                    uint32_t parsed = as_parsed(pgn);
+                    if (parsed < ranges[i].first || parsed > ranges[i].last) {
+                        continue;   /* A PDU1 PGN with a destination byte: not a PGN of its own */
+                    }
+                    missed += !e32_filter_plan_accepts(&plan, frame_id(parsed, -1));
+                }
+            }
+            for (int i = 0; i < source_count; i++) {
+                for (int k = 0; k < 4; k++) {
+                    missed += !e32_filter_plan_accepts(&plan, frame_id(as_parsed(sources[i].pgn), sources[i].sa));
+                }
+            }
+            CHECK_EQ(missed, 0);
+        }
+    }
+}
+
+static void exact_within_budget(void)
+{
+    e32_filter_plan_t plan;
+    e32_filter_plan_init(&plan, 8);
+    e32_filter_plan_add_source(&plan, E32_PGN_EEC1, 0x00);
+    e32_filter_plan_add_source(&plan, E32_PGN_REQUEST, 0x21);
+    e32_filter_plan_add_pgns(&plan, E32_PGN_TP_DT, E32_PGN_TP_CM);
+    CHECK_EQ(plan.count, 4);       /* TP.DT and TP.CM differ in three PF bits */
+
+    CHECK(e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_EEC1, 0x00, 3, E32_SA_GLOBAL)));
+    CHECK(!e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_EEC1, 0x01, 3, E32_SA_GLOBAL)));
+    CHECK(e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_REQUEST, 0x21, 6, 0x80)));
+    CHECK(!e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_REQUEST, 0x22, 6, 0x80)));
+    CHECK(e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_TP_CM, 0x42, 7, 0x80)));
+    CHECK(e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_TP_DT, 0x42, 7, E32_SA_GLOBAL)));
+    CHECK(!e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_ET1, 0x00, 6, E32_SA_GLOBAL)));
+
+    /* Adding what is covered changes nothing */
+    CHECK(!e32_filter_plan_add_source(&plan, E32_PGN_TP_CM, 0x42));
+}
+
+static void one_bank_still_accepts_all_wanted(void)
+{
+    e32_filter_plan_t plan;
+    e32_filter_plan_init(&plan, 1);
+    e32_filter_plan_add_source(&plan, E32_PGN_EEC1, 0x00);
+    e32_filter_plan_add_source(&plan, E32_PGN_ET1, 0x00);
+    CHECK_EQ(plan.count, 1);
+    CHECK(e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_EEC1, 0x00, 3, E32_SA_GLOBAL)));
+    CHECK(e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_ET1, 0x00, 6, E32_SA_GLOBAL)));
+    CHECK(!e32_filter_plan_accepts(&plan, e32_build_j1939_id(E32_PGN_ET1, 0x01, 6, E32_SA_GLOBAL)));
+}
+
+/* ==========================================================================
+ * REGISTER ENCODINGS
+ * ========================================================================== */
+
+static void encodes_bxcan_banks(void)
+{
+    /* ET1 from any source: EXID in FR1[31:3], IDE (bit 2) set */
+    e32_can_filter_t et1 = { 0x18FEEE00, 0x03FFFF00 };
+    uint32_t fr1 = 0, fr2 = 0;
+    e32_filter_to_bxcan(&et1, &fr1, &fr2);
+    CHECK_EQ(fr1, 0xC7F77004u);
+    CHECK_EQ(fr2, 0x1FFFF806u);     /* IDE and RTR always compared */
+
+    e32_can_filter_t all = { 0, 0 };
+    e32_filter_to_bxcan(&all, &fr1, &fr2);
+    CHECK_EQ(fr1, 0x00000004u);
+    CHECK_EQ(fr2, 0x00000006u);
+
+    e32_can_filter_t one = { 0x1FFFFFFF, 0x1FFFFFFF };
+    e32_filter_to_bxcan(&one, &fr1, &fr2);
+    CHECK_EQ(fr1, 0xFFFFFFFCu);
+    CHECK_EQ(fr2, 0xFFFFFFFEu);
+}
+
+static void encodes_twai_filter(void)
+{
+    /* Set mask bits are don't-care; RTR (bit 2) must be 0, bits 1:0 unused */
+    e32_can_filter_t et1 = { 0x18FEEE00, 0x03FFFF00 };
+    uint32_t code = 0, mask = 0;
+    e32_filter_to_twai(&et1, &code, &mask);
+    CHECK_EQ(code, 0xC7F77000u);
+    CHECK_EQ(mask, 0xE00007FBu);
+
+    e32_can_filter_t all = { 0, 0 };
+    e32_filter_to_twai(&all, &code, &mask);
+    CHECK_EQ(code, 0x00000000u);
+    CHECK_EQ(mask, 0xFFFFFFFBu);
+
+    e32_can_filter_t one = { 0x0CF00400, 0x1FFFFFFF };
+    e32_filter_to_twai(&one, &code, &mask);
+    CHECK_EQ(code, 0x67802000u);
+    CHECK_EQ(mask, 0x00000003u);
+}
+
+int main(void)
+{
+    RUN(plans_accept_every_wanted_id);
+    RUN(exact_within_budget);
+    RUN(one_bank_still_accepts_all_wanted);
+    RUN(encodes_bxcan_banks);
+    RUN(encodes_twai_filter);
+    return TEST_RESULT();
+}
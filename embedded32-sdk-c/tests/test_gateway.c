@@ -0,0 +1,346 @@
+/**
+ * @file test_gateway.c
+ * @brief Embedded32 SDK - Gateway Routing Tests
+ *
+ * The compiled rule table on its own, then a two-channel gateway client
+ * between two manual-clock virtual buses with a listener on the far side.
+ *
+ * Tests:
+ * - Rule compile: PDU1 destinations ignored, PDU2 PGNs matched whole
+ * - In-place rewrite of source, priority and PDU1 destination
+ * - E32_ROUTE_SET_DESTINATION leaves PDU2 identifiers alone
+ * - E32_ROUTE_BLOCK only carves out of rules added after it
+ * - Source rewrite of single frames and of BAM transfers end to end
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include "e32_gateway.h"
+
+#define PGN_PROP_B      0xFF10
+#define SA_ENGINE       0x00
+#define SA_ALIAS        0x27
+
+/* ==========================================================================
+ * RULE TABLE
+ * ========================================================================== */
+
+static e32_can_frame_t frame_on(uint8_t channel, uint32_t pgn, uint8_t sa, uint8_t da, uint8_t prio)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = e32_build_j1939_id(pgn, sa, prio, da);
+    frame.is_extended = true;
+    frame.dlc = 8;
+    frame.channel = channel;
+    return frame;
+}
+
+static void compiles_pgn_and_source_match(void)
+{
+    e32_gateway_t gateway;
+    e32_gateway_init(&gateway);
+
+    e32_route_t pdu1 = { 0 };
+    pdu1.to_channels = 1u << 1;
+    pdu1.pgn = E32_PGN_REQUEST | 0x17;      /* Destination byte is not compared */
+    pdu1.pgn_mask = 0x3FFFF;
+    CHECK_EQ(e32_gateway_add(&gateway, &pdu1, 2), E32_OK);
+    CHECK_EQ(gateway.rules[0].mask, 0x3FF0000u);
+    CHECK_EQ(gateway.rules[0].value, (uint32_t)E32_PGN_REQUEST << 8);
+
+    e32_route_t pdu2 = { 0 };
+    pdu2.to_channels = 1u << 1;
+    pdu2.pgn = E32_PGN_EEC1;
+    pdu2.pgn_mask = 0x3FFFF;
+    pdu2.source = 0x00;
+    pdu2.source_mask = 0xFF;
+    CHECK_EQ(e32_gateway_add(&gateway, &pdu2, 2), E32_OK);
+    CHECK_EQ(gateway.rules[1].mask, 0x3FFFFFFu);
+    CHECK_EQ(gateway.rules[1].value, (uint32_t)E32_PGN_EEC1 << 8);
+
+    e32_can_frame_t request = frame_on(0, E32_PGN_REQUEST, 0x42, 0x99, 6);
+    CHECK_EQ(e32_gateway_route(&gateway, &request), 1u << 1);
+    e32_can_frame_t eec1 = frame_on(0, E32_PGN_EEC1, 0x00, E32_SA_GLOBAL, 3);
+    CHECK_EQ(e32_gateway_route(&gateway, &eec1), 1u << 1);
+    e32_can_frame_t other_sender = frame_on(0, E32_PGN_EEC1, 0x01, E32_SA_GLOBAL, 3);
+    CHECK_EQ(e32_gateway_route(&gateway, &other_sender), 0);
+    e32_can_frame_t other_bus = frame_on(1, E32_PGN_EEC1, 0x00, E32_SA_GLOBAL, 3);
+    CHECK_EQ(e32_gateway_route(&gateway, &other_bus), 0);
+}
+
+static void rejects_bad_rules(void)
+{
+    e32_gateway_t gateway;
+    e32_gateway_init(&gateway);
+    e32_route_t route = { 0 };
+
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_ERR_INVALID_PARAM);     /* Nowhere */
+    route.to_channels = 1u << 0;
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_ERR_INVALID_PARAM);     /* Own bus */
+    route.to_channels = 1u << 2;
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_ERR_INVALID_PARAM);     /* Missing bus */
+    route.to_channels = 1u << 1;
+    route.priority_out = 8;
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_ERR_INVALID_PARAM);
+    route.priority_out = 0;
+    route.from_channel = 2;
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_ERR_INVALID_PARAM);
+    CHECK_EQ(gateway.count, 0);
+
+    route.from_channel = 0;
+    for (int i = 0; i < E32_CFG_ROUTE_MAX; i++) {
+        CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_OK);
+    }
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_ERR_NO_MEMORY);
+}
+
+static void rewrites_in_place(void)
+{
+    e32_gateway_t gateway;
+    e32_gateway_init(&gateway);
+
+    e32_route_t route = { 0 };
+    route.to_channels = 1u << 1;
+    route.flags = E32_ROUTE_SET_SOURCE | E32_ROUTE_SET_PRIORITY | E32_ROUTE_SET_DESTINATION;
+    route.source_out = SA_ALIAS;
+    route.priority_out = 7;
+    route.destination_out = 0x33;
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_OK);
+
+    e32_can_frame_t pdu1 = frame_on(0, E32_PGN_REQUEST, 0x42, 0x17, 6);
+    pdu1.data[0] = 0xAB;
+    CHECK_EQ(e32_gateway_route(&gateway, &pdu1), 1u << 1);
+    CHECK_EQ(pdu1.id, e32_build_j1939_id(E32_PGN_REQUEST, SA_ALIAS, 7, 0x33));
+    CHECK_EQ(pdu1.data[0], 0xAB);
+    CHECK_EQ(pdu1.channel, 0);
+
+    /* PS of a PDU2 identifier is part of the PGN, not a destination */
+    e32_can_frame_t pdu2 = frame_on(0, E32_PGN_ET1, 0x00, E32_SA_GLOBAL, 6);
+    CHECK_EQ(e32_gateway_route(&gateway, &pdu2), 1u << 1);
+    CHECK_EQ(pdu2.id, e32_build_j1939_id(E32_PGN_ET1, SA_ALIAS, 7, E32_SA_GLOBAL));
+
+    e32_j1939_id_t id;
+    e32_parse_j1939_id(pdu2.id, &id);
+    CHECK_EQ(id.pgn, E32_PGN_ET1);
+}
+
+static void destination_only_leaves_pdu2_alone(void)
+{
+    e32_gateway_t gateway;
+    e32_gateway_init(&gateway);
+
+    e32_route_t route = { 0 };
+    route.to_channels = 1u << 1;
+    route.flags = E32_ROUTE_SET_DESTINATION;
+    route.destination_out = 0x33;
+    CHECK_EQ(e32_gateway_add(&gateway, &route, 2), E32_OK);
+
+    static const uint32_t pgns[] = { E32_PGN_EEC1, E32_PGN_ET1, E32_PGN_DM1, PGN_PROP_B, 0x1F004 };
+    for (unsigned i = 0; i < sizeof(pgns) / sizeof(pgns[0]); i++) {
+        e32_can_frame_t frame = frame_on(0, pgns[i], 0x00, E32_SA_GLOBAL, 6);
+        uint32_t before = frame.id;
+        CHECK_EQ(e32_gateway_route(&gateway, &frame), 1u << 1);
+        CHECK_EQ(frame.id, before);
+    }
+}
+
+static void block_orders_before_wider_rules(void)
+{
+    e32_gateway_t gateway;
+    e32_gateway_init(&gateway);
+
+    e32_route_t block = { 0 };
+    block.flags = E32_ROUTE_BLOCK;
+    block.pgn = E32_PGN_DM1;
+    block.pgn_mask = 0x3FFFF;
+    e32_route_t all = { 0 };
+    all.to_channels = 1u << 1;
+    e32_route_t back = { 0 };
+    back.from_channel = 1;
+    back.to_channels = 1u << 0;
+
+    /* Channel 1's rule first: rules still group by channel */
+    CHECK_EQ(e32_gateway_add(&gateway, &back, 2), E32_OK);
+    CHECK_EQ(e32_gateway_add(&gateway, &block, 2), E32_OK);
+    CHECK_EQ(e32_gateway_add(&gateway, &all, 2), E32_OK);
+    CHECK_EQ(e32_gateway_add(&gateway, &block, 2), E32_OK);    /* Shadowed by all */
+
+    e32_can_frame_t dm1 = frame_on(0, E32_PGN_DM1, 0x00, E32_SA_GLOBAL, 6);
+    CHECK_EQ(e32_gateway_route(&gateway, &dm1), 0);
+    CHECK_EQ(gateway.stats.blocked, 1);
+    e32_can_frame_t eec1 = frame_on(0, E32_PGN_EEC1, 0x00, E32_SA_GLOBAL, 3);
+    CHECK_EQ(e32_gateway_route(&gateway, &eec1), 1u << 1);
+    e32_can_frame_t dm1_back = frame_on(1, E32_PGN_DM1, 0x00, E32_SA_GLOBAL, 6);
+    CHECK_EQ(e32_gateway_route(&gateway, &dm1_back), 1u << 0);
+
+    /* The other order: the wide rule wins */
+    e32_gateway_init(&gateway);
+    CHECK_EQ(e32_gateway_add(&gateway, &all, 2), E32_OK);
+    CHECK_EQ(e32_gateway_add(&gateway, &block, 2), E32_OK);
+    dm1 = frame_on(0, E32_PGN_DM1, 0x00, E32_SA_GLOBAL, 6);
+    CHECK_EQ(e32_gateway_route(&gateway, &dm1), 1u << 1);
+    CHECK_EQ(gateway.stats.blocked, 0);
+}
+
+/* ==========================================================================
+ * BETWEEN TWO BUSES
+ * ========================================================================== */
+
+typedef struct {
+    uint32_t pgn;
+    uint8_t  sa;
+    uint16_t len;
+    uint8_t  data[32];
+} seen_t;
+
+static seen_t g_seen[128];
+static int    g_seen_count;
+
+static void log_message(const e32_j1939_view_t* view, void* user)
+{
+    (void)user;
+    if (g_seen_count < (int)(sizeof(g_seen) / sizeof(g_seen[0]))) {
+        seen_t* seen = &g_seen[g_seen_count++];
+        seen->pgn = view->pgn;
+        seen->sa = view->source_address;
+        seen->len = view->len;
+        memcpy(seen->data, view->data, view->len < 32 ? view->len : 32);
+    }
+}
+
+static const seen_t* find_seen(uint32_t pgn)
+{
+    for (int i = 0; i < g_seen_count; i++) {
+        if (g_seen[i].pgn == pgn) {
+            return &g_seen[i];
+        }
+    }
+    return NULL;
+}
+
+static e32_vbus_t*        g_engine_bus;
+static e32_j1939_client_t g_gateway;
+static e32_j1939_client_t g_engine;
+
+/* Engine node on vgw0, gateway between vgw0 and vgw1, listener on vgw1 */
+static void setup(void)
+{
+    g_engine_bus = test_bus("vgw0");
+    test_bus("vgw1");
+
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.channel_count = 2;
+    config.channels[0] = "vgw0";
+    config.channels[1] = "vgw1";
+    g_gateway = test_client_ex(&config, 0x80);
+    g_engine = test_client("vgw0", SA_ENGINE);
+    e32_j1939_client_t listener = test_client("vgw1", 0x30);
+
+    g_seen_count = 0;
+    e32_j1939_on_pgn_view(listener, E32_PGN_ANY, log_message, NULL, NULL);
+}
+
+static void forwards_single_frames_renamed(void)
+{
+    setup();
+    e32_route_t route = { 0 };
+    route.to_channels = 1u << 1;
+    route.flags = E32_ROUTE_SET_SOURCE;
+    route.source_out = SA_ALIAS;
+    CHECK_EQ(e32_j1939_add_route(g_gateway, &route), E32_OK);
+
+    const uint8_t data[8] = { 0xF0, 0x7D, 0x7D, 0x40, 0x1F, 0x00, 0xF0, 0x7D };
+    test_inject(g_engine_bus, E32_PGN_EEC1, SA_ENGINE, E32_SA_GLOBAL, 3, data);
+    test_run(1);
+
+    const seen_t* eec1 = find_seen(E32_PGN_EEC1);
+    CHECK(eec1 != NULL);
+    if (eec1) {
+        CHECK_EQ(eec1->sa, SA_ALIAS);
+        CHECK_EQ(eec1->len, 8);
+        CHECK(memcmp(eec1->data, data, 8) == 0);
+    }
+
+    e32_route_stats_t stats;
+    CHECK_EQ(e32_j1939_get_route_stats(g_gateway, &stats), E32_OK);
+    CHECK_EQ(stats.forwarded + stats.queued, 1);
+    CHECK_EQ(stats.dropped, 0);
+    test_teardown();
+}
+
+static void forwards_bam_renamed(void)
+{
+    setup();
+    e32_route_t route = { 0 };
+    route.to_channels = 1u << 1;
+    route.flags = E32_ROUTE_SET_SOURCE;
+    route.source_out = SA_ALIAS;
+    CHECK_EQ(e32_j1939_add_route(g_gateway, &route), E32_OK);
+
+    uint8_t data[20];
+    for (int i = 0; i < 20; i++) {
+        data[i] = (uint8_t)(i * 11 + 1);
+    }
+    CHECK_EQ(e32_j1939_send_raw_on(g_engine, 0, PGN_PROP_B, data, sizeof(data), E32_SA_GLOBAL, 6), E32_OK);
+    test_run(4 * E32_CFG_TP_BAM_INTERVAL_MS);
+
+    /* Announcement and every packet renamed alike, so it reassembles */
+    const seen_t* message = find_seen(PGN_PROP_B);
+    CHECK(message != NULL);
+    if (message) {
+        CHECK_EQ(message->sa, SA_ALIAS);
+        CHECK_EQ(message->len, 20);
+        CHECK(memcmp(message->data, data, 20) == 0);
+    }
+    for (int i = 0; i < g_seen_count; i++) {
+        CHECK_EQ(g_seen[i].sa, SA_ALIAS);
+    }
+    test_teardown();
+}
+
+static void blocks_on_the_bus(void)
+{
+    setup();
+    e32_route_t block = { 0 };
+    block.flags = E32_ROUTE_BLOCK;
+    block.pgn = E32_PGN_DM1;
+    block.pgn_mask = 0x3FFFF;
+    e32_route_t all = { 0 };
+    all.to_channels = 1u << 1;
+    CHECK_EQ(e32_j1939_add_route(g_gateway, &block), E32_OK);
+    CHECK_EQ(e32_j1939_add_route(g_gateway, &all), E32_OK);
+
+    const uint8_t data[8] = { 0x44, 0xFF, 100, 0, 1, 1, 0xFF, 0xFF };
+    test_inject(g_engine_bus, E32_PGN_DM1, SA_ENGINE, E32_SA_GLOBAL, 6, data);
+    test_inject(g_engine_bus, E32_PGN_ET1, SA_ENGINE, E32_SA_GLOBAL, 6, data);
+    test_run(1);
+
+    CHECK(find_seen(E32_PGN_DM1) == NULL);
+    CHECK(find_seen(E32_PGN_ET1) != NULL);
+
+    e32_route_stats_t stats;
+    CHECK_EQ(e32_j1939_get_route_stats(g_gateway, &stats), E32_OK);
+    CHECK_EQ(stats.blocked, 1);
+
+    CHECK_EQ(e32_j1939_clear_routes(g_gateway), E32_OK);
+    g_seen_count = 0;
+    test_inject(g_engine_bus, E32_PGN_ET1, SA_ENGINE, E32_SA_GLOBAL, 6, data);
+    test_run(1);
+    CHECK_EQ(g_seen_count, 0);
+    test_teardown();
+}
+
+int main(void)
+{
+    RUN(compiles_pgn_and_source_match);
+    RUN(rejects_bad_rules);
+    RUN(rewrites_in_place);
+    RUN(destination_only_leaves_pdu2_alone);
+    RUN(block_orders_before_wider_rules);
+    RUN(forwards_single_frames_renamed);
+    RUN(forwards_bam_renamed);
+    RUN(blocks_on_the_bus);
+    return TEST_RESULT();
+}
@@ -0,0 +1,180 @@
+/**
+ * @file test_mpg.c
+ * @brief Embedded32 SDK - Multi-PG Tests
+ *
+ * J1939-22 containers packed and unpacked by the codec, then sent and
+ * received by clients on a virtual bus. Only built with E32_CAN_FD.
+ *
+ * Tests:
+ * - FD lengths and DLC codes
+ * - Packed PGs come back in order with their bytes; padding ends the
+ *   container; a PG that does not fit leaves the frame untouched
+ * - Client: a burst of PGs goes out in as few containers as fit and
+ *   reaches the subscribers of each contained PGN
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+
+#define PGN_PROP_BASE   0xFF00
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void fd_lengths(void)
+{
+    CHECK_EQ(e32_can_len_to_dlc(8), 8);
+    CHECK_EQ(e32_can_len_to_dlc(9), 9);
+    CHECK_EQ(e32_can_len_to_dlc(13), 10);
+    CHECK_EQ(e32_can_len_to_dlc(64), 15);
+    CHECK_EQ(e32_can_dlc_to_len(9), 12);
+    CHECK_EQ(e32_can_dlc_to_len(14), 48);
+    CHECK_EQ(e32_can_fd_len(5), 5);
+    CHECK_EQ(e32_can_fd_len(21), 24);
+    CHECK_EQ(e32_can_fd_len(33), 48);
+    for (uint8_t len = 0; len <= E32_CAN_MAX_DATA_LEN; len++) {
+        CHECK(e32_can_dlc_to_len(e32_can_len_to_dlc(len)) == e32_can_fd_len(len));
+    }
+}
+
+static void packs_and_unpacks(void)
+{
+    uint8_t eec1[8], big[20];
+    for (int i = 0; i < 20; i++) {
+        big[i] = (uint8_t)(0x80 + i);
+        if (i < 8) {
+            eec1[i] = (uint8_t)(0x10 + i);
+        }
+    }
+
+    e32_can_frame_t frame;
+    e32_mpg_begin(0x20, 3, E32_SA_GLOBAL, &frame);
+    CHECK_EQ(frame.flags, E32_CAN_FLAG_FD | E32_CAN_FLAG_BRS);
+    CHECK_EQ(e32_mpg_add(&frame, E32_PGN_EEC1, eec1, 8), E32_OK);
+    CHECK_EQ(e32_mpg_add(&frame, PGN_PROP_BASE, NULL, 0), E32_OK);
+    CHECK_EQ(e32_mpg_add(&frame, PGN_PROP_BASE + 1, big, 20), E32_OK);
+    CHECK_EQ(frame.dlc, 12 + 4 + 24);
+    e32_mpg_finish(&frame);
+    CHECK_EQ(frame.dlc, 48);
+
+    e32_j1939_id_t id;
+    e32_parse_j1939_id(frame.id, &id);
+    CHECK_EQ(id.pgn, E32_PGN_MULTI_PG);
+    CHECK_EQ(id.source_address, 0x20);
+    CHECK_EQ(id.priority, 3);
+
+    e32_cpg_t cpg;
+    uint16_t at = 0;
+    CHECK(e32_mpg_next(frame.data, frame.dlc, &at, &cpg));
+    CHECK_EQ(cpg.pgn, E32_PGN_EEC1);
+    CHECK_EQ(cpg.len, 8);
+    CHECK_EQ(cpg.tos, E32_CPG_TOS_PLAIN);
+    CHECK_EQ(cpg.trailer, 0);
+    CHECK(memcmp(cpg.data, eec1, 8) == 0);
+    CHECK(e32_mpg_next(frame.data, frame.dlc, &at, &cpg));
+    CHECK_EQ(cpg.pgn, PGN_PROP_BASE);
+    CHECK_EQ(cpg.len, 0);
+    CHECK(e32_mpg_next(frame.data, frame.dlc, &at, &cpg));
+    CHECK_EQ(cpg.pgn, PGN_PROP_BASE + 1);
+    CHECK_EQ(cpg.len, 20);
+    CHECK(memcmp(cpg.data, big, 20) == 0);
+    CHECK(!e32_mpg_next(frame.data, frame.dlc, &at, &cpg));    /* 8 bytes of padding */
+
+    /* Fill to the brim: the PG that does not fit changes nothing */
+    e32_mpg_begin(0x20, 3, E32_SA_GLOBAL, &frame);
+    CHECK_EQ(e32_mpg_add(&frame, PGN_PROP_BASE, big, 20), E32_OK);
+    CHECK_EQ(e32_mpg_add(&frame, PGN_PROP_BASE, big, 20), E32_OK);
+    e32_can_frame_t before = frame;
+    CHECK_EQ(e32_mpg_add(&frame, PGN_PROP_BASE, big, 13), E32_ERR_NO_MEMORY);
+    CHECK(memcmp(&frame, &before, sizeof(frame)) == 0);
+    CHECK_EQ(e32_mpg_add(&frame, PGN_PROP_BASE, big, 12), E32_OK);
+    CHECK_EQ(frame.dlc, E32_CAN_MAX_DATA_LEN);
+    CHECK_EQ(e32_mpg_add(&frame, PGN_PROP_BASE, NULL, 0), E32_ERR_NO_MEMORY);
+
+    at = 0;
+    int count = 0;
+    while (e32_mpg_next(frame.data, frame.dlc, &at, &cpg)) {
+        count++;
+    }
+    CHECK_EQ(count, 3);
+    CHECK_EQ(at, E32_CAN_MAX_DATA_LEN);
+
+    /* A truncated container yields only the PGs it holds whole */
+    at = 0;
+    CHECK(e32_mpg_next(frame.data, 30, &at, &cpg));
+    CHECK(!e32_mpg_next(frame.data, 30, &at, &cpg));
+}
+
+#define BURST   12
+
+static int      g_seen[BURST];
+static uint8_t  g_first_byte[BURST];
+static int      g_unpacked;
+
+static void contained(const e32_j1939_view_t* view, void* user_data)
+{
+    (void)user_data;
+    uint32_t i = view->pgn - PGN_PROP_BASE;
+    if (i < BURST && view->len == 8 && !view->frame && view->source_address == 0x20) {
+        g_seen[i]++;
+        g_first_byte[i] = view->data[0];
+        g_unpacked++;
+    }
+}
+
+static void clients_round_trip(void)
+{
+    e32_vbus_t* bus = test_bus("vmpg0");
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.interface_name = "vmpg0";
+    config.can_fd = true;
+    e32_j1939_client_t sender = test_client_ex(&config, 0x20);
+    memset(&config, 0, sizeof(config));
+    config.interface_name = "vmpg0";
+    config.can_fd = true;
+    e32_j1939_client_t receiver = test_client_ex(&config, 0x30);
+    e32_j1939_client_t classic = test_client("vmpg0", 0x40);
+    CHECK_EQ(e32_j1939_on_pgn_view_range(receiver, PGN_PROP_BASE, PGN_PROP_BASE + BURST - 1,
+                                         contained, NULL, NULL), E32_OK);
+
+    uint8_t data[BURST][8];
+    e32_cpg_t pgs[BURST];
+    for (int i = 0; i < BURST; i++) {
+        memset(data[i], (uint8_t)(0xA0 + i), 8);
+        pgs[i].pgn = PGN_PROP_BASE + (uint32_t)i;
+        pgs[i].data = data[i];
+        pgs[i].len = 8;
+    }
+    memset(g_seen, 0, sizeof(g_seen));
+    g_unpacked = 0;
+
+    /* Five 12-byte PGs per container: three containers */
+    CHECK_EQ(e32_j1939_send_multi_pg(sender, 0, pgs, BURST, E32_SA_GLOBAL, 3), E32_OK);
+    test_run(2);
+    e32_vbus_stats_t stats;
+    CHECK_EQ(e32_vbus_get_stats(bus, &stats), E32_OK);
+    CHECK_EQ(stats.frames, 3);
+    CHECK_EQ(g_unpacked, BURST);
+    for (int i = 0; i < BURST; i++) {
+        CHECK_EQ(g_seen[i], 1);
+        CHECK_EQ(g_first_byte[i], 0xA0 + i);
+    }
+
+    /* Oversize PGs and classic clients are refused */
+    pgs[0].len = E32_CPG_MAX_DATA_LEN + 1;
+    CHECK_EQ(e32_j1939_send_multi_pg(sender, 0, pgs, 1, E32_SA_GLOBAL, 3), E32_ERR_INVALID_PARAM);
+    pgs[0].len = 8;
+    CHECK_EQ(e32_j1939_send_multi_pg(classic, 0, pgs, 1, E32_SA_GLOBAL, 3), E32_ERR_NOT_SUPPORTED);
+    CHECK_EQ(e32_j1939_send_multi_pg(sender, 0, pgs, 0, E32_SA_GLOBAL, 3), E32_ERR_INVALID_PARAM);
+    test_teardown();
+}
+
+int main(void)
+{
+    RUN(fd_lengths);
+    RUN(packs_and_unpacks);
+    RUN(clients_round_trip);
+    return TEST_RESULT();
+}
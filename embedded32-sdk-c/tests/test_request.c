@@ -0,0 +1,330 @@
+/**
+ * @file test_request.c
+ * @brief Embedded32 SDK - Request/Response Tests
+ *
+ * The correlation table on its own, then requests from a client on a
+ * manual-clock virtual bus.
+ *
+ * Tests:
+ * - Responses complete the request for their PGN, source and channel only
+ * - Acknowledgments: NACK, Cannot Respond, other requesters ignored
+ * - In-flight and per-destination limits; a blocked destination does not
+ *   hold up the others; BUSY sends are retried in order
+ * - Deadlines, send errors, global requests collecting until the timeout,
+ *   callbacks that submit again, cancel
+ * - Client: the response is handed to the callback, silence times out
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include "e32_request.h"
+
+#define OWN_SA      0x20
+#define PGN_ID      0xFEEB      /* Component Identification */
+#define PGN_SOFT    0xFEDA      /* Software Identification */
+
+static e32_requests_t g_reqs;
+
+/* Sent Request frames: destination << 24 | pgn */
+static uint32_t    g_sent[64];
+static int         g_sent_count;
+static e32_error_t g_send_result;
+
+static e32_error_t record_send(void* ctx, const e32_request_t* request)
+{
+    (void)ctx;
+    if (g_send_result == E32_OK && g_sent_count < 64) {
+        g_sent[g_sent_count++] = ((uint32_t)request->destination << 24) | request->pgn;
+    }
+    return g_send_result;
+}
+
+/* Completions: tag from user_data, status, responder */
+static int         g_done_tag[64];
+static e32_error_t g_done_status[64];
+static uint8_t     g_done_sa[64];
+static int         g_done_count;
+
+static void note_done(e32_error_t status, const e32_j1939_view_t* response, void* user_data)
+{
+    if (g_done_count < 64) {
+        g_done_tag[g_done_count] = (int)(intptr_t)user_data;
+        g_done_status[g_done_count] = status;
+        g_done_sa[g_done_count++] = response ? response->source_address : E32_SA_NULL;
+    }
+}
+
+static void reset(void)
+{
+    e32_requests_init(&g_reqs);
+    g_sent_count = 0;
+    g_send_result = E32_OK;
+    g_done_count = 0;
+}
+
+static void add(uint32_t pgn, uint8_t destination, uint32_t timeout, int tag)
+{
+    CHECK_EQ(e32_requests_add(&g_reqs, 0, pgn, destination, timeout, note_done, (void*)(intptr_t)tag), E32_OK);
+}
+
+static void start(uint32_t now)
+{
+    e32_requests_start(&g_reqs, now, record_send, NULL);
+}
+
+/* Response from sa to da */
+static void respond(uint32_t pgn, uint8_t sa, uint8_t da)
+{
+    static const uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    e32_j1939_view_t view;
+    memset(&view, 0, sizeof(view));
+    view.data = data;
+    view.len = 8;
+    view.pgn = pgn;
+    view.source_address = sa;
+    view.destination_address = da;
+    e32_requests_match(&g_reqs, &view, OWN_SA);
+}
+
+static void acknowledge(uint8_t control, uint32_t pgn, uint8_t sa, uint8_t requester)
+{
+    uint8_t data[8] = { control, 0xFF, 0xFF, 0xFF, requester,
+                        (uint8_t)pgn, (uint8_t)(pgn >> 8), (uint8_t)(pgn >> 16) };
+    e32_j1939_view_t view;
+    memset(&view, 0, sizeof(view));
+    view.data = data;
+    view.len = 8;
+    view.pgn = E32_PGN_ACKNOWLEDGMENT;
+    view.source_address = sa;
+    view.destination_address = E32_SA_GLOBAL;
+    e32_requests_match(&g_reqs, &view, OWN_SA);
+}
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void matches_pgn_and_source(void)
+{
+    reset();
+    add(PGN_ID, 0x10, 0, 1);
+    add(PGN_ID, 0x11, 0, 2);
+    add(PGN_SOFT, 0x11, 0, 3);      /* Waits: 0x11 already has one in flight */
+    start(0);
+    CHECK_EQ(g_sent_count, 2);
+    CHECK(e32_requests_expects(&g_reqs, PGN_ID));
+    CHECK(!e32_requests_expects(&g_reqs, PGN_SOFT));
+
+    respond(PGN_SOFT, 0x11, E32_SA_GLOBAL);     /* Not requested yet */
+    respond(PGN_ID, 0x12, E32_SA_GLOBAL);       /* Nobody asked 0x12 */
+    respond(PGN_ID, 0x11, 0x50);                /* Addressed to another node */
+    CHECK_EQ(g_done_count, 0);
+
+    respond(PGN_ID, 0x11, OWN_SA);
+    CHECK_EQ(g_done_count, 1);
+    CHECK_EQ(g_done_tag[0], 2);
+    CHECK_EQ(g_done_status[0], E32_OK);
+    CHECK_EQ(g_done_sa[0], 0x11);
+
+    /* 0x11 is free again: the waiting request goes out */
+    start(10);
+    CHECK_EQ(g_sent_count, 3);
+    CHECK_EQ(g_sent[2], (0x11u << 24) | PGN_SOFT);
+    respond(PGN_SOFT, 0x11, E32_SA_GLOBAL);
+    respond(PGN_ID, 0x10, E32_SA_GLOBAL);
+    CHECK_EQ(g_done_count, 3);
+    CHECK_EQ(g_reqs.in_flight, 0);
+}
+
+static void acknowledgments(void)
+{
+    reset();
+    add(PGN_ID, 0x10, 0, 1);
+    add(PGN_ID, 0x11, 0, 2);
+    add(PGN_ID, 0x12, 0, 3);
+    start(0);
+
+    acknowledge(1, PGN_ID, 0x10, 0x55);         /* NACK to another requester */
+    acknowledge(0, PGN_SOFT, 0x10, OWN_SA);     /* About another PGN */
+    CHECK_EQ(g_done_count, 0);
+
+    acknowledge(1, PGN_ID, 0x10, OWN_SA);
+    acknowledge(3, PGN_ID, 0x11, E32_SA_GLOBAL);    /* Pre-2006 node */
+    acknowledge(0, PGN_ID, 0x12, OWN_SA);
+    CHECK_EQ(g_done_count, 3);
+    CHECK_EQ(g_done_status[0], E32_ERR_NOT_SUPPORTED);
+    CHECK_EQ(g_done_status[1], E32_ERR_BUSY);
+    CHECK_EQ(g_done_status[2], E32_OK);
+    CHECK_EQ(g_done_sa[1], 0x11);
+}
+
+static void limits_in_flight(void)
+{
+    reset();
+    /* Two to 0x10 first, then one to each of ten other ECUs */
+    add(PGN_ID, 0x10, 0, 100);
+    add(PGN_SOFT, 0x10, 0, 101);
+    for (int i = 0; i < 10; i++) {
+        add(PGN_ID, (uint8_t)(0x30 + i), 0, i);
+    }
+    start(0);
+    CHECK_EQ(g_sent_count, E32_CFG_REQUEST_IN_FLIGHT);
+    CHECK_EQ(g_reqs.in_flight, E32_CFG_REQUEST_IN_FLIGHT);
+    CHECK_EQ(g_sent[0], (0x10u << 24) | PGN_ID);
+    CHECK_EQ(g_sent[1], (0x30u << 24) | PGN_ID);     /* Passed the second 0x10 request */
+
+    /* A freed slot goes to the oldest request that may start */
+    respond(PGN_ID, 0x10, OWN_SA);
+    start(1);
+    CHECK_EQ(g_sent[E32_CFG_REQUEST_IN_FLIGHT], (0x10u << 24) | PGN_SOFT);
+
+    /* The transmit path refuses: nothing is lost or reordered */
+    respond(PGN_ID, 0x30, OWN_SA);
+    respond(PGN_ID, 0x31, OWN_SA);
+    g_send_result = E32_ERR_BUSY;
+    start(2);
+    CHECK_EQ(g_reqs.in_flight, E32_CFG_REQUEST_IN_FLIGHT - 2);
+    g_send_result = E32_OK;
+    start(3);
+    CHECK_EQ(g_reqs.in_flight, E32_CFG_REQUEST_IN_FLIGHT);
+    CHECK_EQ(g_sent[E32_CFG_REQUEST_IN_FLIGHT + 1], ((0x30u + E32_CFG_REQUEST_IN_FLIGHT - 1) << 24) | PGN_ID);
+    CHECK_EQ(g_sent[E32_CFG_REQUEST_IN_FLIGHT + 2], ((0x30u + E32_CFG_REQUEST_IN_FLIGHT) << 24) | PGN_ID);
+
+    /* Nine pending: the table is full once every entry is */
+    for (int i = 9; i < E32_CFG_REQUEST_MAX; i++) {
+        add(PGN_SOFT, (uint8_t)(0x80 + i), 0, 200 + i);
+    }
+    CHECK_EQ(e32_requests_add(&g_reqs, 0, PGN_ID, 0x90, 0, NULL, NULL), E32_ERR_NO_MEMORY);
+}
+
+static void deadlines_and_errors(void)
+{
+    reset();
+    add(PGN_ID, 0x10, 100, 1);
+    add(PGN_ID, 0x11, 0, 2);
+    start(1000);
+    CHECK_EQ(e32_requests_next_timeout(&g_reqs, 1000), 100);
+    CHECK_EQ(e32_requests_next_timeout(&g_reqs, 1150), 0);
+
+    e32_requests_expire(&g_reqs, 1099);
+    CHECK_EQ(g_done_count, 0);
+    e32_requests_expire(&g_reqs, 1100);
+    CHECK_EQ(g_done_count, 1);
+    CHECK_EQ(g_done_status[0], E32_ERR_TIMEOUT);
+    CHECK_EQ(g_done_sa[0], E32_SA_NULL);
+    CHECK_EQ(e32_requests_next_timeout(&g_reqs, 1100), E32_REQUEST_TIMEOUT_MS - 100);
+
+    /* A late answer to an expired request is ignored */
+    respond(PGN_ID, 0x10, OWN_SA);
+    CHECK_EQ(g_done_count, 1);
+
+    /* A send error is reported by the next expire */
+    add(PGN_SOFT, 0x12, 0, 3);
+    g_send_result = E32_ERR_IO;
+    start(1200);
+    CHECK_EQ(g_done_count, 1);
+    e32_requests_expire(&g_reqs, 1200);
+    CHECK_EQ(g_done_count, 2);
+    CHECK_EQ(g_done_status[1], E32_ERR_IO);
+
+    e32_requests_cancel(&g_reqs, E32_ERR_NOT_CONNECTED);
+    CHECK_EQ(g_done_count, 3);
+    CHECK_EQ(g_done_tag[2], 2);
+    CHECK_EQ(g_done_status[2], E32_ERR_NOT_CONNECTED);
+    CHECK_EQ(e32_requests_next_timeout(&g_reqs, 1200), UINT32_MAX);
+}
+
+static void global_collects(void)
+{
+    reset();
+    add(PGN_ID, E32_SA_GLOBAL, 200, 1);
+    start(0);
+    respond(PGN_ID, 0x10, E32_SA_GLOBAL);
+    respond(PGN_ID, 0x11, E32_SA_GLOBAL);
+    acknowledge(1, PGN_ID, 0x12, OWN_SA);       /* Not an answer to a global request */
+    CHECK_EQ(g_done_count, 2);
+    CHECK_EQ(g_done_sa[0], 0x10);
+    CHECK_EQ(g_done_sa[1], 0x11);
+    CHECK_EQ(g_reqs.in_flight, 1);
+
+    e32_requests_expire(&g_reqs, 200);
+    CHECK_EQ(g_done_count, 3);
+    CHECK_EQ(g_done_status[2], E32_ERR_TIMEOUT);
+    CHECK_EQ(g_reqs.in_flight, 0);
+}
+
+/* Each completion asks the next ECU, reusing the freed entry */
+static void ask_next(e32_error_t status, const e32_j1939_view_t* response, void* user_data)
+{
+    note_done(status, response, user_data);
+    int n = (int)(intptr_t)user_data;
+    if (n < 5) {
+        CHECK_EQ(e32_requests_add(&g_reqs, 0, PGN_ID, (uint8_t)(0x10 + n + 1), 0,
+                                  ask_next, (void*)(intptr_t)(n + 1)), E32_OK);
+    }
+}
+
+static void callbacks_submit_again(void)
+{
+    reset();
+    e32_requests_add(&g_reqs, 0, PGN_ID, 0x10, 0, ask_next, (void*)(intptr_t)0);
+    for (int n = 0; n <= 5; n++) {
+        start((uint32_t)n);
+        respond(PGN_ID, (uint8_t)(0x10 + n), OWN_SA);
+    }
+    CHECK_EQ(g_sent_count, 6);
+    CHECK_EQ(g_done_count, 6);
+    CHECK_EQ(g_done_tag[5], 5);
+    CHECK_EQ(g_reqs.in_flight, 0);
+    CHECK_EQ(g_reqs.wait_head, E32_REQUEST_NIL);
+}
+
+static int g_requests_seen;
+
+static void count_request(const e32_j1939_view_t* view, void* user)
+{
+    (void)user;
+    if (view->len == 3 && (view->data[0] | (view->data[1] << 8) | (view->data[2] << 16)) == PGN_ID) {
+        g_requests_seen++;
+    }
+}
+
+static void client_round_trip(void)
+{
+    e32_vbus_t* bus = test_bus("vreq0");
+    e32_j1939_on_pgn_view(test_client("vreq0", 0x40), E32_PGN_REQUEST, count_request, NULL, NULL);
+    e32_j1939_client_t client = test_client("vreq0", OWN_SA);
+    g_requests_seen = 0;
+    g_done_count = 0;
+
+    CHECK_EQ(e32_j1939_request_async(client, 0, PGN_ID, 0x30, 0, note_done, (void*)(intptr_t)1), E32_OK);
+    CHECK_EQ(e32_j1939_request_async(client, 0, PGN_ID, 0x31, 50, note_done, (void*)(intptr_t)2), E32_OK);
+    CHECK_EQ(e32_j1939_request_async(client, 1, PGN_ID, 0x31, 50, note_done, NULL), E32_ERR_INVALID_PARAM);
+    test_run(5);
+    CHECK_EQ(g_requests_seen, 2);
+
+    const uint8_t id[8] = { 'E', '3', '2', '*', 'X', '*', '1', '*' };
+    test_inject(bus, PGN_ID, 0x30, E32_SA_GLOBAL, 6, id);
+    CHECK_EQ(g_done_count, 1);
+    CHECK_EQ(g_done_tag[0], 1);
+    CHECK_EQ(g_done_status[0], E32_OK);
+    CHECK_EQ(g_done_sa[0], 0x30);
+
+    test_run(50);
+    CHECK_EQ(g_done_count, 2);
+    CHECK_EQ(g_done_tag[1], 2);
+    CHECK_EQ(g_done_status[1], E32_ERR_TIMEOUT);
+    test_teardown();
+}
+
+int main(void)
+{
+    RUN(matches_pgn_and_source);
+    RUN(acknowledgments);
+    RUN(limits_in_flight);
+    RUN(deadlines_and_errors);
+    RUN(global_collects);
+    RUN(callbacks_submit_again);
+    RUN(client_round_trip);
+    return TEST_RESULT();
+}
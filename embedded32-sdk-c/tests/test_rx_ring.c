@@ -0,0 +1,246 @@
+/**
+ * @file test_rx_ring.c
+ * @brief Embedded32 SDK - Receive Ring Tests
+ *
+ * The SPSC ring on its own, then one producer and one consumer thread.
+ *
+ * Tests:
+ * - Frames come out in order across the slot wrap and the 32-bit index wrap
+ * - A full ring refuses and counts; reserve/commit and peek stop at the wrap
+ * - High-water events for single pushes and for batches jumping the mark
+ * - Threads: every frame arrives once, in order (run under TSan to check
+ *   the orderings)
+ */
+
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "e32_test.h"
+#include "e32_rx_ring.h"
+#include <string.h>
+
+#ifndef E32_CFG_NO_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#define RING    E32_CFG_RX_RING_SIZE
+
+static e32_rx_ring_t g_ring;
+
+static e32_can_frame_t numbered(uint32_t n)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = n & 0x1FFFFFFF;
+    frame.dlc = 8;
+    memcpy(frame.data, &n, sizeof(n));
+    return frame;
+}
+
+static uint32_t number_of(const e32_can_frame_t* frame)
+{
+    uint32_t n;
+    memcpy(&n, frame->data, sizeof(n));
+    return n;
+}
+
+/* Take up to max frames, checking they continue from *next */
+static uint32_t drain(e32_rx_ring_t* ring, uint32_t max, uint32_t* next)
+{
+    uint32_t taken = 0;
+    while (taken < max) {
+        e32_can_frame_t* first;
+        uint32_t n = e32_rx_ring_peek(ring, &first);
+        if (n == 0) {
+            break;
+        }
+        if (n > max - taken) {
+            n = max - taken;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            CHECK_EQ(number_of(&first[i]), *next);
+            (*next)++;
+        }
+        e32_rx_ring_release(ring, n);
+        taken += n;
+    }
+    return taken;
+}
+
+static void fifo_across_index_wrap(void)
+{
+    e32_rx_ring_init(&g_ring, 0);
+    /* Free-running indices a few frames short of wrapping */
+    g_ring.head = g_ring.tail = 0xFFFFFFFFu - RING / 2;
+
+    uint32_t pushed = 0, next = 0;
+    for (int round = 0; round < 5; round++) {
+        for (uint32_t i = 0; i < RING - 3; i++) {
+            e32_can_frame_t frame = numbered(pushed);
+            CHECK_EQ(e32_rx_ring_push(&g_ring, &frame), E32_OK);
+            pushed++;
+        }
+        CHECK_EQ(e32_rx_ring_depth(&g_ring), RING - 3);
+        CHECK_EQ(drain(&g_ring, RING, &next), RING - 3);
+    }
+    CHECK_EQ(next, pushed);
+    CHECK_EQ(e32_rx_ring_depth(&g_ring), 0);
+    CHECK_EQ(g_ring.overflows, 0);
+}
+
+static void full_ring_refuses(void)
+{
+    e32_rx_ring_init(&g_ring, 0);
+    for (uint32_t i = 0; i < RING; i++) {
+        e32_can_frame_t frame = numbered(i);
+        CHECK_EQ(e32_rx_ring_push(&g_ring, &frame), E32_OK);
+    }
+    e32_can_frame_t extra = numbered(RING);
+    CHECK_EQ(e32_rx_ring_push(&g_ring, &extra), E32_ERR_NO_MEMORY);
+    CHECK_EQ(e32_rx_ring_push(&g_ring, &extra), E32_ERR_NO_MEMORY);
+    CHECK_EQ(g_ring.overflows, 2);
+    CHECK_EQ(g_ring.peak_depth, RING);
+
+    uint32_t room = 99;
+    e32_rx_ring_reserve(&g_ring, &room);
+    CHECK_EQ(room, 0);
+
+    /* Dropped frames never show up: the ring still holds 0 .. RING-1 */
+    uint32_t next = 0;
+    CHECK_EQ(drain(&g_ring, 2 * RING, &next), RING);
+}
+
+static void runs_stop_at_the_wrap(void)
+{
+    e32_rx_ring_init(&g_ring, 0);
+    uint32_t pushed = 0, next = 0;
+
+    /* Move the indices to 3 slots before the end of the array */
+    for (uint32_t i = 0; i < RING - 3; i++) {
+        e32_can_frame_t frame = numbered(pushed++);
+        e32_rx_ring_push(&g_ring, &frame);
+    }
+    drain(&g_ring, RING, &next);
+
+    uint32_t room = 0;
+    e32_can_frame_t* slots = e32_rx_ring_reserve(&g_ring, &room);
+    CHECK_EQ(room, 3);
+    for (uint32_t i = 0; i < room; i++) {
+        slots[i] = numbered(pushed++);
+    }
+    e32_rx_ring_commit(&g_ring, room);
+
+    slots = e32_rx_ring_reserve(&g_ring, &room);
+    CHECK_EQ(room, RING - 3);
+    CHECK(slots == &g_ring.slots[0]);
+    for (uint32_t i = 0; i < 5; i++) {
+        slots[i] = numbered(pushed++);
+    }
+    e32_rx_ring_commit(&g_ring, 5);
+
+    e32_can_frame_t* first;
+    CHECK_EQ(e32_rx_ring_peek(&g_ring, &first), 3);     /* Up to the end of the array */
+    CHECK_EQ(drain(&g_ring, RING, &next), 8);
+    CHECK_EQ(next, pushed);
+}
+
+static void counts_high_water(void)
+{
+    e32_rx_ring_init(&g_ring, 4);
+    uint32_t next = 0, pushed = 0;
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 6; i++) {
+            e32_can_frame_t frame = numbered(pushed++);
+            e32_rx_ring_push(&g_ring, &frame);
+        }
+        drain(&g_ring, RING, &next);
+    }
+    CHECK_EQ(g_ring.high_water_events, 3);      /* Once per climb past the mark */
+
+    /* A batch from 2 to 7 passes the mark without landing on it */
+    for (int i = 0; i < 2; i++) {
+        e32_can_frame_t frame = numbered(pushed++);
+        e32_rx_ring_push(&g_ring, &frame);
+    }
+    uint32_t room = 0;
+    e32_can_frame_t* slots = e32_rx_ring_reserve(&g_ring, &room);
+    CHECK(room >= 5);
+    for (uint32_t i = 0; i < 5; i++) {
+        slots[i] = numbered(pushed++);
+    }
+    e32_rx_ring_commit(&g_ring, 5);
+    CHECK_EQ(g_ring.high_water_events, 4);
+    CHECK_EQ(g_ring.peak_depth, 7);
+    drain(&g_ring, RING, &next);
+    CHECK_EQ(next, pushed);
+}
+
+#ifndef E32_CFG_NO_THREADS
+
+#define STREAM  50000u
+
+static void* produce(void* arg)
+{
+    (void)arg;
+    uint32_t n = 0;
+    while (n < STREAM) {
+        if (n % 3 == 0) {
+            uint32_t room = 0;
+            e32_can_frame_t* slots = e32_rx_ring_reserve(&g_ring, &room);
+            uint32_t batch = room < 7 ? room : 7;
+            if (batch > STREAM - n) {
+                batch = STREAM - n;
+            }
+            for (uint32_t i = 0; i < batch; i++) {
+                slots[i] = numbered(n + i);
+            }
+            e32_rx_ring_commit(&g_ring, batch);
+            n += batch;
+            if (batch == 0) {
+                sched_yield();      /* Full: let the consumer run */
+            }
+        } else {
+            e32_can_frame_t frame = numbered(n);
+            if (e32_rx_ring_push(&g_ring, &frame) == E32_OK) {
+                n++;
+            } else {
+                sched_yield();
+            }
+        }
+    }
+    return NULL;
+}
+
+static void threads_keep_order(void)
+{
+    e32_rx_ring_init(&g_ring, 0);
+    pthread_t producer;
+    CHECK_EQ(pthread_create(&producer, NULL, produce, NULL), 0);
+
+    uint32_t next = 0;
+    while (next < STREAM) {
+        if (drain(&g_ring, 5, &next) == 0) {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+    CHECK_EQ(next, STREAM);
+    CHECK_EQ(e32_rx_ring_depth(&g_ring), 0);
+}
+
+#endif
+
+int main(void)
+{
+    RUN(fifo_across_index_wrap);
+    RUN(full_ring_refuses);
+    RUN(runs_stop_at_the_wrap);
+    RUN(counts_high_water);
+#ifndef E32_CFG_NO_THREADS
+    RUN(threads_keep_order);
+#endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,193 @@
+/**
+ * @file test_send.c
+ * @brief Embedded32 SDK - Channel Selection Tests
+ *
+ * A two-channel client on vsend0 and vsend1 with a listener on each bus.
+ *
+ * Tests:
+ * - Async, cyclic and engine control frames go out on the chosen channel
+ * - The plain calls keep using channel 0
+ * - Out-of-range channels are refused
+ * - Registering a cyclic PGN again moves it to the new channel
+ * - CAN FD builds: cyclic payloads over 8 bytes go out as padded FD
+ *   frames, and are skipped by a classic client
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+
+#define PGN_PROP_B      0xFF20
+#define PGN_PROP_C      0xFF30
+
+static uint32_t g_seen[2][3];   /* [bus][PROP_B, PROP_C, ENGINE_CONTROL_CMD] */
+
+static void count_frame(const e32_j1939_view_t* view, void* user)
+{
+    int bus = (int)(intptr_t)user;
+    if (view->pgn == PGN_PROP_B) {
+        g_seen[bus][0]++;
+    } else if (view->pgn == PGN_PROP_C) {
+        g_seen[bus][1]++;
+    } else if (view->pgn == E32_PGN_ENGINE_CONTROL_CMD) {
+        g_seen[bus][2]++;
+    }
+}
+
+static bool fill_prop_c(uint32_t pgn, uint8_t* data, uint8_t* len, void* user)
+{
+    (void)pgn; (void)user;
+    memset(data, 0x5A, 8);
+    *len = 8;
+    return true;
+}
+
+static e32_j1939_client_t g_sender;
+
+static void setup(void)
+{
+    test_bus("vsend0");
+    test_bus("vsend1");
+
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.channel_count = 2;
+    config.channels[0] = "vsend0";
+    config.channels[1] = "vsend1";
+    g_sender = test_client_ex(&config, 0x80);
+
+    memset(g_seen, 0, sizeof(g_seen));
+    e32_j1939_on_pgn_view(test_client("vsend0", 0x30), E32_PGN_ANY, count_frame, (void*)(intptr_t)0, NULL);
+    e32_j1939_on_pgn_view(test_client("vsend1", 0x31), E32_PGN_ANY, count_frame, (void*)(intptr_t)1, NULL);
+}
+
+static void sends_on_chosen_channel(void)
+{
+    setup();
+    const uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    e32_engine_control_cmd_t cmd = { 1500, true, E32_FAULT_NONE };
+
+    CHECK_EQ(e32_j1939_send_async_on(g_sender, 1, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6, 0, NULL, NULL), E32_OK);
+    CHECK_EQ(e32_j1939_send_engine_control_on(g_sender, 1, &cmd), E32_OK);
+    CHECK_EQ(e32_j1939_add_cyclic_on(g_sender, 1, PGN_PROP_C, 10, 6, E32_SA_GLOBAL, fill_prop_c, NULL), E32_OK);
+    test_run(25);
+
+    CHECK_EQ(g_seen[1][0], 1);
+    CHECK_EQ(g_seen[1][2], 1);
+    CHECK(g_seen[1][1] >= 2);
+    CHECK_EQ(g_seen[0][0], 0);
+    CHECK_EQ(g_seen[0][1], 0);
+    CHECK_EQ(g_seen[0][2], 0);
+    test_teardown();
+}
+
+static void plain_calls_use_channel_0(void)
+{
+    setup();
+    const uint8_t data[8] = { 0 };
+    e32_engine_control_cmd_t cmd = { 800, false, E32_FAULT_NONE };
+
+    CHECK_EQ(e32_j1939_send_async(g_sender, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6, 0, NULL, NULL), E32_OK);
+    CHECK_EQ(e32_j1939_send_engine_control(g_sender, &cmd), E32_OK);
+    CHECK_EQ(e32_j1939_add_cyclic(g_sender, PGN_PROP_C, 10, 6, E32_SA_GLOBAL, fill_prop_c, NULL), E32_OK);
+    test_run(25);
+
+    CHECK_EQ(g_seen[0][0], 1);
+    CHECK_EQ(g_seen[0][2], 1);
+    CHECK(g_seen[0][1] >= 2);
+    CHECK_EQ(g_seen[1][0] + g_seen[1][1] + g_seen[1][2], 0);
+    test_teardown();
+}
+
+static void refuses_unknown_channel(void)
+{
+    setup();
+    const uint8_t data[8] = { 0 };
+    e32_engine_control_cmd_t cmd = { 800, false, E32_FAULT_NONE };
+
+    CHECK_EQ(e32_j1939_send_async_on(g_sender, 2, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6, 0, NULL, NULL),
+             E32_ERR_INVALID_PARAM);
+    CHECK_EQ(e32_j1939_send_engine_control_on(g_sender, 2, &cmd), E32_ERR_INVALID_PARAM);
+    CHECK_EQ(e32_j1939_add_cyclic_on(g_sender, 2, PGN_PROP_C, 10, 6, E32_SA_GLOBAL, fill_prop_c, NULL),
+             E32_ERR_INVALID_PARAM);
+    test_teardown();
+}
+
+static void cyclic_moves_between_channels(void)
+{
+    setup();
+    CHECK_EQ(e32_j1939_add_cyclic_on(g_sender, 0, PGN_PROP_C, 10, 6, E32_SA_GLOBAL, fill_prop_c, NULL), E32_OK);
+    test_run(25);
+    uint32_t on_first = g_seen[0][1];
+    CHECK(on_first >= 2);
+
+    CHECK_EQ(e32_j1939_add_cyclic_on(g_sender, 1, PGN_PROP_C, 10, 6, E32_SA_GLOBAL, fill_prop_c, NULL), E32_OK);
+    test_run(25);
+    CHECK_EQ(g_seen[0][1], on_first);
+    CHECK(g_seen[1][1] >= 2);
+    test_teardown();
+}
+
+#ifdef E32_CFG_CAN_FD
+
+static e32_can_frame_t g_fd_frame;
+static uint32_t        g_fd_seen;
+
+static void keep_frame(const e32_j1939_view_t* view, void* user)
+{
+    (void)user;
+    g_fd_frame = *view->frame;
+    g_fd_seen++;
+}
+
+static bool fill_13(uint32_t pgn, uint8_t* data, uint8_t* len, void* user)
+{
+    (void)pgn; (void)user;
+    memset(data, 0x5A, 13);
+    *len = 13;
+    return true;
+}
+
+static void cyclic_fd_payloads(void)
+{
+    test_bus("vsend2");
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.interface_name = "vsend2";
+    config.can_fd = true;
+    e32_j1939_client_t fd = test_client_ex(&config, 0x80);
+    e32_j1939_client_t classic = test_client("vsend2", 0x81);
+    e32_j1939_client_t listener = test_client("vsend2", 0x30);
+    g_fd_seen = 0;
+    CHECK_EQ(e32_j1939_on_pgn_view(listener, PGN_PROP_C, keep_frame, NULL, NULL), E32_OK);
+
+    CHECK_EQ(e32_j1939_add_cyclic(fd, PGN_PROP_C, 10, 6, E32_SA_GLOBAL, fill_13, NULL), E32_OK);
+    CHECK_EQ(e32_j1939_add_cyclic(classic, PGN_PROP_B, 10, 6, E32_SA_GLOBAL, fill_13, NULL), E32_OK);
+    test_run(25);
+
+    CHECK(g_fd_seen >= 2);
+    CHECK_EQ(g_fd_frame.flags, E32_CAN_FLAG_FD | E32_CAN_FLAG_BRS);
+    CHECK_EQ(g_fd_frame.dlc, 16);
+    CHECK_EQ(g_fd_frame.data[12], 0x5A);
+    CHECK_EQ(g_fd_frame.data[13], E32_CPG_PADDING);
+    CHECK_EQ(g_fd_frame.data[15], E32_CPG_PADDING);
+
+    e32_cyclic_stats_t stats;
+    CHECK_EQ(e32_j1939_get_cyclic_stats(classic, PGN_PROP_B, &stats), E32_OK);
+    CHECK_EQ(stats.sent, 0);
+    CHECK(stats.skipped >= 2);
+    test_teardown();
+}
+
+#endif
+
+int main(void)
+{
+    RUN(sends_on_chosen_channel);
+    RUN(plain_calls_use_channel_0);
+    RUN(refuses_unknown_channel);
+    RUN(cyclic_moves_between_channels);
+#ifdef E32_CFG_CAN_FD
+    RUN(cyclic_fd_payloads);
+#endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,206 @@
+/**
+ * @file test_signals.c
+ * @brief Embedded32 SDK - Signal Cache Tests
+ *
+ * The last-value table on its own, then one writer thread against
+ * reader threads.
+ *
+ * Tests:
+ * - Values, status and freshness follow the frames of the tracked sender
+ * - Short payloads keep the previous value; other senders are ignored
+ * - Track/find/untrack, a full table, and the PGN summary bits
+ * - Threads: readers only ever see whole updates (run under TSan to
+ *   check the orderings)
+ */
+
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "e32_test.h"
+#include "e32_signals.h"
+#include <string.h>
+
+#ifndef E32_CFG_NO_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static e32_signals_t g_table;
+
+/* EEC1 from sa with raw engine speed and torque */
+static e32_j1939_view_t eec1(uint8_t sa, uint16_t speed, uint8_t torque, uint8_t* data)
+{
+    memset(data, 0xFF, 8);
+    data[2] = torque;
+    data[3] = (uint8_t)speed;
+    data[4] = (uint8_t)(speed >> 8);
+
+    e32_j1939_view_t view;
+    memset(&view, 0, sizeof(view));
+    view.data = data;
+    view.len = 8;
+    view.pgn = E32_PGN_EEC1;
+    view.source_address = sa;
+    view.destination_address = E32_SA_GLOBAL;
+    return view;
+}
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void follows_the_sender(void)
+{
+    e32_signals_init(&g_table);
+    uint16_t speed, torque;
+    CHECK_EQ(e32_signals_track(&g_table, 0x00, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, 100, &speed), E32_OK);
+    CHECK_EQ(e32_signals_track(&g_table, 0x00, E32_PGN_EEC1, E32_SPN_ENGINE_TORQUE, 0, &torque), E32_OK);
+
+    e32_signal_value_t v;
+    CHECK_EQ(e32_signals_read(&g_table, speed, 10, &v), E32_OK);
+    CHECK_EQ(v.state, E32_SIGNAL_NO_DATA);
+    CHECK_EQ(v.updates, 0);
+
+    uint8_t data[8];
+    e32_j1939_view_t view = eec1(0x00, 1500 * 8, 125 + 40, data);
+    e32_signals_update(&g_table, &view, 1000);
+    CHECK_EQ(e32_signals_read(&g_table, speed, 1050, &v), E32_OK);
+    CHECK_EQ(v.state, E32_SIGNAL_FRESH);
+    CHECK_EQ(v.spn.status, E32_SPN_STATUS_OK);
+    CHECK_EQ(v.spn.value, 1500 * 8);            /* 1/8 rpm */
+    CHECK_EQ(v.age_ms, 50);
+    CHECK_EQ(v.updated_ms, 1000);
+    CHECK_EQ(v.source_address, 0x00);
+    CHECK_EQ(v.pgn, E32_PGN_EEC1);
+    CHECK_EQ(e32_signals_read(&g_table, torque, 1050, &v), E32_OK);
+    CHECK_EQ(v.spn.value, 40);
+
+    /* Stale only for a signal with a maximum age */
+    CHECK_EQ(e32_signals_read(&g_table, speed, 1101, &v), E32_OK);
+    CHECK_EQ(v.state, E32_SIGNAL_STALE);
+    CHECK_EQ(e32_signals_read(&g_table, torque, 90000, &v), E32_OK);
+    CHECK_EQ(v.state, E32_SIGNAL_FRESH);
+
+    /* Another sender, then a short frame: the value stays */
+    view = eec1(0x01, 2000 * 8, 125, data);
+    e32_signals_update(&g_table, &view, 1200);
+    view = eec1(0x00, 2000 * 8, 125, data);
+    view.len = 4;
+    e32_signals_update(&g_table, &view, 1200);
+    CHECK_EQ(e32_signals_read(&g_table, speed, 1200, &v), E32_OK);
+    CHECK_EQ(v.spn.value, 1500 * 8);
+    CHECK_EQ(v.updates, 1);
+    CHECK_EQ(e32_signals_read(&g_table, torque, 1200, &v), E32_OK);
+    CHECK_EQ(v.spn.value, 0);                   /* Byte 2 is in the short frame */
+    CHECK_EQ(v.updates, 2);
+
+    /* Not available: status set, value zero, still an update */
+    view = eec1(0x00, 0xFFFF, 0xFF, data);
+    e32_signals_update(&g_table, &view, 1300);
+    CHECK_EQ(e32_signals_read(&g_table, speed, 1300, &v), E32_OK);
+    CHECK_EQ(v.spn.status, E32_SPN_STATUS_NOT_AVAILABLE);
+    CHECK_EQ(v.spn.value, 0);
+    CHECK_EQ(v.updates, 2);
+    CHECK_EQ(v.state, E32_SIGNAL_FRESH);
+}
+
+static void table_management(void)
+{
+    e32_signals_init(&g_table);
+    uint16_t id, again;
+    CHECK_EQ(e32_signals_track(&g_table, 0x00, E32_PGN_EEC1, E32_SPN_COOLANT_TEMP, 0, &id), E32_ERR_NOT_FOUND);
+    CHECK(!e32_signals_wants(&g_table, E32_PGN_EEC1));
+
+    CHECK_EQ(e32_signals_track(&g_table, 0x00, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, 0, &id), E32_OK);
+    CHECK(e32_signals_wants(&g_table, E32_PGN_EEC1));
+    CHECK_EQ(e32_signals_track(&g_table, 0x00, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, 500, &again), E32_OK);
+    CHECK_EQ(again, id);
+    CHECK_EQ(g_table.count, 1);
+    CHECK_EQ(g_table.signals[id].max_age, 500);
+
+    /* Fill the table with one signal per sender */
+    for (int sa = 1; sa < E32_CFG_MAX_SIGNALS; sa++) {
+        CHECK_EQ(e32_signals_track(&g_table, (uint8_t)sa, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, 0, &again), E32_OK);
+    }
+    CHECK_EQ(e32_signals_track(&g_table, 0xF0, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, 0, &again), E32_ERR_NO_MEMORY);
+
+    uint16_t found;
+    CHECK_EQ(e32_signals_find(&g_table, 5, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, &found), E32_OK);
+    CHECK_EQ(e32_signals_untrack(&g_table, found), E32_OK);
+    CHECK_EQ(e32_signals_untrack(&g_table, found), E32_ERR_NOT_FOUND);
+    CHECK_EQ(e32_signals_find(&g_table, 5, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, &found), E32_ERR_NOT_FOUND);
+    e32_signal_value_t v;
+    CHECK_EQ(e32_signals_read(&g_table, found, 0, &v), E32_ERR_NOT_FOUND);
+    CHECK_EQ(e32_signals_track(&g_table, 0xF0, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, 0, &again), E32_OK);
+    CHECK_EQ(again, found);
+
+    /* The summary bits drop a PGN once nothing tracks it */
+    for (uint16_t i = 0; i < E32_CFG_MAX_SIGNALS; i++) {
+        e32_signals_untrack(&g_table, i);
+    }
+    CHECK_EQ(g_table.count, 0);
+    CHECK(!e32_signals_wants(&g_table, E32_PGN_EEC1));
+}
+
+#ifndef E32_CFG_NO_THREADS
+
+#define UPDATES     50000u      /* Raw speeds stay below the error range */
+#define READERS     2
+
+static uint16_t g_speed_id;
+
+/* Update n carries raw speed n at time 2n: every word follows from updates */
+static void* read_signals(void* arg)
+{
+    int* torn = (int*)arg;
+    uint32_t last = 0;
+    while (last < UPDATES) {
+        e32_signal_value_t v;
+        e32_signals_read(&g_table, g_speed_id, 0, &v);
+        if ((uint32_t)v.spn.value != v.updates || v.updated_ms != 2 * v.updates || v.updates < last) {
+            (*torn)++;
+        }
+        last = v.updates;
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void readers_see_whole_updates(void)
+{
+    e32_signals_init(&g_table);
+    CHECK_EQ(e32_signals_track(&g_table, 0x00, E32_PGN_EEC1, E32_SPN_ENGINE_SPEED, 0, &g_speed_id), E32_OK);
+
+    pthread_t readers[READERS];
+    int torn[READERS] = { 0 };
+    for (int r = 0; r < READERS; r++) {
+        CHECK_EQ(pthread_create(&readers[r], NULL, read_signals, &torn[r]), 0);
+    }
+
+    uint8_t data[8];
+    for (uint32_t n = 1; n <= UPDATES; n++) {
+        e32_j1939_view_t view = eec1(0x00, (uint16_t)n, 125, data);
+        e32_signals_update(&g_table, &view, 2 * n);
+        if (n % 64 == 0) {
+            sched_yield();
+        }
+    }
+
+    for (int r = 0; r < READERS; r++) {
+        pthread_join(readers[r], NULL);
+        CHECK_EQ(torn[r], 0);
+    }
+}
+
+#endif
+
+int main(void)
+{
+    RUN(follows_the_sender);
+    RUN(table_management);
+#ifndef E32_CFG_NO_THREADS
+    RUN(readers_see_whole_updates);
+#endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,410 @@
+/**
+ * @file test_tp.c
+ * @brief Embedded32 SDK - J1939-21 Transport Protocol Tests
+ *
+ * Two clients on a manual-clock virtual bus, plus a listener that logs
+ * every TP.CM frame. The peer side of protocol edge cases is scripted
+ * with e32_vbus_inject(). Built against a library with
+ * E32_CFG_TP_MAX_LEN=512 so oversize announcements can be tested.
+ *
+ * Tests:
+ * - BAM and RTS/CTS reassembly end to end
+ * - BAM sequence gap and T1 timeout
+ * - Receiver T1/T2 timeouts, gap-resync CTS, oversize RTS
+ * - Sender T3 timeout, CTS hold (T4), aborts in both directions
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+
+#define PGN_PROP_B      0xFF10
+#define SA_A            0x10
+#define SA_B            0x20
+#define SA_LISTENER     0x30
+#define SA_PEER         0x50
+
+#define CM_RTS          16
+#define CM_CTS          17
+#define CM_EOM_ACK      19
+#define CM_BAM          32
+#define CM_ABORT        255
+
+/* ==========================================================================
+ * FIXTURE
+ * ========================================================================== */
+
+typedef struct {
+    uint8_t sa;
+    uint8_t da;
+    uint8_t data[8];
+} cm_log_t;
+
+static e32_vbus_t*        g_bus;
+static e32_j1939_client_t g_a;
+static e32_j1939_client_t g_b;
+static cm_log_t           g_cm[256];
+static int                g_cm_count;
+static uint8_t            g_payload[E32_CFG_TP_MAX_LEN];
+static uint16_t           g_payload_len;
+static int                g_delivered;
+
+static void log_cm(const e32_j1939_view_t* view, void* user)
+{
+    (void)user;
+    if (g_cm_count < (int)(sizeof(g_cm) / sizeof(g_cm[0]))) {
+        cm_log_t* entry = &g_cm[g_cm_count++];
+        entry->sa = view->source_address;
+        entry->da = view->destination_address;
+        memcpy(entry->data, view->data, 8);
+    }
+}
+
+static void on_message(const e32_j1939_message_t* msg, void* user)
+{
+    (void)user;
+    uint16_t len;
+    const uint8_t* data = e32_msg_data(msg, &len);
+    memcpy(g_payload, data, len);
+    g_payload_len = len;
+    g_delivered++;
+}
+
+static void setup(void)
+{
+    g_bus = test_bus("vtp");
+    g_a = test_client("vtp", SA_A);
+    g_b = test_client("vtp", SA_B);
+    e32_j1939_client_t listener = test_client("vtp", SA_LISTENER);
+
+    e32_j1939_on_pgn(g_b, PGN_PROP_B, on_message, NULL, NULL);
+    e32_j1939_on_pgn_view(listener, E32_PGN_TP_CM, log_cm, NULL, NULL);
+
+    g_cm_count = 0;
+    g_payload_len = 0;
+    g_delivered = 0;
+}
+
+/* Last TP.CM frame of the given control byte sent by sa, NULL if none */
+static const cm_log_t* last_cm(uint8_t sa, uint8_t control)
+{
+    for (int i = g_cm_count - 1; i >= 0; i--) {
+        if (g_cm[i].sa == sa && g_cm[i].data[0] == control) {
+            return &g_cm[i];
+        }
+    }
+    return NULL;
+}
+
+static int count_cm(uint8_t sa, uint8_t control)
+{
+    int n = 0;
+    for (int i = 0; i < g_cm_count; i++) {
+        n += g_cm[i].sa == sa && g_cm[i].data[0] == control;
+    }
+    return n;
+}
+
+static void inject_cm(uint8_t sa, uint8_t da, uint8_t control, uint16_t size_or_b1,
+                      uint8_t b3, uint8_t b4)
+{
+    const uint8_t data[8] = {
+        control, (uint8_t)size_or_b1, (uint8_t)(size_or_b1 >> 8), b3, b4,
+        PGN_PROP_B & 0xFF, (PGN_PROP_B >> 8) & 0xFF, 0
+    };
+    test_inject(g_bus, E32_PGN_TP_CM, sa, da, 7, data);
+}
+
+static void inject_cts(uint8_t sa, uint8_t da, uint8_t packets, uint8_t next)
+{
+    const uint8_t data[8] = {
+        CM_CTS, packets, next, 0xFF, 0xFF, PGN_PROP_B & 0xFF, (PGN_PROP_B >> 8) & 0xFF, 0
+    };
+    test_inject(g_bus, E32_PGN_TP_CM, sa, da, 7, data);
+}
+
+static void inject_dt(uint8_t sa, uint8_t da, uint8_t seq)
+{
+    uint8_t data[8];
+    data[0] = seq;
+    for (int i = 1; i < 8; i++) {
+        data[i] = (uint8_t)((seq - 1) * 7 + i - 1);
+    }
+    test_inject(g_bus, E32_PGN_TP_DT, sa, da, 7, data);
+}
+
+static e32_tp_stats_t tp_stats(e32_j1939_client_t client)
+{
+    e32_tp_stats_t stats;
+    e32_j1939_get_tp_stats(client, &stats);
+    return stats;
+}
+
+static void fill(uint8_t* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+}
+
+/* ==========================================================================
+ * BAM
+ * ========================================================================== */
+
+static void bam_100_bytes_arrive_intact(void)
+{
+    setup();
+    uint8_t data[100];
+    fill(data, sizeof(data));
+
+    CHECK_EQ(e32_j1939_send_raw_on(g_a, 0, PGN_PROP_B, data, sizeof(data), E32_SA_GLOBAL, 6), E32_OK);
+    test_run(15 * E32_CFG_TP_BAM_INTERVAL_MS + 10);
+
+    CHECK_EQ(g_delivered, 1);
+    CHECK_EQ(g_payload_len, 100);
+    CHECK(memcmp(g_payload, data, sizeof(data)) == 0);
+    CHECK_EQ(count_cm(SA_A, CM_BAM), 1);
+    CHECK_EQ(tp_stats(g_a).tx_completed, 1);
+    CHECK_EQ(tp_stats(g_b).rx_completed, 1);
+    test_teardown();
+}
+
+static void bam_gap_discards_message(void)
+{
+    setup();
+    inject_cm(SA_PEER, E32_SA_GLOBAL, CM_BAM, 20, 3, 0xFF);
+    inject_dt(SA_PEER, E32_SA_GLOBAL, 1);
+    inject_dt(SA_PEER, E32_SA_GLOBAL, 3);
+    test_run(5);
+
+    CHECK_EQ(g_delivered, 0);
+    CHECK_EQ(tp_stats(g_b).rx_aborted, 1);
+    CHECK_EQ(tp_stats(g_b).rx_active, 0);
+    test_teardown();
+}
+
+static void bam_times_out_after_t1(void)
+{
+    setup();
+    inject_cm(SA_PEER, E32_SA_GLOBAL, CM_BAM, 20, 3, 0xFF);
+    inject_dt(SA_PEER, E32_SA_GLOBAL, 1);
+
+    test_run(740);
+    CHECK_EQ(tp_stats(g_b).rx_active, 1);
+    test_run(20);
+    CHECK_EQ(tp_stats(g_b).rx_active, 0);
+    CHECK_EQ(tp_stats(g_b).rx_timeouts, 1);
+    CHECK_EQ(g_delivered, 0);
+    test_teardown();
+}
+
+/* ==========================================================================
+ * RTS/CTS RECEIVE
+ * ========================================================================== */
+
+static void rts_cts_200_bytes_arrive_intact(void)
+{
+    setup();
+    uint8_t data[200];
+    fill(data, sizeof(data));
+
+    CHECK_EQ(e32_j1939_send_raw_on(g_a, 0, PGN_PROP_B, data, sizeof(data), SA_B, 6), E32_OK);
+    test_run(50);
+
+    CHECK_EQ(g_delivered, 1);
+    CHECK_EQ(g_payload_len, 200);
+    CHECK(memcmp(g_payload, data, sizeof(data)) == 0);
+    CHECK_EQ(count_cm(SA_A, CM_RTS), 1);
+    CHECK_EQ(count_cm(SA_B, CM_CTS), (29 + E32_CFG_TP_CTS_PACKETS - 1) / E32_CFG_TP_CTS_PACKETS);
+    CHECK_EQ(count_cm(SA_B, CM_EOM_ACK), 1);
+    CHECK_EQ(tp_stats(g_a).tx_completed, 1);
+    CHECK_EQ(tp_stats(g_a).tx_active, 0);
+    test_teardown();
+}
+
+static void receiver_honours_packets_per_cts(void)
+{
+    setup();
+    inject_cm(SA_PEER, SA_B, CM_RTS, 35, 5, 2);    /* At most 2 packets per CTS */
+
+    const cm_log_t* cts = last_cm(SA_B, CM_CTS);
+    CHECK(cts != NULL);
+    if (cts) {
+        CHECK_EQ(cts->da, SA_PEER);
+        CHECK_EQ(cts->data[1], 2);
+        CHECK_EQ(cts->data[2], 1);
+    }
+    test_teardown();
+}
+
+static void gap_requests_one_resync_cts(void)
+{
+    setup();
+    inject_cm(SA_PEER, SA_B, CM_RTS, 35, 5, 0xFF);
+    CHECK_EQ(count_cm(SA_B, CM_CTS), 1);
+
+    inject_dt(SA_PEER, SA_B, 1);
+    inject_dt(SA_PEER, SA_B, 3);            /* Packet 2 lost */
+    CHECK_EQ(count_cm(SA_B, CM_CTS), 2);
+    const cm_log_t* cts = last_cm(SA_B, CM_CTS);
+    CHECK(cts && cts->data[2] == 2);        /* Retransmit from 2 */
+
+    inject_dt(SA_PEER, SA_B, 4);            /* Rest of the old window: ignored */
+    CHECK_EQ(count_cm(SA_B, CM_CTS), 2);
+
+    for (uint8_t seq = 2; seq <= 5; seq++) {
+        inject_dt(SA_PEER, SA_B, seq);
+    }
+    CHECK_EQ(g_delivered, 1);
+    CHECK_EQ(g_payload_len, 35);
+    CHECK_EQ(g_payload[7], 7);
+    CHECK_EQ(g_payload[34], 34);
+    CHECK_EQ(count_cm(SA_B, CM_EOM_ACK), 1);
+    test_teardown();
+}
+
+static void receiver_aborts_after_t2(void)
+{
+    setup();
+    inject_cm(SA_PEER, SA_B, CM_RTS, 20, 3, 0xFF);
+
+    test_run(1240);
+    CHECK_EQ(count_cm(SA_B, CM_ABORT), 0);
+    test_run(20);
+    const cm_log_t* abort = last_cm(SA_B, CM_ABORT);
+    CHECK(abort && abort->da == SA_PEER && abort->data[1] == 3);
+    CHECK_EQ(tp_stats(g_b).rx_timeouts, 1);
+    test_teardown();
+}
+
+static void receiver_aborts_after_t1(void)
+{
+    setup();
+    inject_cm(SA_PEER, SA_B, CM_RTS, 20, 3, 0xFF);
+    inject_dt(SA_PEER, SA_B, 1);
+
+    test_run(740);
+    CHECK_EQ(count_cm(SA_B, CM_ABORT), 0);
+    test_run(20);
+    CHECK_EQ(count_cm(SA_B, CM_ABORT), 1);
+    CHECK_EQ(tp_stats(g_b).rx_timeouts, 1);
+    test_teardown();
+}
+
+static void rejects_rts_above_max_len(void)
+{
+    setup();
+    uint16_t size = E32_CFG_TP_MAX_LEN + 7;
+    inject_cm(SA_PEER, SA_B, CM_RTS, size, (uint8_t)((size + 6) / 7), 0xFF);
+
+    CHECK_EQ(count_cm(SA_B, CM_CTS), 0);
+    const cm_log_t* abort = last_cm(SA_B, CM_ABORT);
+    CHECK(abort && abort->da == SA_PEER && abort->data[1] == 2);
+    CHECK_EQ(tp_stats(g_b).rx_no_session, 1);
+    CHECK_EQ(tp_stats(g_b).rx_active, 0);
+    test_teardown();
+}
+
+static void sender_abort_closes_receive_session(void)
+{
+    setup();
+    inject_cm(SA_PEER, SA_B, CM_RTS, 20, 3, 0xFF);
+    CHECK_EQ(tp_stats(g_b).rx_active, 1);
+
+    inject_cm(SA_PEER, SA_B, CM_ABORT, 0xFF01, 0xFF, 0xFF);
+    CHECK_EQ(tp_stats(g_b).rx_active, 0);
+    CHECK_EQ(tp_stats(g_b).rx_aborted, 1);
+    test_teardown();
+}
+
+/* ==========================================================================
+ * RTS/CTS SEND
+ * ========================================================================== */
+
+static void start_send_to_peer(void)
+{
+    uint8_t data[20];
+    fill(data, sizeof(data));
+    CHECK_EQ(e32_j1939_send_raw_on(g_a, 0, PGN_PROP_B, data, sizeof(data), SA_PEER, 6), E32_OK);
+    test_run(0);
+    CHECK_EQ(count_cm(SA_A, CM_RTS), 1);
+}
+
+static void sender_aborts_after_t3(void)
+{
+    setup();
+    start_send_to_peer();
+
+    test_run(1240);
+    CHECK_EQ(tp_stats(g_a).tx_active, 1);
+    test_run(20);
+    const cm_log_t* abort = last_cm(SA_A, CM_ABORT);
+    CHECK(abort && abort->da == SA_PEER && abort->data[1] == 3);
+    CHECK_EQ(tp_stats(g_a).tx_timeouts, 1);
+    CHECK_EQ(tp_stats(g_a).tx_active, 0);
+    test_teardown();
+}
+
+static void cts_hold_extends_to_t4(void)
+{
+    setup();
+    start_send_to_peer();
+
+    test_run(1000);
+    inject_cts(SA_PEER, SA_A, 0, 0xFF);      /* Hold: no packets yet */
+
+    test_run(1040);                          /* Well past T3 of the RTS */
+    CHECK_EQ(tp_stats(g_a).tx_active, 1);
+    CHECK_EQ(count_cm(SA_A, CM_ABORT), 0);
+    test_run(20);
+    CHECK_EQ(tp_stats(g_a).tx_timeouts, 1);
+    CHECK_EQ(count_cm(SA_A, CM_ABORT), 1);
+    test_teardown();
+}
+
+static void sender_follows_cts_to_eom(void)
+{
+    setup();
+    start_send_to_peer();
+
+    inject_cts(SA_PEER, SA_A, 3, 1);
+    CHECK_EQ(tp_stats(g_a).tx_active, 1);
+
+    inject_cts(SA_PEER, SA_A, 1, 2);         /* Retransmit after the last window */
+    inject_cm(SA_PEER, SA_A, CM_EOM_ACK, 20, 3, 0xFF);
+    CHECK_EQ(tp_stats(g_a).tx_completed, 1);
+    CHECK_EQ(tp_stats(g_a).tx_active, 0);
+    test_teardown();
+}
+
+static void receiver_abort_closes_send_session(void)
+{
+    setup();
+    start_send_to_peer();
+
+    inject_cm(SA_PEER, SA_A, CM_ABORT, 0xFF01, 0xFF, 0xFF);
+    CHECK_EQ(tp_stats(g_a).tx_aborted, 1);
+    CHECK_EQ(tp_stats(g_a).tx_active, 0);
+
+    test_run(1300);                          /* No timeout abort follows */
+    CHECK_EQ(count_cm(SA_A, CM_ABORT), 0);
+    test_teardown();
+}
+
+int main(void)
+{
+    RUN(bam_100_bytes_arrive_intact);
+    RUN(bam_gap_discards_message);
+    RUN(bam_times_out_after_t1);
+    RUN(rts_cts_200_bytes_arrive_intact);
+    RUN(receiver_honours_packets_per_cts);
+    RUN(gap_requests_one_resync_cts);
+    RUN(receiver_aborts_after_t2);
+    RUN(receiver_aborts_after_t1);
+    RUN(rejects_rts_above_max_len);
+    RUN(sender_abort_closes_receive_session);
+    RUN(sender_aborts_after_t3);
+    RUN(cts_hold_extends_to_t4);
+    RUN(sender_follows_cts_to_eom);
+    RUN(receiver_abort_closes_send_session);
+    return TEST_RESULT();
+}
@@ -0,0 +1,245 @@
+/**
+ * @file test_tx_queue.c
+ * @brief Embedded32 SDK - Transmit Queue Tests
+ *
+ * The prioritised queue on its own, flushed into a recording backend.
+ *
+ * Tests:
+ * - Bursts go out in arbitration order, FIFO within a priority
+ * - A coalescing frame replaces the queued one with its identifier in
+ *   place, cancelling the old completion; other frames are never replaced
+ * - A full queue refuses but still coalesces
+ * - Partial accepts and backend errors keep the rest queued in order
+ * - Completion callbacks may queue again; cancel completes everything
+ */
+
+#include "e32_test.h"
+#include "e32_tx_queue.h"
+#include "e32_codec.h"
+#include <string.h>
+
+#define PGN_PROP_B  0xFF20
+
+/* Recording backend */
+static e32_can_frame_t g_sent[8 * E32_CFG_TX_QUEUE_SIZE];
+static int             g_sent_count;
+static int             g_accept = 1000;     /* Frames accepted per call */
+static int             g_fail;              /* Return this error once when non-zero */
+
+static int record_send(void* ctx, const e32_can_frame_t* frames, int count)
+{
+    (void)ctx;
+    if (g_fail) {
+        int rc = g_fail;
+        g_fail = 0;
+        return rc;
+    }
+    int n = count < g_accept ? count : g_accept;
+    for (int i = 0; i < n; i++) {
+        g_sent[g_sent_count++] = frames[i];
+    }
+    return n;
+}
+
+/* Completions */
+static e32_error_t g_status[64];
+static uint8_t     g_status_tag[64];
+static int         g_done_count;
+
+static void note_done(const e32_can_frame_t* frame, e32_error_t status, void* user)
+{
+    (void)frame;
+    if (g_done_count < 64) {
+        g_status[g_done_count] = status;
+        g_status_tag[g_done_count++] = (uint8_t)(uintptr_t)user;
+    }
+}
+
+static e32_tx_queue_t g_queue;
+
+static void reset(void)
+{
+    e32_tx_queue_init(&g_queue);
+    g_sent_count = 0;
+    g_accept = 1000;
+    g_fail = 0;
+    g_done_count = 0;
+}
+
+/* Frame of pgn at a priority from sa, data[0] = tag */
+static e32_can_frame_t tagged(uint32_t pgn, uint8_t priority, uint8_t sa, uint8_t tag)
+{
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.id = e32_build_j1939_id(pgn, sa, priority, E32_SA_GLOBAL);
+    frame.is_extended = true;
+    frame.dlc = 8;
+    frame.data[0] = tag;
+    return frame;
+}
+
+static void push(uint32_t pgn, uint8_t priority, uint8_t sa, uint8_t tag, uint8_t flags)
+{
+    e32_can_frame_t frame = tagged(pgn, priority, sa, tag);
+    CHECK_EQ(e32_tx_queue_push(&g_queue, &frame, flags, note_done, (void*)(uintptr_t)tag), E32_OK);
+}
+
+static void check_sent_tags(const uint8_t* tags, int count)
+{
+    CHECK_EQ(g_sent_count, count);
+    for (int i = 0; i < count && i < g_sent_count; i++) {
+        CHECK_EQ(g_sent[i].data[0], tags[i]);
+    }
+}
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void sends_in_arbitration_order(void)
+{
+    reset();
+    push(PGN_PROP_B, 6, 0x20, 1, 0);
+    push(PGN_PROP_B, 3, 0x20, 2, 0);
+    push(PGN_PROP_B, 7, 0x20, 3, 0);
+    push(PGN_PROP_B, 6, 0x21, 4, 0);
+    push(PGN_PROP_B, 0, 0x20, 5, 0);
+
+    CHECK_EQ(e32_tx_queue_flush(&g_queue, record_send, NULL, 2), 5);
+    static const uint8_t order[] = { 5, 2, 1, 4, 3 };
+    check_sent_tags(order, 5);
+    CHECK_EQ(g_queue.depth, 0);
+    CHECK_EQ(g_queue.stats.sent, 5);
+    CHECK_EQ(g_queue.stats.peak_depth, 5);
+    CHECK_EQ(g_done_count, 5);
+}
+
+static void coalesces_in_place(void)
+{
+    reset();
+    push(E32_PGN_EEC1, 3, 0x20, 1, E32_TX_COALESCE);
+    push(PGN_PROP_B, 3, 0x20, 2, 0);
+    push(E32_PGN_EEC1, 3, 0x20, 3, E32_TX_COALESCE);   /* Replaces 1 */
+    CHECK_EQ(g_queue.depth, 2);
+    CHECK_EQ(g_queue.stats.coalesced, 1);
+    CHECK_EQ(g_done_count, 1);
+    CHECK_EQ(g_status[0], E32_ERR_CANCELLED);
+    CHECK_EQ(g_status_tag[0], 1);
+
+    /* Not coalesced: a plain frame, another source, another priority */
+    push(E32_PGN_EEC1, 3, 0x20, 4, 0);
+    push(E32_PGN_EEC1, 3, 0x21, 5, E32_TX_COALESCE);
+    push(E32_PGN_EEC1, 2, 0x20, 6, E32_TX_COALESCE);
+    /* A coalescing frame does not replace a plain one with its identifier */
+    push(PGN_PROP_B, 3, 0x20, 7, E32_TX_COALESCE);
+    CHECK_EQ(g_queue.depth, 6);
+    CHECK_EQ(g_queue.stats.coalesced, 1);
+
+    e32_tx_queue_flush(&g_queue, record_send, NULL, 0);
+    static const uint8_t order[] = { 6, 3, 2, 4, 5, 7 };
+    check_sent_tags(order, 6);
+}
+
+static void full_queue_still_coalesces(void)
+{
+    reset();
+    push(E32_PGN_EEC1, 3, 0x20, 1, E32_TX_COALESCE);
+    for (int i = 1; i < E32_CFG_TX_QUEUE_SIZE; i++) {
+        push(PGN_PROP_B, 6, 0x20, (uint8_t)(i + 1), 0);
+    }
+
+    e32_can_frame_t extra = tagged(PGN_PROP_B, 6, 0x20, 99);
+    CHECK_EQ(e32_tx_queue_push(&g_queue, &extra, 0, NULL, NULL), E32_ERR_BUSY);
+    CHECK_EQ(g_queue.stats.rejected, 1);
+
+    e32_can_frame_t update = tagged(E32_PGN_EEC1, 3, 0x20, 50);
+    CHECK_EQ(e32_tx_queue_push(&g_queue, &update, E32_TX_COALESCE, NULL, NULL), E32_OK);
+    CHECK_EQ(g_queue.depth, E32_CFG_TX_QUEUE_SIZE);
+
+    e32_tx_queue_flush(&g_queue, record_send, NULL, 0);
+    CHECK_EQ(g_sent_count, E32_CFG_TX_QUEUE_SIZE);
+    CHECK_EQ(g_sent[0].data[0], 50);
+}
+
+static void partial_accept_keeps_order(void)
+{
+    reset();
+    for (uint8_t i = 0; i < 10; i++) {
+        push(PGN_PROP_B, (uint8_t)(i % 2 ? 6 : 3), 0x20, i, 0);
+    }
+
+    g_accept = 3;
+    CHECK_EQ(e32_tx_queue_flush(&g_queue, record_send, NULL, 4), 3);   /* Stops when short */
+    CHECK_EQ(g_queue.depth, 7);
+    CHECK_EQ(g_done_count, 3);
+
+    g_fail = E32_ERR_IO;
+    CHECK_EQ(e32_tx_queue_flush(&g_queue, record_send, NULL, 4), 0);
+    CHECK_EQ(g_queue.stats.errors, 1);
+    CHECK_EQ(g_queue.depth, 6);                 /* The first frame failed, not the burst */
+    CHECK_EQ(g_status[3], E32_ERR_IO);
+    CHECK_EQ(g_status_tag[3], 6);
+
+    g_accept = 1000;
+    e32_tx_queue_flush(&g_queue, record_send, NULL, 4);
+    static const uint8_t order[] = { 0, 2, 4, 8, 1, 3, 5, 7, 9 };
+    check_sent_tags(order, 9);
+    CHECK_EQ(g_queue.stats.sent, 9);
+}
+
+static void requeue_from_completion(const e32_can_frame_t* frame, e32_error_t status, void* user)
+{
+    (void)status; (void)user;
+    if (frame->data[0] < 5) {
+        e32_can_frame_t next = *frame;
+        next.data[0]++;
+        CHECK_EQ(e32_tx_queue_push(&g_queue, &next, 0, requeue_from_completion, NULL), E32_OK);
+    }
+}
+
+static void completions_may_requeue(void)
+{
+    reset();
+    for (int i = 0; i < E32_CFG_TX_QUEUE_SIZE; i++) {
+        e32_can_frame_t frame = tagged(PGN_PROP_B, 6, 0x20, 0);
+        CHECK_EQ(e32_tx_queue_push(&g_queue, &frame, 0, requeue_from_completion, NULL), E32_OK);
+    }
+    /* Entries are free again before callbacks run, even in a full queue */
+    for (int round = 0; round < 6; round++) {
+        e32_tx_queue_flush(&g_queue, record_send, NULL, 0);
+    }
+    CHECK_EQ(g_sent_count, 6 * E32_CFG_TX_QUEUE_SIZE);
+    CHECK_EQ(g_queue.depth, 0);
+    CHECK_EQ(g_queue.stats.rejected, 0);
+}
+
+static void cancel_completes_everything(void)
+{
+    reset();
+    push(PGN_PROP_B, 6, 0x20, 1, 0);
+    push(PGN_PROP_B, 2, 0x20, 2, E32_TX_COALESCE);
+    push(PGN_PROP_B, 7, 0x20, 3, 0);
+    e32_tx_queue_cancel(&g_queue, E32_ERR_NOT_CONNECTED);
+    CHECK_EQ(g_queue.depth, 0);
+    CHECK_EQ(g_done_count, 3);
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ(g_status[i], E32_ERR_NOT_CONNECTED);
+    }
+
+    /* Every entry is back: the queue fills completely again */
+    for (int i = 0; i < E32_CFG_TX_QUEUE_SIZE; i++) {
+        push(PGN_PROP_B, 6, 0x20, 0, 0);
+    }
+    CHECK_EQ(g_queue.stats.rejected, 0);
+}
+
+int main(void)
+{
+    RUN(sends_in_arbitration_order);
+    RUN(coalesces_in_place);
+    RUN(full_queue_still_coalesces);
+    RUN(partial_accept_keeps_order);
+    RUN(completions_may_requeue);
+    RUN(cancel_completes_everything);
+    return TEST_RESULT();
+}
@@ -0,0 +1,238 @@
+/**
+ * @file test_vbus.c
+ * @brief Embedded32 SDK - Virtual Bus Tests
+ *
+ * Clients on a manual-clock virtual bus, with bit timing and with the
+ * fault generator turned on.
+ *
+ * Tests:
+ * - Frames waiting on several nodes go out lowest identifier first, each
+ *   for its bit time; losers are counted; nobody hears its own frames
+ * - Error frames cost bus time and are retried; drops only cost the
+ *   receiver the frame; every frame is accounted for
+ * - The same seed repeats a run exactly, another seed does not
+ * - Configuration checks
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include "e32_busload.h"
+
+#define PGN_PROP_B  0xFF20
+
+/* Each delivery: receiving client and sender */
+typedef struct {
+    int      receiver;
+    uint8_t  sa;
+} heard_t;
+
+static heard_t g_heard[4096];
+static int     g_heard_count;
+
+static void hear(const e32_j1939_view_t* view, void* user_data)
+{
+    if (g_heard_count < (int)(sizeof(g_heard) / sizeof(g_heard[0]))) {
+        g_heard[g_heard_count].receiver = (int)(intptr_t)user_data;
+        g_heard[g_heard_count].sa = view->source_address;
+        g_heard_count++;
+    }
+}
+
+static e32_j1939_client_t listening_client(const char* bus, uint8_t sa, int tag)
+{
+    e32_j1939_client_t client = test_client(bus, sa);
+    CHECK_EQ(e32_j1939_on_pgn_view(client, PGN_PROP_B, hear, (void*)(intptr_t)tag, NULL), E32_OK);
+    return client;
+}
+
+static int heard_by(int receiver)
+{
+    int n = 0;
+    for (int i = 0; i < g_heard_count; i++) {
+        n += g_heard[i].receiver == receiver;
+    }
+    return n;
+}
+
+/* ==========================================================================
+ * TESTS
+ * ========================================================================== */
+
+static void arbitrates_by_identifier(void)
+{
+    e32_vbus_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.name = "vbus0";
+    config.bitrate = 250000;
+    config.stuffing = E32_STUFFING_NONE;
+    e32_vbus_t* bus = test_bus_ex(&config);
+
+    e32_j1939_client_t low = listening_client("vbus0", 0x30, 0);
+    e32_j1939_client_t mid = listening_client("vbus0", 0x20, 1);
+    e32_j1939_client_t high = listening_client("vbus0", 0x10, 2);
+    listening_client("vbus0", 0x40, 3);
+    g_heard_count = 0;
+
+    /* Time stands still: all three wait, queued in the wrong order */
+    const uint8_t data[8] = { 0 };
+    CHECK_EQ(e32_j1939_send_raw(low, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6), E32_OK);
+    CHECK_EQ(e32_j1939_send_raw(mid, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 3), E32_OK);
+    CHECK_EQ(e32_j1939_send_raw(high, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 3), E32_OK);
+    test_run(0);
+    CHECK_EQ(g_heard_count, 0);
+
+    test_run(5);
+    CHECK_EQ(g_heard_count, 9);
+    CHECK_EQ(heard_by(3), 3);
+    for (int i = 0; i < g_heard_count; i++) {
+        CHECK(g_heard[i].sa != (uint8_t)(0x30 - 0x10 * g_heard[i].receiver));
+    }
+
+    /* The listener heard priority first, then the lower source address */
+    const uint8_t order[3] = { 0x10, 0x20, 0x30 };
+    int n = 0;
+    for (int i = 0; i < g_heard_count; i++) {
+        if (g_heard[i].receiver == 3) {
+            CHECK_EQ(g_heard[i].sa, order[n]);
+            n++;
+        }
+    }
+
+    e32_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.is_extended = true;
+    frame.dlc = 8;
+    uint32_t frame_us = e32_busload_frame_bits(&frame, E32_STUFFING_NONE) * 4u;
+
+    e32_vbus_stats_t stats;
+    CHECK_EQ(e32_vbus_get_stats(bus, &stats), E32_OK);
+    CHECK_EQ(stats.frames, 3);
+    CHECK_EQ(stats.arbitration_lost, 2 + 1);
+    CHECK_EQ(stats.nodes, 4);
+    CHECK_EQ(stats.busy_us, 3 * frame_us);
+    CHECK_EQ(stats.time_us, 5000);
+    CHECK_EQ(stats.error_frames, 0);
+    CHECK_EQ(stats.dropped, 0);
+    test_teardown();
+}
+
+#define FAULT_FRAMES    1000
+
+/* One sender, two receivers, FAULT_FRAMES frames through the fault generator */
+static void faulty_run(uint32_t seed, e32_vbus_stats_t* stats)
+{
+    e32_vbus_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.name = "vbus1";
+    config.seed = seed;
+    config.error_ppm = 20000;
+    config.burst_ppm = 5000;
+    config.burst_length = 4;
+    config.drop_ppm = 30000;
+    e32_vbus_t* bus = test_bus_ex(&config);
+
+    e32_j1939_client_t sender = test_client("vbus1", 0x30);
+    listening_client("vbus1", 0x31, 1);
+    listening_client("vbus1", 0x32, 2);
+    g_heard_count = 0;
+
+    const uint8_t data[8] = { 0 };
+    for (int i = 0; i < FAULT_FRAMES; i++) {
+        CHECK_EQ(e32_j1939_send_raw(sender, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6), E32_OK);
+        test_run(0);
+    }
+    e32_vbus_get_stats(bus, stats);
+    test_teardown();
+}
+
+static void faults_are_retried_or_dropped(void)
+{
+    e32_vbus_stats_t stats;
+    faulty_run(42, &stats);
+
+    /* Destroyed transmissions are retried until they complete */
+    CHECK_EQ(stats.frames, FAULT_FRAMES);
+    CHECK(stats.error_frames > 0);
+    CHECK(stats.error_frames < FAULT_FRAMES / 5);
+
+    /* A drop costs one receiver one frame */
+    CHECK(stats.dropped > 0);
+    CHECK_EQ(g_heard_count + (int)stats.dropped, 2 * FAULT_FRAMES);
+    CHECK(heard_by(1) < FAULT_FRAMES);
+    CHECK(heard_by(2) < FAULT_FRAMES);
+    CHECK_EQ(stats.overflows, 0);
+
+    /* A transmission that never gets through holds the bus in error frames */
+    e32_vbus_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.name = "vbus2";
+    config.bitrate = 250000;
+    config.stuffing = E32_STUFFING_NONE;
+    config.seed = 1;
+    config.error_ppm = 999999;
+    e32_vbus_t* bus = test_bus_ex(&config);
+    e32_j1939_client_t sender = test_client("vbus2", 0x30);
+    const uint8_t data[8] = { 0 };
+    CHECK_EQ(e32_j1939_send_raw(sender, PGN_PROP_B, data, 8, E32_SA_GLOBAL, 6), E32_OK);
+    test_run(10);
+    CHECK_EQ(e32_vbus_get_stats(bus, &stats), E32_OK);
+    CHECK_EQ(stats.frames, 0);
+    CHECK(stats.error_frames > 10);
+    CHECK(stats.busy_us > 9000);
+    test_teardown();
+}
+
+static void seed_repeats_a_run(void)
+{
+    e32_vbus_stats_t first, again, other;
+    faulty_run(7, &first);
+    int heard = g_heard_count;
+    int heard_one = heard_by(1);
+
+    faulty_run(7, &again);
+    CHECK_EQ(g_heard_count, heard);
+    CHECK_EQ(heard_by(1), heard_one);
+    CHECK_EQ(again.frames, first.frames);
+    CHECK_EQ(again.error_frames, first.error_frames);
+    CHECK_EQ(again.dropped, first.dropped);
+
+    faulty_run(8, &other);
+    CHECK(other.error_frames != first.error_frames || other.dropped != first.dropped);
+}
+
+static void checks_configuration(void)
+{
+    e32_vbus_config_t config;
+    memset(&config, 0, sizeof(config));
+    e32_vbus_t* bus = NULL;
+    CHECK_EQ(e32_vbus_create(&config, &bus), E32_ERR_INVALID_PARAM);
+
+    config.name = "vbus3";
+    config.error_ppm = 1000000;
+    CHECK_EQ(e32_vbus_create(&config, &bus), E32_ERR_INVALID_PARAM);
+    config.error_ppm = 0;
+    config.burst_ppm = 1000000;
+    CHECK_EQ(e32_vbus_create(&config, &bus), E32_ERR_INVALID_PARAM);
+
+    /* Losing every delivery is allowed; names are unique */
+    config.burst_ppm = 0;
+    config.drop_ppm = 1000000;
+    CHECK_EQ(e32_vbus_create(&config, &bus), E32_OK);
+    e32_vbus_t* twin = NULL;
+    CHECK_EQ(e32_vbus_create(&config, &twin), E32_ERR_BUSY);
+    e32_vbus_destroy(bus);
+    CHECK_EQ(e32_vbus_create(&config, &twin), E32_OK);
+    e32_vbus_destroy(twin);
+
+    CHECK_EQ(e32_vbus_advance(NULL, 1000), E32_ERR_INVALID_PARAM);
+    CHECK_EQ(e32_vbus_inject(NULL, NULL, 0), E32_ERR_INVALID_PARAM);
+}
+
+int main(void)
+{
+    RUN(arbitrates_by_identifier);
+    RUN(faults_are_retried_or_dropped);
+    RUN(seed_repeats_a_run);
+    RUN(checks_configuration);
+    return TEST_RESULT();
+}
@@ -0,0 +1,248 @@
+/**
+ * @file test_workers.c
+ * @brief Embedded32 SDK - Threaded Dispatch Tests
+ *
+ * Clients with config.workers on a manual-clock virtual bus, and the
+ * worker pool on its own.
+ *
+ * Tests:
+ * - Per-source ordering across subscription changes that restart the pool
+ * - Subscribing from a handler on a worker is refused
+ * - A full worker queue drops the item and counts it
+ * - Payloads are copied into the queue: the caller's buffer may change
+ * - Reassembled messages reach handlers on workers intact
+ */
+
+#include "e32_test.h"
+#include "e32_test_bus.h"
+#include "e32_workers.h"
+#include <pthread.h>
+
+#define PGN_PROP_B      0xFF20
+#define PGN_PROP_B2     0xFF21
+#define SOURCES         8
+#define ROUNDS          120
+
+/* ==========================================================================
+ * ORDERING
+ * ========================================================================== */
+
+/* Each source is handled by one thread at a time, so no locking */
+static uint16_t g_next[SOURCES];
+static uint32_t g_out_of_order[SOURCES];
+static uint32_t g_late_seen[SOURCES];
+static e32_error_t g_nested = E32_OK;
+
+static void count_in_order(const e32_j1939_message_t* msg, void* user)
+{
+    (void)user;
+    uint8_t src = msg->source_address - 0x40;
+    uint16_t seq = (uint16_t)(msg->raw[0] | (msg->raw[1] << 8));
+    if (seq != g_next[src]) {
+        g_out_of_order[src]++;
+    }
+    g_next[src] = (uint16_t)(seq + 1);
+}
+
+static void count_late(const e32_j1939_message_t* msg, void* user)
+{
+    (void)user;
+    g_late_seen[msg->source_address - 0x40]++;
+}
+
+static void ignore(const e32_j1939_message_t* msg, void* user)
+{
+    (void)msg; (void)user;
+}
+
+static void subscribe_from_worker(const e32_j1939_message_t* msg, void* user)
+{
+    (void)msg;
+    g_nested = e32_j1939_on_pgn((e32_j1939_client_t)user, PGN_PROP_B2, ignore, NULL, NULL);
+}
+
+static void inject_seq(e32_vbus_t* bus, uint8_t src, uint16_t seq)
+{
+    const uint8_t data[8] = { (uint8_t)seq, (uint8_t)(seq >> 8), src, 0, 0, 0, 0, 0 };
+    test_inject(bus, PGN_PROP_B, (uint8_t)(0x40 + src), E32_SA_GLOBAL, 6, data);
+}
+
+static void orders_per_source_across_restarts(void)
+{
+    e32_vbus_t* bus = test_bus("vwork");
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.interface_name = "vwork";
+    config.workers = 4;
+    config.affinity = E32_AFFINITY_SOURCE;
+    e32_j1939_client_t client = test_client_ex(&config, 0x20);
+
+    memset(g_next, 0, sizeof(g_next));
+    memset(g_out_of_order, 0, sizeof(g_out_of_order));
+    memset(g_late_seen, 0, sizeof(g_late_seen));
+    CHECK_EQ(e32_j1939_on_pgn(client, PGN_PROP_B, count_in_order, NULL, NULL), E32_OK);
+
+    for (uint16_t round = 0; round < ROUNDS; round++) {
+        for (uint8_t src = 0; src < SOURCES; src++) {
+            inject_seq(bus, src, round);
+        }
+        if (round % 20 == 10) {
+            /* Stops the running pool; the next message starts another */
+            CHECK_EQ(e32_j1939_on_pgn(client, E32_PGN_DM1, ignore, NULL, NULL), E32_OK);
+            CHECK_EQ(e32_j1939_off_pgn(client, E32_PGN_DM1), E32_OK);
+        }
+        if (round == ROUNDS / 2) {
+            CHECK_EQ(e32_j1939_on_pgn(client, PGN_PROP_B, count_late, NULL, NULL), E32_OK);
+        }
+    }
+
+    /* Drains the queues before the counters are read */
+    CHECK_EQ(e32_j1939_off_pgn(client, PGN_PROP_B), E32_OK);
+
+    for (uint8_t src = 0; src < SOURCES; src++) {
+        CHECK_EQ(g_next[src], ROUNDS);
+        CHECK_EQ(g_out_of_order[src], 0);
+        CHECK_EQ(g_late_seen[src], ROUNDS - ROUNDS / 2 - 1);
+    }
+
+    e32_stats_t stats;
+    CHECK_EQ(e32_j1939_get_stats(client, &stats), E32_OK);
+    CHECK_EQ(stats.worker_overflows, 0);
+    test_teardown();
+}
+
+static void refuses_subscribe_on_worker(void)
+{
+    e32_vbus_t* bus = test_bus("vwork");
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.interface_name = "vwork";
+    config.workers = 2;
+    e32_j1939_client_t client = test_client_ex(&config, 0x20);
+
+    g_nested = E32_OK;
+    CHECK_EQ(e32_j1939_on_pgn(client, PGN_PROP_B, subscribe_from_worker, client, NULL), E32_OK);
+    inject_seq(bus, 0, 0);
+    CHECK_EQ(e32_j1939_off_pgn(client, PGN_PROP_B), E32_OK);
+
+    CHECK_EQ(g_nested, E32_ERR_BUSY);
+    test_teardown();
+}
+
+static uint8_t  g_message[64];
+static uint16_t g_message_len;
+
+static void keep_message(const e32_j1939_message_t* msg, void* user)
+{
+    (void)user;
+    g_message_len = msg->payload_len;
+    memcpy(g_message, msg->payload, msg->payload_len < sizeof(g_message) ? msg->payload_len : sizeof(g_message));
+}
+
+static void delivers_reassembled_payload(void)
+{
+    test_bus("vwork");
+    e32_j1939_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.interface_name = "vwork";
+    config.workers = 2;
+    e32_j1939_client_t client = test_client_ex(&config, 0x20);
+    e32_j1939_client_t sender = test_client("vwork", 0x41);
+
+    g_message_len = 0;
+    CHECK_EQ(e32_j1939_on_pgn(client, PGN_PROP_B, keep_message, NULL, NULL), E32_OK);
+
+    uint8_t data[40];
+    for (int i = 0; i < 40; i++) {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+    CHECK_EQ(e32_j1939_send_raw_on(sender, 0, PGN_PROP_B, data, sizeof(data), E32_SA_GLOBAL, 6), E32_OK);
+    test_run(8 * E32_CFG_TP_BAM_INTERVAL_MS);
+    CHECK_EQ(e32_j1939_off_pgn(client, PGN_PROP_B), E32_OK);
+
+    CHECK_EQ(g_message_len, 40);
+    CHECK(memcmp(g_message, data, 40) == 0);
+    test_teardown();
+}
+
+/* ==========================================================================
+ * POOL
+ * ========================================================================== */
+
+static pthread_mutex_t g_gate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_gate_open = PTHREAD_COND_INITIALIZER;
+static int             g_gate;
+static uint32_t        g_handled;
+static uint32_t        g_corrupt;
+
+/* Holds its slot until the gate opens, so the queue cannot drain */
+static void wait_at_gate(void* ctx, const e32_work_item_t* item)
+{
+    (void)ctx;
+    pthread_mutex_lock(&g_gate_lock);
+    while (!g_gate) {
+        pthread_cond_wait(&g_gate_open, &g_gate_lock);
+    }
+    g_handled++;
+    for (uint16_t i = 0; i < item->payload_len; i++) {
+        g_corrupt += item->payload[i] != (uint8_t)(item->pgn + i);
+    }
+    pthread_mutex_unlock(&g_gate_lock);
+}
+
+static void full_queue_drops_and_counts(void)
+{
+    e32_workers_t* pool = NULL;
+    g_gate = 0;
+    g_handled = 0;
+    CHECK_EQ(e32_workers_start(&pool, 1, wait_at_gate, NULL), E32_OK);
+    if (!pool) {
+        return;
+    }
+    CHECK(!e32_workers_on_worker(pool));
+
+    /* One buffer, rewritten for every item: the queue keeps its own copies */
+    static uint8_t buffer[E32_CFG_TP_MAX_LEN + 1];
+    e32_work_item_t item;
+    memset(&item, 0, sizeof(item));
+    item.payload = buffer;
+    int accepted = 0;
+    e32_error_t last = E32_OK;
+    g_corrupt = 0;
+    for (int i = 0; i <= E32_CFG_WORKER_QUEUE_SIZE; i++) {
+        item.pgn = (uint32_t)i;
+        item.payload_len = (uint16_t)(i % 2 ? E32_CFG_TP_MAX_LEN : 9);
+        for (uint16_t k = 0; k < item.payload_len; k++) {
+            buffer[k] = (uint8_t)(item.pgn + k);
+        }
+        last = e32_workers_push(pool, 7, &item);
+        accepted += last == E32_OK;
+    }
+    CHECK_EQ(accepted, E32_CFG_WORKER_QUEUE_SIZE);
+    CHECK_EQ(last, E32_ERR_BUSY);
+
+    item.payload_len = E32_CFG_TP_MAX_LEN + 1;
+    CHECK_EQ(e32_workers_push(pool, 7, &item), E32_ERR_INVALID_PARAM);
+
+    e32_worker_stats_t stats;
+    CHECK_EQ(e32_workers_get_stats(pool, 0, &stats), E32_OK);
+    CHECK_EQ(stats.overflows, 2);
+
+    pthread_mutex_lock(&g_gate_lock);
+    g_gate = 1;
+    pthread_cond_broadcast(&g_gate_open);
+    pthread_mutex_unlock(&g_gate_lock);
+
+    e32_workers_stop(pool);
+    CHECK_EQ(g_handled, E32_CFG_WORKER_QUEUE_SIZE);
+    CHECK_EQ(g_corrupt, 0);
+}
+
+int main(void)
+{
+    RUN(orders_per_source_across_restarts);
+    RUN(refuses_subscribe_on_worker);
+    RUN(delivers_reassembled_payload);
+    RUN(full_queue_drops_and_counts);
+    return TEST_RESULT();
+}
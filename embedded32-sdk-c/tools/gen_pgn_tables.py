@@ -0,0 +1,323 @@
+#!/usr/bin/env python3
+"""
+Embedded32 SDK - PGN/SPN decoder table generator
+
+Reads J1939 definitions from JSON (defs/j1939_pgns.json format) and/or
+J1939 DBC files, and writes the constant decoder tables consumed by
+src/e32_codec.c. Later inputs override PGNs defined by earlier ones, so
+an OEM DBC can be layered on top of the standard JSON catalogue.
+
+Usage:
+    python3 tools/gen_pgn_tables.py defs/j1939_pgns.json [oem.dbc ...] \\
+        -o src/e32_pgn_defs.c
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import sys
+from fractions import Fraction
+
+SPN_TYPES = {"int": "E32_SPN_TYPE_INT", "float": "E32_SPN_TYPE_FLOAT", "bool": "E32_SPN_TYPE_BOOL"}
+
+
+class DefinitionError(Exception):
+    pass
+
+
+# =============================================================================
+# INPUT PARSING
+# =============================================================================
+
+def parse_int(value):
+    if isinstance(value, int):
+        return value
+    return int(str(value), 0)
+
+
+def parse_number(value):
+    """Resolution/offset: a number, or an exact ratio such as "1/20"."""
+    if isinstance(value, str) and "/" in value:
+        return Fraction(value)
+    return float(value)
+
+
+def infer_type(bit_length, scale, offset):
+    if scale != int(scale) or offset != int(offset):
+        return "float"
+    if bit_length <= 2 and scale == 1 and offset == 0:
+        return "bool"
+    return "int"
+
+
+def pgn_from_can_id(can_id):
+    """Extract the PGN from a 29-bit identifier (PS dropped for PDU1)."""
+    pgn = (can_id >> 8) & 0x3FFFF
+    if ((pgn >> 8) & 0xFF) < 240:
+        pgn &= 0x3FF00
+    return pgn
+
+
+def load_json(path):
+    with open(path, encoding="utf-8") as f:
+        doc = json.load(f)
+
+    pgns = {}
+    for entry in doc.get("pgns", []):
+        pgn = parse_int(entry["pgn"])
+        spns = []
+        for s in entry.get("spns", []):
+            scale = parse_number(s.get("resolution", 1))
+            offset = parse_number(s.get("offset", 0))
+            bit_length = parse_int(s["bitLength"])
+            spns.append({
+                "spn": parse_int(s["spn"]),
+                "name": s["name"],
+                "start_bit": parse_int(s["startBit"]),
+                "bit_length": bit_length,
+                "type": s.get("type") or infer_type(bit_length, scale, offset),
+                "scale": scale,
+                "offset": offset,
+                "signed": bool(s.get("signed", False)),
+            })
+        pgns[pgn] = {
+            "pgn": pgn,
+            "name": entry.get("name", ""),
+            "length": parse_int(entry.get("length", 8)),
+            "spns": spns,
+            "source": path,
+        }
+    return pgns
+
+
+BO_RE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)")
+SG_RE = re.compile(
+    r"^\s*SG_\s+(\w+)\s*(?:M|m\d+)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+    r"\(\s*([-+0-9.eE]+)\s*,\s*([-+0-9.eE]+)\s*\)")
+SPN_ATTR_RE = re.compile(r'^BA_\s+"SPN"\s+SG_\s+(\d+)\s+(\w+)\s+(\d+)\s*;')
+
+
+def load_dbc(path):
+    messages = {}
+    order = []
+    current = None
+    spn_attrs = {}
+
+    with open(path, encoding="latin-1") as f:
+        for lineno, line in enumerate(f, 1):
+            m = BO_RE.match(line)
+            if m:
+                can_id = int(m.group(1))
+                current = {"id": can_id, "name": m.group(2), "length": int(m.group(3)), "signals": []}
+                messages[can_id] = current
+                order.append(can_id)
+                continue
+
+            m = SG_RE.match(line)
+            if m and current is not None:
+                name, start, length, little, sign, scale, offset = m.groups()
+                if little != "1":
+                    raise DefinitionError("%s:%d: signal %s is big-endian; J1939 signals are little-endian"
+                                          % (path, lineno, name))
+                current["signals"].append({
+                    "name": name,
+                    "start_bit": int(start),
+                    "bit_length": int(length),
+                    "signed": sign == "-",
+                    "scale": float(scale),
+                    "offset": float(offset),
+                })
+                continue
+
+            if not line.strip():
+                current = None
+
+            m = SPN_ATTR_RE.match(line)
+            if m:
+                spn_attrs[(int(m.group(1)), m.group(2))] = int(m.group(3))
+
+    pgns = {}
+    for can_id in order:
+        msg = messages[can_id]
+        pgn = pgn_from_can_id(can_id & 0x1FFFFFFF)
+        spns = []
+        for sig in msg["signals"]:
+            spn = spn_attrs.get((can_id, sig["name"]))
+            if spn is None:
+                raise DefinitionError("%s: signal %s.%s has no SPN attribute" % (path, msg["name"], sig["name"]))
+            spns.append(dict(sig, spn=spn, type=infer_type(sig["bit_length"], sig["scale"], sig["offset"])))
+        pgns[pgn] = {"pgn": pgn, "name": msg["name"], "length": msg["length"], "spns": spns, "source": path}
+    return pgns
+
+
+# =============================================================================
+# FIXED-POINT SCALING
+# =============================================================================
+
+def rational(value):
+    """Exact ratio for a decimal resolution (0.05 -> 1/20, 0.125 -> 1/8)."""
+    if isinstance(value, Fraction):
+        return value
+    return Fraction(value).limit_denominator(1 << 20)
+
+
+def fixed_point(s):
+    """
+    Integer form of value = raw * scale + offset, as
+    value * den = raw * num + offset_num. den is the smallest common
+    denominator of scale and offset.
+    """
+    scale = rational(s["scale"])
+    offset = rational(s["offset"])
+    den = scale.denominator * offset.denominator // math.gcd(scale.denominator, offset.denominator)
+    return int(scale * den), int(offset * den), den
+
+
+def fixed_point_fits(s):
+    """Whether every valid raw value maps into int32 in 1/den units."""
+    num, offset_num, _ = fixed_point(s)
+    if s["signed"]:
+        lo, hi = -(1 << (s["bit_length"] - 1)), (1 << (s["bit_length"] - 1)) - 1
+    else:
+        lo, hi = 0, (1 << s["bit_length"]) - 1
+    ends = (lo * num + offset_num, hi * num + offset_num)
+    return -(1 << 31) <= min(ends) and max(ends) < (1 << 31)
+
+
+# =============================================================================
+# VALIDATION
+# =============================================================================
+
+def validate(pgns):
+    for pgn, entry in pgns.items():
+        if pgn > 0x3FFFF:
+            raise DefinitionError("PGN 0x%X exceeds 18 bits (%s)" % (pgn, entry["source"]))
+        if not 0 < entry["length"] <= 1785:
+            raise DefinitionError("PGN 0x%X: length %d out of range" % (pgn, entry["length"]))
+        if len(entry["spns"]) > 255:
+            raise DefinitionError("PGN 0x%X: more than 255 SPNs" % pgn)
+        for s in entry["spns"]:
+            where = "PGN 0x%X SPN %d (%s)" % (pgn, s["spn"], s["name"])
+            if s["type"] not in SPN_TYPES:
+                raise DefinitionError("%s: unknown type %r" % (where, s["type"]))
+            if not 1 <= s["bit_length"] <= 32:
+                raise DefinitionError("%s: bit length must be 1-32" % where)
+            if s["start_bit"] + s["bit_length"] > entry["length"] * 8:
+                raise DefinitionError("%s: field extends past the %d-byte PGN" % (where, entry["length"]))
+            if not 0 <= s["spn"] <= 0x7FFFF:
+                raise DefinitionError("%s: SPN number exceeds 19 bits" % where)
+            num, offset_num, den = fixed_point(s)
+            if not (-(1 << 31) <= num < (1 << 31) and -(1 << 31) <= offset_num < (1 << 31)
+                    and den < (1 << 32)):
+                raise DefinitionError("%s: resolution/offset have no 32-bit fixed-point form" % where)
+            if s["type"] != "bool" and not fixed_point_fits(s):
+                print("gen_pgn_tables: warning: %s: compact values saturate at the ends of the range"
+                      % where, file=sys.stderr)
+
+
+# =============================================================================
+# OUTPUT
+# =============================================================================
+
+def c_float(value):
+    text = "%.9g" % value
+    if "." not in text and "e" not in text:
+        text += ".0"
+    return text + "f"
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def render(pgns, inputs):
+    spn_rows = []
+    spn_index = {}      # identical SPN lists (e.g. ETC1 / proprietary copy) share rows
+    pgn_rows = []
+
+    for pgn in sorted(pgns):
+        entry = pgns[pgn]
+        first = 0
+        if entry["spns"]:
+            key = tuple((s["spn"], s["name"], s["start_bit"], s["bit_length"], s["type"],
+                         rational(s["scale"]), rational(s["offset"]), s["signed"])
+                        for s in entry["spns"])
+            if key not in spn_index:
+                spn_index[key] = len(spn_rows)
+                spn_rows.extend(entry["spns"])
+            first = spn_index[key]
+        pgn_rows.append((pgn, entry["name"] or ("PGN 0x%05X" % pgn), first,
+                         len(entry["spns"]), entry["length"]))
+
+    if len(spn_rows) > 0xFFFF:
+        raise DefinitionError("more than 65535 SPN rows")
+
+    sources = ", ".join(os.path.relpath(p).replace(os.sep, "/") for p in inputs)
+    out = []
+    out.append("/**")
+    out.append(" * @file e32_pgn_defs.c")
+    out.append(" * @brief Embedded32 SDK - PGN/SPN Decoder Tables")
+    out.append(" *")
+    out.append(" * GENERATED FILE - DO NOT EDIT.")
+    out.append(" * Source: %s" % sources)
+    out.append(" * Regenerate with tools/gen_pgn_tables.py.")
+    out.append(" *")
+    out.append(" * @version 1.0.0")
+    out.append(" */")
+    out.append("")
+    out.append('#include "e32_pgn_defs.h"')
+    out.append("")
+    out.append("const e32_spn_def_t E32_SPN_DEFS[] E32_TABLE_ATTR = {")
+    for i, s in enumerate(spn_rows):
+        flags = "E32_SPN_FLAG_SIGNED" if s["signed"] else "0"
+        num, offset_num, den = fixed_point(s)
+        out.append("    /* %4d */ { %6d, %-24s %4d, %2d, %-19s %-2s %-13s %-10s %3d, %6d, %6du }," % (
+            i, s["spn"], c_string(s["name"]) + ",", s["start_bit"], s["bit_length"],
+            SPN_TYPES[s["type"]] + ",", flags + ",", c_float(float(s["scale"])) + ",",
+            c_float(float(s["offset"])) + ",", num, offset_num, den))
+    if not spn_rows:
+        out.append("    { 0, \"\", 0, 0, E32_SPN_TYPE_INT, 0, 0.0f, 0.0f, 1, 0, 1u },")
+    out.append("};")
+    out.append("")
+    out.append("/* Every known PGN, sorted by PGN for binary search */")
+    out.append("const e32_pgn_def_t E32_PGN_DEFS[] E32_TABLE_ATTR = {")
+    for pgn, name, first, count, length in pgn_rows:
+        out.append("    { 0x%05X, %-56s %4d, %4d, %3d }," % (pgn, c_string(name) + ",", first, length, count))
+    if not pgn_rows:
+        out.append("    { 0, \"\", 0, 0, 0 },")
+    out.append("};")
+    out.append("")
+    out.append("const size_t E32_SPN_DEFS_COUNT = %d;" % len(spn_rows))
+    out.append("const size_t E32_PGN_DEFS_COUNT = %d;" % len(pgn_rows))
+    out.append("")
+    return "\n".join(out)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Generate Embedded32 C SDK decoder tables")
+    parser.add_argument("inputs", nargs="+", help="JSON (.json) or DBC (.dbc) definition files")
+    parser.add_argument("-o", "--output", required=True, help="Output C file")
+    args = parser.parse_args(argv)
+
+    pgns = {}
+    try:
+        for path in args.inputs:
+            if path.lower().endswith(".dbc"):
+                pgns.update(load_dbc(path))
+            else:
+                pgns.update(load_json(path))
+        validate(pgns)
+        text = render(pgns, args.inputs)
+    except (DefinitionError, OSError, ValueError, KeyError) as e:
+        print("gen_pgn_tables: error: %s" % e, file=sys.stderr)
+        return 1
+
+    with open(args.output, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())